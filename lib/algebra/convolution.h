@@ -23,6 +23,7 @@
 
 #include "algebra/blas.h"
 #include "algebra/fft.h"
+#include "algebra/nussbaumer.h"
 #include "algebra/rfft.h"
 
 /*
@@ -37,6 +38,10 @@ SlowConvolution uses an O(n*m) method for testing validation.
 FFTConvolution and FFTExtConvolution first pad y to length n and use advanced
 FFT algorithms to compute the same in O(nlogn) time.
 
+NussbaumerConvolution needs no root of unity and works in any field of odd
+characteristic, at the cost of an O(nlogn loglogn) algorithm that cannot
+precompute the transform of y.
+
 The const Field& objects that are passed have lifetimes that exceed the call
 durations and can be safely passed by const reference.
 */
@@ -214,6 +219,61 @@ class FFTExtConvolutionFactory {
   const EltExt omega_;
   const uint64_t omega_order_;
 };
+
+template <class Field>
+class NussbaumerConvolution {
+  using Elt = typename Field::Elt;
+
+ public:
+  NussbaumerConvolution(size_t n, size_t m, const Field& f, const Elt y[/*m*/])
+      : f_(f),
+        n_(n),
+        m_(m),
+        padding_(choose_padding(m)),
+        y_(padding_, f_.zero()) {
+    Blas<Field>::copy(m, &y_[0], 1, y, 1);
+  }
+
+  // Computes (first m entries of) convolution of x with y, outputs in z:
+  // z[k] = \sum_{i=0}^{n-1} x[i] y[k-i].
+  // The full linear product of the padded x and y is computed, of
+  // which only the first m entries are needed.
+  void convolution(const Elt x[/*n_*/], Elt z[/*m_*/]) const {
+    std::vector<Elt> x_pad(padding_, f_.zero());
+    std::vector<Elt> z_pad(2 * padding_);
+    Blas<Field>::copy(n_, &x_pad[0], 1, x, 1);
+    Nussbaumer<Field>::linear(padding_, &z_pad[0], &x_pad[0], &y_[0], f_);
+    Blas<Field>::copy(m_, z, 1, &z_pad[0], 1);
+  }
+
+ private:
+  const Field& f_;
+
+  // n is the number of points input
+  size_t n_;
+  size_t m_;  // total number of points output (points in + new points out)
+  size_t padding_;
+
+  // y padded with zeroes to the next power of 2 at least m.
+  std::vector<Elt> y_;
+};
+
+template <class Field>
+class NussbaumerConvolutionFactory {
+  using Elt = typename Field::Elt;
+
+ public:
+  using Convolver = NussbaumerConvolution<Field>;
+  explicit NussbaumerConvolutionFactory(const Field& f) : f_(f) {}
+
+  std::unique_ptr<const Convolver> make(size_t n, size_t m,
+                                        const Elt y[/*m*/]) const {
+    return std::make_unique<const Convolver>(n, m, f_, y);
+  }
+
+ private:
+  const Field& f_;
+};
 }  // namespace proofs
 
 #endif  // PRIVACY_PROOFS_ZK_LIB_ALGEBRA_CONVOLUTION_H_
@@ -0,0 +1,161 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This program times the convolution engines for several prime
+// fields over a range of sizes, and prints the crossover table and
+// the resulting TunedConvolutionFactory profile for each field.
+//
+// Usage: convolution_tuner [max_logn]
+//
+// Sizes are n = 2^k for 4 <= k <= max_logn, and m = 4n, which is
+// the shape of the Reed-Solomon code at Ligero rate 4.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "algebra/convolution.h"
+#include "algebra/crt.h"
+#include "algebra/crt_convolution.h"
+#include "algebra/fp.h"
+#include "algebra/fp2.h"
+#include "algebra/fp_p128.h"
+#include "algebra/fp_p256.h"
+#include "algebra/tuned_convolution.h"
+
+namespace proofs {
+namespace {
+
+template <class Field>
+void print_table(const char* title, TunedConvolutionFactory<Field>& tuned,
+                 size_t max_logn) {
+  tuned.set_autotune(true);
+  printf("== %s\n%8s %8s", title, "n", "m");
+  for (size_t e = 0; e < tuned.nengines(); ++e) {
+    printf(" %12s", tuned.name(e).c_str());
+  }
+  printf("  best\n");
+
+  for (size_t k = 4; k <= max_logn; ++k) {
+    size_t n = size_t(1) << k, m = 4 * n;
+    std::vector<double> t = tuned.time_all(n, m);
+    printf("%8zu %8zu", n, m);
+    for (double te : t) {
+      printf(" %10.1fus", te * 1e6);
+    }
+    printf("  %s\n", tuned.name(tuned.choose(n, m)).c_str());
+  }
+  printf("-- profile\n%s\n", tuned.profile().c_str());
+}
+
+void run(size_t max_logn) {
+  {
+    using Field = Fp256<>;
+    using Field2 = Fp2<Field>;
+    const Field f;
+    const Field2 f2(f);
+    const FFTExtConvolutionFactory<Field, Field2> fft(
+        f, f2,
+        f2.of_string("112649224146410281873500457609690258373018840430489408"
+                     "729223714171582664680802",
+                     "840879943585409076957404614278186605601821689971823787"
+                     "49313018254450460212908"),
+        1ull << 31);
+    const CrtConvolutionFactory<CRT256<Field>, Field> crt(f);
+    const NussbaumerConvolutionFactory<Field> nuss(f);
+    TunedConvolutionFactory<Field> tuned(f);
+    tuned.add("fft_ext", fft);
+    tuned.add("crt", crt);
+    tuned.add("nussbaumer", nuss);
+    print_table("Fp256", tuned, max_logn);
+  }
+  {
+    using Field = Fp128<true>;
+    const Field f;
+    const FFTConvolutionFactory<Field> fft(
+        f, f.of_string("164956748514267535023998284330560247862"), 1ull << 32);
+    const CrtConvolutionFactory<CRT256<Field>, Field> crt(f);
+    const NussbaumerConvolutionFactory<Field> nuss(f);
+    TunedConvolutionFactory<Field> tuned(f);
+    tuned.add("fft", fft);
+    tuned.add("crt", crt);
+    tuned.add("nussbaumer", nuss);
+    print_table("Fp128", tuned, max_logn);
+  }
+  {
+    using Field = Fp<1>;
+    const Field f("18446744069414584321");
+    const FFTConvolutionFactory<Field> fft(
+        f, f.of_string("2752994695033296049"), 1ull << 29);
+    const CrtConvolutionFactory<CRT256<Field>, Field> crt(f);
+    const NussbaumerConvolutionFactory<Field> nuss(f);
+    TunedConvolutionFactory<Field> tuned(f);
+    tuned.add("fft", fft);
+    tuned.add("crt", crt);
+    tuned.add("nussbaumer", nuss);
+    print_table("Fp64", tuned, max_logn);
+  }
+  {
+    using Field = Fp<6, true>;
+    const Field f(
+        "2003797487426793996089889686768405227835788807033335490997995637482"
+        "4637627743258099255609959785846902476153458524161");
+    const FFTConvolutionFactory<Field> fft(
+        f,
+        f.of_string("50647606193563528288433715408802192282898918225577021459"
+                    "32265519341948099014652144667694099245156866923045442095"
+                    "606"),
+        1ull << 22);
+    const CrtConvolutionFactory<CRT384<Field>, Field> crt(f);
+    const NussbaumerConvolutionFactory<Field> nuss(f);
+    TunedConvolutionFactory<Field> tuned(f);
+    tuned.add("fft", fft);
+    tuned.add("crt", crt);
+    tuned.add("nussbaumer", nuss);
+    print_table("Fp384", tuned, max_logn);
+  }
+  {
+    using Field = Fp<9, true>;
+    const Field f(
+        "3207947620498445696389399669374928791427377218706463849574804264443"
+        "3982545374197547568607427166023956833042445656767790708864735743465"
+        "74476927946442026254337");
+    const FFTConvolutionFactory<Field> fft(
+        f,
+        f.of_string("31823443021031919081147483961203288919826765761971511088"
+                    "43359416643738172607399657243575079979889297218330863250"
+                    "710223139208683093312148113827665536113183520"),
+        1ull << 22);
+    const CrtConvolutionFactory<CRT521<Field>, Field> crt(f);
+    const NussbaumerConvolutionFactory<Field> nuss(f);
+    TunedConvolutionFactory<Field> tuned(f);
+    tuned.add("fft", fft);
+    tuned.add("crt", crt);
+    tuned.add("nussbaumer", nuss);
+    print_table("Fp521", tuned, max_logn);
+  }
+}
+
+}  // namespace
+}  // namespace proofs
+
+int main(int argc, char** argv) {
+  size_t max_logn = 12;
+  if (argc > 1) {
+    max_logn = strtoul(argv[1], nullptr, 10);
+  }
+  proofs::run(max_logn);
+  return 0;
+}
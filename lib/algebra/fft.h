@@ -62,20 +62,9 @@ class FFT {
     F.sub(A[s], t);
   }
 
- public:
-  // Backward FFT.
-  // N (the length of A) must be a power of 2
-  static void fftb(Elt A[/*n*/], size_t n, const Elt& omega,
-                   uint64_t omega_order, const Field& F) {
-    if (n <= 1) {
-      return;
-    }
-
-    Elt omega_n = Twiddle<Field>::reroot(omega, omega_order, n, F);
-    Twiddle<Field> roots(n, omega_n, F);
-
-    Permutations<Elt>::bitrev(A, n);
-
+  // Textbook radix-2 decimation in time, on the bit-reversed A.
+  static void radix2(Elt A[/*n*/], size_t n, const Twiddle<Field>& roots,
+                     const Field& F) {
     // m=1 iteration
     for (size_t k = 0; k < n; k += 2) {
       butterfly(&A[k], 1, F);
@@ -93,6 +82,138 @@ class FFT {
     }
   }
 
+  // Two radix-2 levels fused into one pass.  The four inputs are
+  // the sub-transforms of size M at A[0], A[M], A[2M], A[3M].  The
+  // first level combines pairs into two transforms of size 2M with
+  // twiddle w_{2M}^j, and the second combines those with twiddles
+  // w_{4M}^j and w_{4M}^{j+M}.  These are the same operations as in
+  // radix2(), in a different order.
+  static void butterfly4(Elt* A, size_t m, const Elt* w1, const Elt* w2,
+                         const Elt& w3, const Field& F) {
+    Elt b0 = A[0];
+    Elt b1 = A[m];
+    Elt b2 = A[2 * m];
+    Elt b3 = A[3 * m];
+    if (w1 != nullptr) {
+      F.mul(b1, *w1);
+      F.mul(b3, *w1);
+    }
+    Elt e0 = F.addf(b0, b1);
+    Elt e1 = F.subf(b0, b1);
+    Elt o0 = F.addf(b2, b3);
+    Elt o1 = F.subf(b2, b3);
+    if (w2 != nullptr) {
+      F.mul(o0, *w2);
+    }
+    F.mul(o1, w3);
+    A[0] = F.addf(e0, o0);
+    A[2 * m] = F.subf(e0, o0);
+    A[m] = F.addf(e1, o1);
+    A[3 * m] = F.subf(e1, o1);
+  }
+
+  // One radix-4 level, combining the sub-transforms of size M into
+  // transforms of size 4M, over the block A[0, S) of a transform of
+  // size N.
+  static void level4(Elt A[/*s*/], size_t s, size_t m, size_t n,
+                     const Twiddle<Field>& roots, const Field& F) {
+    size_t ws = n / (4 * m);
+    for (size_t k = 0; k < s; k += 4 * m) {
+      butterfly4(&A[k], m, nullptr, nullptr, roots.w_[m * ws], F);  // j==0
+      for (size_t j = 1; j < m; ++j) {
+        butterfly4(&A[k + j], m, &roots.w_[2 * j * ws], &roots.w_[j * ws],
+                   roots.w_[(j + m) * ws], F);
+      }
+    }
+  }
+
+  // Radix-4 decimation in time on the bit-reversed block A[0, S) of
+  // a transform of size N.  Blocks that fit in kBlockBytes are
+  // transformed level by level, and larger blocks are split into
+  // four quarters that are transformed first.
+  static void radix4(Elt A[/*s*/], size_t s, size_t n,
+                     const Twiddle<Field>& roots, const Field& F) {
+    if (s * sizeof(Elt) <= kBlockBytes || s < 16) {
+      size_t m = s;
+      while (m > 4) {
+        m /= 4;
+      }
+      if (m == 2) {
+        // odd log2(s): one radix-2 level without twiddles
+        for (size_t k = 0; k < s; k += 2) {
+          butterfly(&A[k], 1, F);
+        }
+      } else {
+        m = 1;
+      }
+      for (; m < s; m *= 4) {
+        level4(A, s, m, n, roots, F);
+      }
+    } else {
+      size_t q = s / 4;
+      for (size_t r = 0; r < 4; ++r) {
+        radix4(&A[r * q], q, n, roots, F);
+      }
+      level4(A, s, q, n, roots, F);
+    }
+  }
+
+  static void transform(Elt A[/*n*/], size_t n, const Elt& omega,
+                        uint64_t omega_order, bool use_radix4,
+                        const Field& F) {
+    if (n <= 1) {
+      return;
+    }
+
+    Elt omega_n = Twiddle<Field>::reroot(omega, omega_order, n, F);
+    Twiddle<Field> roots(n, omega_n, F);
+
+    Permutations<Elt>::bitrev(A, n);
+
+    if (use_radix4) {
+      radix4(A, n, n, roots, F);
+    } else {
+      radix2(A, n, roots, F);
+    }
+  }
+
+ public:
+  // Transforms of at least kRadix4Threshold elements of at most
+  // kRadix4MaxEltBytes bytes use the radix-4 engine, and all others
+  // the radix-2 engine.  Both compute exactly the same result.  The
+  // radix-4 engine halves the number of passes over the array, which
+  // pays off when additions are not negligible relative to
+  // multiplications.  For wider elements such as Fp2<Fp256> the
+  // transform is bound by multiplications, which both engines
+  // perform in the same number, and the four elements live in each
+  // radix-4 butterfly make it slower.
+  static constexpr size_t kRadix4Threshold = 256;
+  static constexpr size_t kRadix4MaxEltBytes = 16;
+
+  // The radix-4 engine runs depth first, finishing each sub-transform
+  // of at most this many bytes before combining, so that all levels
+  // of the sub-transform run in cache.
+  static constexpr size_t kBlockBytes = size_t(1) << 16;
+
+  // Backward FFT.
+  // N (the length of A) must be a power of 2
+  static void fftb(Elt A[/*n*/], size_t n, const Elt& omega,
+                   uint64_t omega_order, const Field& F) {
+    bool use_radix4 =
+        sizeof(Elt) <= kRadix4MaxEltBytes && n >= kRadix4Threshold;
+    transform(A, n, omega, omega_order, use_radix4, F);
+  }
+
+  // Backward FFT with a given engine regardless of N, for testing.
+  static void fftb_radix2(Elt A[/*n*/], size_t n, const Elt& omega,
+                          uint64_t omega_order, const Field& F) {
+    transform(A, n, omega, omega_order, /*use_radix4=*/false, F);
+  }
+  static void fftb_radix4(Elt A[/*n*/], size_t n, const Elt& omega,
+                          uint64_t omega_order, const Field& F) {
+    transform(A, n, omega, omega_order, /*use_radix4=*/true, F);
+  }
+
   // forward transform
   static void fftf(Elt A[/*n*/], size_t n, const Elt& omega,
                    uint64_t omega_order, const Field& F) {
@@ -147,6 +147,42 @@ TEST(FFT, Shift) {
     F.mul(w, omega_n);
   }
 }
+
+// The radix-4 engine must agree with the radix-2 engine, for sizes
+// that cover both parities of log2(n) and the blocked recursion.
+TEST(FFT, Radix4) {
+  for (size_t n = 1; n <= (1 << 14); n *= 2) {
+    std::vector<Elt> A(n);
+    for (size_t i = 0; i < n; ++i) {
+      A[i] = rng.next();
+    }
+    std::vector<Elt> B(A);
+    FFT<Field>::fftb_radix4(&A[0], n, omega, omega_order, F);
+    FFT<Field>::fftb_radix2(&B[0], n, omega, omega_order, F);
+    EXPECT_EQ(A, B) << "n=" << n;
+  }
+}
+
+// Same as above with a field small enough that fftb() selects the
+// radix-4 engine.
+TEST(FFT, Radix4Small) {
+  using Field64 = Fp<1>;
+  const Field64 F64("18446744069414584321");
+  const Field64::Elt omega64 = F64.of_string("2752994695033296049");
+  constexpr uint64_t kOmegaOrder64 = 1ull << 32;
+  Bogorng<Field64> rng64(&F64);
+
+  for (size_t n = 1; n <= (1 << 16); n *= 2) {
+    std::vector<Field64::Elt> A(n);
+    for (size_t i = 0; i < n; ++i) {
+      A[i] = rng64.next();
+    }
+    std::vector<Field64::Elt> B(A);
+    FFT<Field64>::fftb(&A[0], n, omega64, kOmegaOrder64, F64);
+    FFT<Field64>::fftb_radix2(&B[0], n, omega64, kOmegaOrder64, F64);
+    EXPECT_EQ(A, B) << "n=" << n;
+  }
+}
 }  // namespace
 
 // ================ Benchmarking ==============================================
@@ -201,6 +237,29 @@ BENCHMARK(BM_FFT_Fp128)
     ->RangeMultiplier(4)
     ->Range(1024, (1 << 22));
 
+// same as above, with the radix-2 engine
+void BM_FFT_Fp128_radix2(benchmark::State& state) {
+  using Field = Fp128<>;
+  using Elt = Field::Elt;
+  Field F;
+  Bogorng<Field> rng(&F);
+  // bogus root of unit, doesn't matter for benchmark purposes since
+  // we are transforming zeroes anyway
+  auto omega = F.two();
+  size_t N = state.range(0);
+  std::vector<Elt> A(N);
+  for (size_t i = 0; i < N; ++i) {
+    A[i] = rng.next();
+  }
+  for (auto _ : state) {
+    FFT<Field>::fftb_radix2(&A[0], N, omega, omega_order, F);
+  }
+}
+
+BENCHMARK(BM_FFT_Fp128_radix2)
+    ->RangeMultiplier(4)
+    ->Range(1024, (1 << 22));
+
 void BM_FFT_F64_2(benchmark::State& state) {
   using BaseField = Fp<1>;
   using Field = Fp2<BaseField>;
@@ -253,5 +312,30 @@ BENCHMARK(BM_FFT_F64)
     ->RangeMultiplier(4)
     ->Range(1024, (1 << 22));
 
+// same as above, with the radix-2 engine
+void BM_FFT_F64_radix2(benchmark::State& state) {
+  using Field = Fp<1>;
+  const Field F("18446744069414584321");
+  using Elt = Field::Elt;
+  static constexpr char kSmallRoot[] = "2752994695033296049";
+  static constexpr uint64_t kSmallOrder = 1ull << 32;
+  const Elt omega = F.of_string(kSmallRoot);
+  Bogorng<Field> rng(&F);
+
+  size_t N = state.range(0);
+  std::vector<Elt> A(N);
+  for (size_t i = 0; i < N; ++i) {
+    A[i] = rng.next();
+  }
+
+  for (auto _ : state) {
+    FFT<Field>::fftb_radix2(&A[0], N, omega, kSmallOrder, F);
+  }
+}
+
+BENCHMARK(BM_FFT_F64_radix2)
+    ->RangeMultiplier(4)
+    ->Range(1024, (1 << 22));
+
 }  // namespace bench
 }  // namespace proofs
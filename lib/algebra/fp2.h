@@ -19,10 +19,22 @@
 
 #include <cstdint>
 #include <optional>
+#include <type_traits>
 
 #include "util/panic.h"
 
 namespace proofs {
+
+// A base field may provide the lazy-reduction interface mulw(),
+// addw(), subw() and reducew() (see fp_generic.h), enabled by
+// kWideMul, which allows the Karatsuba products below to reduce
+// each component only once.
+template <class Field, class = void>
+struct HasWideMul : std::false_type {};
+template <class Field>
+struct HasWideMul<Field, std::void_t<decltype(Field::kWideMul)>>
+    : std::bool_constant<Field::kWideMul> {};
+
 // Fields of the form a+sqrt(r)*b where a, b \in Fp and
 // r is a quadratic nonresidue in Fp.  The special "complex"
 // case r = -1 allows for a faster implementation of multiplication.
@@ -84,6 +96,19 @@ class Fp2 {
     f_.sub(a.im, y.im);
   }
   void mul(Elt& a, const Elt& y) const {
+    if constexpr (nonresidue_is_mone && HasWideMul<Field>::value) {
+      // Karatsuba on unreduced products:
+      // re = p0 - p1, im = (a.re + a.im)(y.re + y.im) - p0 - p1
+      auto p0 = f_.mulw(a.re, y.re);
+      auto p1 = f_.mulw(a.im, y.im);
+      auto pm = f_.mulw(f_.addf(a.re, a.im), f_.addf(y.re, y.im));
+      f_.subw(pm, p0);
+      f_.subw(pm, p1);
+      f_.subw(p0, p1);
+      a.re = f_.reducew(p0);
+      a.im = f_.reducew(pm);
+      return;
+    }
     auto p0 = f_.mulf(a.re, y.re);
     auto p1 = f_.mulf(a.im, y.im);
     auto a01 = f_.addf(a.re, a.im);
@@ -186,6 +211,26 @@ class Fp2 {
     f_.to_bytes_field(ab + Field::kBytes, x.im);
   }
 
+  // Bulk versions of to_bytes_field() and of_bytes_field(), as in
+  // the base field.
+  void to_bytes_field_n(size_t n, uint8_t ab[/* n * kBytes */],
+                        const Elt x[/*n:incx*/], size_t incx) const {
+    for (size_t i = 0; i < n; ++i) {
+      to_bytes_field(&ab[i * kBytes], x[i * incx]);
+    }
+  }
+
+  bool of_bytes_field_n(size_t n, Elt x[/*n*/],
+                        const uint8_t ab[/* n * kBytes */]) const {
+    bool ok = true;
+    for (size_t i = 0; i < n; ++i) {
+      ok = f_.of_bytes_field_n(1, &x[i].re, &ab[i * kBytes]) && ok;
+      ok = f_.of_bytes_field_n(1, &x[i].im, &ab[i * kBytes + Field::kBytes]) &&
+           ok;
+    }
+    return ok;
+  }
+
   bool in_subfield(const Elt& e) const { return is_real(e); }
 
   std::optional<Elt> of_bytes_subfield(
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "algebra/bogorng.h"
 #include "algebra/fft.h"
 #include "algebra/fp.h"
 #include "algebra/fp_p256.h"
@@ -75,6 +76,24 @@ struct tests {
     }
   }
 
+  // Compare mul() against the schoolbook product for i^2 = -1.
+  static void schoolbook(const Field& F) {
+    const auto& F0 = F.base_field();
+    Bogorng<typename Field::BaseField> rng(&F0);
+    std::vector<Elt> xs = {F.zero(), F.one(), F.mone(), F.i(),
+                           Elt{F0.mone(), F0.mone()}};
+    for (size_t i = 0; i < 20; ++i) {
+      xs.push_back(Elt{rng.next(), rng.next()});
+    }
+    for (const auto& a : xs) {
+      for (const auto& b : xs) {
+        Elt ab{F0.subf(F0.mulf(a.re, b.re), F0.mulf(a.im, b.im)),
+               F0.addf(F0.mulf(a.re, b.im), F0.mulf(a.im, b.re))};
+        EXPECT_EQ(F.mulf(a, b), ab);
+      }
+    }
+  }
+
   static Elt reroot(const Elt& omega_n, uint64_t n, uint64_t r,
                     const Field& F) {
     Elt omega_r = omega_n;
@@ -167,6 +186,23 @@ struct tests {
     EXPECT_FALSE(x.has_value());
     auto sx = F.of_bytes_subfield(bad_bytes.data());
     EXPECT_FALSE(sx.has_value());
+
+    // bulk conversions
+    std::vector<Elt> v(n);
+    for (uint64_t i = 0; i < n; ++i) {
+      v[i] = F.of_scalar_field(3 * i + 1, i * i);
+    }
+    std::vector<uint8_t> want(n * Field::kBytes), got(n * Field::kBytes);
+    for (uint64_t i = 0; i < n; ++i) {
+      F.to_bytes_field(&want[i * Field::kBytes], v[i]);
+    }
+    F.to_bytes_field_n(n, got.data(), v.data(), 1);
+    EXPECT_EQ(want, got);
+    std::vector<Elt> w(n);
+    EXPECT_TRUE(F.of_bytes_field_n(n, w.data(), got.data()));
+    EXPECT_EQ(v, w);
+    std::copy(bad_bytes.begin(), bad_bytes.end(), got.end() - Field::kBytes);
+    EXPECT_FALSE(F.of_bytes_field_n(n, w.data(), got.data()));
   }
 
   static void poly_evaluation_points(const Field& F) {
@@ -208,6 +244,7 @@ TEST(Fp2, All) {
     const auto omega = F.of_scalar_field(1033321771269002680ull, 2147483648ull);
     const uint64_t omega_order = 1ull << 62;
     tests<Field>::all(omega, omega_order, F);
+    tests<Field>::schoolbook(F);
   }
   {
     // goldilocks
@@ -233,6 +270,7 @@ TEST(Fp2, All) {
     const auto omega = F.of_string(kRootX, kRootY);
     const uint64_t omega_order = 1ull << 31;
     tests<Field>::all(omega, omega_order, F);
+    tests<Field>::schoolbook(F);
   }
 }
 
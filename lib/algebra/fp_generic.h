@@ -19,6 +19,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <type_traits>
 #include <utility>
 
 #include "algebra/nat.h"
@@ -29,6 +30,17 @@
 namespace proofs {
 struct PrimeFieldTypeTag {};
 
+// OPS may provide mul_kernel() and sqr_kernel(), which compute the
+// reduced Montgomery product in one unrolled step, and
+// mulw_kernel() and reducew_kernel(), which implement mulw() and
+// reducew(), together with use_mul_kernel(), which tells at run time
+// whether the CPU can execute them.
+template <class OPS, class = void>
+struct HasMulKernel : std::false_type {};
+template <class OPS>
+struct HasMulKernel<OPS, std::void_t<decltype(&OPS::mul_kernel)>>
+    : std::true_type {};
+
 /*
 The Fp_generic class contains the implementation of a finite field.
 */
@@ -173,6 +185,17 @@ class FpGeneric {
   // Nat by Elt
   void mul(N& x, const Elt& y) const { mul0(x, y); }
 
+  // x = x * x
+  void sqr(Elt& x) const {
+    if constexpr (HasMulKernel<OPS>::value) {
+      if (OPS::use_mul_kernel()) {
+        OPS::sqr_kernel(x.n.limb_, x.n.limb_);
+        return;
+      }
+    }
+    mul0(x.n, x);
+  }
+
   // x = -x
   void neg(Elt& x) const {
     Elt y(k_[0]);
@@ -196,6 +219,10 @@ class FpGeneric {
     mul(a, y);
     return a;
   }
+  Elt sqrf(Elt a) const {
+    sqr(a);
+    return a;
+  }
   Elt negf(Elt a) const {
     neg(a);
     return a;
@@ -254,6 +281,86 @@ class FpGeneric {
     return x;
   }
 
+  // Lazy reduction.  A Wide holds the unreduced product of two
+  // elements as a two's complement number of 2*kLimbs+1 limbs.
+  // Sums and differences of products can be accumulated in a Wide
+  // and then reduced once, e.g., the real part of a complex product
+  // costs one reduction instead of two.  reducew(mulw(x, y)) equals
+  // mulf(x, y).  For a single limb the reduced product is already
+  // cheap, and kWideMul tells callers not to bother.
+  static constexpr bool kWideMul = (kLimbs > 1);
+
+  struct Wide {
+    limb_t limb_[2 * kLimbs + 1];
+  };
+
+  Wide mulw(const Elt& x, const Elt& y) const {
+    Wide w;
+    w.limb_[2 * kLimbs] = zero_limb<limb_t>();
+    if constexpr (HasMulKernel<OPS>::value) {
+      if (OPS::use_mul_kernel()) {
+        OPS::mulw_kernel(w.limb_, x.n.limb_, y.n.limb_);
+        return w;
+      }
+    }
+    limb_t h[kLimbs];
+    w.limb_[kLimbs] = zero_limb<limb_t>();
+    mulhl(kLimbs, w.limb_, h, x.n.limb_[0], y.n.limb_);
+    accum(kLimbs, w.limb_ + 1, kLimbs, h);
+    for (size_t i = 1; i < kLimbs; ++i) {
+      limb_t l[kLimbs];
+      w.limb_[i + kLimbs] = zero_limb<limb_t>();
+      mulhl(kLimbs, l, h, x.n.limb_[i], y.n.limb_);
+      accum(kLimbs + 1, w.limb_ + i, kLimbs, l);
+      accum(kLimbs, w.limb_ + i + 1, kLimbs, h);
+    }
+    return w;
+  }
+
+  // a += y, a -= y
+  void addw(Wide& a, const Wide& y) const {
+    accum(2 * kLimbs + 1, a.limb_, 2 * kLimbs + 1, y.limb_);
+  }
+  void subw(Wide& a, const Wide& y) const {
+    negaccum(2 * kLimbs + 1, a.limb_, 2 * kLimbs + 1, y.limb_);
+  }
+
+  // Montgomery reduction of A, which must satisfy -2mR <= A < 2mR
+  // for the Montgomery radix R.  This range holds for the sum or
+  // difference of two products, and for a product minus two others.
+  Elt reducew(const Wide& a) const {
+    if constexpr (HasMulKernel<OPS>::value) {
+      if (OPS::use_mul_kernel()) {
+        Elt r;
+        OPS::reducew_kernel(r.n.limb_, a.limb_);
+        return r;
+      }
+    }
+    // A = L + R*H, where L*R^{-1} is reduced by from_montgomery(),
+    // and the signed H lies in [-2m, 2m) and is reduced by
+    // conditional additions and subtractions of m.
+    constexpr size_t kSignShift = 8 * sizeof(limb_t) - 1;
+    Elt l;
+    mov(kLimbs, l.n.limb_, a.limb_);
+    Elt r{from_montgomery(l)};
+
+    limb_t h[kLimbs + 1], t[kLimbs + 1];
+    mov(kLimbs + 1, h, a.limb_ + kLimbs);
+    for (size_t i = 0; i < 2; ++i) {
+      mov(kLimbs + 1, t, h);
+      accum(kLimbs + 1, t, kLimbs, m_.limb_);
+      cmovnz(kLimbs + 1, h, h[kLimbs] >> kSignShift, t);
+    }
+    mov(kLimbs + 1, t, h);
+    negaccum(kLimbs + 1, t, kLimbs, m_.limb_);
+    cmovnz(kLimbs + 1, h, ~t[kLimbs] >> kSignShift, t);
+
+    Elt hh;
+    mov(kLimbs, hh.n.limb_, h);
+    add(r, hh);
+    return r;
+  }
+
   bool in_subfield(const Elt& e) const { return true; }
 
   // The of_scalar methods should only be used on trusted inputs known
@@ -324,6 +431,28 @@ class FpGeneric {
     from_montgomery(x).to_bytes(ab);
   }
 
+  // Bulk versions of to_bytes_field() and of_bytes_field() for the N
+  // elements X[i * INCX], stored in N * kBytes contiguous bytes.
+  // of_bytes_field_n() returns false if any element is out of range,
+  // in which case the contents of X are unspecified.
+  void to_bytes_field_n(size_t n, uint8_t ab[/* n * kBytes */],
+                        const Elt x[/*n:incx*/], size_t incx) const {
+    for (size_t i = 0; i < n; ++i) {
+      from_montgomery(x[i * incx]).to_bytes(&ab[i * kBytes]);
+    }
+  }
+
+  bool of_bytes_field_n(size_t n, Elt x[/*n*/],
+                        const uint8_t ab[/* n * kBytes */]) const {
+    bool ok = true;
+    for (size_t i = 0; i < n; ++i) {
+      N an = N::of_bytes(&ab[i * kBytes]);
+      ok = ok && (an < m_);
+      x[i] = to_montgomery(an);
+    }
+    return ok;
+  }
+
   std::optional<Elt> of_bytes_subfield(const uint8_t ab[/* kBytes */]) const {
     return of_bytes_field(ab);
   }
@@ -407,6 +536,12 @@ class FpGeneric {
   // unoptimized montgomery multiplication that does not
   // depend on the constants zero() and one() being defined.
   void mul0(N& x, const Elt& y) const {
+    if constexpr (HasMulKernel<OPS>::value) {
+      if (OPS::use_mul_kernel()) {
+        OPS::mul_kernel(x.limb_, x.limb_, y.n.limb_);
+        return;
+      }
+    }
     limb_t a[2 * kLimbs + 1];  // uninitialized
     mulstep<true>(a, x.limb_[0], y.n.limb_);
     for (size_t i = 1; i < kLimbs; ++i) {
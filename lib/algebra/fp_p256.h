@@ -37,6 +37,10 @@ struct Fp256Reduce {
       0,
       0xFFFFFFFF00000001u,
   };
+  // 2 * kModulus, as five limbs.
+  static const constexpr std::array<uint64_t, 5> kTwoModulus = {
+      0xFFFFFFFFFFFFFFFEu, 0x1FFFFFFFFu, 0, 0xFFFFFFFE00000002u, 1,
+  };
 
 
   static inline void reduction_step(uint64_t a[], uint64_t mprime,
@@ -59,6 +63,492 @@ struct Fp256Reduce {
     uint32_t h[6] = {r, 0, 0, r, 0, r};
     accum(7, a + 3, 6, h);
   }
+
+#if defined(__x86_64__)
+  // Fully unrolled Montgomery multiplication and squaring for the
+  // case where the CPU has ADX.  They use mulx and the two
+  // independent carry chains of adcx (CF) and adox (OF), and the
+  // special form of p, for which mprime = 1 and the product by p
+  // takes two multiplications.  Like the generic loop in
+  // FpGeneric::mul0(), they compute x*y/2^256 in [0, 2p), and then
+  // subtract p with a branch-free conditional move, so that A is
+  // fully reduced.
+  static bool use_mul_kernel() { return kHasAdx; }
+
+  static inline void mul_kernel(uint64_t a[4], const uint64_t x[4],
+                                const uint64_t y[4]) {
+    // t0..t5 hold the running sum, whose low limb rotates by one
+    // register per row.
+    uint64_t t0, t1, t2, t3, t4, t5, lo, hi, z;
+    asm(
+        "movq 0(%[x]), %%rdx\n\t"
+        "xorl %k[t5], %k[t5]\n\t"
+        "xorl %k[z], %k[z]\n\t"
+        "mulxq 0(%[y]), %[t0], %[t1]\n\t"
+        "mulxq 8(%[y]), %[lo], %[t2]\n\t"
+        "adcxq %[lo], %[t1]\n\t"
+        "mulxq 16(%[y]), %[lo], %[t3]\n\t"
+        "adcxq %[lo], %[t2]\n\t"
+        "mulxq 24(%[y]), %[lo], %[t4]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adcxq %[z], %[t4]\n\t"
+        "movq %[t0], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t1]\n\t"
+        "adoxq %[lo], %[t1]\n\t"
+        "adcxq %[hi], %[t2]\n\t"
+        "adoxq %[z], %[t2]\n\t"
+        "mulxq %[p3], %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[z], %[t3]\n\t"
+        "adcxq %[hi], %[t4]\n\t"
+        "adoxq %[z], %[t4]\n\t"
+        "adcxq %[z], %[t5]\n\t"
+        "adoxq %[z], %[t5]\n\t"
+        "movq 8(%[x]), %%rdx\n\t"
+        "xorl %k[t0], %k[t0]\n\t"
+        "mulxq 0(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t1]\n\t"
+        "adoxq %[hi], %[t2]\n\t"
+        "mulxq 8(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t2]\n\t"
+        "adoxq %[hi], %[t3]\n\t"
+        "mulxq 16(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[hi], %[t4]\n\t"
+        "mulxq 24(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[hi], %[t5]\n\t"
+        "adcxq %[z], %[t5]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "adcxq %[z], %[t0]\n\t"
+        "movq %[t1], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t2]\n\t"
+        "adoxq %[lo], %[t2]\n\t"
+        "adcxq %[hi], %[t3]\n\t"
+        "adoxq %[z], %[t3]\n\t"
+        "mulxq %[p3], %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[z], %[t4]\n\t"
+        "adcxq %[hi], %[t5]\n\t"
+        "adoxq %[z], %[t5]\n\t"
+        "adcxq %[z], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "movq 16(%[x]), %%rdx\n\t"
+        "xorl %k[t1], %k[t1]\n\t"
+        "mulxq 0(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t2]\n\t"
+        "adoxq %[hi], %[t3]\n\t"
+        "mulxq 8(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[hi], %[t4]\n\t"
+        "mulxq 16(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[hi], %[t5]\n\t"
+        "mulxq 24(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t5]\n\t"
+        "adoxq %[hi], %[t0]\n\t"
+        "adcxq %[z], %[t0]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "adcxq %[z], %[t1]\n\t"
+        "movq %[t2], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t3]\n\t"
+        "adoxq %[lo], %[t3]\n\t"
+        "adcxq %[hi], %[t4]\n\t"
+        "adoxq %[z], %[t4]\n\t"
+        "mulxq %[p3], %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t5]\n\t"
+        "adoxq %[z], %[t5]\n\t"
+        "adcxq %[hi], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "adcxq %[z], %[t1]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "movq 24(%[x]), %%rdx\n\t"
+        "xorl %k[t2], %k[t2]\n\t"
+        "mulxq 0(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[hi], %[t4]\n\t"
+        "mulxq 8(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[hi], %[t5]\n\t"
+        "mulxq 16(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t5]\n\t"
+        "adoxq %[hi], %[t0]\n\t"
+        "mulxq 24(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t0]\n\t"
+        "adoxq %[hi], %[t1]\n\t"
+        "adcxq %[z], %[t1]\n\t"
+        "adoxq %[z], %[t2]\n\t"
+        "adcxq %[z], %[t2]\n\t"
+        "movq %[t3], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t4]\n\t"
+        "adoxq %[lo], %[t4]\n\t"
+        "adcxq %[hi], %[t5]\n\t"
+        "adoxq %[z], %[t5]\n\t"
+        "mulxq %[p3], %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "adcxq %[hi], %[t1]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "adcxq %[z], %[t2]\n\t"
+        "adoxq %[z], %[t2]\n\t"
+        // subtract p if the result is >= p
+        "movq %[t4], %[lo]\n\t"
+        "subq $-1, %[lo]\n\t"
+        "movq %[t5], %[hi]\n\t"
+        "sbbq %[p1], %[hi]\n\t"
+        "movq %[t0], %[z]\n\t"
+        "sbbq $0, %[z]\n\t"
+        "movq %[t1], %%rdx\n\t"
+        "sbbq %[p3], %%rdx\n\t"
+        "sbbq $0, %[t2]\n\t"
+        "cmovncq %[lo], %[t4]\n\t"
+        "cmovncq %[hi], %[t5]\n\t"
+        "cmovncq %[z], %[t0]\n\t"
+        "cmovncq %%rdx, %[t1]\n\t"
+        : [t0] "=&r"(t0), [t1] "=&r"(t1), [t2] "=&r"(t2), [t3] "=&r"(t3),
+          [t4] "=&r"(t4), [t5] "=&r"(t5), [lo] "=&r"(lo), [hi] "=&r"(hi),
+          [z] "=&r"(z)
+        : [x] "r"(x), [y] "r"(y), [p1] "m"(kModulus[1]),
+          [p3] "m"(kModulus[3]), "m"(*(const uint64_t(*)[4])x),
+          "m"(*(const uint64_t(*)[4])y)
+        : "rdx", "cc");
+    a[0] = t4;
+    a[1] = t5;
+    a[2] = t0;
+    a[3] = t1;
+  }
+
+  static inline void sqr_kernel(uint64_t a[4], const uint64_t x[4]) {
+    // The six products x[i]*x[j] for i < j are computed once and
+    // doubled, then the four squares are added.  The low half of the
+    // 512-bit square is reduced, and then the high half is added.
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, lo, hi, z;
+    uint64_t w = reinterpret_cast<uint64_t>(x);
+    asm(
+        "movq 0(%[w]), %%rdx\n\t"
+        "xorl %k[z], %k[z]\n\t"
+        "mulxq 8(%[w]), %[t1], %[t2]\n\t"
+        "mulxq 16(%[w]), %[lo], %[t3]\n\t"
+        "adcxq %[lo], %[t2]\n\t"
+        "mulxq 24(%[w]), %[lo], %[t4]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adcxq %[z], %[t4]\n\t"
+        "movq 8(%[w]), %%rdx\n\t"
+        "mulxq 16(%[w]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[hi], %[t4]\n\t"
+        "mulxq 24(%[w]), %[lo], %[t5]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[z], %[t5]\n\t"
+        "adcxq %[z], %[t5]\n\t"
+        "movq 16(%[w]), %%rdx\n\t"
+        "mulxq 24(%[w]), %[lo], %[t6]\n\t"
+        "adcxq %[lo], %[t5]\n\t"
+        "adcxq %[z], %[t6]\n\t"
+        "xorl %k[t7], %k[t7]\n\t"
+        "movq 0(%[w]), %%rdx\n\t"
+        "mulxq %%rdx, %[t0], %[hi]\n\t"
+        "adcxq %[t1], %[t1]\n\t"
+        "adoxq %[hi], %[t1]\n\t"
+        "movq 8(%[w]), %%rdx\n\t"
+        "mulxq %%rdx, %[lo], %[hi]\n\t"
+        "adcxq %[t2], %[t2]\n\t"
+        "adoxq %[lo], %[t2]\n\t"
+        "adcxq %[t3], %[t3]\n\t"
+        "adoxq %[hi], %[t3]\n\t"
+        "movq 16(%[w]), %%rdx\n\t"
+        "mulxq %%rdx, %[lo], %[hi]\n\t"
+        "adcxq %[t4], %[t4]\n\t"
+        "adoxq %[lo], %[t4]\n\t"
+        "adcxq %[t5], %[t5]\n\t"
+        "adoxq %[hi], %[t5]\n\t"
+        "movq 24(%[w]), %%rdx\n\t"
+        "mulxq %%rdx, %[lo], %[hi]\n\t"
+        "adcxq %[t6], %[t6]\n\t"
+        "adoxq %[lo], %[t6]\n\t"
+        "adcxq %[z], %[t7]\n\t"
+        "adoxq %[hi], %[t7]\n\t"
+        "movq %[t0], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t1]\n\t"
+        "adoxq %[lo], %[t1]\n\t"
+        "adcxq %[hi], %[t2]\n\t"
+        "adoxq %[z], %[t2]\n\t"
+        "mulxq %[p3], %[lo], %[w]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[z], %[t3]\n\t"
+        "adcxq %[z], %[w]\n\t"
+        "adoxq %[z], %[w]\n\t"
+        "movq %[t1], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t2]\n\t"
+        "adoxq %[lo], %[t2]\n\t"
+        "adcxq %[hi], %[t3]\n\t"
+        "adoxq %[z], %[t3]\n\t"
+        "mulxq %[p3], %[lo], %[t0]\n\t"
+        "adcxq %[lo], %[w]\n\t"
+        "adoxq %[z], %[w]\n\t"
+        "adcxq %[z], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "movq %[t2], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t3]\n\t"
+        "adoxq %[lo], %[t3]\n\t"
+        "adcxq %[hi], %[w]\n\t"
+        "adoxq %[z], %[w]\n\t"
+        "mulxq %[p3], %[lo], %[t1]\n\t"
+        "adcxq %[lo], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "adcxq %[z], %[t1]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "movq %[t3], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[w]\n\t"
+        "adoxq %[lo], %[w]\n\t"
+        "adcxq %[hi], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "mulxq %[p3], %[lo], %[t2]\n\t"
+        "adcxq %[lo], %[t1]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "adcxq %[z], %[t2]\n\t"
+        "adoxq %[z], %[t2]\n\t"
+        "addq %[t4], %[w]\n\t"
+        "adcq %[t5], %[t0]\n\t"
+        "adcq %[t6], %[t1]\n\t"
+        "adcq %[t7], %[t2]\n\t"
+        "movl $0, %k[t3]\n\t"
+        "adcq $0, %[t3]\n\t"
+        // subtract p if the result is >= p
+        "movq %[w], %[lo]\n\t"
+        "subq $-1, %[lo]\n\t"
+        "movq %[t0], %[hi]\n\t"
+        "sbbq %[p1], %[hi]\n\t"
+        "movq %[t1], %[z]\n\t"
+        "sbbq $0, %[z]\n\t"
+        "movq %[t2], %%rdx\n\t"
+        "sbbq %[p3], %%rdx\n\t"
+        "sbbq $0, %[t3]\n\t"
+        "cmovncq %[lo], %[w]\n\t"
+        "cmovncq %[hi], %[t0]\n\t"
+        "cmovncq %[z], %[t1]\n\t"
+        "cmovncq %%rdx, %[t2]\n\t"
+        : [t0] "=&r"(t0), [t1] "=&r"(t1), [t2] "=&r"(t2), [t3] "=&r"(t3),
+          [t4] "=&r"(t4), [t5] "=&r"(t5), [t6] "=&r"(t6), [t7] "=&r"(t7),
+          [lo] "=&r"(lo), [hi] "=&r"(hi), [z] "=&r"(z), [w] "+r"(w)
+        : [p1] "m"(kModulus[1]), [p3] "m"(kModulus[3]),
+          "m"(*(const uint64_t(*)[4])x)
+        : "rdx", "cc");
+    a[0] = w;
+    a[1] = t0;
+    a[2] = t1;
+    a[3] = t2;
+  }
+
+  // Unreduced 512-bit product for FpGeneric::mulw(), row by row
+  // as in mul_kernel() but without the interleaved reduction.
+  static inline void mulw_kernel(uint64_t a[8], const uint64_t x[4],
+                                 const uint64_t y[4]) {
+    uint64_t t0, t1, t2, t3, t4, t5, lo, hi, z;
+    asm("movq 0(%[x]), %%rdx\n\t"
+        "xorl %k[z], %k[z]\n\t"
+        "mulxq 0(%[y]), %[t0], %[t1]\n\t"
+        "mulxq 8(%[y]), %[lo], %[t2]\n\t"
+        "adcxq %[lo], %[t1]\n\t"
+        "mulxq 16(%[y]), %[lo], %[t3]\n\t"
+        "adcxq %[lo], %[t2]\n\t"
+        "mulxq 24(%[y]), %[lo], %[t4]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adcxq %[z], %[t4]\n\t"
+        "movq %[t0], 0(%[a])\n\t"
+        "movq 8(%[x]), %%rdx\n\t"
+        "xorl %k[z], %k[z]\n\t"
+        "mulxq 0(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t1]\n\t"
+        "adoxq %[hi], %[t2]\n\t"
+        "mulxq 8(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t2]\n\t"
+        "adoxq %[hi], %[t3]\n\t"
+        "mulxq 16(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[hi], %[t4]\n\t"
+        "mulxq 24(%[y]), %[lo], %[t5]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[z], %[t5]\n\t"
+        "adcxq %[z], %[t5]\n\t"
+        "movq %[t1], 8(%[a])\n\t"
+        "movq 16(%[x]), %%rdx\n\t"
+        "xorl %k[z], %k[z]\n\t"
+        "mulxq 0(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t2]\n\t"
+        "adoxq %[hi], %[t3]\n\t"
+        "mulxq 8(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[hi], %[t4]\n\t"
+        "mulxq 16(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[hi], %[t5]\n\t"
+        "mulxq 24(%[y]), %[lo], %[t0]\n\t"
+        "adcxq %[lo], %[t5]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "adcxq %[z], %[t0]\n\t"
+        "movq %[t2], 16(%[a])\n\t"
+        "movq 24(%[x]), %%rdx\n\t"
+        "xorl %k[z], %k[z]\n\t"
+        "mulxq 0(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[hi], %[t4]\n\t"
+        "mulxq 8(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t4]\n\t"
+        "adoxq %[hi], %[t5]\n\t"
+        "mulxq 16(%[y]), %[lo], %[hi]\n\t"
+        "adcxq %[lo], %[t5]\n\t"
+        "adoxq %[hi], %[t0]\n\t"
+        "mulxq 24(%[y]), %[lo], %[t1]\n\t"
+        "adcxq %[lo], %[t0]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "adcxq %[z], %[t1]\n\t"
+        "movq %[t3], 24(%[a])\n\t"
+        "movq %[t4], 32(%[a])\n\t"
+        "movq %[t5], 40(%[a])\n\t"
+        "movq %[t0], 48(%[a])\n\t"
+        "movq %[t1], 56(%[a])\n\t"
+        : [t0] "=&r"(t0), [t1] "=&r"(t1), [t2] "=&r"(t2), [t3] "=&r"(t3),
+          [t4] "=&r"(t4), [t5] "=&r"(t5), [lo] "=&r"(lo), [hi] "=&r"(hi),
+          [z] "=&r"(z), "=m"(*(uint64_t(*)[8])a)
+        : [a] "r"(a), [x] "r"(x), [y] "r"(y), "m"(*(const uint64_t(*)[4])x),
+          "m"(*(const uint64_t(*)[4])y)
+        : "rdx", "cc");
+  }
+
+  // FpGeneric::reducew() of the signed 576-bit W.  The low half is
+  // reduced as in sqr_kernel() to a value in [0, p], the signed high
+  // half is added, and the sum in [-2p, 3p) is brought into [0, p) by
+  // adding 2p if negative and then subtracting p twice.
+  static inline void reducew_kernel(uint64_t a[4], const uint64_t w[9]) {
+    uint64_t t0, t1, t2, t3, u, lo, hi, z;
+    uint64_t wp = reinterpret_cast<uint64_t>(w);
+    asm("movq 0(%[wp]), %[t0]\n\t"
+        "movq 8(%[wp]), %[t1]\n\t"
+        "movq 16(%[wp]), %[t2]\n\t"
+        "movq 24(%[wp]), %[t3]\n\t"
+        "xorl %k[z], %k[z]\n\t"
+        "movq %[t0], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t1]\n\t"
+        "adoxq %[lo], %[t1]\n\t"
+        "adcxq %[hi], %[t2]\n\t"
+        "adoxq %[z], %[t2]\n\t"
+        "mulxq %[p3], %[lo], %[u]\n\t"
+        "adcxq %[lo], %[t3]\n\t"
+        "adoxq %[z], %[t3]\n\t"
+        "adcxq %[z], %[u]\n\t"
+        "adoxq %[z], %[u]\n\t"
+        "movq %[t1], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t2]\n\t"
+        "adoxq %[lo], %[t2]\n\t"
+        "adcxq %[hi], %[t3]\n\t"
+        "adoxq %[z], %[t3]\n\t"
+        "mulxq %[p3], %[lo], %[t0]\n\t"
+        "adcxq %[lo], %[u]\n\t"
+        "adoxq %[z], %[u]\n\t"
+        "adcxq %[z], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "movq %[t2], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[t3]\n\t"
+        "adoxq %[lo], %[t3]\n\t"
+        "adcxq %[hi], %[u]\n\t"
+        "adoxq %[z], %[u]\n\t"
+        "mulxq %[p3], %[lo], %[t1]\n\t"
+        "adcxq %[lo], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "adcxq %[z], %[t1]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "movq %[t3], %%rdx\n\t"
+        "mulxq %[p1], %[lo], %[hi]\n\t"
+        "adcxq %%rdx, %[u]\n\t"
+        "adoxq %[lo], %[u]\n\t"
+        "adcxq %[hi], %[t0]\n\t"
+        "adoxq %[z], %[t0]\n\t"
+        "mulxq %[p3], %[lo], %[t2]\n\t"
+        "adcxq %[lo], %[t1]\n\t"
+        "adoxq %[z], %[t1]\n\t"
+        "adcxq %[z], %[t2]\n\t"
+        "adoxq %[z], %[t2]\n\t"
+        // add the signed high half
+        "addq 32(%[wp]), %[u]\n\t"
+        "adcq 40(%[wp]), %[t0]\n\t"
+        "adcq 48(%[wp]), %[t1]\n\t"
+        "adcq 56(%[wp]), %[t2]\n\t"
+        "movq 64(%[wp]), %[t3]\n\t"
+        "adcq $0, %[t3]\n\t"
+        // add 2p if negative
+        "movq %[u], %[lo]\n\t"
+        "movq %[t0], %[hi]\n\t"
+        "movq %[t1], %[z]\n\t"
+        "movq %[t2], %%rdx\n\t"
+        "movq %[t3], %[wp]\n\t"
+        "addq $-2, %[lo]\n\t"
+        "adcq %[q1], %[hi]\n\t"
+        "adcq $0, %[z]\n\t"
+        "adcq %[q3], %%rdx\n\t"
+        "adcq $1, %[wp]\n\t"
+        "testq %[t3], %[t3]\n\t"
+        "cmovsq %[lo], %[u]\n\t"
+        "cmovsq %[hi], %[t0]\n\t"
+        "cmovsq %[z], %[t1]\n\t"
+        "cmovsq %%rdx, %[t2]\n\t"
+        "cmovsq %[wp], %[t3]\n\t"
+        // subtract p if >= p, twice
+        "movq %[u], %[lo]\n\t"
+        "movq %[t0], %[hi]\n\t"
+        "movq %[t1], %[z]\n\t"
+        "movq %[t2], %%rdx\n\t"
+        "movq %[t3], %[wp]\n\t"
+        "subq $-1, %[lo]\n\t"
+        "sbbq %[p1], %[hi]\n\t"
+        "sbbq $0, %[z]\n\t"
+        "sbbq %[p3], %%rdx\n\t"
+        "sbbq $0, %[wp]\n\t"
+        "cmovncq %[lo], %[u]\n\t"
+        "cmovncq %[hi], %[t0]\n\t"
+        "cmovncq %[z], %[t1]\n\t"
+        "cmovncq %%rdx, %[t2]\n\t"
+        "cmovncq %[wp], %[t3]\n\t"
+        "movq %[u], %[lo]\n\t"
+        "movq %[t0], %[hi]\n\t"
+        "movq %[t1], %[z]\n\t"
+        "movq %[t2], %%rdx\n\t"
+        "subq $-1, %[lo]\n\t"
+        "sbbq %[p1], %[hi]\n\t"
+        "sbbq $0, %[z]\n\t"
+        "sbbq %[p3], %%rdx\n\t"
+        "sbbq $0, %[t3]\n\t"
+        "cmovncq %[lo], %[u]\n\t"
+        "cmovncq %[hi], %[t0]\n\t"
+        "cmovncq %[z], %[t1]\n\t"
+        "cmovncq %%rdx, %[t2]\n\t"
+        : [t0] "=&r"(t0), [t1] "=&r"(t1), [t2] "=&r"(t2), [t3] "=&r"(t3),
+          [u] "=&r"(u), [lo] "=&r"(lo), [hi] "=&r"(hi), [z] "=&r"(z),
+          [wp] "+r"(wp)
+        : [p1] "m"(kModulus[1]), [p3] "m"(kModulus[3]),
+          [q1] "m"(kTwoModulus[1]), [q3] "m"(kTwoModulus[3]),
+          "m"(*(const uint64_t(*)[9])w)
+        : "rdx", "cc");
+    a[0] = u;
+    a[1] = t0;
+    a[2] = t1;
+    a[3] = t2;
+  }
+
+ private:
+  static inline const bool kHasAdx = cpu_has_adx();
+#endif  // defined(__x86_64__)
 };
 
 template <bool optimized_mul = false>
@@ -17,6 +17,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "algebra/bogorng.h"
 #include "algebra/fp_p128.h"
@@ -340,6 +341,44 @@ TEST(Fp, SmallField) {
   EXPECT_FALSE(F17.of_bytes_subfield(bad).has_value());
 }
 
+// The bulk conversions agree with the one-element ones.
+template <class Field>
+void bulkbytes(const Field& F) {
+  using Elt = typename Field::Elt;
+  constexpr size_t n = 37;
+  std::vector<Elt> x(2 * n);
+  for (size_t i = 0; i < 2 * n; ++i) {
+    x[i] = F.mulf(F.of_scalar(i + 2), F.of_scalar(i * i + 7));
+    F.neg(x[i]);
+  }
+
+  std::vector<uint8_t> want(n * Field::kBytes), got(n * Field::kBytes);
+  for (size_t i = 0; i < n; ++i) {
+    F.to_bytes_field(&want[i * Field::kBytes], x[2 * i]);
+  }
+  F.to_bytes_field_n(n, got.data(), x.data(), 2);
+  EXPECT_EQ(want, got);
+
+  std::vector<Elt> y(n);
+  EXPECT_TRUE(F.of_bytes_field_n(n, y.data(), got.data()));
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(y[i], x[2 * i]);
+  }
+
+  // One element out of range fails the whole array.
+  for (size_t k = 0; k < Field::kBytes; ++k) {
+    got[5 * Field::kBytes + k] = 0xFF;
+  }
+  EXPECT_FALSE(F.of_bytes_field_n(n, y.data(), got.data()));
+}
+
+TEST(Fp, BulkBytes) {
+  bulkbytes(Fp<1>("18446744069414584321"));
+  bulkbytes(Fp256<>());
+  bulkbytes(Fp128<>());
+  bulkbytes(Fp521<>());
+}
+
 TEST(Fp, RootOfUnity) {
   Fp<4> F(
       "218882428718392752222464057452572750885483644004160343436982041865758084"
@@ -373,6 +412,84 @@ TEST(Fp, InverseSecp256k1) {
   }
 }
 
+// Fp256 may use the unrolled multiplication and squaring kernels,
+// while Fp<4> with the same modulus always uses the generic loop.
+// Both use R = 2^256, hence they must agree limb by limb.
+TEST(Fp, P256Kernel) {
+  const Fp256<> F;
+  const Fp<4> G(
+      "115792089210356248762697446949407573530086143415290314195533631308867"
+      "097853951");
+  std::vector<Fp<4>::N> xs = {Fp<4>::N(0), Fp<4>::N(1), Fp<4>::N(2)};
+  for (uint64_t k = 1; k < 4; ++k) {
+    Fp<4>::N x = G.m_;
+    x.sub(Fp<4>::N(k));
+    xs.push_back(x);
+  }
+  Bogorng<Fp<4>> rng(&G);
+  for (size_t i = 0; i < 200; ++i) {
+    xs.push_back(rng.next().n);
+  }
+
+  for (const auto& x : xs) {
+    EXPECT_EQ(F.sqrf(Fp256<>::Elt{x}).n, G.sqrf(Fp<4>::Elt{x}).n);
+    EXPECT_EQ(F.sqrf(Fp256<>::Elt{x}).n, G.mulf(Fp<4>::Elt{x}, {x}).n);
+    for (const auto& y : xs) {
+      EXPECT_EQ(F.mulf(Fp256<>::Elt{x}, {y}).n, G.mulf(Fp<4>::Elt{x}, {y}).n);
+    }
+  }
+}
+
+// reducew() of sums and differences of unreduced products must
+// agree with the reduced arithmetic, including at the extremes
+// of its input range.
+template <class Field>
+void widemul(const Field& F) {
+  using Elt = typename Field::Elt;
+  using N = typename Field::N;
+  std::vector<Elt> xs = {F.zero(), F.one(), F.mone(), Elt{N(0)}, Elt{N(1)}};
+  for (uint64_t k = 1; k < 4; ++k) {
+    N x = F.m_;
+    x.sub(N(k));
+    xs.push_back(Elt{x});
+  }
+  Bogorng<Field> rng(&F);
+  for (size_t i = 0; i < 30; ++i) {
+    xs.push_back(rng.next());
+  }
+
+  for (const auto& x : xs) {
+    for (const auto& y : xs) {
+      Elt xy = F.mulf(x, y);
+      EXPECT_EQ(F.reducew(F.mulw(x, y)), xy);
+      for (const auto& z : {x, F.mone(), rng.next()}) {
+        Elt yz = F.mulf(y, z);
+        Elt zx = F.mulf(z, x);
+        auto a = F.mulw(x, y);
+        F.addw(a, F.mulw(y, z));
+        EXPECT_EQ(F.reducew(a), F.addf(xy, yz));
+        a = F.mulw(x, y);
+        F.subw(a, F.mulw(y, z));
+        EXPECT_EQ(F.reducew(a), F.subf(xy, yz));
+        F.subw(a, F.mulw(z, x));
+        EXPECT_EQ(F.reducew(a), F.subf(F.subf(xy, yz), zx));
+      }
+    }
+  }
+}
+
+TEST(Fp, WideMul) {
+  widemul(Fp<1>("18446744069414584321"));
+  widemul(Fp<1>("18446744073709551557"));
+  widemul(Fp<2>("340282366920938463463374607431768211297"));
+  widemul(
+      Fp<4>("115792089237316195423570985008687907853269984665640564039457584007"
+            "913129639747"));
+  widemul(Fp256<>());
+  widemul(Fp128<>());
+  widemul(Fp521<>());
+}
+
 TEST(Fp, castable) {
   Fp<4> F(
       "11579208923731619542357098500868790785326998466564056403945758400790"
@@ -408,6 +525,16 @@ void bench_mul(const Field& F, benchmark::State& state) {
   }
 }
 
+template <class Field>
+void bench_sqr(const Field& F, benchmark::State& state) {
+  Bogorng<Field> rng(&F);
+  auto a = rng.next();
+  for (auto _ : state) {
+    a = F.sqrf(a);
+    benchmark::DoNotOptimize(a);
+  }
+}
+
 void BM_Fp1_add(benchmark::State& state) {
   const Fp<1> F("18446744073709551557");
   bench_add(F, state);
@@ -444,6 +571,21 @@ void BM_p256_mul(benchmark::State& state) {
 }
 BENCHMARK(BM_p256_mul);
 
+// The generic multiplication loop with the P256 modulus
+void BM_p256_mul_normal(benchmark::State& state) {
+  const Fp<4, true> F(
+      "115792089210356248762697446949407573530086143415290314195533631308867"
+      "097853951");
+  bench_mul(F, state);
+}
+BENCHMARK(BM_p256_mul_normal);
+
+void BM_p256_sqr(benchmark::State& state) {
+  const Fp256<true> F;
+  bench_sqr(F, state);
+}
+BENCHMARK(BM_p256_sqr);
+
 void BM_p384_mul(benchmark::State& state) {
   const Fp384<true> F;
   bench_mul(F, state);
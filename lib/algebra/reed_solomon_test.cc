@@ -18,6 +18,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "algebra/blas.h"
@@ -31,6 +32,7 @@
 #include "algebra/fp_p256.h"
 #include "algebra/interpolation.h"
 #include "algebra/poly.h"
+#include "algebra/tuned_convolution.h"
 #include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
 
@@ -161,6 +163,74 @@ void one_field_reed_solomon(const typename Field::Elt& omega,
   for (size_t i = 0; i < M; ++i) {
     EXPECT_EQ(L4[i], L[i]);
   }
+
+  std::vector<Elt> L5(M);
+  for (size_t i = 0; i < N; ++i) {
+    L5[i] = L[i];
+  }
+  NussbaumerConvolutionFactory<Field> nuss_factory(f);
+  ReedSolomon<Field, NussbaumerConvolutionFactory<Field>> r_nuss(
+      N, M, f, nuss_factory);
+  r_nuss.interpolate(&L5[0]);
+  for (size_t i = 0; i < M; ++i) {
+    EXPECT_EQ(L5[i], L[i]);
+  }
+
+  std::vector<Elt> L6(M);
+  for (size_t i = 0; i < N; ++i) {
+    L6[i] = L[i];
+  }
+  TunedConvolutionFactory<Field> tuned_factory(f);
+  tuned_factory.add("fft", factory);
+  tuned_factory.add("slow", slow_factory);
+  tuned_factory.add("crt", crt_factory);
+  tuned_factory.add("nussbaumer", nuss_factory);
+  ReedSolomon<Field, TunedConvolutionFactory<Field>> r_tuned(N, M, f,
+                                                             tuned_factory);
+  r_tuned.interpolate(&L6[0]);
+  for (size_t i = 0; i < M; ++i) {
+    EXPECT_EQ(L6[i], L[i]);
+  }
+}
+
+TEST(ReedSolomonTest, TunedConvolutionProfile) {
+  using Field = Fp<4>;
+  FFTConvolutionFactory<Field> fft(F, omegaf, omegaf_order);
+  SlowConvolutionFactory<Field> slow(F);
+
+  TunedConvolutionFactory<Field> tuned(F);
+  tuned.add("fft", fft);
+  tuned.add("slow", slow);
+  EXPECT_TRUE(tuned.load_profile("37 256 slow\n1024 4096 fft\n"));
+  EXPECT_EQ(tuned.name(tuned.choose(37, 256)), "slow");
+  EXPECT_EQ(tuned.name(tuned.choose(1024, 4096)), "fft");
+  EXPECT_EQ(tuned.profile(), "37 256 slow\n1024 4096 fft\n");
+
+  // Unknown engines are ignored, malformed profiles are rejected.
+  TunedConvolutionFactory<Field> tuned2(F);
+  tuned2.add("fft", fft);
+  EXPECT_TRUE(tuned2.load_profile(tuned.profile()));
+  EXPECT_EQ(tuned2.profile(), "1024 4096 fft\n");
+  EXPECT_FALSE(tuned2.load_profile("37 slow\n"));
+}
+
+TEST(ReedSolomonTest, TunedConvolutionStatic) {
+  using Field = Fp<4>;
+  FFTConvolutionFactory<Field> fft(F, omegaf, omegaf_order);
+  SlowConvolutionFactory<Field> slow(F);
+
+  // Without autotuning, the engine depends only on the size, and
+  // nothing is recorded in the profile.
+  TunedConvolutionFactory<Field> tuned(F);
+  tuned.add("slow", slow);
+  tuned.add("fft", fft, /*min_n=*/64);
+  EXPECT_EQ(tuned.name(tuned.choose(37, 256)), "slow");
+  EXPECT_EQ(tuned.name(tuned.choose(64, 256)), "fft");
+  EXPECT_EQ(tuned.profile(), "");
+
+  // A profile overrides the static choice.
+  EXPECT_TRUE(tuned.load_profile("1024 4096 slow\n"));
+  EXPECT_EQ(tuned.name(tuned.choose(1024, 4096)), "slow");
 }
 
 TEST(ReedSolomonTest, ReedSolomon) {
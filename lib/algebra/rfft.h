@@ -18,6 +18,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "algebra/fp2.h"
 #include "algebra/permutations.h"
 #include "algebra/twiddle.h"
 #include "util/panic.h"
@@ -268,105 +269,166 @@ class RFFT {
     cmul(&Ar[3 * s], &Ai[3 * s], tw3.re, tw3.im, R);
   }
 
- public:
-  // Forward real to half-complex in-place transform.
-  // N (the length of A) must be a power of 2
-  static void r2hc(RElt A[/*n*/], size_t n, const CElt& omega,
-                   uint64_t omega_order, const FieldExt& C) {
-    const Field& R = C.base_field();
-    validate_root(omega, C);
-
-    if (n == 2) {
-      r2hcI_2(A, 1, R);
-    } else if (n >= 4) {
-      CElt omega_n = Twiddle<FieldExt>::reroot(omega, omega_order, n, C);
-      Twiddle<FieldExt> roots(n, omega_n, C);
-      validate_I(roots.w_[n / 4], C);
+  // One radix-4 level of r2hc(), combining the half-complex
+  // transforms of size M into transforms of size 4M, over the block
+  // A[0, S) of a transform of size N.
+  static void r2hc_level(RElt A[/*s*/], size_t s, size_t m, size_t n,
+                         const Twiddle<FieldExt>& roots, const Field& R) {
+    size_t ws = n / (4 * m);
+    for (size_t k = 0; k < s; k += 4 * m) {
+      size_t j;
+      r2hcI_4(&A[k], m, R);  // j==0
+
+      for (j = 1; j + j < m; ++j) {
+        hc2hcf_4(&A[k + j], &A[k + m - j], m, roots.w_[j * ws],
+                 roots.w_[2 * j * ws], roots.w_[3 * j * ws], R);
+      }
 
-      Permutations<RElt>::bitrev(A, n);
+      r2hcII_4(&A[k + j], m, roots.w_[j * ws], R);  // j==m/2
+    }
+  }
 
-      size_t m = n;
+  // r2hc() of the bit-reversed block A[0, S) of a transform of size
+  // N.  Blocks that fit in kBlockBytes are transformed level by level,
+  // and larger blocks are split into four quarters that are
+  // transformed first.
+  static void r2hc_block(RElt A[/*s*/], size_t s, size_t n,
+                         const Twiddle<FieldExt>& roots, const Field& R) {
+    if (s * sizeof(RElt) <= kBlockBytes || s < 16) {
+      size_t m = s;
       while (m > 4) {
         m /= 4;
       }
 
       if (m == 2) {
-        for (size_t k = 0; k < n; k += 2) {
+        for (size_t k = 0; k < s; k += 2) {
           r2hcI_2(&A[k], 1, R);
         }
       } else {
         // m == 4
-        for (size_t k = 0; k < n; k += 4) {
+        for (size_t k = 0; k < s; k += 4) {
           r2hcI_4(&A[k], 1, R);
         }
       }
 
-      for (; m < n; m = 4 * m) {
-        size_t ws = n / (4 * m);
-        for (size_t k = 0; k < n; k += 4 * m) {
-          size_t j;
-          r2hcI_4(&A[k], m, R);  // j==0
-
-          for (j = 1; j + j < m; ++j) {
-            hc2hcf_4(&A[k + j], &A[k + m - j], m, roots.w_[j * ws],
-                     roots.w_[2 * j * ws], roots.w_[3 * j * ws], R);
-          }
-
-          r2hcII_4(&A[k + j], m, roots.w_[j * ws], R);  // j==m/2
-        }
+      for (; m < s; m = 4 * m) {
+        r2hc_level(A, s, m, n, roots, R);
+      }
+    } else {
+      size_t q = s / 4;
+      for (size_t r = 0; r < 4; ++r) {
+        r2hc_block(&A[r * q], q, n, roots, R);
       }
+      r2hc_level(A, s, q, n, roots, R);
     }
   }
 
-  // Backward half-complex to real in-place transform.
-  static void hc2r(RElt A[/*n*/], size_t n, const CElt& omega,
-                   uint64_t omega_order, const FieldExt& C) {
-    const Field& R = C.base_field();
-    validate_root(omega, C);
+  // One radix-4 level of hc2r(), the inverse of r2hc_level().
+  static void hc2r_level(RElt A[/*s*/], size_t s, size_t m, size_t n,
+                         const Twiddle<FieldExt>& roots, const Field& R) {
+    size_t ws = n / (4 * m);
+    for (size_t k = 0; k < s; k += 4 * m) {
+      size_t j;
+      hc2rI_4(&A[k], m, R);  // j==0
+
+      for (j = 1; j + j < m; ++j) {
+        hc2hcb_4(&A[k + j], &A[k + m - j], m, roots.w_[j * ws],
+                 roots.w_[2 * j * ws], roots.w_[3 * j * ws], R);
+      }
 
-    if (n == 2) {
-      hc2rI_2(A, 1, R);
-    } else if (n >= 4) {
-      CElt omega_n = Twiddle<FieldExt>::reroot(omega, omega_order, n, C);
-      Twiddle<FieldExt> roots(n, omega_n, C);
-      validate_I(roots.w_[n / 4], C);
+      hc2rIII_4(&A[k + j], m, roots.w_[j * ws], R);  // j==m/2
+    }
+  }
 
-      size_t m = n;
+  // hc2r() of the block A[0, S) of a transform of size N, the
+  // inverse of r2hc_block() except for the bit reversal.
+  static void hc2r_block(RElt A[/*s*/], size_t s, size_t n,
+                         const Twiddle<FieldExt>& roots, const Field& R) {
+    if (s * sizeof(RElt) <= kBlockBytes || s < 16) {
+      size_t m = s;
 
       while (m > 4) {
         m /= 4;
-        size_t ws = n / (4 * m);
-        for (size_t k = 0; k < n; k += 4 * m) {
-          size_t j;
-          hc2rI_4(&A[k], m, R);  // j==0
-
-          for (j = 1; j + j < m; ++j) {
-            hc2hcb_4(&A[k + j], &A[k + m - j], m, roots.w_[j * ws],
-                     roots.w_[2 * j * ws], roots.w_[3 * j * ws], R);
-          }
-
-          hc2rIII_4(&A[k + j], m, roots.w_[j * ws], R);  // j==m/2
-        }
+        hc2r_level(A, s, m, n, roots, R);
       }
 
       if (m == 2) {
-        for (size_t k = 0; k < n; k += 2) {
+        for (size_t k = 0; k < s; k += 2) {
           hc2rI_2(&A[k], 1, R);
         }
       } else {
         // m == 4
-        for (size_t k = 0; k < n; k += 4) {
+        for (size_t k = 0; k < s; k += 4) {
           hc2rI_4(&A[k], 1, R);
         }
       }
+    } else {
+      size_t q = s / 4;
+      hc2r_level(A, s, q, n, roots, R);
+      for (size_t r = 0; r < 4; ++r) {
+        hc2r_block(&A[r * q], q, n, roots, R);
+      }
+    }
+  }
+
+ public:
+  // The transforms run depth first, finishing each sub-transform of
+  // at most this many bytes before combining, so that all levels of
+  // the sub-transform run in cache.
+  static constexpr size_t kBlockBytes = size_t(1) << 16;
+
+  // Forward real to half-complex in-place transform.
+  // N (the length of A) must be a power of 2
+  static void r2hc(RElt A[/*n*/], size_t n, const CElt& omega,
+                   uint64_t omega_order, const FieldExt& C) {
+    const Field& R = C.base_field();
+    validate_root(omega, C);
+
+    if (n == 2) {
+      r2hcI_2(A, 1, R);
+    } else if (n >= 4) {
+      CElt omega_n = Twiddle<FieldExt>::reroot(omega, omega_order, n, C);
+      Twiddle<FieldExt> roots(n, omega_n, C);
+      validate_I(roots.w_[n / 4], C);
 
       Permutations<RElt>::bitrev(A, n);
+      r2hc_block(A, n, n, roots, R);
+    }
+  }
+
+  // Backward half-complex to real in-place transform.
+  static void hc2r(RElt A[/*n*/], size_t n, const CElt& omega,
+                   uint64_t omega_order, const FieldExt& C) {
+    const Field& R = C.base_field();
+    validate_root(omega, C);
+
+    if (n == 2) {
+      hc2rI_2(A, 1, R);
+    } else if (n >= 4) {
+      CElt omega_n = Twiddle<FieldExt>::reroot(omega, omega_order, n, C);
+      Twiddle<FieldExt> roots(n, omega_n, C);
+      validate_I(roots.w_[n / 4], C);
+
+      hc2r_block(A, n, n, roots, R);
+      Permutations<RElt>::bitrev(A, n);
     }
   }
 
   // X *= B
   static void cmul(RElt* xr, RElt* xi, const RElt& br, const RElt& bi,
                    const Field& R) {
+    if constexpr (HasWideMul<Field>::value) {
+      // Karatsuba with one reduction per component
+      auto p0 = R.mulw(*xr, br);
+      auto p1 = R.mulw(*xi, bi);
+      auto pm = R.mulw(R.addf(*xr, *xi), R.addf(br, bi));
+      R.subw(pm, p0);
+      R.subw(pm, p1);
+      R.subw(p0, p1);
+      *xr = R.reducew(p0);
+      *xi = R.reducew(pm);
+      return;
+    }
     // Karatsuba 3 mul + 5 add
     RElt p0 = R.mulf(*xr, br);
     RElt p1 = R.mulf(*xi, bi);
@@ -382,6 +444,18 @@ class RFFT {
   // *X *= conj(B)
   static void cmulj(RElt* xr, RElt* xi, const RElt& br, const RElt& bi,
                     const Field& R) {
+    if constexpr (HasWideMul<Field>::value) {
+      // re = p0 + p1, im = (xr + xi)(br - bi) - p0 + p1
+      auto p0 = R.mulw(*xr, br);
+      auto p1 = R.mulw(*xi, bi);
+      auto pm = R.mulw(R.addf(*xr, *xi), R.subf(br, bi));
+      R.subw(pm, p0);
+      R.addw(pm, p1);
+      R.addw(p0, p1);
+      *xr = R.reducew(p0);
+      *xi = R.reducew(pm);
+      return;
+    }
     // Karatsuba 3 mul + 5 add
     RElt p0 = R.mulf(*xr, br);
     RElt p1 = R.mulf(*xi, bi);
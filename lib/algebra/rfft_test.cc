@@ -23,6 +23,7 @@
 #include "algebra/fft.h"
 #include "algebra/fp2.h"
 #include "algebra/fp_p256.h"
+#include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
 
 namespace proofs {
@@ -58,7 +59,8 @@ TEST(RFFTTest, Simple) {
     ExtElt one = F_ext.mulf(omega, F_ext.conjf(omega));
     EXPECT_EQ(one, F_ext.one());
 
-    for (size_t n = 1; n < 1024; n *= 2) {
+    // up to sizes where the transforms split into blocks
+    for (size_t n = 1; n <= (1 << 14); n *= 2) {
       std::vector<BaseElt> AR0(n);
       std::vector<BaseElt> AR1(n);
       std::vector<ExtElt> AC(n);
@@ -99,4 +101,35 @@ TEST(RFFTTest, Simple) {
 }
 
 }  // namespace
+
+// ================ Benchmarking ==============================================
+
+namespace bench {
+void BM_RFFT_Fp256(benchmark::State& state) {
+  using BaseField = Fp256<>;
+  using BaseElt = BaseField::Elt;
+  using ExtField = Fp2<BaseField>;
+  using ExtElt = ExtField::Elt;
+
+  const BaseField F0;
+  const ExtField F_ext(F0);
+  const ExtElt omega = F_ext.of_string(
+      "112649224146410281873500457609690258373018840430489408729223714171582664"
+      "680802",
+      "840879943585409076957404614278186605601821689971823787493130182544504602"
+      "12908");
+  uint64_t omega_order = 1ull << 31;
+
+  size_t n = state.range(0);
+  std::vector<BaseElt> A(n);
+  for (size_t i = 0; i < n; ++i) {
+    A[i] = F0.of_scalar(i * i * i + (i & 0xF) + (i ^ (i << 2)));
+  }
+  for (auto _ : state) {
+    RFFT<ExtField>::r2hc(&A[0], n, omega, omega_order, F_ext);
+    RFFT<ExtField>::hc2r(&A[0], n, omega, omega_order, F_ext);
+  }
+}
+BENCHMARK(BM_RFFT_Fp256)->RangeMultiplier(4)->Range(1024, (1 << 22));
+}  // namespace bench
 }  // namespace proofs
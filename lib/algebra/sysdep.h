@@ -26,6 +26,9 @@
 // and 64x64->128 bit multiplication
 #include <x86intrin.h>  // IWYU pragma: keep
 #endif
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 namespace proofs {
 
@@ -55,6 +58,13 @@ static inline uint32_t sbb(uint32_t* a, uint32_t b, uint32_t c) {
 static inline void mulq(uint64_t* l, uint64_t* h, uint64_t a, uint64_t b) {
   asm("mulx %2, %0, %1" : "=r"(*l), "=r"(*h) : "r"(b), "d"(a));
 }
+
+// True if the CPU supports adcx/adox.  Unlike mulx above, which is
+// used unconditionally, code using ADX must check this at run time.
+static inline bool cpu_has_adx() {
+  unsigned int a, b, c, d;
+  return __get_cpuid_count(7, 0, &a, &b, &c, &d) && (b & bit_ADX) != 0;
+}
 #elif defined(__i386__)
 static inline uint32_t adc(uint32_t* a, uint32_t b, uint32_t c) {
   return _addcarry_u32(c, *a, b, a);
@@ -0,0 +1,253 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_ALGEBRA_TUNED_CONVOLUTION_H_
+#define PRIVACY_PROOFS_ZK_LIB_ALGEBRA_TUNED_CONVOLUTION_H_
+
+#include <stddef.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "util/panic.h"
+
+/*
+TunedConvolutionFactory is a ConvolutionFactory that dispatches at
+runtime to one of several registered factories, such as the ones in
+convolution.h and crt_convolution.h.  All engines compute the same
+exact result, so the choice only affects speed.
+
+By default the engine is chosen statically by size: each engine is
+registered with the smallest n for which it should be used, and the
+last registered engine whose threshold does not exceed n wins.  The
+choice for specific sizes can be overridden by a tuning profile
+previously produced by profile().
+
+Timing is opt-in via set_autotune(true).  Then the first call to make()
+for a size that is not in the profile times every registered engine on
+that size and remembers the fastest one.  This takes a few
+milliseconds per size, which is acceptable for an offline tool such as
+convolution_tuner but not for a latency-sensitive prover or verifier.
+*/
+
+namespace proofs {
+
+// Type-erased convolver, which is the Convolver type of
+// TunedConvolutionFactory.
+template <class Field>
+class DynamicConvolver {
+  using Elt = typename Field::Elt;
+
+ public:
+  virtual ~DynamicConvolver() = default;
+  virtual void convolution(const Elt x[/*n*/], Elt z[/*m*/]) const = 0;
+};
+
+template <class Field, class Convolver>
+class DynamicConvolverAdapter : public DynamicConvolver<Field> {
+  using Elt = typename Field::Elt;
+
+ public:
+  explicit DynamicConvolverAdapter(std::unique_ptr<const Convolver> c)
+      : c_(std::move(c)) {}
+
+  void convolution(const Elt x[/*n*/], Elt z[/*m*/]) const override {
+    c_->convolution(x, z);
+  }
+
+ private:
+  std::unique_ptr<const Convolver> c_;
+};
+
+template <class Field>
+class TunedConvolutionFactory {
+  using Elt = typename Field::Elt;
+
+ public:
+  using Convolver = DynamicConvolver<Field>;
+
+  explicit TunedConvolutionFactory(const Field& f) : f_(f) {}
+
+  // no copies, because of the mutex
+  TunedConvolutionFactory(const TunedConvolutionFactory&) = delete;
+  TunedConvolutionFactory& operator=(const TunedConvolutionFactory&) = delete;
+
+  // Register FACTORY under NAME, as the static choice for sizes
+  // n >= MIN_N unless a later engine claims them.  FACTORY must
+  // outlive *this.
+  template <class Factory>
+  void add(const std::string& name, const Factory& factory,
+           size_t min_n = 0) {
+    engines_.push_back(Engine{
+        name, min_n, [&factory](size_t n, size_t m, const Elt y[/*m*/]) {
+          return std::unique_ptr<const Convolver>(
+              std::make_unique<const DynamicConvolverAdapter<
+                  Field, typename Factory::Convolver>>(factory.make(n, m, y)));
+        }});
+  }
+
+  // Time the engines on sizes that are not in the profile, instead
+  // of choosing statically.
+  void set_autotune(bool on) { autotune_ = on; }
+
+  size_t nengines() const { return engines_.size(); }
+  const std::string& name(size_t e) const { return engines_.at(e).name; }
+
+  std::unique_ptr<const Convolver> make(size_t n, size_t m,
+                                        const Elt y[/*m*/]) const {
+    return engines_[choose(n, m)].make(n, m, y);
+  }
+
+  // Return the index of the engine used for size (n, m).  Sizes in
+  // the profile use the recorded engine.  Other sizes use the static
+  // choice, or, with autotuning, the fastest engine on this machine.
+  size_t choose(size_t n, size_t m) const {
+    check(!engines_.empty(), "no convolution engines registered");
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = choice_.find({n, m});
+      if (it != choice_.end()) {
+        return it->second;
+      }
+    }
+
+    if (!autotune_) {
+      size_t e = 0;
+      for (size_t i = 1; i < engines_.size(); ++i) {
+        if (engines_[i].min_n <= n) {
+          e = i;
+        }
+      }
+      return e;
+    }
+
+    // Time outside the lock.  Two threads may race to tune the
+    // same size, which is harmless.
+    std::vector<double> t = time_all(n, m);
+    size_t best = 0;
+    for (size_t e = 1; e < t.size(); ++e) {
+      if (t[e] < t[best]) {
+        best = e;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mu_);
+    choice_.emplace(std::make_pair(n, m), best);
+    return best;
+  }
+
+  // Return the time in seconds of one convolution of size (n, m)
+  // for each engine, in registration order.  The time of
+  // constructing the convolver is not included, since the
+  // Reed-Solomon encoder constructs it once and then convolves
+  // every row of the tableau.
+  std::vector<double> time_all(size_t n, size_t m) const {
+    std::vector<Elt> x(n), y(m), z(m);
+    for (size_t i = 0; i < n; ++i) {
+      x[i] = f_.of_scalar(3 * i + 1);
+    }
+    for (size_t i = 0; i < m; ++i) {
+      y[i] = f_.of_scalar(5 * i + 2);
+    }
+
+    std::vector<double> t(engines_.size());
+    for (size_t e = 0; e < engines_.size(); ++e) {
+      auto c = engines_[e].make(n, m, &y[0]);
+      t[e] = min_time([&]() { c->convolution(&x[0], &z[0]); });
+    }
+    return t;
+  }
+
+  // Textual tuning profile, one "n m name" line per known size.
+  std::string profile() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::ostringstream os;
+    for (const auto& [nm, e] : choice_) {
+      os << nm.first << " " << nm.second << " " << engines_[e].name << "\n";
+    }
+    return os.str();
+  }
+
+  // Load a profile produced by profile().  Lines naming an engine
+  // that is not registered are ignored, and those sizes are tuned
+  // on demand.  Returns false if the profile is malformed.
+  bool load_profile(const std::string& s) {
+    std::istringstream is(s);
+    std::map<std::pair<size_t, size_t>, size_t> loaded;
+    size_t n, m;
+    std::string name;
+    while (is >> n >> m >> name) {
+      for (size_t e = 0; e < engines_.size(); ++e) {
+        if (engines_[e].name == name) {
+          loaded[{n, m}] = e;
+        }
+      }
+    }
+    if (!is.eof()) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& [nm, e] : loaded) {
+      choice_[nm] = e;
+    }
+    return true;
+  }
+
+ private:
+  struct Engine {
+    std::string name;
+    size_t min_n;
+    std::function<std::unique_ptr<const Convolver>(size_t, size_t,
+                                                   const Elt[/*m*/])>
+        make;
+  };
+
+  // Minimum time of FN over a few runs, stopping early once the
+  // total exceeds a small budget so that large sizes are run once.
+  template <class Fn>
+  static double min_time(const Fn& fn) {
+    constexpr size_t kMaxRuns = 5;
+    constexpr double kBudget = 0.01;  // seconds
+    double best = 0, total = 0;
+    for (size_t r = 0; r < kMaxRuns && total < kBudget; ++r) {
+      auto t0 = std::chrono::steady_clock::now();
+      fn();
+      std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+      if (r == 0 || dt.count() < best) {
+        best = dt.count();
+      }
+      total += dt.count();
+    }
+    return best;
+  }
+
+  const Field& f_;
+  std::vector<Engine> engines_;
+  bool autotune_ = false;
+
+  mutable std::mutex mu_;
+  mutable std::map<std::pair<size_t, size_t>, size_t> choice_;
+};
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_ALGEBRA_TUNED_CONVOLUTION_H_
@@ -18,6 +18,7 @@
 #include <stddef.h>
 
 #include <cstdint>
+#include <vector>
 
 namespace proofs {
 template <class Field>
@@ -47,6 +48,31 @@ class AlgebraUtil {
     }
   }
 
+  // *x[i] = inverse(*x[i]) for all nonzero *x[i], via Montgomery batch
+  // inversion.  Zero entries are left unchanged, so that callers can
+  // batch inversions whose inputs may be zero on malicious inputs.
+  static void batch_invert_nonzero(size_t n, Elt* const x[/*n*/],
+                                   const Field& F) {
+    std::vector<Elt> a(n);
+    Elt p = F.one();
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = p;
+      if (*x[i] != F.zero()) {
+        F.mul(p, *x[i]);
+      }
+    }
+
+    F.invert(p);
+
+    for (size_t i = n; i-- > 0;) {
+      if (*x[i] != F.zero()) {
+        F.mul(a[i], p);
+        F.mul(p, *x[i]);
+        *x[i] = a[i];
+      }
+    }
+  }
+
   // a[i] = 1/i, with a[0]=0
   static void batch_inverse_arithmetic(size_t n, Elt a[/*n*/], const Field& F) {
     a[0] = F.zero();
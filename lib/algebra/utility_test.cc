@@ -44,6 +44,29 @@ TEST(Utility, BatchInverse) {
   }
 }
 
+TEST(Utility, BatchInvertNonzero) {
+  const Field F(
+      "218882428718392752222464057452572750885483644004160343436982041865758084"
+      "95617");
+  Bogorng<Field> rng(&F);
+
+  constexpr size_t n = 37;
+  Elt a[n], b[n];
+  Elt* pa[n];
+  for (size_t i = 0; i < n; ++i) {
+    a[i] = b[i] = (i % 5 == 3) ? F.zero() : rng.nonzero();
+    pa[i] = &a[i];
+  }
+  AlgebraUtil<Field>::batch_invert_nonzero(n, pa, F);
+  for (size_t i = 0; i < n; ++i) {
+    if (b[i] == F.zero()) {
+      EXPECT_EQ(a[i], F.zero());
+    } else {
+      EXPECT_EQ(a[i], F.invertf(b[i]));
+    }
+  }
+}
+
 //------------------------------------------------------------
 
 // a[i] /= i!, without doing too many inversions
@@ -0,0 +1,415 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_CBOR_FLAT_DECODER_H_
+#define PRIVACY_PROOFS_ZK_LIB_CBOR_FLAT_DECODER_H_
+
+#include <stddef.h>
+#include <string.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "cbor/host_decoder.h"
+#include "util/panic.h"
+
+namespace proofs {
+
+// Flat, lazily-decoded version of CborDoc, which accepts the same
+// inputs (up to a nesting depth of kMaxDepth) and reports the same
+// positions.
+//
+// All the nodes decoded from one input live in a single arena
+// vector, and they refer to each other by index, so that decoding
+// does not allocate per node.  The children of an ARRAY, MAP or TAG
+// node are contiguous in the arena, and they are decoded only when
+// the node is first indexed or looked up.  decode() still validates
+// the whole input upfront, so that a lazy expansion cannot fail.
+//
+// Map keys are hashed when the map is expanded, so that lookup()
+// compares hashes before comparing bytes.
+//
+// Several items of the same input can be decoded into one FlatCborDoc,
+// e.g., the byte strings that hold embedded CBOR, and all positions
+// are relative to the start of the input.
+class FlatCborDoc {
+ public:
+  using node_t = uint32_t;
+  static constexpr node_t kNone = ~node_t(0);
+
+  struct Node {
+    size_t header_pos_;
+    enum CborTag t_;
+
+    // Same as CborDoc::U, plus the location of the children.
+    union U {
+      uint64_t u64;         /* UNSIGNED */
+      int64_t i64;          /* NEGATIVE */
+      enum CborPrimitive p; /* PRIMITIVE */
+
+      struct {
+        size_t pos;
+        size_t len;
+      } string;
+
+      struct {
+        // The original count in the source document.  For tags,
+        // the tag itself.
+        size_t n;
+
+        // The actual number of children (e.g. 2*n for maps).
+        size_t nchildren;
+
+        // Position in the input of the first child, and the arena
+        // index of the first child, or kNone if not yet decoded.
+        size_t body;
+        node_t first;
+      } items;
+    } u_;
+
+    // Hash of the key, for nodes that are keys of a map.
+    uint64_t key_hash_;
+  };
+
+  FlatCborDoc(const uint8_t in[/*len*/], size_t len) : in_(in), len_(len) {
+    nodes_.reserve(kInitialNodes);
+  }
+
+  // Decodes the item that starts at POS and ends at or before END,
+  // advances POS past the item, and returns the index of the new
+  // root node, or kNone if the input cannot be parsed.
+  node_t decode(size_t &pos, size_t end) {
+    check(end <= len_, "end > len");
+    size_t p = pos;
+    if (!skip(p, end, 0)) {
+      return kNone;
+    }
+    node_t root = static_cast<node_t>(nodes_.size());
+    nodes_.emplace_back();
+    size_t q = pos;
+    decode_header(nodes_[root], q);
+    pos = p;
+    return root;
+  }
+
+  // Decodes the CBOR embedded in the BYTES node N.
+  node_t decode_bytes(node_t n) {
+    const Node &b = nodes_[n];
+    if (b.t_ != BYTES) {
+      return kNone;
+    }
+    size_t pos = b.u_.string.pos;
+    return decode(pos, b.u_.string.pos + b.u_.string.len);
+  }
+
+  const uint8_t *input() const { return in_; }
+
+  // The returned reference is invalidated by decode() and by the
+  // first index() or lookup*() into a container.
+  const Node &operator[](node_t n) const { return nodes_[n]; }
+  size_t nnodes() const { return nodes_.size(); }
+
+  // Child I of the ARRAY or TAG node N, or kNone.
+  node_t index(node_t n, size_t i) const {
+    if ((nodes_[n].t_ == ARRAY || nodes_[n].t_ == TAG) &&
+        i < nodes_[n].u_.items.nchildren) {
+      return children(n) + static_cast<node_t>(i);
+    }
+    return kNone;
+  }
+
+  // Lookup a TEXT key in the MAP node N.  Returns the key node, or
+  // kNone if not found.  The value is the node following the key.
+  // NDX is set to the index of the key in the map.
+  node_t lookup(node_t n, size_t len, const uint8_t bytes[/*len*/],
+                size_t &ndx) const {
+    if (nodes_[n].t_ != MAP) {
+      return kNone;
+    }
+    uint64_t h = hash(TEXT, bytes, len);
+    node_t c = children(n);
+    for (size_t i = 0; i < nodes_[n].u_.items.n; ++i) {
+      const Node &key = nodes_[c + 2 * i];
+      if (key.key_hash_ == h && key.t_ == TEXT && key.u_.string.len == len &&
+          memcmp(bytes, &in_[key.u_.string.pos], len) == 0) {
+        ndx = i;
+        return c + static_cast<node_t>(2 * i);
+      }
+    }
+    return kNone;
+  }
+
+  // Lookup a key in a map of type {unsigned->object}.
+  node_t lookup_unsigned(node_t n, uint64_t k, size_t &ndx) const {
+    return lookup_int(n, UNSIGNED, k, ndx);
+  }
+
+  // Lookup a key in a map of type {negative->object}.
+  node_t lookup_negative(node_t n, int64_t k, size_t &ndx) const {
+    return lookup_int(n, NEGATIVE, static_cast<uint64_t>(k), ndx);
+  }
+
+  // Same as CborDoc::position()
+  size_t position(node_t n) const {
+    const Node &x = nodes_[n];
+    switch (x.t_) {
+      case UNSIGNED:
+      case PRIMITIVE:
+        return x.header_pos_;
+      case BYTES:
+      case TEXT:
+        return x.u_.string.pos;
+      case TAG:
+        return nodes_[children(n)].u_.string.pos;
+      default:
+        check(false, "valueIndex called on non-value type");
+    }
+    return 0;
+  }
+
+  // Same as CborDoc::length()
+  size_t length(node_t n) const {
+    const Node &x = nodes_[n];
+    switch (x.t_) {
+      case UNSIGNED:
+        if (x.u_.u64 < 24) {
+          return 1;
+        } else if (x.u_.u64 < 256) {
+          return 2;
+        } else if (x.u_.u64 < 65536) {
+          return 3;
+        }
+        return 5;
+      case BYTES:
+      case TEXT:
+        return x.u_.string.len;
+      case TAG:
+        return nodes_[children(n)].u_.string.len;
+      case PRIMITIVE:
+        return 1;
+      default:
+        check(false, "valueLength called on non-value type");
+    }
+    return 0;
+  }
+
+ private:
+  // FNV-1a over the key type and bytes
+  static uint64_t hash(CborTag t, const uint8_t *bytes, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ull ^ static_cast<uint64_t>(t);
+    for (size_t i = 0; i < len; ++i) {
+      h = (h ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return h;
+  }
+
+  static uint64_t hash_int(CborTag t, uint64_t k) {
+    uint8_t b[8];
+    for (size_t i = 0; i < 8; ++i) {
+      b[i] = static_cast<uint8_t>(k >> (8 * i));
+    }
+    return hash(t, b, 8);
+  }
+
+  node_t lookup_int(node_t n, CborTag t, uint64_t k, size_t &ndx) const {
+    if (nodes_[n].t_ != MAP) {
+      return kNone;
+    }
+    uint64_t h = hash_int(t, k);
+    node_t c = children(n);
+    for (size_t i = 0; i < nodes_[n].u_.items.n; ++i) {
+      const Node &key = nodes_[c + 2 * i];
+      if (key.key_hash_ == h && key.t_ == t && key.u_.u64 == k) {
+        ndx = i;
+        return c + static_cast<node_t>(2 * i);
+      }
+    }
+    return kNone;
+  }
+
+  // Reads the initial byte and count of the item at POS, which has
+  // already been validated by skip().
+  void read_count(size_t &pos, size_t &type, size_t &count) const {
+    uint8_t b = in_[pos++];
+    type = (b >> 5) & 0x7u;
+    size_t count0 = b & 0x1Fu;
+    count = 0;
+    if (count0 < 24) {
+      count = count0;
+    } else {
+      size_t nb = size_t(1) << (count0 - 24);
+      for (size_t i = 0; i < nb; ++i) {
+        count = count * 256 + in_[pos++];
+      }
+    }
+  }
+
+  // Validates the item at POS with the same rules as CborDoc::decode(),
+  // and advances POS past it, without creating nodes.
+  bool skip(size_t &pos, size_t end, size_t depth) const {
+    // bound the recursion on adversarial inputs
+    if (depth > kMaxDepth || pos >= end) {
+      return false;
+    }
+    uint8_t b = in_[pos++];
+    size_t type = (b >> 5) & 0x7u;
+    size_t count0 = b & 0x1Fu;
+
+    size_t count = 0;
+    if (count0 < 24) {
+      count = count0;
+    } else if (count0 == 24) {
+      if (pos >= end) {
+        return false;
+      }
+      count = in_[pos++];
+    } else if (count0 == 25) {
+      if (pos + 1 >= end) {
+        return false;
+      }
+      count = in_[pos] * 256 + in_[pos + 1];
+      pos += 2;
+    } else if (count0 == 26) {
+      if (pos + 3 >= end) {
+        return false;
+      }
+      for (size_t i = 0; i < 4; ++i) {
+        count *= 256;
+        count += in_[pos++];
+      }
+    } else {
+      return false;
+    }
+
+    switch (type) {
+      case 0:
+      case 1:
+        return true;
+      case 2:
+      case 3:
+        if (pos + count > end) {
+          return false;
+        }
+        pos += count;
+        return true;
+      case 4:
+      case 5: {
+        size_t nchildren = (type == 4) ? count : 2 * count;
+        if (pos + nchildren > end) {
+          return false;
+        }
+        for (size_t i = 0; i < nchildren; ++i) {
+          if (!skip(pos, end, depth + 1)) {
+            return false;
+          }
+        }
+        return true;
+      }
+      case 6:
+        if (count == 1004) {
+          if (pos + 1 + 10 > end) {
+            return false;
+          }
+        }
+        return skip(pos, end, depth + 1);
+      default: /* 7 */
+        return count >= 20 && count <= 22;
+    }
+  }
+
+  // Fills N from the validated item at POS and advances POS past
+  // the header, leaving the children of containers undecoded.
+  void decode_header(Node &n, size_t &pos) const {
+    n.header_pos_ = pos;
+    n.key_hash_ = 0;
+    size_t type, count;
+    read_count(pos, type, count);
+    switch (type) {
+      case 0:
+        n.t_ = UNSIGNED;
+        n.u_.u64 = count;
+        break;
+      case 1:
+        n.t_ = NEGATIVE;
+        n.u_.i64 = -(int64_t)count;
+        break;
+      case 2:
+      case 3:
+        n.t_ = (type == 2) ? BYTES : TEXT;
+        n.u_.string.pos = pos;
+        n.u_.string.len = count;
+        pos += count;
+        break;
+      case 4:
+      case 5:
+      case 6:
+        n.t_ = (type == 4) ? ARRAY : (type == 5) ? MAP : TAG;
+        n.u_.items.n = count;
+        n.u_.items.nchildren =
+            (type == 4) ? count : (type == 5) ? 2 * count : 1;
+        n.u_.items.body = pos;
+        n.u_.items.first = kNone;
+        break;
+      default:
+        n.t_ = PRIMITIVE;
+        n.u_.p = (count == 20) ? CFALSE : (count == 21) ? CTRUE : CNULL;
+        break;
+    }
+  }
+
+  // Arena index of the first child of container N, decoding the
+  // children on first use.
+  node_t children(node_t n) const {
+    if (nodes_[n].u_.items.first == kNone) {
+      size_t nchildren = nodes_[n].u_.items.nchildren;
+      bool is_map = nodes_[n].t_ == MAP;
+      size_t pos = nodes_[n].u_.items.body;
+      node_t first = static_cast<node_t>(nodes_.size());
+      nodes_.resize(nodes_.size() + nchildren);
+      for (size_t i = 0; i < nchildren; ++i) {
+        Node &c = nodes_[first + i];
+        decode_header(c, pos);
+        if (c.t_ == ARRAY || c.t_ == MAP || c.t_ == TAG) {
+          size_t p = c.header_pos_;
+          (void)skip(p, len_, 0); /* already validated */
+          pos = p;
+        }
+        if (is_map && i % 2 == 0) {
+          c.key_hash_ = (c.t_ == TEXT)
+                            ? hash(TEXT, &in_[c.u_.string.pos], c.u_.string.len)
+                            : hash_int(c.t_, c.u_.u64);
+        }
+      }
+      nodes_[n].u_.items.first = first;
+    }
+    return nodes_[n].u_.items.first;
+  }
+
+  static constexpr size_t kMaxDepth = 64;
+
+  // Enough for a DeviceResponse with a few attributes, so that
+  // the arena is usually allocated once.
+  static constexpr size_t kInitialNodes = 256;
+
+  const uint8_t *in_;
+  size_t len_;
+
+  // Expanding a node does not change the tree, only how much of it
+  // is materialized, hence the lookup methods are const.
+  mutable std::vector<Node> nodes_;
+};
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_CBOR_FLAT_DECODER_H_
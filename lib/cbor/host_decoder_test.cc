@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "cbor/flat_decoder.h"
 #include "gtest/gtest.h"
 
 namespace proofs {
@@ -437,6 +438,16 @@ TEST(HostDecoderTest, DecodeHost) {
     bool got = root.decode(&test.bytes[0], test.bytes.size(), pos, 0);
     EXPECT_EQ(test.valid, got);
     EXPECT_LE(pos, test.bytes.size());
+
+    FlatCborDoc flat(&test.bytes[0], test.bytes.size());
+    size_t fpos = 0;
+    FlatCborDoc::node_t froot = flat.decode(fpos, test.bytes.size());
+    EXPECT_EQ(test.valid, froot != FlatCborDoc::kNone);
+    if (got) {
+      EXPECT_EQ(pos, fpos);
+      EXPECT_EQ(root.t_, flat[froot].t_);
+      EXPECT_EQ(root.header_pos_, flat[froot].header_pos_);
+    }
   }
 }
 
@@ -537,5 +548,100 @@ TEST(HostDecoderTest, Lookup) {
   EXPECT_EQ(ptr, nullptr);
 }
 
+TEST(HostDecoderTest, FlatLookup) {
+  std::vector<uint8_t> mso = {
+      0xA6, 0x67, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6F, 0x6E, 0x63, 0x31, 0x2E,
+      0x30, 0x6F, 0x64, 0x69, 0x67, 0x65, 0x73, 0x74, 0x41, 0x6C, 0x67, 0x6F,
+      0x72, 0x69, 0x74, 0x68, 0x6D, 0x67, 0x53, 0x48, 0x41, 0x2D, 0x32, 0x35,
+      0x36, 0x67, 0x64, 0x6F, 0x63, 0x54, 0x79, 0x70, 0x65, 0x75, 0x6F, 0x72,
+      0x67, 0x2E, 0x69, 0x73, 0x6F, 0x2E, 0x31, 0x38, 0x30, 0x31, 0x33, 0x2E,
+      0x35, 0x2E, 0x31, 0x2E, 0x6D, 0x44, 0x4C, 0x6C, 0x76, 0x61, 0x6C, 0x75,
+      0x65, 0x44, 0x69, 0x67, 0x65, 0x73, 0x74, 0x73, 0xA1, 0x71, 0x6F, 0x72,
+      0x67, 0x2E, 0x69, 0x73, 0x6F, 0x2E, 0x31, 0x38, 0x30, 0x31, 0x33, 0x2E,
+      0x35, 0x2E, 0x31, 0xA5, 0x01, 0x58, 0x20, 0xAD, 0xF6, 0xA3, 0x33, 0x03,
+      0x6A, 0xDE, 0xFC, 0x48, 0x90, 0xDF, 0x38, 0xE0, 0xF7, 0x37, 0x22, 0x90,
+      0x85, 0xA9, 0xB0, 0xBA, 0x7C, 0x07, 0x19, 0xD3, 0x92, 0x40, 0x5D, 0x74,
+      0x46, 0x23, 0x77, 0x02, 0x58, 0x20, 0xA0, 0xA1, 0x4A, 0x5A, 0xA1, 0xB3,
+      0x36, 0x84, 0x4D, 0x8F, 0x8D, 0x14, 0x8E, 0xD4, 0x4F, 0xD2, 0xCC, 0xC6,
+      0x6F, 0x54, 0xD8, 0x78, 0x2B, 0x70, 0xFB, 0x77, 0x13, 0xFB, 0x3C, 0x93,
+      0xF5, 0x56, 0x03, 0x58, 0x20, 0x97, 0xB0, 0x18, 0x4E, 0xDD, 0xE3, 0x99,
+      0xCB, 0x7D, 0xEA, 0x2D, 0x7D, 0x27, 0x9A, 0x45, 0x69, 0x90, 0xD9, 0xF3,
+      0x12, 0x46, 0x71, 0x63, 0x78, 0x7E, 0x1B, 0xA7, 0x66, 0x0A, 0x5C, 0x08,
+      0x6F, 0x04, 0x58, 0x20, 0xAF, 0x0B, 0x9F, 0xE7, 0x24, 0x5C, 0xA9, 0xA5,
+      0x9F, 0x64, 0xB1, 0xAA, 0x82, 0xCC, 0x2C, 0x1A, 0xB1, 0x38, 0x6F, 0x77,
+      0x95, 0x64, 0x93, 0x83, 0x62, 0x97, 0xC8, 0xA8, 0x4D, 0x2A, 0xE0, 0xB4,
+      0x00, 0x58, 0x20, 0x0D, 0x98, 0x54, 0xDB, 0x51, 0x48, 0x6F, 0xF4, 0x49,
+      0x07, 0xBC, 0x61, 0x4F, 0xFA, 0xEA, 0x93, 0xDA, 0xE1, 0xA8, 0x9E, 0xAD,
+      0x40, 0x26, 0x3F, 0x90, 0x1A, 0xE6, 0xCE, 0x41, 0x26, 0x46, 0x21, 0x6D,
+      0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x4B, 0x65, 0x79, 0x49, 0x6E, 0x66,
+      0x6F, 0xA1, 0x69, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x4B, 0x65, 0x79,
+      0xA4, 0x01, 0x02, 0x20, 0x01, 0x21, 0x58, 0x20, 0xC3, 0x14, 0xA7, 0xAB,
+      0xBA, 0x07, 0xE4, 0x0E, 0x64, 0xAE, 0x87, 0xDB, 0x4A, 0xD9, 0x71, 0x80,
+      0x13, 0xFD, 0x39, 0x8E, 0x6E, 0x23, 0x17, 0xB3, 0x04, 0xF5, 0x7F, 0xC9,
+      0xAC, 0xCA, 0xB9, 0xF5, 0x22, 0x58, 0x20, 0xED, 0xB8, 0xB0, 0x23, 0x0C,
+      0xCC, 0x98, 0xDD, 0x42, 0xCD, 0xFF, 0x89, 0xA8, 0xD1, 0xE2, 0x5F, 0xF8,
+      0xD1, 0xA7, 0xFA, 0x38, 0x9E, 0x92, 0xDC, 0x8F, 0x01, 0xAF, 0x98, 0x5A,
+      0x79, 0xEF, 0xCC, 0x6C, 0x76, 0x61, 0x6C, 0x69, 0x64, 0x69, 0x74, 0x79,
+      0x49, 0x6E, 0x66, 0x6F, 0xA3, 0x66, 0x73, 0x69, 0x67, 0x6E, 0x65, 0x64,
+      0xC0, 0x74, 0x32, 0x30, 0x32, 0x34, 0x2D, 0x30, 0x31, 0x2D, 0x32, 0x35,
+      0x54, 0x32, 0x31, 0x3A, 0x31, 0x32, 0x3A, 0x35, 0x39, 0x5A, 0x69, 0x76,
+      0x61, 0x6C, 0x69, 0x64, 0x46, 0x72, 0x6F, 0x6D, 0xC0, 0x74, 0x32, 0x30,
+      0x32, 0x34, 0x2D, 0x30, 0x31, 0x2D, 0x32, 0x35, 0x54, 0x32, 0x31, 0x3A,
+      0x31, 0x32, 0x3A, 0x35, 0x39, 0x5A, 0x6A, 0x76, 0x61, 0x6C, 0x69, 0x64,
+      0x55, 0x6E, 0x74, 0x69, 0x6C, 0xC0, 0x74, 0x32, 0x30, 0x32, 0x34, 0x2D,
+      0x30, 0x32, 0x2D, 0x32, 0x34, 0x54, 0x32, 0x31, 0x3A, 0x31, 0x32, 0x3A,
+      0x35, 0x39, 0x5a};
+
+  CborDoc croot;
+  size_t cpos = 0;
+  ASSERT_TRUE(croot.decode(&mso[0], mso.size(), cpos, 0));
+
+  FlatCborDoc doc(&mso[0], mso.size());
+  size_t pos = 0;
+  FlatCborDoc::node_t root = doc.decode(pos, mso.size());
+  ASSERT_NE(root, FlatCborDoc::kNone);
+  EXPECT_EQ(cpos, pos);
+
+  size_t ndx, cndx;
+  const uint8_t dki[13] = {'d', 'e', 'v', 'i', 'c', 'e', 'K',
+                           'e', 'y', 'I', 'n', 'f', 'o'};
+  FlatCborDoc::node_t f_dki = doc.lookup(root, sizeof(dki), dki, ndx);
+  const CborDoc *c_dki = croot.lookup(mso.data(), sizeof(dki), dki, cndx);
+  ASSERT_NE(f_dki, FlatCborDoc::kNone);
+  EXPECT_EQ(cndx, ndx);
+  EXPECT_EQ(c_dki[0].position(), doc.position(f_dki));
+  EXPECT_EQ(c_dki[1].header_pos_, doc[f_dki + 1].header_pos_);
+
+  const uint8_t dk[9] = {'d', 'e', 'v', 'i', 'c', 'e', 'K', 'e', 'y'};
+  FlatCborDoc::node_t f_dk = doc.lookup(f_dki + 1, sizeof(dk), dk, ndx);
+  const CborDoc *c_dk = c_dki[1].lookup(mso.data(), sizeof(dk), dk, cndx);
+  ASSERT_NE(f_dk, FlatCborDoc::kNone);
+  EXPECT_EQ(cndx, ndx);
+
+  FlatCborDoc::node_t f_pkx = doc.lookup_negative(f_dk + 1, -1, ndx);
+  const CborDoc *c_pkx = c_dk[1].lookup_negative(-1, cndx);
+  ASSERT_NE(f_pkx, FlatCborDoc::kNone);
+  EXPECT_EQ(2u, ndx);
+  EXPECT_EQ(c_pkx[1].u_.string.pos, doc[f_pkx + 1].u_.string.pos);
+  EXPECT_EQ(c_pkx[1].u_.string.len, doc[f_pkx + 1].u_.string.len);
+
+  EXPECT_NE(doc.lookup_unsigned(f_dk + 1, 1, ndx), FlatCborDoc::kNone);
+  EXPECT_EQ(0u, ndx);
+
+  // Lookups that should fail
+  const uint8_t version[7] = {'v', 'e', 'r', 's', 'i', 'a', 'n'};
+  EXPECT_EQ(doc.lookup(root, sizeof(version), version, ndx),
+            FlatCborDoc::kNone);
+  EXPECT_EQ(doc.lookup(f_dki + 1, sizeof(dki), dki, ndx), FlatCborDoc::kNone);
+  EXPECT_EQ(doc.lookup_negative(f_dk + 1, -4, ndx), FlatCborDoc::kNone);
+  EXPECT_EQ(doc.lookup_unsigned(f_dk + 1, 6, ndx), FlatCborDoc::kNone);
+  EXPECT_EQ(doc.index(root, 0), FlatCborDoc::kNone);
+
+  // Truncated input fails upfront, at any nesting level.
+  FlatCborDoc short_doc(&mso[0], mso.size() - 1);
+  pos = 0;
+  EXPECT_EQ(short_doc.decode(pos, mso.size() - 1), FlatCborDoc::kNone);
+}
+
 }  // namespace
 }  // namespace proofs
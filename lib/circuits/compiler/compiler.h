@@ -126,17 +126,18 @@ class QuadCircuit {
 
     if (n0.zero()) {
       return op0;
-    } else if (n0.constant()) {
+    } else if (n0.constant(terms_)) {
       // k * (k1 * op1) -> (k * k1) * op1
-      return mul(f_.mulf(k, kload(n0.terms[0].ki)), op1);
-    } else if (n0.linearp()) {
+      return mul(f_.mulf(k, kload(n0.terms(terms_)[0].ki)), op1);
+    } else if (n0.linearp(terms_)) {
       // k * ((k1 * op0) * op1) -> (k * k1) * op0 * op1
-      return mul(f_.mulf(k, kload(n0.terms[0].ki)), n0.terms[0].op1, op1);
-    } else if (n1.zero() || n1.constant() || n1.linearp()) {
+      const term t0 = n0.terms(terms_)[0];
+      return mul(f_.mulf(k, kload(t0.ki)), t0.op1, op1);
+    } else if (n1.zero() || n1.constant(terms_) || n1.linearp(terms_)) {
       return mul(k, op1, op0);
     } else {
       // general term k * op0 * op1
-      return push_node(node(kstore(k), op0, op1));
+      return push_node(single_term_node(kstore(k), op0, op1));
     }
   }
 
@@ -168,7 +169,9 @@ class QuadCircuit {
   }
   size_t sub(size_t op0, size_t op1) { return add(op0, mul(f_.mone(), op1)); }
 
-  size_t konst(const Elt& k) { return push_node(node(kstore(k), 0, 0)); }
+  size_t konst(const Elt& k) {
+    return push_node(single_term_node(kstore(k), 0, 0));
+  }
 
   // Generate a special node that asserts that op == 0.
   // The node has the form 0*(1*op), which does not normally
@@ -180,21 +183,21 @@ class QuadCircuit {
       // More importantly, we cannot multiply OP by 1,
       // since OP doesn't really exist.
       return op;
-    } else if (n->linearp()) {
+    } else if (n->linearp(terms_)) {
       // n = k * (1 * op1).
       //
       // Reduce to assert0(op1), but handle the screw case k==0,
       // which shouldn't happen but just in case...
-      if (n->terms[0].ki == 0) {
+      if (n->terms(terms_)[0].ki == 0) {
         return op;
       } else {
-        return assert0(n->terms[0].op1);
+        return assert0(n->terms(terms_)[0].op1);
       }
     } else {
       typename term::assert0_type_hack hack;
-      std::vector<term> terms;
-      terms.push_back(term(op, hack));
-      size_t n1 = push_node(node(terms));
+      size_t toff = terms_.size();
+      terms_.push_back(term(op, hack));
+      size_t n1 = push_node(node(toff, 1));
       nodes_[n1].info.is_assert0 = true;
       return n1;
     }
@@ -242,6 +245,18 @@ class QuadCircuit {
 
   size_t ninput() const { return ninput_; }
 
+  // Ask mkcircuit() to renumber the internal wires of each layer for
+  // memory locality of the prover.  This does not affect the inputs
+  // or outputs, but it changes the circuit id, and the renumbered
+  // circuit compresses much worse than the canonical one.
+  void optimize_wire_locality() { wire_locality_ = true; }
+
+  // Ask mkcircuit() to compute nodes later than their earliest
+  // possible depth when this reduces the number of copy wires, see
+  // retime().  Like optimize_wire_locality(), this changes the
+  // circuit id.
+  void optimize_copy_wires() { retime_ = true; }
+
   void output_wire(size_t n, size_t wire_id) {
     output_internal(n, quad_corner_t(wire_id));
   }
@@ -250,10 +265,13 @@ class QuadCircuit {
     size_t depth_ub = compute_depth_ub();
     fixup_last_layer_assertions(depth_ub);
     compute_needed(depth_ub);
+    if (retime_) {
+      retime(depth_ub);
+    }
 
-    Scheduler<Field> sched(nodes_, f_);
+    Scheduler<Field> sched(nodes_, terms_, f_);
     std::unique_ptr<Circuit<Field>> c =
-        sched.mkcircuit(constants_, depth_ub, nc);
+        sched.mkcircuit(constants_, depth_ub, nc, wire_locality_);
 
     // re-export the scheduler telemetry
     nwires_ = sched.nwires_;
@@ -275,24 +293,33 @@ class QuadCircuit {
     noutput_++;
   }
 
+  // N is either an input node, or a node whose terms have just been
+  // appended to the end of TERMS_.
   size_t push_node(node n) {
     // common-subexpression elimination: if we have already seen a
     // node equal to n, return that node.
-    uint64_t d = n.hash();
+    uint64_t d = n.hash(terms_);
 
-    auto pred = [&](PdqHash::value_t op) { return n == nodes_[op]; };
+    auto pred = [&](PdqHash::value_t op) {
+      return n.equal(nodes_[op], terms_);
+    };
     if (size_t op = cse_.find(d, pred); op != PdqHash::kNil) {
       // do not linear terms as eliminated by the CSE, since they are
       // likely placeholder nodes absorbed by the next layer.
-      if (!n.linearp()) {
+      if (!n.linearp(terms_)) {
         ++nwires_cse_eliminated_;
       }
+      // release the terms of N, which are at the end of the pool
+      if (n.nterms > 0) {
+        terms_.resize(n.toff);
+      }
       return op;
     }
 
     // compute the node depth, which has been so far uninitialized
     n.info.depth = 0;
-    for (const auto& t : n.terms) {
+    for (size_t i = 0; i < n.nterms; ++i) {
+      const term& t = terms_[n.toff + i];
       n.info.depth = std::max<size_t>(
           n.info.depth, 1 + std::max<size_t>(nodes_[t.op0].info.depth,
                                              nodes_[t.op1].info.depth));
@@ -307,59 +334,91 @@ class QuadCircuit {
     return nid;
   }
 
-  node materialize_input(size_t op) {
-    if (nodes_[op].info.is_input) {
-      return node(/*kstore(f.one())=*/1, 0, op);
-    } else {
-      return /*a copy of*/ nodes_[op];
+  // Append the term k*op0*op1 to the pool, unless k == 0, and
+  // return the corresponding node.
+  node single_term_node(size_t ki, size_t op0, size_t op1) {
+    size_t toff = terms_.size();
+    if (ki != 0) {
+      terms_.push_back(term(ki, op0, op1));
     }
+    return node(toff, terms_.size() - toff);
   }
 
+  // The terms of node OP, where an input node is viewed as the
+  // single term 1 * (1 * op).  Terms are returned by value and
+  // addressed by index, because the pool may be reallocated
+  // while they are being read.
+  class termseq {
+   public:
+    termseq(const QuadCircuit& Q, size_t op)
+        : q_(Q),
+          input_(Q.nodes_[op].info.is_input),
+          toff_(Q.nodes_[op].toff),
+          n_(input_ ? 1 : Q.nodes_[op].nterms),
+          t_(input_ ? term(/*kstore(f.one())=*/1, 0, op) : term()) {}
+
+    size_t size() const { return n_; }
+    term operator[](size_t i) const {
+      return input_ ? t_ : q_.terms_[toff_ + i];
+    }
+
+   private:
+    const QuadCircuit& q_;
+    bool input_;
+    size_t toff_;
+    size_t n_;
+    term t_;
+  };
+
   node scale(const Elt& k, size_t op) {
-    node n = materialize_input(op);
-    for (auto& t : n.terms) {
+    termseq t0(*this, op);
+    size_t toff = terms_.size();
+    for (size_t i = 0; i < t0.size(); ++i) {
+      term t = t0[i];
       t.ki = kstore(f_.mulf(kload(t.ki), k));
+      terms_.push_back(t);
     }
-    return n;
+    return node(toff, t0.size());
   }
 
-  void push_back_unless_zero(std::vector<term>& terms, const term& t) const {
+  void push_back_unless_zero(const term& t) {
     if (t.ki != 0) {
-      terms.push_back(t);
+      terms_.push_back(t);
     }
   }
 
   node merge(size_t op0, size_t op1) {
-    const node n0 = materialize_input(op0);
-    const node n1 = materialize_input(op1);
-    const std::vector<term>& t0 = n0.terms;
-    const std::vector<term>& t1 = n1.terms;
-    std::vector<term> terms;
+    termseq t0(*this, op0);
+    termseq t1(*this, op1);
+    size_t toff = terms_.size();
     size_t i0 = 0, i1 = 0;
     while (i0 < t0.size() && i1 < t1.size()) {
       term t;
-      if (t0[i0].eqndx(t1[i1])) {
-        t = t0[i0];
-        t.ki = kstore(f_.addf(kload(t.ki), kload(t1[i1].ki)));
+      term a = t0[i0], b = t1[i1];
+      if (a.eqndx(b)) {
+        t = a;
+        t.ki = kstore(f_.addf(kload(a.ki), kload(b.ki)));
         i0++;
         i1++;
-      } else if (t0[i0].ltndx(t1[i1])) {
-        t = t0[i0++];
+      } else if (a.ltndx(b)) {
+        t = a;
+        i0++;
       } else {
-        t = t1[i1++];
+        t = b;
+        i1++;
       }
-      push_back_unless_zero(terms, t);
+      push_back_unless_zero(t);
     }
 
     while (i0 < t0.size()) {
-      push_back_unless_zero(terms, t0[i0++]);
+      push_back_unless_zero(t0[i0++]);
     }
 
     while (i1 < t1.size()) {
-      push_back_unless_zero(terms, t1[i1++]);
+      push_back_unless_zero(t1[i1++]);
     }
 
-    return node(terms);
+    return node(toff, terms_.size() - toff);
   }
 
   // constants_[n] stores the n-th constant, once.
@@ -371,6 +430,12 @@ class QuadCircuit {
   std::vector<node> nodes_;
   PdqHash cse_;
 
+  // Append-only pool of the terms of all nodes.
+  std::vector<term> terms_;
+
+  bool wire_locality_ = false;  // see optimize_wire_locality()
+  bool retime_ = false;         // see optimize_copy_wires()
+
   size_t kstore(const Elt& k) {
     uint64_t d = elt_hash(k, f_);
     auto pred = [&](PdqHash::value_t ki) { return k == constants_[ki]; };
@@ -413,7 +478,7 @@ class QuadCircuit {
         // layer, it will be transformed in an output of OP at
         // n.info.depth.  If the assertion is not in the last layer,
         // then it doesn't matter whether we use DEPTH or 1 + DEPTH.
-        if (n.linearp()) {
+        if (n.linearp(terms_)) {
           r = std::max<size_t>(r, n.info.depth);
         } else {
           r = std::max<size_t>(r, 1 + n.info.depth);
@@ -428,9 +493,9 @@ class QuadCircuit {
     // convert assertions in the last layer into outputs
     for (auto& n : nodes_) {
       if (!n.info.is_output && n.info.is_assert0 && n.info.depth == depth_ub &&
-          n.linearp()) {
+          n.linearp(terms_)) {
         n.info.is_assert0 = false;
-        output_internal(n.terms[0].op1, nodeinfo::kWireIdUndefined);
+        output_internal(n.terms(terms_)[0].op1, nodeinfo::kWireIdUndefined);
       }
     }
   }
@@ -455,7 +520,9 @@ class QuadCircuit {
       }
 
       if (nfo->is_needed) {
-        for (const auto& t : nodes_[i].terms) {
+        const node& n = nodes_[i];
+        for (size_t j = 0; j < n.nterms; ++j) {
+          const term& t = terms_[n.toff + j];
           mark_needed(t.op0, nfo->depth);
           mark_needed(t.op1, nfo->depth);
         }
@@ -464,6 +531,115 @@ class QuadCircuit {
       }
     }
   }
+
+  // Retiming.  The depth of a node as computed by push_node() is the
+  // earliest depth at which the node can be computed, and the
+  // scheduler inserts a copy wire at every depth between the node
+  // and its last consumer.  Computing a node N later saves one copy
+  // wire (and one quad term) per layer, but each operand of N must
+  // then be available later, which costs one copy wire per layer per
+  // operand that is not already needed that late.  Operands that are
+  // needed late anyway, such as the constant one, are free.
+  //
+  // This pass recomputes the MAX_NEEDED_DEPTH computed by
+  // compute_needed(), visiting nodes by decreasing depth, so that the
+  // final depth of all consumers of a node is known when the node
+  // is visited.  Each node is moved to the depth, between its
+  // earliest depth and its first consumer, that saves the most copy
+  // wires.  The cost of moving a node is estimated assuming that the
+  // other nodes at the same depth stay put, so that the decision
+  // does not depend on the order in which nodes were created, and
+  // the result is canonical.
+  void retime(size_t depth_ub) {
+    // Needed non-input nodes, bucketed by depth.
+    std::vector<std::vector<size_t>> level(depth_ub);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      nodeinfo& nfo = nodes_[i].info;
+      if (nfo.is_needed && !nfo.is_input && !nodes_[i].zero()) {
+        level.at(nfo.depth).push_back(i);
+      }
+      nfo.max_needed_depth = 0;
+    }
+
+    // MIN_NEEDED[OP]: least depth at which OP is needed.
+    std::vector<size_t> min_needed(nodes_.size(), depth_ub);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      const nodeinfo& nfo = nodes_[i].info;
+      if (nfo.is_input) {
+        mark_needed(i, 1);
+      }
+      if (nfo.is_output) {
+        mark_needed(i, depth_ub);
+      }
+      if (nfo.is_assert0) {
+        mark_needed(i, nfo.depth + 1);
+        min_needed[i] = nfo.depth + 1;
+      }
+    }
+
+    std::vector<size_t> ops;
+    for (size_t d = depth_ub; d-- > 1;) {
+      const std::vector<size_t>& lv = level[d];
+
+      // The operands of all nodes at depth D are needed at least at D.
+      for (size_t op : lv) {
+        const node& n = nodes_[op];
+        for (size_t j = 0; j < n.nterms; ++j) {
+          const term& t = terms_[n.toff + j];
+          mark_needed(t.op0, d);
+          mark_needed(t.op1, d);
+        }
+      }
+
+      std::vector<size_t> newd(lv.size(), d);
+      for (size_t k = 0; k < lv.size(); ++k) {
+        const node& n = nodes_[lv[k]];
+        size_t latest = min_needed[lv[k]] - 1;
+        if (n.info.is_assert0 || latest <= d) {
+          continue;
+        }
+
+        ops.clear();
+        for (size_t j = 0; j < n.nterms; ++j) {
+          const term& t = terms_[n.toff + j];
+          ops.push_back(t.op0);
+          ops.push_back(t.op1);
+        }
+        std::sort(ops.begin(), ops.end());
+        ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+
+        // GAIN is the number of copy wires saved by computing N at
+        // depth DD instead of D.
+        size_t best = d;
+        ptrdiff_t gain = 0, best_gain = 0;
+        for (size_t dd = d + 1; dd <= latest; ++dd) {
+          ++gain;
+          for (size_t op : ops) {
+            if (nodes_[op].info.max_needed_depth < dd) {
+              --gain;
+            }
+          }
+          if (gain > best_gain) {
+            best_gain = gain;
+            best = dd;
+          }
+        }
+        newd[k] = best;
+      }
+
+      for (size_t k = 0; k < lv.size(); ++k) {
+        node& n = nodes_[lv[k]];
+        n.info.depth = newd[k];
+        for (size_t j = 0; j < n.nterms; ++j) {
+          const term& t = terms_[n.toff + j];
+          for (size_t op : {size_t(t.op0), size_t(t.op1)}) {
+            mark_needed(op, newd[k]);
+            min_needed[op] = std::min(min_needed[op], newd[k]);
+          }
+        }
+      }
+    }
+  }
 };
 
 }  // namespace proofs
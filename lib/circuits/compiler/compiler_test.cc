@@ -17,11 +17,14 @@
 #include <stddef.h>
 
 #include <memory>
+#include <random>
+#include <vector>
 
 #include "algebra/fp.h"
 #include "arrays/dense.h"
 #include "circuits/compiler/circuit_dump.h"
 #include "sumcheck/circuit.h"
+#include "sumcheck/prover.h"
 #include "sumcheck/testing.h"
 #include "gtest/gtest.h"
 
@@ -106,5 +109,122 @@ TEST(Compiler, Output0) {
   EXPECT_EQ(Q.nquad_terms_, 0u);
 }
 
+// A random layered circuit with many internal wires.
+std::unique_ptr<Circuit<Field>> random_circuit(bool wire_locality) {
+  std::mt19937 rng(1);
+  QuadCircuit<Field> Q(F);
+  constexpr size_t kW = 64, kDepth = 6;
+  std::vector<size_t> w(kW);
+  for (size_t i = 0; i < kW; ++i) {
+    w[i] = Q.input_wire();
+  }
+  for (size_t d = 0; d < kDepth; ++d) {
+    std::vector<size_t> nw(kW);
+    for (size_t i = 0; i < kW; ++i) {
+      size_t a = w[rng() % kW], b = w[rng() % kW], c = w[rng() % kW];
+      nw[i] = Q.add(Q.mul(a, b), Q.mul(F.of_scalar(rng() % 7 + 2), c));
+    }
+    w = nw;
+  }
+  for (size_t i = 0; i < kW; ++i) {
+    Q.output_wire(w[i], i);
+  }
+  if (wire_locality) {
+    Q.optimize_wire_locality();
+  }
+  return Q.mkcircuit(/*nc=*/1);
+}
+
+TEST(Compiler, WireLocality) {
+  auto C0 = random_circuit(false);
+  auto C1 = random_circuit(true);
+  ASSERT_EQ(C0->nl, C1->nl);
+  EXPECT_EQ(C0->nterms(), C1->nterms());
+
+  // Same outputs on the same inputs.
+  Dense<Field> W(1, C0->ninputs);
+  W.v_[0] = F.one();
+  for (size_t i = 1; i < C0->ninputs; ++i) {
+    W.v_[i] = F.of_scalar(3 * i + 1);
+  }
+  Prover<Field> prover(F);
+  typename Prover<Field>::inputs in0, in1;
+  auto V0 = prover.eval_circuit(&in0, C0.get(), W.clone(), F);
+  auto V1 = prover.eval_circuit(&in1, C1.get(), W.clone(), F);
+  ASSERT_NE(V0, nullptr);
+  ASSERT_NE(V1, nullptr);
+  for (size_t i = 0; i < C0->nv; ++i) {
+    EXPECT_EQ(V0->v_[i], V1->v_[i]);
+  }
+
+  // In every layer but the output one, each new g is one more than
+  // the largest g seen so far.
+  for (size_t l = 1; l < C1->nl; ++l) {
+    const Quad<Field>& q = *C1->l[l].quad;
+    size_t next = 0;
+    for (size_t i = 0; i < q.n_; ++i) {
+      size_t g = static_cast<size_t>(q.c_[i].g);
+      EXPECT_LE(g, next);
+      if (g == next) {
+        ++next;
+      }
+    }
+  }
+}
+
+// A random circuit whose nodes consume nodes of any earlier depth,
+// so that many values are copied across layers.
+std::unique_ptr<Circuit<Field>> mixed_depth_circuit(bool retime,
+                                                    size_t* overhead) {
+  std::mt19937 rng(2);
+  QuadCircuit<Field> Q(F);
+  constexpr size_t kIn = 16, kNodes = 400, kOut = 16;
+  std::vector<size_t> w;
+  for (size_t i = 0; i < kIn; ++i) {
+    w.push_back(Q.input_wire());
+  }
+  for (size_t i = 0; i < kNodes; ++i) {
+    size_t a = w[rng() % w.size()], b = w[rng() % w.size()];
+    if (rng() % 2) {
+      w.push_back(Q.mul(a, b));
+    } else {
+      w.push_back(Q.add(Q.mul(a, a), b));
+    }
+  }
+  for (size_t i = 0; i < kOut; ++i) {
+    Q.output_wire(w[rng() % w.size()], i);
+  }
+  if (retime) {
+    Q.optimize_copy_wires();
+  }
+  auto c = Q.mkcircuit(/*nc=*/1);
+  *overhead = Q.nwires_overhead_;
+  return c;
+}
+
+TEST(Compiler, Retime) {
+  size_t ovh0, ovh1;
+  auto C0 = mixed_depth_circuit(false, &ovh0);
+  auto C1 = mixed_depth_circuit(true, &ovh1);
+  EXPECT_LT(ovh1, ovh0);
+  EXPECT_LT(C1->nterms(), C0->nterms());
+
+  Dense<Field> W(1, C0->ninputs);
+  W.v_[0] = F.one();
+  for (size_t i = 1; i < C0->ninputs; ++i) {
+    W.v_[i] = F.of_scalar(5 * i + 2);
+  }
+  Prover<Field> prover(F);
+  typename Prover<Field>::inputs in0, in1;
+  auto V0 = prover.eval_circuit(&in0, C0.get(), W.clone(), F);
+  auto V1 = prover.eval_circuit(&in1, C1.get(), W.clone(), F);
+  ASSERT_NE(V0, nullptr);
+  ASSERT_NE(V1, nullptr);
+  ASSERT_EQ(C0->nv, C1->nv);
+  for (size_t i = 0; i < C0->nv; ++i) {
+    EXPECT_EQ(V0->v_[i], V1->v_[i]);
+  }
+}
+
 }  // namespace
 }  // namespace proofs
@@ -111,33 +111,44 @@ struct NodeInfoF {
   }
 };
 
+// The terms of all nodes live in a single append-only pool owned by
+// the compiler, and a node refers to the range [toff, toff + nterms)
+// of the pool.  This avoids one heap allocation per node, which
+// dominated the compiler's time and space for large circuits.
+// Methods that inspect the terms take the pool as an argument.
 template <class Field>
 struct NodeF {
   using nodeinfo = NodeInfoF<Field>;
   using quad_corner_t = typename Quad<Field>::quad_corner_t;
+  using size_t_for_storage = term::size_t_for_storage;
 
-  std::vector<term> terms;
+  size_t toff;  // offset of the first term in the pool
+  size_t_for_storage nterms;
   nodeinfo info;
 
   NodeF() = delete;
-  explicit NodeF(quad_corner_t id) : terms() {
+  explicit NodeF(quad_corner_t id) : toff(0), nterms(0) {
     info.is_input = true;
     info.desired_wire_id_for_input = id;
   }
 
-  explicit NodeF(size_t ki, size_t op0, size_t op1) : terms() {
-    if (ki != 0) {
-      terms.push_back(term(ki, op0, op1));
-    }
+  explicit NodeF(size_t toff, size_t nterms) : toff(toff), nterms(nterms) {
+    check(nterms == size_t_for_storage(nterms), "too many terms in node");
   }
 
-  explicit NodeF(const std::vector<term>& terms) : terms(terms) {}
+  const term* terms(const std::vector<term>& pool) const {
+    return pool.data() + toff;
+  }
 
-  bool zero() const { return !info.is_input && terms.empty(); }
-  bool constant() const { return terms.size() == 1 && terms[0].constant(); }
-  bool linearp() const { return terms.size() == 1 && terms[0].linearp(); }
+  bool zero() const { return !info.is_input && nterms == 0; }
+  bool constant(const std::vector<term>& pool) const {
+    return nterms == 1 && pool[toff].constant();
+  }
+  bool linearp(const std::vector<term>& pool) const {
+    return nterms == 1 && pool[toff].linearp();
+  }
 
-  bool operator==(const NodeF& y) const {
+  bool equal(const NodeF& y, const std::vector<term>& pool) const {
     if (info.is_input != y.info.is_input) return false;
     if (info.desired_wire_id_for_input != y.info.desired_wire_id_for_input)
       return false;
@@ -145,14 +156,14 @@ struct NodeF {
     if (info.desired_wire_id_for_output != y.info.desired_wire_id_for_output)
       return false;
     if (info.is_input != y.info.is_input) return false;
-    if (terms.size() != y.terms.size()) return false;
-    size_t l = terms.size();
+    if (nterms != y.nterms) return false;
+    size_t l = nterms;
     for (size_t i = 0; i < l; ++i) {
-      if (!(terms[i] == y.terms[i])) return false;
+      if (!(pool[toff + i] == pool[y.toff + i])) return false;
     }
     return true;
   }
-  uint64_t hash() const {
+  uint64_t hash(const std::vector<term>& pool) const {
     uint64_t crc = 0x1;
     crc = crc64::update(crc,
                         static_cast<uint64_t>(info.desired_wire_id_for_input));
@@ -160,12 +171,13 @@ struct NodeF {
                         static_cast<uint64_t>(info.desired_wire_id_for_output));
     crc = crc64::update(crc, info.is_input);
     crc = crc64::update(crc, info.is_output);
-    size_t l = terms.size();
+    size_t l = nterms;
     crc = crc64::update(crc, l);
     for (size_t i = 0; i < l; ++i) {
-      crc = crc64::update(crc, terms[i].ki);
-      crc = crc64::update(crc, terms[i].op0);
-      crc = crc64::update(crc, terms[i].op1);
+      const term& t = pool[toff + i];
+      crc = crc64::update(crc, t.ki);
+      crc = crc64::update(crc, t.op0);
+      crc = crc64::update(crc, t.op1);
     }
     return crc;
   }
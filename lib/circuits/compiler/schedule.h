@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "algebra/compare.h"
@@ -41,21 +42,27 @@ class Scheduler {
 
   const Field& f_;
   const std::vector<node>& nodes_;
+  const std::vector<term>& terms_;  // term pool of nodes_
 
  public:
   size_t nwires_;
   size_t nquad_terms_;
   size_t nwires_overhead_;
 
-  Scheduler(const std::vector<node>& nodes, const Field& f)
+  Scheduler(const std::vector<node>& nodes, const std::vector<term>& terms,
+            const Field& f)
       : f_(f),
         nodes_(nodes),
+        terms_(terms),
         nwires_(0),
         nquad_terms_(0),
         nwires_overhead_(0) {}
 
+  // If WIRE_LOCALITY is set, renumber the internal wires for memory
+  // locality of the prover, see order_for_locality().
   std::unique_ptr<Circuit<Field>> mkcircuit(const std::vector<Elt>& constants,
-                                            size_t depth_ub, size_t nc) {
+                                            size_t depth_ub, size_t nc,
+                                            bool wire_locality) {
     std::unique_ptr<Circuit<Field>> c = std::make_unique<Circuit<Field>>();
 
     // number of layers and copies
@@ -63,7 +70,7 @@ class Scheduler {
     c->nc = nc;
     c->logc = lg(nc);
 
-    auto lnodes = order_by_layer(constants, depth_ub);
+    auto layers = order_by_layer(constants, depth_ub);
 
     // TODO [matteof 2025-03-12] ASSIGN_WIRE_IDS() renames LNODES in
     // order to sort it and assign LNODES[].DESIRED_WIRE ID.  Then it
@@ -73,8 +80,8 @@ class Scheduler {
     // for now, this is just a performance optimization of the
     // compiler anyway.
     //
-    assign_wire_ids(lnodes);
-    fill_layers(c.get(), depth_ub, lnodes);
+    assign_wire_ids(layers);
+    fill_layers(c.get(), depth_ub, layers, wire_locality);
 
     return c;
   }
@@ -85,6 +92,10 @@ class Scheduler {
     Elt k;
     quad_corner_t lop0, lop1;
   };
+
+  // As in the compiler, the terms of all lnodes in a layer are
+  // stored contiguously in a per-layer pool, and an lnode refers to
+  // the range [toff, toff + nterms) of the pool.
   struct lnode {
     quad_corner_t desired_wire_id;
 
@@ -99,38 +110,58 @@ class Scheduler {
     // to write, it seems simpler to just handle this case
     // uniformly.
     bool is_copy_wire;
+    size_t_for_storage toff;
+    size_t_for_storage nterms;
 
-    std::vector<lterm> lterms;
-
-    lnode(quad_corner_t desired_wire_id, bool is_copy_wire,
-          const std::vector<lterm>& lterms)
+    lnode(quad_corner_t desired_wire_id, bool is_copy_wire, size_t toff,
+          size_t nterms)
         : desired_wire_id(desired_wire_id),
           is_copy_wire(is_copy_wire),
-          lterms(lterms) {}
+          toff(toff),
+          nterms(nterms) {
+      check(toff + nterms == size_t_for_storage(toff + nterms),
+            "too many terms in layer");
+    }
+  };
+
+  struct layer {
+    std::vector<lnode> lnodes;
+    std::vector<lterm> lterms;
+  };
+
+  // The LOP indices of all replicas of all nodes, stored contiguously
+  // per node.
+  struct lop_table {
+    std::vector<quad_corner_t> lop;
+    std::vector<size_t> off;  // off[op]: index of the first LOP of OP
+    std::vector<size_t_for_storage> n;  // n[op]: number of LOPs of OP
   };
 
-  quad_corner_t lop_of_op_at_depth(
-      const std::vector<std::vector<quad_corner_t>>& lop, size_t op,
-      size_t d) const {
+  quad_corner_t lop_of_op_at_depth(const lop_table& lops, size_t op,
+                                   size_t d) const {
     const node& n = nodes_.at(op);
-    return lop.at(op).at(d - n.info.depth);
+    size_t i = d - n.info.depth;
+    check(i < lops.n.at(op), "lop_of_op_at_depth out of range");
+    return lops.lop[lops.off[op] + i];
   }
 
   // Convert the DAG of nodes into a layered dag of lnodes.
-  std::vector<std::vector<lnode>> order_by_layer(
-      const std::vector<Elt>& constants, size_t depth_ub) {
+  std::vector<layer> order_by_layer(const std::vector<Elt>& constants,
+                                    size_t depth_ub) {
     // The source DAG is indexed by NODES_[OP].
     // The destination dag uses a two-dimensional indexing
     // scheme LNODES[D][LOP], where D is the depth.
 
     // A single value NODES_[OP] may be replicated multiple times in
-    // LNODES.  The mapping is maintained in array LOPS such that
+    // LNODES.  The mapping is maintained in LOPS such that
     // LOPS[OP][D - D0] contains the LOP index of node OP at depth D.
     // D0 is the depth at which NODES_[OP] is first computed, and
     // there is no point in storing LOPS[OP] for D < D0.
 
-    std::vector<std::vector<lnode>> lnodes(depth_ub);
-    std::vector<std::vector<quad_corner_t>> lops(nodes_.size());
+    std::vector<layer> layers(depth_ub);
+    lop_table lops;
+    lops.off.resize(nodes_.size());
+    lops.n.resize(nodes_.size());
 
     nwires_overhead_ = 0;
 
@@ -139,24 +170,29 @@ class Scheduler {
       const nodeinfo& nfo = n.info;
       if (nfo.is_needed && !n.zero()) {
         size_t d = nfo.depth;
+        lops.off[op] = lops.lop.size();
 
         // Allocate the LOP at depth D
-        quad_corner_t lop = quad_corner_t(lnodes.at(d).size());
-        lops.at(op).push_back(lop);
+        layer& ld = layers.at(d);
+        quad_corner_t lop = quad_corner_t(ld.lnodes.size());
+        lops.lop.push_back(lop);
+        lops.n[op]++;
 
         // create a LOPS entry for depth D
         /*scope*/ {
-          std::vector<lterm> lterms;
-          for (const auto& t : n.terms) {
+          size_t toff = ld.lterms.size();
+          const term* terms = n.terms(terms_);
+          for (size_t i = 0; i < n.nterms; ++i) {
+            const term& t = terms[i];
             lterm lt = {
                 .k = constants.at(t.ki),
                 .lop0 = lop_of_op_at_depth(lops, t.op0, d - 1),
                 .lop1 = lop_of_op_at_depth(lops, t.op1, d - 1),
             };
-            lterms.push_back(lt);
+            ld.lterms.push_back(lt);
           }
-          lnodes.at(d).push_back(lnode(nfo.desired_wire_id(d, depth_ub),
-                                       /*is_copy_wire=*/false, lterms));
+          ld.lnodes.push_back(lnode(nfo.desired_wire_id(d, depth_ub),
+                                    /*is_copy_wire=*/false, toff, n.nterms));
         }
 
         // create copy wires
@@ -164,10 +200,10 @@ class Scheduler {
           quad_corner_t lop_dm1 = lop;
 
           // allocate the LOP at depth D
-          lop = quad_corner_t(lnodes.at(d).size());
-          lops.at(op).push_back(lop);
-
-          std::vector<lterm> lterms;
+          layer& lc = layers.at(d);
+          lop = quad_corner_t(lc.lnodes.size());
+          lops.lop.push_back(lop);
+          lops.n[op]++;
 
           // Insert a multiplication by one of the layer
           // at the previous layer.
@@ -176,15 +212,16 @@ class Scheduler {
               .lop0 = quad_corner_t(0),
               .lop1 = lop_dm1,
           };
-          lterms.push_back(lt);
-          lnodes.at(d).push_back(lnode(nfo.desired_wire_id(d, depth_ub),
-                                       /*is_copy_wire=*/true, lterms));
+          size_t toff = lc.lterms.size();
+          lc.lterms.push_back(lt);
+          lc.lnodes.push_back(lnode(nfo.desired_wire_id(d, depth_ub),
+                                    /*is_copy_wire=*/true, toff, 1));
           ++nwires_overhead_;
         }  // for copy wires
       }  // if needed
     }  // for OP
 
-    return lnodes;
+    return layers;
   }
 
   //------------------------------------------------------------
@@ -223,33 +260,40 @@ class Scheduler {
     }
   };
 
+  // The renamed terms of all nodes in a layer are stored in a
+  // per-layer pool RLTERMS, and a renamed_lnode refers to the
+  // range [toff_, toff_ + nterms_) of the pool.
   class renamed_lnode {
    public:
     quad_corner_t desired_wire_id_;
     quad_corner_t original_wire_index_;
     bool is_copy_wire_;
-    std::vector<renamed_lterm> rlterms_;
+    size_t_for_storage toff_;
+    size_t_for_storage nterms_;
 
     renamed_lnode(quad_corner_t desired_wire_id,
                   quad_corner_t original_wire_index, bool is_copy_wire,
-                  const std::vector<renamed_lterm>& rlterms)
+                  size_t toff, size_t nterms)
         : desired_wire_id_(desired_wire_id),
           original_wire_index_(original_wire_index),
           is_copy_wire_(is_copy_wire),
-          rlterms_(rlterms) {}
-
-    bool operator==(const renamed_lnode& y) const {
-      if (is_copy_wire_ != y.is_copy_wire_) return false;
-      if (rlterms_.size() != y.rlterms_.size()) return false;
-      size_t l = rlterms_.size();
+          toff_(toff),
+          nterms_(nterms) {}
+
+    static bool equal(const renamed_lnode& x, const renamed_lnode& y,
+                      const std::vector<renamed_lterm>& rlterms) {
+      if (x.is_copy_wire_ != y.is_copy_wire_) return false;
+      if (x.nterms_ != y.nterms_) return false;
+      size_t l = x.nterms_;
       for (size_t i = 0; i < l; ++i) {
-        if (!(rlterms_[i] == y.rlterms_[i])) return false;
+        if (!(rlterms[x.toff_ + i] == rlterms[y.toff_ + i])) return false;
       }
       return true;
     }
 
     // canonical order
     static bool compare(const renamed_lnode& ra, const renamed_lnode& rb,
+                        const std::vector<renamed_lterm>& rlterms,
                         const Field& F) {
       // Defined before undefined.  This choice is mandated by the
       // fact that the range of defined wire id's starts at 0.
@@ -269,18 +313,17 @@ class Scheduler {
       // [ARBITRARY CHOICE] Lexicographic order on the reverse of the
       // terms array.  This seems to compress much better than
       // the normal lexicographic order.
-      for (size_t ia = ra.rlterms_.size(), ib = rb.rlterms_.size();
-           ia-- > 0 && ib-- > 0;) {
-        const renamed_lterm& rlta = ra.rlterms_[ia];
-        const renamed_lterm& rltb = rb.rlterms_[ib];
+      for (size_t ia = ra.nterms_, ib = rb.nterms_; ia-- > 0 && ib-- > 0;) {
+        const renamed_lterm& rlta = rlterms[ra.toff_ + ia];
+        const renamed_lterm& rltb = rlterms[rb.toff_ + ib];
         if (renamed_lterm::compare(rlta, rltb, F)) return true;
         if (renamed_lterm::compare(rltb, rlta, F)) return false;
       }
 
       // [ARBITRARY CHOICE] If the common suffixes are the same, the
       // shorter terms come first.
-      if (ra.rlterms_.size() < rb.rlterms_.size()) return true;
-      if (ra.rlterms_.size() > rb.rlterms_.size()) return false;
+      if (ra.nterms_ < rb.nterms_) return true;
+      if (ra.nterms_ > rb.nterms_) return false;
 
       // Nodes that were in the original dag come first.
       if (!ra.is_copy_wire_ && rb.is_copy_wire_) return true;
@@ -291,35 +334,49 @@ class Scheduler {
     }
   };
 
-  template <class T>
-  bool uniq(const std::vector<T>& sorted) {
-    for (size_t i = 0; i + 1 < sorted.size(); ++i) {
-      if (sorted[i] == sorted[i + 1]) return false;
+  // Check that no two adjacent elements of the sorted range
+  // [BEGIN, END) are equal.
+  template <class It, class Eq>
+  bool uniq(It begin, It end, const Eq& eq) {
+    for (It i = begin; i != end && i + 1 != end; ++i) {
+      if (eq(*i, *(i + 1))) return false;
     }
     return true;
   }
 
-  void assign_wire_ids(std::vector<std::vector<lnode>>& lnodes) {
+  void assign_wire_ids(std::vector<layer>& layers) {
     // all inputs are expected to be defined already
-    assert_all_desired_wire_id_defined(lnodes.at(0));
+    assert_all_desired_wire_id_defined(layers.at(0).lnodes);
 
-    for (size_t d = 1; d < lnodes.size(); ++d) {
-      const std::vector<lnode>& lnodes_at_dm1 = lnodes.at(d - 1);
-      const std::vector<lnode>& lnodes_at_d = lnodes.at(d);
+    // Scratch space, reused across layers.
+    std::vector<renamed_lterm> rlterms;
+    std::vector<renamed_lnode> renamed_at_d;
+
+    for (size_t d = 1; d < layers.size(); ++d) {
+      const std::vector<lnode>& lnodes_at_dm1 = layers.at(d - 1).lnodes;
+      const layer& layer_at_d = layers.at(d);
+      const std::vector<lnode>& lnodes_at_d = layer_at_d.lnodes;
 
       // Create a renamed clone of LNODES_AT_D, in which all
       // the LOP's are mapped to their desired wire id's
       // at the previous layer.  We use different types
       // to avoid any possibility of confusion.
-      std::vector<renamed_lnode> renamed_at_d;
+      rlterms.clear();
+      rlterms.reserve(layer_at_d.lterms.size());
+      renamed_at_d.clear();
+      renamed_at_d.reserve(lnodes_at_d.size());
+
+      auto eq_rlterm = [](const renamed_lterm& a, const renamed_lterm& b) {
+        return a == b;
+      };
 
       quad_corner_t original_wire_index(0);
       for (const lnode& ln : lnodes_at_d) {
-        std::vector<renamed_lterm> rlterms;
+        size_t toff = rlterms.size();
 
         // rename all terms
-        rlterms.reserve(ln.lterms.size());
-        for (const lterm& lt : ln.lterms) {
+        for (size_t i = 0; i < ln.nterms; ++i) {
+          const lterm& lt = layer_at_d.lterms[ln.toff + i];
           rlterms.push_back(renamed_lterm(
               lt.k,
               lnodes_at_dm1.at(static_cast<size_t>(lt.lop0)).desired_wire_id,
@@ -327,7 +384,8 @@ class Scheduler {
         }
 
         // canonicalize the terms order
-        std::sort(rlterms.begin(), rlterms.end(),
+        auto b = rlterms.begin() + toff;
+        std::sort(b, rlterms.end(),
                   [&](const renamed_lterm& a, const renamed_lterm& b) {
                     return renamed_lterm::compare(a, b, f_);
                   });
@@ -335,10 +393,12 @@ class Scheduler {
         // Terms must be unique, otherwise the canonicalization is
         // ill-defined.  Uniqueness is guaranteed by the algebraic
         // simplifier, but assert it for good measure.
-        check(uniq(rlterms), "rlterms not unique");
+        check(uniq(b, rlterms.end(), eq_rlterm),
+              "rlterms not unique");
 
-        renamed_at_d.push_back(renamed_lnode(
-            ln.desired_wire_id, original_wire_index, ln.is_copy_wire, rlterms));
+        renamed_at_d.push_back(renamed_lnode(ln.desired_wire_id,
+                                             original_wire_index,
+                                             ln.is_copy_wire, toff, ln.nterms));
         ++original_wire_index;
       }
 
@@ -347,15 +407,19 @@ class Scheduler {
 
       std::sort(renamed_at_d.begin(), renamed_at_d.end(),
                 [&](const renamed_lnode& a, const renamed_lnode& b) {
-                  return renamed_lnode::compare(a, b, f_);
+                  return renamed_lnode::compare(a, b, rlterms, f_);
                 });
 
       // Nodes must be unique, otherwise the canonicalization is
       // ill-defined.
-      check(uniq(renamed_at_d), "renamed_at_d not unique");
+      check(uniq(renamed_at_d.begin(), renamed_at_d.end(),
+                 [&](const renamed_lnode& a, const renamed_lnode& b) {
+                   return renamed_lnode::equal(a, b, rlterms);
+                 }),
+            "renamed_at_d not unique");
 
       quad_corner_t wid(0);
-      std::vector<lnode>& wlnodes_at_d = lnodes.at(d);
+      std::vector<lnode>& wlnodes_at_d = layers.at(d).lnodes;
 
       for (const renamed_lnode& ln : renamed_at_d) {
         lnode& lnpi =
@@ -379,10 +443,19 @@ class Scheduler {
   }
 
   void fill_layers(Circuit<Field>* c, size_t depth_ub,
-                   const std::vector<std::vector<lnode>>& lnodes) {
-    check(depth_ub == lnodes.size(), "depth_ub == lnodes.size()");
+                   const std::vector<layer>& layers, bool wire_locality) {
+    check(depth_ub == layers.size(), "depth_ub == layers.size()");
 
-    corner_t nv = corner_t(lnodes.at(depth_ub - 1).size());
+    // QUADS[D] is the quad of the layer at depth D >= 1.
+    std::vector<std::unique_ptr<Quad<Field>>> quads(depth_ub);
+    for (size_t d = 1; d < depth_ub; ++d) {
+      quads[d] = mkquad(layers.at(d), layers.at(d - 1).lnodes);
+    }
+    if (wire_locality) {
+      order_for_locality(quads, layers);
+    }
+
+    corner_t nv = corner_t(layers.at(depth_ub - 1).lnodes.size());
 
     nwires_ = nv;
     c->nv = nv;
@@ -392,30 +465,26 @@ class Scheduler {
     // Sumcheck counts layers starting from the output, hence the loop
     // counts downwards.
     for (size_t d = depth_ub; d-- > 1;) {
-      corner_t nw =
-          corner_t(lnodes.at(d - 1).size());  // inputs[d] == outputs[d-1]
+      corner_t nw = corner_t(
+          layers.at(d - 1).lnodes.size());  // inputs[d] == outputs[d-1]
       nwires_ += nw;
-      c->l.push_back(
-          Layer<Field>{.nw = nw,
-                       .logw = lg(nw),
-                       .quad = mkquad(lnodes.at(d), lnodes.at(d - 1))});
+      c->l.push_back(Layer<Field>{
+          .nw = nw, .logw = lg(nw), .quad = std::move(quads[d])});
     }
   }
 
-  std::unique_ptr<const Quad<Field>> mkquad(
-      const std::vector<lnode>& lnodes0,  // wires at this layer
+  std::unique_ptr<Quad<Field>> mkquad(
+      const layer& layer0,                // wires at this layer
       const std::vector<lnode>& lnodes1   // wires at the previous layer
   ) {
-    size_t nterms0 = 0;
-    for (const auto& ln0 : lnodes0) {
-      nterms0 += ln0.lterms.size();
-    }
+    size_t nterms0 = layer0.lterms.size();
     nquad_terms_ += nterms0;
 
     auto S = std::make_unique<Quad<Field>>(nterms0);
     size_t i = 0;
-    for (const auto& ln0 : lnodes0) {
-      for (const auto& lt : ln0.lterms) {
+    for (const auto& ln0 : layer0.lnodes) {
+      for (size_t j = 0; j < ln0.nterms; ++j) {
+        const lterm& lt = layer0.lterms[ln0.toff + j];
         S->c_[i++] = typename Quad<Field>::corner{
             .g = ln0.desired_wire_id,
             .h = {lnodes1.at(static_cast<size_t>(lt.lop0)).desired_wire_id,
@@ -426,6 +495,63 @@ class Scheduler {
     S->canonicalize(f_);
     return S;
   }
+
+  //------------------------------------------------------------
+  // optional renumbering of internal wires for locality
+  //------------------------------------------------------------
+  //
+  // A canonical quad is sorted by (h[0], h[1]) in Morton order,
+  // so the prover reads W[h] mostly sequentially, but the writes
+  // of V[g] in eval_quad() and the reads of EQ[g] in bind_g() are
+  // scattered across the layer.  For each layer whose outputs are
+  // internal wires, this pass renames the g wires in order of first
+  // appearance in the quad, so that g grows with h, and propagates
+  // the renaming to the h wires of the next layer, which is then
+  // re-sorted and renamed in turn.
+  //
+  // The inputs at depth 0 and the outputs at depth DEPTH_UB-1 keep
+  // their wire ids, so the witness layout is unchanged.  The pass is
+  // a deterministic function of the canonical circuit, hence
+  // canonical itself, but the circuit id differs from the one
+  // without the pass.
+  void order_for_locality(std::vector<std::unique_ptr<Quad<Field>>>& quads,
+                          const std::vector<layer>& layers) {
+    using index_t = typename Quad<Field>::index_t;
+    const quad_corner_t undefined = nodeinfo::kWireIdUndefined;
+    std::vector<quad_corner_t> rename;
+
+    for (size_t d = 1; d + 1 < layers.size(); ++d) {
+      Quad<Field>& q = *quads.at(d);
+      Quad<Field>& qnext = *quads.at(d + 1);
+
+      rename.assign(layers.at(d).lnodes.size(), undefined);
+      quad_corner_t wid(0);
+      for (index_t i = 0; i < q.n_; ++i) {
+        quad_corner_t& r = rename.at(static_cast<size_t>(q.c_[i].g));
+        if (r == undefined) {
+          r = wid++;
+        }
+      }
+      // Wires that appear in no term, if any, go last.
+      for (quad_corner_t& r : rename) {
+        if (r == undefined) {
+          r = wid++;
+        }
+      }
+
+      for (index_t i = 0; i < q.n_; ++i) {
+        q.c_[i].g = rename[static_cast<size_t>(q.c_[i].g)];
+      }
+      for (index_t i = 0; i < qnext.n_; ++i) {
+        for (size_t hand = 0; hand < 2; ++hand) {
+          qnext.c_[i].h[hand] =
+              rename[static_cast<size_t>(qnext.c_[i].h[hand])];
+        }
+      }
+      q.canonicalize(f_);
+      qnext.canonicalize(f_);
+    }
+  }
 };
 
 }  // namespace proofs
@@ -294,6 +294,52 @@ TEST(ecdsa, verify3_p256) {
                                      p256, p256_scalar, n256_order);
 }
 
+TEST(ecdsa, witness_batch_p256) {
+  using Field = Fp256Base;
+  using Nat = Field::N;
+  using Verw = VerifyWitness3<P256, Fp256Scalar>;
+  const Field& F = p256.f_;
+  constexpr size_t k = sizeof(P256_TEST) / sizeof(P256_TEST[0]);
+
+  std::vector<Verw> want, got;
+  std::vector<Verw*> pw;
+  std::vector<Verw::Signature> sig;
+  for (size_t i = 0; i < k; ++i) {
+    sig.push_back(Verw::Signature{
+        F.of_string(P256_TEST[i].pk_x), F.of_string(P256_TEST[i].pk_y),
+        Nat(P256_TEST[i].e), Nat(P256_TEST[i].r), Nat(P256_TEST[i].s)});
+    want.emplace_back(p256_scalar, p256);
+    got.emplace_back(p256_scalar, p256);
+    EXPECT_TRUE(want[i].compute_witness(sig[i].pkX, sig[i].pkY, sig[i].e,
+                                        sig[i].r, sig[i].s));
+  }
+  for (size_t i = 0; i < k; ++i) {
+    pw.push_back(&got[i]);
+  }
+  EXPECT_TRUE(Verw::compute_witness(k, pw.data(), sig.data()));
+
+  for (size_t i = 0; i < k; ++i) {
+    EXPECT_EQ(got[i].rx_, want[i].rx_);
+    EXPECT_EQ(got[i].ry_, want[i].ry_);
+    EXPECT_EQ(got[i].rx_inv_, want[i].rx_inv_);
+    EXPECT_EQ(got[i].s_inv_, want[i].s_inv_);
+    EXPECT_EQ(got[i].pk_inv_, want[i].pk_inv_);
+    for (size_t j = 0; j < 8; ++j) {
+      EXPECT_EQ(got[i].pre_[j], want[i].pre_[j]);
+    }
+    for (size_t j = 0; j < Verw::kBits; ++j) {
+      EXPECT_EQ(got[i].bi_[j], want[i].bi_[j]);
+      EXPECT_EQ(got[i].int_x_[j], want[i].int_x_[j]);
+      EXPECT_EQ(got[i].int_y_[j], want[i].int_y_[j]);
+      EXPECT_EQ(got[i].int_z_[j], want[i].int_z_[j]);
+    }
+  }
+
+  // A bad signature fails the batch.
+  sig[1].s = Nat(P256_TEST[0].s);
+  EXPECT_FALSE(Verw::compute_witness(k, pw.data(), sig.data()));
+}
+
 TEST(ecdsa, p256_failure) {
   using Field = Fp256Base;
   using Nat = Field::N;
@@ -445,6 +491,36 @@ TEST(ECDSA, Size) {
 }
 
 // ================ Benchmarks =================================================
+// Witnesses for the first state.range(0) test vectors, one at a
+// time or as one batch.
+void BM_ECDSAWitness(benchmark::State& state) {
+  using Verw = VerifyWitness3<P256, Fp256Scalar>;
+  size_t k = state.range(0);
+  bool batch = state.range(1);
+  std::vector<Verw> w(k, Verw(p256_scalar, p256));
+  std::vector<Verw*> pw;
+  std::vector<Verw::Signature> sig;
+  for (size_t i = 0; i < k; ++i) {
+    const auto& t = P256_TEST[i];
+    sig.push_back(Verw::Signature{p256_base.of_string(t.pk_x),
+                                  p256_base.of_string(t.pk_y),
+                                  Fp256Nat(t.e), Fp256Nat(t.r),
+                                  Fp256Nat(t.s)});
+    pw.push_back(&w[i]);
+  }
+  for (auto _ : state) {
+    if (batch) {
+      Verw::compute_witness(k, pw.data(), sig.data());
+    } else {
+      for (size_t i = 0; i < k; ++i) {
+        w[i].compute_witness(sig[i].pkX, sig[i].pkY, sig[i].e, sig[i].r,
+                             sig[i].s);
+      }
+    }
+  }
+}
+BENCHMARK(BM_ECDSAWitness)->ArgsProduct({{1, 2, 3}, {0, 1}});
+
 void BM_ECDSASumcheckProver(benchmark::State& state) {
   size_t numSigs = state.range(0);
   std::unique_ptr<Circuit<Fp256Base>> CIRCUIT =
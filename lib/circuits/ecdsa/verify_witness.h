@@ -16,6 +16,7 @@
 #define PRIVACY_PROOFS_ZK_LIB_CIRCUITS_ECDSA_VERIFY_WITNESS_H_
 
 #include <cstddef>
+#include <vector>
 
 #include "algebra/utility.h"
 #include "arrays/dense.h"
@@ -69,131 +70,187 @@ class VerifyWitness3 {
     }
   }
 
+  // Public inputs of one signature verification
+  struct Signature {
+    Elt pkX, pkY;
+    Nat e, r, s;
+  };
+
   // Produces witnesses to support the verification of the equation
   //     id = g*e + pk*r + (rx,ry)*-s
   // Note that the same rx is interpreted in scalar field as r.
   bool compute_witness(const Elt pkX, const Elt pkY, const Nat e, const Nat r,
                        const Nat s) {
-    const Field& F = ec_.f_;
-    const Scalar _s = fn_.invertf(fn_.to_montgomery(s));
-    const Scalar tms = fn_.negf(fn_.to_montgomery(s));
+    VerifyWitness3* w[] = {this};
+    const Signature sig[] = {{pkX, pkY, e, r, s}};
+    return compute_witness(1, w, sig);
+  }
 
-    // Because Fp does not have a sqrt method, compute ry via the
-    // elliptic curve point g*(e/s) + pk*(r/s).
-    auto te_s = fn_.mulf(fn_.to_montgomery(e), _s);
-    auto tr_s = fn_.mulf(fn_.to_montgomery(r), _s);
-    const Nat nes = fn_.from_montgomery(te_s);
-    const Nat nrs = fn_.from_montgomery(tr_s);
-    Point bases[] = {ec_.generator(), Point(pkX, pkY, F.one())};
-    Nat scalars[] = {nes, nrs};
-    auto pr = ec_.scalar_multf(2, bases, scalars);
-    ec_.normalize(pr);
-
-    rx_ = F.to_montgomery(r);
-    ry_ = pr.y;
-
-    // In the case of a malicious input with rx=0 or s=0, the proof will fail.
-    if (rx_ != F.zero()) {
-      rx_inv_ = F.invertf(rx_);
-      check(F.mulf(rx_, rx_inv_) == F.one(), "bad inv");
+  // Batched version of compute_witness(), which sets W[i] to the
+  // witness for SIG[i] for all i < K.  All the inversions of one phase
+  // are shared across the K instances (and across the several
+  // inversions of each instance) via Montgomery's trick, and the K
+  // double-and-add loops are interleaved, which keeps more
+  // independent field operations in flight.  All W[i] must refer to
+  // the same curve and scalar field.  Returns true iff all K
+  // verification equations hold.
+  static bool compute_witness(size_t k, VerifyWitness3* const w[/*k*/],
+                              const Signature sig[/*k*/]) {
+    if (k == 0) {
+      return true;
     }
+    const ScalarField& fn = w[0]->fn_;
+    const EC& ec = w[0]->ec_;
+    const Field& F = ec.f_;
 
-    s_inv_ = F.to_montgomery(fn_.from_montgomery(tms));
-    if (s_inv_ != F.zero()) {
-      F.invert(s_inv_);
+    // 1/s and -s in the scalar field
+    std::vector<Scalar> s_inv(k), tms(k);
+    std::vector<Scalar*> ps(k);
+    for (size_t j = 0; j < k; ++j) {
+      s_inv[j] = fn.to_montgomery(sig[j].s);
+      tms[j] = fn.negf(s_inv[j]);
+      ps[j] = &s_inv[j];
     }
+    AlgebraUtil<ScalarField>::batch_invert_nonzero(k, ps.data(), fn);
 
-    if (pkX != F.zero()) {
-      pk_inv_ = F.invertf(pkX);
-    }
+    // Because Fp does not have a sqrt method, compute ry via the
+    // elliptic curve point g*(e/s) + pk*(r/s).
+    std::vector<Point> pr(k);
+    std::vector<Elt*> pe;
+    for (size_t j = 0; j < k; ++j) {
+      VerifyWitness3& wj = *w[j];
+      auto te_s = fn.mulf(fn.to_montgomery(sig[j].e), s_inv[j]);
+      auto tr_s = fn.mulf(fn.to_montgomery(sig[j].r), s_inv[j]);
+      const Nat nes = fn.from_montgomery(te_s);
+      const Nat nrs = fn.from_montgomery(tr_s);
+      pr[j] = ec.scalar_multf_generator(
+          nes, Point(sig[j].pkX, sig[j].pkY, F.one()), nrs);
 
-    const Nat nms = fn_.from_montgomery(tms);   /* -s */
+      // In the case of a malicious input with rx=0 or s=0, the proof
+      // will fail.  Zero values are not inverted.
+      wj.rx_ = F.to_montgomery(sig[j].r);
+      wj.rx_inv_ = wj.rx_;
+      wj.s_inv_ = F.to_montgomery(fn.from_montgomery(tms[j]));
+      wj.pk_inv_ = sig[j].pkX;
+      pe.insert(pe.end(), {&pr[j].z, &wj.rx_inv_, &wj.s_inv_, &wj.pk_inv_});
+    }
+    AlgebraUtil<Field>::batch_invert_nonzero(pe.size(), pe.data(), F);
 
     // Produce the table of pre-computed g,r,pk sums.
-    const Elt one = F.one(), gX = ec_.gx_, gY = ec_.gy_;
-    const Elt lh[] = {gX, gY, gX, gY, pkX, pkY};
-    const Elt rh[] = {pkX, pkY, rx_, ry_, rx_, ry_};
-    Elt zi;
-    for (size_t i = 0; i < 3; ++i) {
-      ec_.addE(pre_[2 * i], pre_[2 * i + 1], zi,
-               lh[2 * i], lh[2 * i + 1], one,
-               rh[2 * i], rh[2 * i + 1], one);
-
-      // This invert cannot fail because both the generator and pk are
-      // trusted inputs, so the above addition is not the identity.
-      // In the case that it is, the proof will fail (and it should, since
-      // the system is unsound with sk=-1).
-      if (zi != F.zero()) {
-        F.invert(zi);
+    const Elt one = F.one(), gX = ec.gx_, gY = ec.gy_;
+    std::vector<Elt> zi(3 * k);
+    pe.clear();
+    for (size_t j = 0; j < k; ++j) {
+      VerifyWitness3& wj = *w[j];
+      // pr.z now holds the inverse of z, unless z = 0
+      if (pr[j].z != F.zero()) {
+        F.mul(pr[j].y, pr[j].z);
+      }
+      wj.ry_ = pr[j].y;
+
+      const Elt& pkX = sig[j].pkX;
+      const Elt& pkY = sig[j].pkY;
+      const Elt lh[] = {gX, gY, gX, gY, pkX, pkY};
+      const Elt rh[] = {pkX, pkY, wj.rx_, wj.ry_, wj.rx_, wj.ry_};
+      for (size_t i = 0; i < 3; ++i) {
+        ec.addE(wj.pre_[2 * i], wj.pre_[2 * i + 1], zi[3 * j + i],
+                lh[2 * i], lh[2 * i + 1], one,
+                rh[2 * i], rh[2 * i + 1], one);
+        pe.push_back(&zi[3 * j + i]);
       }
-      F.mul(pre_[2 * i], zi);
-      F.mul(pre_[2 * i + 1], zi);
-    }
-    // rgpk
-    ec_.addE(pre_[6], pre_[7], zi, pre_[2], pre_[3], one, pkX, pkY, one);
-    if (zi != F.zero()) {
-      F.invert(zi);
     }
-    F.mul(pre_[6], zi);
-    F.mul(pre_[7], zi);
 
-    Elt aX = F.zero(), aY = one, aZ = F.zero();
+    // This invert cannot fail because both the generator and pk are
+    // trusted inputs, so the above additions are not the identity.
+    // In the case that it is, the proof will fail (and it should, since
+    // the system is unsound with sk=-1).
+    AlgebraUtil<Field>::batch_invert_nonzero(pe.size(), pe.data(), F);
+    pe.clear();
+    for (size_t j = 0; j < k; ++j) {
+      VerifyWitness3& wj = *w[j];
+      for (size_t i = 0; i < 3; ++i) {
+        F.mul(wj.pre_[2 * i], zi[3 * j + i]);
+        F.mul(wj.pre_[2 * i + 1], zi[3 * j + i]);
+      }
+      // rgpk
+      ec.addE(wj.pre_[6], wj.pre_[7], zi[j], wj.pre_[2], wj.pre_[3], one,
+              sig[j].pkX, sig[j].pkY, one);
+      pe.push_back(&zi[j]);
+    }
+    AlgebraUtil<Field>::batch_invert_nonzero(pe.size(), pe.data(), F);
+    for (size_t j = 0; j < k; ++j) {
+      F.mul(w[j]->pre_[6], zi[j]);
+      F.mul(w[j]->pre_[7], zi[j]);
+    }
 
     // Compute b[], and intermediate points, encode b as:
     //  1:g  2:pk  3: gpk  4: r  5: r+g  6: r+pk  7:g+r+pk
-    // Elt int_z[kBits];
-    size_t b[kBits];
-    // bool early_zero = false;   /* indicates if any intermediate z is zero */
+    std::vector<Nat> nms(k);
+    std::vector<Point> a(k, ec.zero());
+    for (size_t j = 0; j < k; ++j) {
+      nms[j] = fn.from_montgomery(tms[j]); /* -s */
+    }
     for (size_t i = 0; i < kBits; ++i) {
-      b[i] = e.bit(kBits - i - 1) + 2 * r.bit(kBits - i - 1) +
-             4 * nms.bit(kBits - i - 1);
+      // one step of all K loops
+      for (size_t j = 0; j < k; ++j) {
+        VerifyWitness3& wj = *w[j];
+        Point& aj = a[j];
+        size_t b = sig[j].e.bit(kBits - i - 1) +
+                   2 * sig[j].r.bit(kBits - i - 1) +
+                   4 * nms[j].bit(kBits - i - 1);
 
-      // Manually compute standard (-n...n representation).
-      bi_[i] = F.subf(F.of_scalar(2 * b[i]), F.of_scalar(7));
+        // Manually compute standard (-n...n representation).
+        wj.bi_[i] = F.subf(F.of_scalar(2 * b), F.of_scalar(7));
 
-      if (i > 0) {
-        ec_.doubleE(aX, aY, aZ, aX, aY, aZ);
-      }
-      switch (b[i]) {
-        case 0:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, F.zero(), F.one(), F.zero());
-          break;
-        case 1:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, gX, gY, one);
-          break;
-        case 2:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, pkX, pkY, one);
-          break;
-        case 3:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, pre_[0], pre_[1], one);
-          break;
-        case 4:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, rx_, ry_, one);
-          break;
-        case 5:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, pre_[2], pre_[3], one);
-          break;
-        case 6:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, pre_[4], pre_[5], one);
-          break;
-        case 7:
-          ec_.addE(aX, aY, aZ, aX, aY, aZ, pre_[6], pre_[7], one);
-          break;
-      }
+        if (i > 0) {
+          ec.doubleE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z);
+        }
+        switch (b) {
+          case 0:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, F.zero(), F.one(),
+                    F.zero());
+            break;
+          case 1:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, gX, gY, one);
+            break;
+          case 2:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, sig[j].pkX,
+                    sig[j].pkY, one);
+            break;
+          case 3:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, wj.pre_[0],
+                    wj.pre_[1], one);
+            break;
+          case 4:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, wj.rx_, wj.ry_, one);
+            break;
+          case 5:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, wj.pre_[2],
+                    wj.pre_[3], one);
+            break;
+          case 6:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, wj.pre_[4],
+                    wj.pre_[5], one);
+            break;
+          case 7:
+            ec.addE(aj.x, aj.y, aj.z, aj.x, aj.y, aj.z, wj.pre_[6],
+                    wj.pre_[7], one);
+            break;
+        }
 
-      int_x_[i] = aX;
-      int_y_[i] = aY;
-      int_z_[i] = aZ;
+        wj.int_x_[i] = aj.x;
+        wj.int_y_[i] = aj.y;
+        wj.int_z_[i] = aj.z;
+      }
     }
 
-    if (aX != F.zero()) {
-      return false;
-    }
-    if (aZ != F.zero()) {
-      return false;
+    bool ok = true;
+    for (size_t j = 0; j < k; ++j) {
+      if (a[j].x != F.zero() || a[j].z != F.zero()) {
+        ok = false;
+      }
     }
-
-    return true;
+    return ok;
   }
 };
 }  // namespace proofs
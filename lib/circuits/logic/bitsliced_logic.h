@@ -0,0 +1,832 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_CIRCUITS_LOGIC_BITSLICED_LOGIC_H_
+#define PRIVACY_PROOFS_ZK_LIB_CIRCUITS_LOGIC_BITSLICED_LOGIC_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "util/panic.h"
+
+namespace proofs {
+/*
+  Bit-sliced evaluation of boolean logic.
+
+  Logic<Field, EvaluationBackend<Field>> evaluates one instance of a
+  circuit, and it computes every boolean gate as field arithmetic on
+  the (c0, c1, x) representation.  BitslicedLogic instead evaluates
+  kLanes = 64 independent instances at once: a BitW is a 64-bit word
+  whose bit L is the value of the wire in instance L, so that boolean
+  gates are single word operations and bitvec operations such as
+  vadd() and vlt() are evaluated natively.  Only EltW values, which
+  are arbitrary field elements, fall back to field arithmetic, one
+  lane at a time.
+
+  The interface is the one of Logic, with the same argument
+  conventions, so that circuits templated on the Logic class, such as
+  FlatSHA256Circuit with its BitAdder and BitPlucker, can be
+  instantiated with either class.  The exceptions are circuit I/O
+  (input(), vinput(), output(), ...), which only makes sense for a
+  compiler backend, and rebase(), which depends on the (c0, c1, x)
+  representation.  Assertions return their argument rather than an
+  EltW.  Instances enter and leave the bit-sliced representation via
+  vpack() and vunpack(), or by filling EltW::e lane by lane.
+ */
+template <typename Field_>
+class BitslicedLogic {
+ public:
+  using Field = Field_;
+  using Elt = typename Field::Elt;
+  using word_t = uint64_t;
+  static constexpr size_t kLanes = 64;
+
+  // a field element in each of the kLanes instances
+  struct EltW {
+    std::array<Elt, kLanes> e;
+  };
+
+  // a bit in each of the kLanes instances
+  struct BitW {
+    word_t w;
+    BitW() = default;
+    explicit BitW(word_t w_) : w(w_) {}
+
+    // Same as Logic::BitW(bv, F): the bit is set in the lanes where
+    // BV is one.  Callers assert_is_bit(BV) first.
+    BitW(const EltW& bv, const Field& F) : w(0) {
+      for (size_t l = 0; l < kLanes; ++l) {
+        if (bv.e[l] == F.one()) {
+          w |= word_t(1) << l;
+        }
+      }
+    }
+  };
+
+  template <size_t N>
+  class bitvec : public std::array<BitW, N> {};
+
+  using v1 = bitvec<1>;
+  using v4 = bitvec<4>;
+  using v8 = bitvec<8>;
+  using v16 = bitvec<16>;
+  using v32 = bitvec<32>;
+  using v64 = bitvec<64>;
+  using v128 = bitvec<128>;
+  using v256 = bitvec<256>;
+
+  const Field& f_;
+
+  explicit BitslicedLogic(const Field& F,
+                          bool panic_on_assertion_failure = true)
+      : f_(F),
+        panic_on_assertion_failure_(panic_on_assertion_failure),
+        assertion_failed_(0) {}
+
+  ~BitslicedLogic() {
+    // Same policy as ~EvaluationBackend()
+    check(assertion_failed_ == 0,
+          "assertion_failed_ nonzero in ~BitslicedLogic()");
+  }
+
+  // Return the mask of the lanes in which an assertion has failed
+  // since the last call, and reset the mask.
+  word_t assertion_failed() const {
+    word_t m = assertion_failed_;
+    assertion_failed_ = 0;
+    return m;
+  }
+
+  //------------------------------------------------------------
+  // Field operations
+  Elt addf(const Elt& a, const Elt& b) const { return f_.addf(a, b); }
+  Elt mulf(const Elt& a, const Elt& b) const { return f_.mulf(a, b); }
+  Elt invertf(const Elt& a) const { return f_.invertf(a); }
+  Elt negf(const Elt& a) const { return f_.negf(a); }
+  Elt zero() const { return f_.zero(); }
+  Elt one() const { return f_.one(); }
+  Elt mone() const { return f_.mone(); }
+  Elt elt(uint64_t a) const { return f_.of_scalar(a); }
+
+  template <size_t N>
+  Elt elt(const char (&s)[N]) const {
+    return f_.of_string(s);
+  }
+
+  //------------------------------------------------------------
+  // Arithmetic on EltW, lane by lane.
+  EltW assert0(const EltW& a) const {
+    word_t m = 0;
+    for (size_t l = 0; l < kLanes; ++l) {
+      if (a.e[l] != f_.zero()) {
+        m |= word_t(1) << l;
+      }
+    }
+    fail(m, "a != F.zero()");
+    return a;
+  }
+
+  EltW add(const EltW* a, const EltW& b) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = f_.addf(a->e[l], b.e[l]);
+    }
+    return r;
+  }
+  EltW sub(const EltW* a, const EltW& b) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = f_.subf(a->e[l], b.e[l]);
+    }
+    return r;
+  }
+  EltW mul(const EltW* a, const EltW& b) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = f_.mulf(a->e[l], b.e[l]);
+    }
+    return r;
+  }
+  EltW mul(const Elt& k, const EltW& b) const { return ax(k, b); }
+  EltW mul(const Elt& k, const EltW* a, const EltW& b) const {
+    return axy(k, a, b);
+  }
+
+  EltW ax(const Elt& a, const EltW& x) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = f_.mulf(a, x.e[l]);
+    }
+    return r;
+  }
+  EltW axy(const Elt& a, const EltW* x, const EltW& y) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = f_.mulf(a, f_.mulf(x->e[l], y.e[l]));
+    }
+    return r;
+  }
+  EltW axpy(const EltW* y, const Elt& a, const EltW& x) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = f_.addf(y->e[l], f_.mulf(a, x.e[l]));
+    }
+    return r;
+  }
+  EltW apy(const EltW& y, const Elt& a) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = f_.addf(y.e[l], a);
+    }
+    return r;
+  }
+
+  EltW konst(const Elt& a) const {
+    EltW r;
+    r.e.fill(a);
+    return r;
+  }
+  EltW konst(uint64_t a) const { return konst(elt(a)); }
+
+  template <size_t N>
+  std::array<EltW, N> konst(const std::array<Elt, N>& a) const {
+    std::array<EltW, N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = konst(a[i]);
+    }
+    return r;
+  }
+
+  //------------------------------------------------------------
+  // Boolean logic, one word operation per gate.
+
+  // conversion to the standard basis
+  EltW eval(const BitW& v) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = ((v.w >> l) & 1) ? f_.one() : f_.zero();
+    }
+    return r;
+  }
+
+  // same as Logic::as_scalar()
+  template <size_t N>
+  EltW as_scalar(const bitvec<N>& v) const {
+    EltW r = konst(zero());
+    for (size_t i = 0; i < N; ++i) {
+      Elt bi = f_.beta(i);
+      for (size_t l = 0; l < kLanes; ++l) {
+        if ((v[i].w >> l) & 1) {
+          f_.add(r.e[l], bi);
+        }
+      }
+    }
+    return r;
+  }
+
+  BitW assert0(const BitW& v) const {
+    fail(v.w, "a != F.zero()");
+    return v;
+  }
+  BitW assert1(const BitW& v) const { return assert0(lnot(v)); }
+  EltW assert_eq(const EltW* a, const EltW& b) const {
+    return assert0(sub(a, b));
+  }
+  BitW assert_eq(const BitW* a, const BitW& b) const {
+    return assert0(lxor(a, b));
+  }
+  BitW assert_implies(const BitW* a, const BitW& b) const {
+    return assert1(limplies(a, b));
+  }
+
+  // A BitW is a bit by construction
+  BitW assert_is_bit(const BitW& b) const { return b; }
+  EltW assert_is_bit(const EltW& v) const {
+    word_t m = 0;
+    for (size_t l = 0; l < kLanes; ++l) {
+      if (v.e[l] != f_.zero() && v.e[l] != f_.one()) {
+        m |= word_t(1) << l;
+      }
+    }
+    fail(m, "a != F.zero()");
+    return v;
+  }
+
+  // B in all lanes
+  BitW bit(size_t b) const { return BitW(b == 0 ? word_t(0) : ~word_t(0)); }
+
+  void bits(size_t n, BitW a[/*n*/], uint64_t x) const {
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = bit((x >> i) & 1u);
+    }
+  }
+
+  BitW lnot(const BitW& x) const { return BitW(~x.w); }
+  BitW land(const BitW* a, const BitW& b) const { return BitW(a->w & b.w); }
+  BitW lxor(const BitW* a, const BitW& b) const { return BitW(a->w ^ b.w); }
+  BitW lxor(const BitW* a, const BitW* b) const { return BitW(a->w ^ b->w); }
+  BitW lor(const BitW* a, const BitW& b) const { return BitW(a->w | b.w); }
+  BitW limplies(const BitW* a, const BitW& b) const {
+    return BitW(~a->w | b.w);
+  }
+  BitW lor_exclusive(const BitW* a, const BitW& b) const {
+    return BitW(a->w | b.w);
+  }
+  BitW lxor3(const BitW* a, const BitW* b, const BitW& c) const {
+    return BitW(a->w ^ b->w ^ c.w);
+  }
+  BitW lCh(const BitW* x, const BitW* y, const BitW& z) const {
+    return BitW((x->w & y->w) ^ (~x->w & z.w));
+  }
+  BitW lMaj(const BitW* x, const BitW* y, const BitW& z) const {
+    return BitW((x->w & y->w) | ((x->w ^ y->w) & z.w));
+  }
+  BitW mux(const BitW* control, const BitW* iftrue, const BitW& iffalse) const {
+    return BitW((control->w & iftrue->w) | (~control->w & iffalse.w));
+  }
+
+  // products of a bit by a field element
+  EltW lmul(const BitW* a, const EltW& b) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = ((a->w >> l) & 1) ? b.e[l] : f_.zero();
+    }
+    return r;
+  }
+  EltW lmul(const EltW* b, const BitW& a) const { return lmul(&a, *b); }
+
+  EltW mux(const BitW* control, const EltW* iftrue, const EltW& iffalse) const {
+    EltW r;
+    for (size_t l = 0; l < kLanes; ++l) {
+      r.e[l] = ((control->w >> l) & 1) ? iftrue->e[l] : iffalse.e[l];
+    }
+    return r;
+  }
+
+  // Reductions over f(i) for i0 <= i < i1.  The lanes are independent,
+  // so a linear pass computes the same values as the balanced trees of
+  // Logic.
+
+  // sum_{i0 <= i < i1} f(i)
+  EltW add(size_t i0, size_t i1, const std::function<EltW(size_t)>& f) const {
+    EltW r = konst(zero());
+    for (size_t i = i0; i < i1; ++i) {
+      r = add(&r, f(i));
+    }
+    return r;
+  }
+
+  // prod_{i0 <= i < i1} f(i)
+  EltW mul(size_t i0, size_t i1, const std::function<EltW(size_t)>& f) const {
+    EltW r = konst(one());
+    for (size_t i = i0; i < i1; ++i) {
+      r = mul(&r, f(i));
+    }
+    return r;
+  }
+
+  BitW lor_exclusive(size_t i0, size_t i1,
+                     const std::function<BitW(size_t)>& f) const {
+    return lor(i0, i1, f);
+  }
+
+  BitW land(size_t i0, size_t i1, const std::function<BitW(size_t)>& f) const {
+    word_t r = ~word_t(0);
+    for (size_t i = i0; i < i1; ++i) {
+      r &= f(i).w;
+    }
+    return BitW(r);
+  }
+
+  BitW lor(size_t i0, size_t i1, const std::function<BitW(size_t)>& f) const {
+    word_t r = 0;
+    for (size_t i = i0; i < i1; ++i) {
+      r |= f(i).w;
+    }
+    return BitW(r);
+  }
+
+  BitW or_of_and(std::vector<std::vector<BitW>> clauses_of_ands) const {
+    word_t r = 0;
+    for (const auto& ai : clauses_of_ands) {
+      r |= land(0, ai.size(), [&](size_t i) { return ai[i]; }).w;
+    }
+    return BitW(r);
+  }
+
+  // a == 0
+  BitW eq0(size_t w, const BitW a[/*w*/]) const {
+    word_t r = 0;
+    for (size_t i = 0; i < w; ++i) {
+      r |= a[i].w;
+    }
+    return BitW(~r);
+  }
+
+  // a == b
+  BitW eq(size_t w, const BitW a[/*w*/], const BitW b[/*w*/]) const {
+    word_t r = 0;
+    for (size_t i = 0; i < w; ++i) {
+      r |= a[i].w ^ b[i].w;
+    }
+    return BitW(~r);
+  }
+
+  // a < b, scanning from the most significant bit
+  BitW lt(size_t w, const BitW a[/*w*/], const BitW b[/*w*/]) const {
+    word_t xlt = 0, xeq = ~word_t(0);
+    for (size_t i = w; i-- > 0;) {
+      xlt |= xeq & ~a[i].w & b[i].w;
+      xeq &= ~(a[i].w ^ b[i].w);
+    }
+    return BitW(xlt);
+  }
+
+  // a <= b
+  BitW leq(size_t w, const BitW a[/*w*/], const BitW b[/*w*/]) const {
+    return lnot(lt(w, b, a));
+  }
+
+  // c = a + b mod 2^w, returning the carry out
+  BitW ripple_carry_add(size_t w, BitW c[/*w*/], const BitW a[/*w*/],
+                        const BitW b[/*w*/]) const {
+    word_t carry = 0;
+    for (size_t i = 0; i < w; ++i) {
+      word_t p = a[i].w ^ b[i].w;
+      word_t g = a[i].w & b[i].w;
+      c[i] = BitW(p ^ carry);
+      carry = g | (p & carry);
+    }
+    return BitW(carry);
+  }
+
+  // c = a - b mod 2^w, returning the borrow out
+  BitW ripple_carry_sub(size_t w, BitW c[/*w*/], const BitW a[/*w*/],
+                        const BitW b[/*w*/]) const {
+    word_t borrow = 0;
+    for (size_t i = 0; i < w; ++i) {
+      word_t p = a[i].w ^ b[i].w;
+      c[i] = BitW(p ^ borrow);
+      borrow = (~a[i].w & b[i].w) | (~p & borrow);
+    }
+    return BitW(borrow);
+  }
+
+  // The carry chain is already one word operation per bit, so the
+  // parallel-prefix variants are aliases.
+  BitW parallel_prefix_add(size_t w, BitW c[/*w*/], const BitW a[/*w*/],
+                           const BitW b[/*w*/]) const {
+    return ripple_carry_add(w, c, a, b);
+  }
+  BitW parallel_prefix_sub(size_t w, BitW c[/*w*/], const BitW a[/*w*/],
+                           const BitW b[/*w*/]) const {
+    return ripple_carry_sub(w, c, a, b);
+  }
+
+  // assert that a + b = c mod 2^w
+  void assert_sum(size_t w, const BitW c[/*w*/], const BitW a[/*w*/],
+                  const BitW b[/*w*/]) const {
+    std::vector<BitW> s(w);
+    (void)ripple_carry_add(w, s.data(), a, b);
+    for (size_t i = 0; i < w; ++i) {
+      (void)assert_eq(&c[i], s[i]);
+    }
+  }
+
+  // w x w -> 2w-bit multiplier c = a * b
+  void multiplier(size_t w, BitW c[/*2*w*/], const BitW a[/*w*/],
+                  const BitW b[/*w*/]) const {
+    std::vector<BitW> t(w);
+    for (size_t j = 0; j < w; ++j) {
+      c[j] = land(&a[0], b[j]);
+    }
+    c[w] = bit(0);
+    for (size_t i = 1; i < w; ++i) {
+      for (size_t j = 0; j < w; ++j) {
+        t[j] = land(&a[i], b[j]);
+      }
+      c[i + w] = ripple_carry_add(w, c + i, t.data(), c + i);
+    }
+  }
+
+  // w x w -> 2w-bit polynomial multiplier over gf2.  c(x) = a(x) * b(x)
+  void gf2_polynomial_multiplier(size_t w, BitW c[/*2*w*/], const BitW a[/*w*/],
+                                 const BitW b[/*w*/]) const {
+    for (size_t k = 0; k < 2 * w; ++k) {
+      word_t r = 0;
+      for (size_t i = 0; i < w && i <= k; ++i) {
+        if (k - i < w) {
+          r ^= a[i].w & b[k - i].w;
+        }
+      }
+      c[k] = BitW(r);
+    }
+  }
+
+  // Karatsuba saves gates in a circuit, but not word operations here.
+  void gf2_polynomial_multiplier_karat(size_t w, BitW c[/*2*w*/],
+                                       const BitW a[/*w*/],
+                                       const BitW b[/*w*/]) const {
+    gf2_polynomial_multiplier(w, c, a, b);
+  }
+
+  // Field multiplication in GF2^128 modulo x^128 + x^7 + x^2 + x + 1,
+  // reducing the product one term at a time instead of via the tap
+  // table of Logic::gf2_128_mul().
+  void gf2_128_mul(v128& c, const v128 a, const v128 b) const {
+    BitW t[256];
+    gf2_polynomial_multiplier(128, t, a.data(), b.data());
+    for (size_t i = 254; i >= 128; --i) {
+      t[i - 128].w ^= t[i].w;
+      t[i - 127].w ^= t[i].w;
+      t[i - 126].w ^= t[i].w;
+      t[i - 121].w ^= t[i].w;
+    }
+    for (size_t i = 0; i < 128; ++i) {
+      c[i] = t[i];
+    }
+  }
+
+  // Field multiplication in GF2^k, where row M[i] lists the terms of
+  // the product polynomial that contribute to bit i.
+  void gf2k_mul(BitW c[/*w*/], const BitW a[/*w*/], const BitW b[/*w*/],
+                const std::vector<uint16_t> M[], size_t w) const {
+    std::vector<BitW> t(w * 2);
+    gf2_polynomial_multiplier(w, t.data(), a, b);
+    for (size_t i = 0; i < w; ++i) {
+      word_t r = 0;
+      for (auto ti : M[i]) {
+        r ^= t[ti].w;
+      }
+      c[i] = BitW(r);
+    }
+  }
+
+  // Parallel prefix of various kinds, same as Logic::scan()
+  template <class T>
+  void scan(const std::function<void(T*, const T&, const T&)>& op, T x[],
+            size_t i0, size_t i1, bool backward = false) const {
+    if (i1 - i0 > 1) {
+      size_t im = i0 + (i1 - i0) / 2;
+      scan(op, x, i0, im, backward);
+      scan(op, x, im, i1, backward);
+      if (backward) {
+        for (size_t i = i0; i < im; ++i) {
+          op(&x[i], x[i], x[im]);
+        }
+      } else {
+        for (size_t i = im; i < i1; ++i) {
+          op(&x[i], x[im - 1], x[i]);
+        }
+      }
+    }
+  }
+
+  void scan_and(BitW x[], size_t i0, size_t i1, bool backward = false) const {
+    scan<BitW>(
+        [&](BitW* out, const BitW& l, const BitW& r) { *out = land(&l, r); }, x,
+        i0, i1, backward);
+  }
+
+  void scan_or(BitW x[], size_t i0, size_t i1, bool backward = false) const {
+    scan<BitW>(
+        [&](BitW* out, const BitW& l, const BitW& r) { *out = lor(&l, r); }, x,
+        i0, i1, backward);
+  }
+
+  void scan_xor(BitW x[], size_t i0, size_t i1, bool backward = false) const {
+    scan<BitW>(
+        [&](BitW* out, const BitW& l, const BitW& r) { *out = lxor(&l, r); }, x,
+        i0, i1, backward);
+  }
+
+  //------------------------------------------------------------
+  // Bit vectors
+  template <size_t I0, size_t I1, size_t N>
+  bitvec<I1 - I0> slice(const bitvec<N>& a) const {
+    bitvec<I1 - I0> r;
+    for (size_t i = I0; i < I1; ++i) {
+      r[i - I0] = a[i];
+    }
+    return r;
+  }
+
+  template <size_t NA, size_t NB>
+  bitvec<NA + NB> vappend(const bitvec<NA>& a, const bitvec<NB>& b) const {
+    bitvec<NA + NB> r;
+    for (size_t i = 0; i < NA; ++i) {
+      r[i] = a[i];
+    }
+    for (size_t i = 0; i < NB; ++i) {
+      r[i + NA] = b[i];
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vbit(uint64_t x) const {
+    bitvec<N> r;
+    bits(N, r.data(), x);
+    return r;
+  }
+  v8 vbit8(uint64_t x) const { return vbit<8>(x); }
+  v32 vbit32(uint64_t x) const { return vbit<32>(x); }
+
+  template <size_t N>
+  bitvec<N> vnot(const bitvec<N>& x) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = lnot(x[i]);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vand(const bitvec<N>* a, const bitvec<N>& b) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = land(&(*a)[i], b[i]);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vand(const BitW* a, const bitvec<N>& b) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = land(a, b[i]);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vor(const bitvec<N>* a, const bitvec<N>& b) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = lor(&(*a)[i], b[i]);
+    }
+    return r;
+  }
+  template <size_t N>
+  bitvec<N> vor_exclusive(const bitvec<N>* a, const bitvec<N>& b) const {
+    return vor(a, b);
+  }
+  template <size_t N>
+  bitvec<N> vxor(const bitvec<N>* a, const bitvec<N>& b) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = lxor(&(*a)[i], b[i]);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vCh(const bitvec<N>* x, const bitvec<N>* y,
+                const bitvec<N>& z) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = lCh(&(*x)[i], &(*y)[i], z[i]);
+    }
+    return r;
+  }
+  template <size_t N>
+  bitvec<N> vMaj(const bitvec<N>* x, const bitvec<N>* y,
+                 const bitvec<N>& z) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = lMaj(&(*x)[i], &(*y)[i], z[i]);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vxor3(const bitvec<N>* x, const bitvec<N>* y,
+                  const bitvec<N>& z) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = lxor3(&(*x)[i], &(*y)[i], z[i]);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vshr(const bitvec<N>& a, size_t shift, size_t b = 0) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = (i + shift < N) ? a[i + shift] : bit(b);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vshl(const bitvec<N>& a, size_t shift, size_t b = 0) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = (i >= shift) ? a[i - shift] : bit(b);
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vrotr(const bitvec<N>& a, size_t b) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[i] = a[(i + b) % N];
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vrotl(const bitvec<N>& a, size_t b) const {
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      r[(i + b) % N] = a[i];
+    }
+    return r;
+  }
+
+  template <size_t N>
+  bitvec<N> vadd(const bitvec<N>& a, const bitvec<N>& b) const {
+    bitvec<N> r;
+    (void)ripple_carry_add(N, &r[0], &a[0], &b[0]);
+    return r;
+  }
+  template <size_t N>
+  bitvec<N> vadd(const bitvec<N>& a, uint64_t val) const {
+    return vadd(a, vbit<N>(val));
+  }
+
+  template <size_t N>
+  BitW veq(const bitvec<N>* a, const bitvec<N>& b) const {
+    return eq(N, (*a).data(), b.data());
+  }
+  template <size_t N>
+  BitW veq(const bitvec<N>& a, uint64_t val) const {
+    auto v = vbit<N>(val);
+    return veq(&a, v);
+  }
+  template <size_t N>
+  BitW vlt(const bitvec<N>* a, const bitvec<N>& b) const {
+    return lt(N, (*a).data(), b.data());
+  }
+  template <size_t N>
+  BitW vlt(const bitvec<N>& a, uint64_t val) const {
+    auto v = vbit<N>(val);
+    return vlt(&a, v);
+  }
+  template <size_t N>
+  BitW vlt(uint64_t a, const bitvec<N>& b) const {
+    auto va = vbit<N>(a);
+    return vlt(&va, b);
+  }
+  template <size_t N>
+  BitW vleq(const bitvec<N>* a, const bitvec<N>& b) const {
+    return leq(N, (*a).data(), b.data());
+  }
+  template <size_t N>
+  BitW vleq(const bitvec<N>& a, uint64_t val) const {
+    auto v = vbit<N>(val);
+    return vleq(&a, v);
+  }
+
+  // (a ^ val) & mask == 0
+  template <size_t N>
+  BitW veqmask(const bitvec<N>* a, uint64_t mask, const bitvec<N>& val) const {
+    word_t r = 0;
+    for (size_t i = 0; i < N && i < 64; ++i) {
+      if ((mask >> i) & 1) {
+        r |= (*a)[i].w ^ val[i].w;
+      }
+    }
+    return BitW(~r);
+  }
+  template <size_t N>
+  BitW veqmask(const bitvec<N>& a, uint64_t mask, uint64_t val) const {
+    auto v = vbit<N>(val);
+    return veqmask(&a, mask, v);
+  }
+
+  template <size_t N>
+  void vassert0(const bitvec<N>& x) const {
+    for (size_t i = 0; i < N; ++i) {
+      (void)assert0(x[i]);
+    }
+  }
+  template <size_t N>
+  void vassert_eq(const bitvec<N>* x, const bitvec<N>& y) const {
+    for (size_t i = 0; i < N; ++i) {
+      (void)assert_eq(&(*x)[i], y[i]);
+    }
+  }
+  template <size_t N>
+  void vassert_eq(const bitvec<N>& x, uint64_t y) const {
+    auto v = vbit<N>(y);
+    vassert_eq(&x, v);
+  }
+  template <size_t N>
+  void vassert_is_bit(const bitvec<N>& a) const {
+    // a BitW is a bit by construction
+  }
+
+  //------------------------------------------------------------
+  // Conversion between kLanes instances and the bit-sliced form.
+
+  // Return the bitvec whose value in lane L is X[L] mod 2^N.
+  template <size_t N>
+  bitvec<N> vpack(const uint64_t x[/*kLanes*/]) const {
+    static_assert(N <= 64, "vpack() supports at most 64 bits");
+    bitvec<N> r;
+    for (size_t i = 0; i < N; ++i) {
+      word_t w = 0;
+      for (size_t l = 0; l < kLanes; ++l) {
+        w |= ((x[l] >> i) & 1) << l;
+      }
+      r[i] = BitW(w);
+    }
+    return r;
+  }
+
+  // Inverse of vpack()
+  template <size_t N>
+  void vunpack(uint64_t x[/*kLanes*/], const bitvec<N>& v) const {
+    static_assert(N <= 64, "vunpack() supports at most 64 bits");
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint64_t xl = 0;
+      for (size_t i = 0; i < N; ++i) {
+        xl |= ((v[i].w >> l) & 1) << i;
+      }
+      x[l] = xl;
+    }
+  }
+
+ private:
+  void fail(word_t lanes, const char* msg) const {
+    if (lanes != 0) {
+      if (panic_on_assertion_failure_) {
+        check(false, msg);
+      }
+      assertion_failed_ |= lanes;
+    }
+  }
+
+  bool panic_on_assertion_failure_;
+  mutable word_t assertion_failed_;
+};
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_CIRCUITS_LOGIC_BITSLICED_LOGIC_H_
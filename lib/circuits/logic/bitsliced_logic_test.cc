@@ -0,0 +1,606 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "circuits/logic/bitsliced_logic.h"
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "algebra/fp.h"
+#include "circuits/logic/bit_plucker.h"
+#include "circuits/logic/bit_plucker_encoder.h"
+#include "circuits/logic/evaluation_backend.h"
+#include "circuits/logic/logic.h"
+#include "circuits/logic/memcmp.h"
+#include "circuits/logic/routing.h"
+#include "circuits/mdoc/mdoc_hash.h"
+#include "circuits/sha/flatsha256_circuit.h"
+#include "circuits/sha/flatsha256_io.h"
+#include "circuits/sha/flatsha256_witness.h"
+#include "gf2k/gf2_128.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+
+namespace proofs {
+namespace {
+using Field = Fp<1>;
+const Field F("18446744073709551557");
+using EvaluationBackend = EvaluationBackend<Field>;
+using Logic = Logic<Field, EvaluationBackend>;
+using BLogic = BitslicedLogic<Field>;
+constexpr size_t kLanes = BLogic::kLanes;
+
+using FlatSha = FlatSHA256Circuit<Logic, BitPlucker<Logic, kShaPluckerSize>>;
+using BFlatSha = FlatSHA256Circuit<BLogic, BitPlucker<BLogic, kShaPluckerSize>>;
+
+uint64_t rnd(uint64_t* s) {
+  // splitmix64
+  uint64_t z = (*s += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+bool lane(const BLogic::BitW& b, size_t l) { return (b.w >> l) & 1; }
+
+template <size_t N>
+uint64_t value(const Logic& L, const Logic::bitvec<N>& v) {
+  uint64_t x = 0;
+  for (size_t i = 0; i < N; ++i) {
+    if (L.eval(v[i]).elt() == F.one()) {
+      x |= uint64_t(1) << i;
+    }
+  }
+  return x;
+}
+
+// N random bits in each lane
+template <size_t N>
+BLogic::bitvec<N> random_bits(uint64_t* s) {
+  BLogic::bitvec<N> r;
+  for (size_t i = 0; i < N; ++i) {
+    r[i] = BLogic::BitW(rnd(s));
+  }
+  return r;
+}
+
+// lane L of V, as constants of the field backend
+template <size_t N>
+Logic::bitvec<N> lane_bits(const Logic& L, const BLogic::bitvec<N>& v,
+                           size_t l) {
+  Logic::bitvec<N> r;
+  for (size_t i = 0; i < N; ++i) {
+    r[i] = L.bit(lane(v[i], l));
+  }
+  return r;
+}
+
+template <size_t N>
+void expect_lane_eq(const Logic& L, const Logic::bitvec<N>& want,
+                    const BLogic::bitvec<N>& got, size_t l) {
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_EQ(L.eval(want[i]).elt() == F.one(), lane(got[i], l));
+  }
+}
+
+// One SHA-256 block and its witness, as in FlatSHA256Circuit
+struct Block {
+  uint32_t in[16], H0[8], outw[48], oute[64], outa[64], H1[8];
+};
+
+std::vector<Block> random_blocks(uint64_t seed) {
+  std::vector<Block> b(kLanes);
+  for (auto& bl : b) {
+    for (size_t i = 0; i < 16; ++i) {
+      bl.in[i] = rnd(&seed);
+    }
+    for (size_t i = 0; i < 8; ++i) {
+      bl.H0[i] = rnd(&seed);
+    }
+    FlatSHA256Witness::transform_and_witness_block(bl.in, bl.H0, bl.outw,
+                                                   bl.oute, bl.outa, bl.H1);
+  }
+  return b;
+}
+
+// the word GET(l) in lane l
+template <class Get>
+BLogic::v32 pack32(const BLogic& BL, const Get& get) {
+  uint64_t x[kLanes];
+  for (size_t l = 0; l < kLanes; ++l) {
+    x[l] = get(l);
+  }
+  return BL.vpack<32>(x);
+}
+
+// the plucker encoding of GET(l) in lane l
+template <class FlatShaT, class FieldT, class Get>
+typename FlatShaT::packed_v32 pack_plucked(const FieldT& Fs, const Get& get) {
+  BitPluckerEncoder<FieldT, kShaPluckerSize> BPENC(Fs);
+  typename FlatShaT::packed_v32 r;
+  for (size_t l = 0; l < kLanes; ++l) {
+    auto p = BPENC.mkpacked_v32(get(l));
+    for (size_t k = 0; k < p.size(); ++k) {
+      r[k].e[l] = p[k];
+    }
+  }
+  return r;
+}
+
+// Whether FlatSHA256Circuit rejects B in the field backend.
+bool field_block_fails(const Block& b) {
+  const EvaluationBackend ebk(F, /*panic_on_assertion_failure=*/false);
+  const Logic L(&ebk, F);
+  const FlatSha FSHA(L);
+  std::vector<Logic::v32> in(16), H0(8), outw(48), oute(64), outa(64), H1(8);
+  for (size_t i = 0; i < 16; ++i) {
+    in[i] = L.vbit32(b.in[i]);
+  }
+  for (size_t i = 0; i < 8; ++i) {
+    H0[i] = L.vbit32(b.H0[i]);
+    H1[i] = L.vbit32(b.H1[i]);
+  }
+  for (size_t i = 0; i < 48; ++i) {
+    outw[i] = L.vbit32(b.outw[i]);
+  }
+  for (size_t i = 0; i < 64; ++i) {
+    oute[i] = L.vbit32(b.oute[i]);
+    outa[i] = L.vbit32(b.outa[i]);
+  }
+  FSHA.assert_transform_block(in.data(), H0.data(), outw.data(), oute.data(),
+                              outa.data(), H1.data());
+  return ebk.assertion_failed();
+}
+
+TEST(BitslicedLogic, FlatSha256Block) {
+  const BLogic BL(F, /*panic_on_assertion_failure=*/false);
+  const BFlatSha FSHA(BL);
+
+  auto b = random_blocks(1);
+  constexpr size_t kBad = 17;
+  b[kBad].outa[5] ^= 0x100;
+
+  std::vector<BLogic::v32> in(16), H0(8), outw(48), oute(64), outa(64), H1(8);
+  for (size_t i = 0; i < 16; ++i) {
+    in[i] = pack32(BL, [&](size_t l) { return b[l].in[i]; });
+  }
+  for (size_t i = 0; i < 8; ++i) {
+    H0[i] = pack32(BL, [&](size_t l) { return b[l].H0[i]; });
+    H1[i] = pack32(BL, [&](size_t l) { return b[l].H1[i]; });
+  }
+  for (size_t i = 0; i < 48; ++i) {
+    outw[i] = pack32(BL, [&](size_t l) { return b[l].outw[i]; });
+  }
+  for (size_t i = 0; i < 64; ++i) {
+    oute[i] = pack32(BL, [&](size_t l) { return b[l].oute[i]; });
+    outa[i] = pack32(BL, [&](size_t l) { return b[l].outa[i]; });
+  }
+  FSHA.assert_transform_block(in.data(), H0.data(), outw.data(), oute.data(),
+                              outa.data(), H1.data());
+  EXPECT_EQ(BL.assertion_failed(), uint64_t(1) << kBad);
+
+  for (size_t l : {size_t(0), kBad, size_t(63)}) {
+    EXPECT_EQ(field_block_fails(b[l]), l == kBad);
+  }
+}
+
+TEST(BitslicedLogic, FlatSha256BlockPacked) {
+  const BLogic BL(F, /*panic_on_assertion_failure=*/false);
+  const BFlatSha FSHA(BL);
+
+  auto b = random_blocks(2);
+  constexpr size_t kBad = 40;
+  b[kBad].H1[3] ^= 1;
+
+  std::vector<BLogic::v32> in(16);
+  for (size_t i = 0; i < 16; ++i) {
+    in[i] = pack32(BL, [&](size_t l) { return b[l].in[i]; });
+  }
+  std::vector<BFlatSha::packed_v32> H0(8), outw(48), oute(64), outa(64), H1(8);
+  for (size_t i = 0; i < 8; ++i) {
+    H0[i] = pack_plucked<BFlatSha>(F, [&](size_t l) { return b[l].H0[i]; });
+    H1[i] = pack_plucked<BFlatSha>(F, [&](size_t l) { return b[l].H1[i]; });
+  }
+  for (size_t i = 0; i < 48; ++i) {
+    outw[i] = pack_plucked<BFlatSha>(F, [&](size_t l) { return b[l].outw[i]; });
+  }
+  for (size_t i = 0; i < 64; ++i) {
+    oute[i] = pack_plucked<BFlatSha>(F, [&](size_t l) { return b[l].oute[i]; });
+    outa[i] = pack_plucked<BFlatSha>(F, [&](size_t l) { return b[l].outa[i]; });
+  }
+  FSHA.assert_transform_block(in.data(), H0.data(), outw.data(), oute.data(),
+                              outa.data(), H1.data());
+  EXPECT_EQ(BL.assertion_failed(), uint64_t(1) << kBad);
+  EXPECT_TRUE(field_block_fails(b[kBad]));
+}
+
+// assert_message_hash() in GF(2^128), as in the mdoc circuits, which
+// exercises the characteristic-two BitAdder.
+TEST(BitslicedLogic, FlatSha256MessageGF2_128) {
+  using f_128 = GF2_128<>;
+  const f_128 Fs;
+  using BLogic2 = BitslicedLogic<f_128>;
+  using BFlatSha2 =
+      FlatSHA256Circuit<BLogic2, BitPlucker<BLogic2, kShaPluckerSize>>;
+  using EvalBackend2 = proofs::EvaluationBackend<f_128>;
+  using Logic2 = proofs::Logic<f_128, EvalBackend2>;
+  using FlatSha2 =
+      FlatSHA256Circuit<Logic2, BitPlucker<Logic2, kShaPluckerSize>>;
+  constexpr size_t kMax = 2;
+  constexpr size_t kBad = 9;
+
+  // a message of 40 + l bytes in lane l
+  uint64_t s = 3;
+  std::vector<std::vector<uint8_t>> in(kLanes,
+                                       std::vector<uint8_t>(64 * kMax));
+  std::vector<std::vector<FlatSHA256Witness::BlockWitness>> bw(
+      kLanes, std::vector<FlatSHA256Witness::BlockWitness>(kMax));
+  uint64_t numb[kLanes];
+  uint8_t hash[kLanes][32];
+  for (size_t l = 0; l < kLanes; ++l) {
+    std::vector<uint8_t> msg(40 + l);
+    for (auto& m : msg) {
+      m = rnd(&s);
+    }
+    uint8_t nb;
+    FlatSHA256Witness::transform_and_witness_message(
+        msg.size(), msg.data(), kMax, nb, in[l].data(), bw[l].data());
+    numb[l] = nb;
+    for (size_t j = 0; j < 32; ++j) {
+      hash[l][j] = bw[l][nb - 1].h1[j / 4] >> (24 - 8 * (j % 4));
+    }
+  }
+  hash[kBad][7] ^= 0x10;
+
+  const BLogic2 BL(Fs, /*panic_on_assertion_failure=*/false);
+  const BFlatSha2 FSHA(BL);
+  std::vector<BLogic2::v8> inW(64 * kMax);
+  for (size_t j = 0; j < 64 * kMax; ++j) {
+    uint64_t x[kLanes];
+    for (size_t l = 0; l < kLanes; ++l) {
+      x[l] = in[l][j];
+    }
+    inW[j] = BL.vpack<8>(x);
+  }
+  BLogic2::v256 target;
+  for (size_t j = 0; j < 256; ++j) {
+    target[j] = BL.bit(0);
+    for (size_t l = 0; l < kLanes; ++l) {
+      target[j].w |= uint64_t((hash[l][(255 - j) / 8] >> (j % 8)) & 1) << l;
+    }
+  }
+  std::vector<BFlatSha2::BlockWitness> bwW(kMax);
+  for (size_t j = 0; j < kMax; ++j) {
+    for (size_t k = 0; k < 48; ++k) {
+      bwW[j].outw[k] = pack_plucked<BFlatSha2>(
+          Fs, [&](size_t l) { return bw[l][j].outw[k]; });
+    }
+    for (size_t k = 0; k < 64; ++k) {
+      bwW[j].oute[k] = pack_plucked<BFlatSha2>(
+          Fs, [&](size_t l) { return bw[l][j].oute[k]; });
+      bwW[j].outa[k] = pack_plucked<BFlatSha2>(
+          Fs, [&](size_t l) { return bw[l][j].outa[k]; });
+    }
+    for (size_t k = 0; k < 8; ++k) {
+      bwW[j].h1[k] = pack_plucked<BFlatSha2>(
+          Fs, [&](size_t l) { return bw[l][j].h1[k]; });
+    }
+  }
+  FSHA.assert_message_hash(kMax, BL.vpack<8>(numb), inW.data(), target,
+                           bwW.data());
+  EXPECT_EQ(BL.assertion_failed(), uint64_t(1) << kBad);
+
+  // the same instances, one at a time in the field backend
+  BitPluckerEncoder<f_128, kShaPluckerSize> BPENC(Fs);
+  for (size_t l : {size_t(0), kBad}) {
+    const EvalBackend2 ebk(Fs, /*panic_on_assertion_failure=*/false);
+    const Logic2 L(&ebk, Fs);
+    const FlatSha2 LSHA(L);
+    std::vector<Logic2::v8> linW(64 * kMax);
+    for (size_t j = 0; j < 64 * kMax; ++j) {
+      linW[j] = L.vbit8(in[l][j]);
+    }
+    Logic2::v256 ltarget;
+    for (size_t j = 0; j < 256; ++j) {
+      ltarget[j] = L.bit((hash[l][(255 - j) / 8] >> (j % 8)) & 1);
+    }
+    std::vector<FlatSha2::BlockWitness> lbw(kMax);
+    for (size_t j = 0; j < kMax; ++j) {
+      for (size_t k = 0; k < 48; ++k) {
+        lbw[j].outw[k] = L.konst(BPENC.mkpacked_v32(bw[l][j].outw[k]));
+      }
+      for (size_t k = 0; k < 64; ++k) {
+        lbw[j].oute[k] = L.konst(BPENC.mkpacked_v32(bw[l][j].oute[k]));
+        lbw[j].outa[k] = L.konst(BPENC.mkpacked_v32(bw[l][j].outa[k]));
+      }
+      for (size_t k = 0; k < 8; ++k) {
+        lbw[j].h1[k] = L.konst(BPENC.mkpacked_v32(bw[l][j].h1[k]));
+      }
+    }
+    LSHA.assert_message_hash(kMax, L.vbit8(numb[l]), linW.data(), ltarget,
+                             lbw.data());
+    EXPECT_EQ(ebk.assertion_failed(), l == kBad);
+  }
+}
+
+// The shift-and-compare step that MdocHash applies to the MSO.
+TEST(BitslicedLogic, RoutingMemcmp) {
+  const EvaluationBackend ebk(F);
+  const Logic L(&ebk, F);
+  const BLogic BL(F);
+  constexpr size_t kLogN = 6, kN = 1 << kLogN, kK = 24, kCmp = 4;
+
+  uint64_t s = 4;
+  std::vector<BLogic::v8> A(kN);
+  for (auto& a : A) {
+    a = random_bits<8>(&s);
+  }
+  BLogic::v8 now[kCmp];
+  for (auto& n : now) {
+    n = random_bits<8>(&s);
+  }
+  // make the first bytes equal in some lanes so that memcmp looks further
+  for (size_t i = 0; i < 8; ++i) {
+    now[0][i].w = (now[0][i].w & 0xffffffff00000000ull) |
+                  (A[0][i].w & 0x00000000ffffffffull);
+  }
+  auto amount = random_bits<kLogN>(&s);
+  for (size_t i = 0; i < kLogN; ++i) {
+    amount[i].w &= 0xffffffffull;  // shift by 0 in the upper lanes
+  }
+
+  const Routing<BLogic> BR(BL);
+  const Memcmp<BLogic> BCMP(BL);
+  std::vector<BLogic::v8> B(kK);
+  BR.shift(amount, kK, B.data(), kN, A.data(), BL.vbit8(0), /*unroll=*/3);
+  auto blt = BCMP.lt(kCmp, B.data(), now);
+  auto bleq = BCMP.leq(kCmp, B.data(), now);
+
+  const Routing<Logic> R(L);
+  const Memcmp<Logic> CMP(L);
+  for (size_t l = 0; l < kLanes; ++l) {
+    std::vector<Logic::v8> lA(kN), lB(kK);
+    for (size_t i = 0; i < kN; ++i) {
+      lA[i] = lane_bits(L, A[i], l);
+    }
+    Logic::v8 lnow[kCmp];
+    for (size_t i = 0; i < kCmp; ++i) {
+      lnow[i] = lane_bits(L, now[i], l);
+    }
+    R.shift(lane_bits(L, amount, l), kK, lB.data(), kN, lA.data(), L.vbit8(0),
+            /*unroll=*/3);
+    for (size_t i = 0; i < kK; ++i) {
+      expect_lane_eq(L, lB[i], B[i], l);
+    }
+    EXPECT_EQ(L.eval(CMP.lt(kCmp, lB.data(), lnow)).elt() == F.one(),
+              lane(blt, l));
+    EXPECT_EQ(L.eval(CMP.leq(kCmp, lB.data(), lnow)).elt() == F.one(),
+              lane(bleq, l));
+  }
+}
+
+TEST(BitslicedLogic, MdocHashInstantiates) {
+  // MdocHash is written against the Logic interface, and must compile
+  // unchanged with BitslicedLogic.
+  auto f = &MdocHash<BLogic, Field>::assert_valid_hash_mdoc;
+  EXPECT_NE(f, nullptr);
+}
+
+TEST(BitslicedLogic, Arithmetic) {
+  const EvaluationBackend ebk(F);
+  const Logic L(&ebk, F);
+  const BLogic BL(F);
+
+  uint64_t s = 5;
+  auto a = random_bits<8>(&s);
+  auto b = random_bits<8>(&s);
+  auto sum = BL.vadd(a, b);
+  BLogic::bitvec<16> prod, gprod;
+  BL.multiplier(8, &prod[0], &a[0], &b[0]);
+  BL.gf2_polynomial_multiplier_karat(8, &gprod[0], &a[0], &b[0]);
+  BL.assert_sum(8, &sum[0], &a[0], &b[0]);
+
+  auto x = random_bits<128>(&s);
+  auto y = random_bits<128>(&s);
+  BLogic::v128 xy;
+  BL.gf2_128_mul(xy, x, y);
+
+  auto v = random_bits<32>(&s);
+  BLogic::v32 sand = v, sor = v, sxor = v;
+  BL.scan_and(&sand[0], 0, 32);
+  BL.scan_or(&sor[0], 0, 32, /*backward=*/true);
+  BL.scan_xor(&sxor[0], 0, 32);
+
+  auto ra = BL.land(0, 8, [&](size_t i) { return a[i]; });
+  auto ro = BL.lor(0, 8, [&](size_t i) { return a[i]; });
+  auto rs = BL.add(0, 8, [&](size_t i) { return BL.eval(a[i]); });
+  const auto bone = BL.konst(BL.one());
+  auto rm =
+      BL.mul(0, 8, [&](size_t i) { return BL.add(&bone, BL.eval(a[i])); });
+  auto roa = BL.or_of_and({{a[0], b[0]}, {a[1], b[1], a[2]}});
+
+  for (size_t l = 0; l < kLanes; ++l) {
+    auto la = lane_bits(L, a, l);
+    auto lb = lane_bits(L, b, l);
+    Logic::bitvec<16> lprod, lgprod;
+    L.multiplier(8, &lprod[0], &la[0], &lb[0]);
+    L.gf2_polynomial_multiplier(8, &lgprod[0], &la[0], &lb[0]);
+    expect_lane_eq(L, lprod, prod, l);
+    expect_lane_eq(L, lgprod, gprod, l);
+
+    Logic::v128 lxy;
+    L.gf2_128_mul(lxy, lane_bits(L, x, l), lane_bits(L, y, l));
+    expect_lane_eq(L, lxy, xy, l);
+
+    Logic::v32 lsand = lane_bits(L, v, l), lsor = lsand, lsxor = lsand;
+    L.scan_and(&lsand[0], 0, 32);
+    L.scan_or(&lsor[0], 0, 32, /*backward=*/true);
+    L.scan_xor(&lsxor[0], 0, 32);
+    expect_lane_eq(L, lsand, sand, l);
+    expect_lane_eq(L, lsor, sor, l);
+    expect_lane_eq(L, lsxor, sxor, l);
+
+    auto lra = L.land(0, 8, [&](size_t i) { return la[i]; });
+    auto lro = L.lor(0, 8, [&](size_t i) { return la[i]; });
+    auto lrs = L.add(0, 8, [&](size_t i) { return L.eval(la[i]); });
+    const auto lone = L.konst(L.one());
+    auto lrm =
+        L.mul(0, 8, [&](size_t i) { return L.add(&lone, L.eval(la[i])); });
+    auto lroa = L.or_of_and({{la[0], lb[0]}, {la[1], lb[1], la[2]}});
+    EXPECT_EQ(L.eval(lra).elt() == F.one(), lane(ra, l));
+    EXPECT_EQ(L.eval(lro).elt() == F.one(), lane(ro, l));
+    EXPECT_EQ(L.eval(lroa).elt() == F.one(), lane(roa, l));
+    EXPECT_EQ(lrs.elt(), rs.e[l]);
+    EXPECT_EQ(lrm.elt(), rm.e[l]);
+  }
+}
+
+TEST(BitslicedLogic, Bitvec) {
+  const EvaluationBackend ebk(F);
+  const Logic L(&ebk, F);
+  const BLogic BL(F);
+
+  uint64_t s = 2;
+  uint64_t x[kLanes], y[kLanes], z[kLanes];
+  for (size_t l = 0; l < kLanes; ++l) {
+    x[l] = rnd(&s) & 0xff;
+    // force some equal pairs
+    y[l] = (l % 4 == 0) ? x[l] : rnd(&s) & 0xff;
+    z[l] = rnd(&s) & 0xff;
+  }
+  auto bx = BL.vpack<8>(x);
+  auto by = BL.vpack<8>(y);
+  auto bz = BL.vpack<8>(z);
+
+  uint64_t sum[kLanes], diff[kLanes];
+  BL.vunpack(sum, BL.vadd(bx, by));
+  BLogic::v8 bd;
+  (void)BL.ripple_carry_sub(8, &bd[0], &bx[0], &by[0]);
+  BL.vunpack(diff, bd);
+  auto beq = BL.veq(&bx, by);
+  auto blt = BL.vlt(&bx, by);
+  auto bleq = BL.vleq(&bx, by);
+  auto bmask = BL.veqmask(&bx, 0x0f, by);
+  auto bsel = BL.mux(&blt, &bz[0], BL.bit(0));
+  auto bscalar = BL.as_scalar(bx);
+  auto ex = BL.konst(7);
+  auto bmuxe = BL.mux(&blt, &ex, BL.konst(9));
+
+  for (size_t l = 0; l < kLanes; ++l) {
+    auto lx = L.vbit8(x[l]);
+    auto ly = L.vbit8(y[l]);
+    auto lz = L.vbit8(z[l]);
+    EXPECT_EQ(value(L, L.vadd(lx, ly)), sum[l]);
+    Logic::v8 ld;
+    (void)L.parallel_prefix_sub(8, &ld[0], &lx[0], &ly[0]);
+    EXPECT_EQ(value(L, ld), diff[l]);
+
+    auto lt = L.vlt(&lx, ly);
+    EXPECT_EQ(L.eval(L.veq(&lx, ly)).elt() == F.one(), lane(beq, l));
+    EXPECT_EQ(L.eval(lt).elt() == F.one(), lane(blt, l));
+    EXPECT_EQ(L.eval(L.vleq(&lx, ly)).elt() == F.one(), lane(bleq, l));
+    EXPECT_EQ(L.eval(L.veqmask(&lx, 0x0f, ly)).elt() == F.one(),
+              lane(bmask, l));
+    auto lsel = L.mux(&lt, &lz[0], L.bit(0));
+    EXPECT_EQ(L.eval(lsel).elt() == F.one(), lane(bsel, l));
+    EXPECT_EQ(L.as_scalar(lx).elt(), bscalar.e[l]);
+    EXPECT_EQ(bmuxe.e[l], F.of_scalar((x[l] < y[l]) ? 7 : 9));
+  }
+}
+
+TEST(BitslicedLogic, Assertions) {
+  const BLogic BL(F, /*panic_on_assertion_failure=*/false);
+  uint64_t x[kLanes];
+  for (size_t l = 0; l < kLanes; ++l) {
+    x[l] = l;
+  }
+  auto bx = BL.vpack<8>(x);
+  BL.vassert_eq(bx, 5);
+  EXPECT_EQ(BL.assertion_failed(), ~(uint64_t(1) << 5));
+
+  BL.assert_eq(&bx[0], bx[0]);
+  EXPECT_EQ(BL.assertion_failed(), 0);
+
+  auto e = BL.eval(bx[1]);
+  BL.assert_is_bit(e);
+  (void)BL.assert0(e);
+  EXPECT_EQ(BL.assertion_failed(), 0xccccccccccccccccull);
+
+  // BitW(EltW, F) inverts eval()
+  EXPECT_EQ(BLogic::BitW(e, F).w, bx[1].w);
+
+  const BLogic BLP(F);
+  EXPECT_DEATH(BLP.assert0(BLP.bit(1)), "a != F.zero()");
+}
+
+void BM_FlatSha256Logic(benchmark::State& state) {
+  auto b = random_blocks(6);
+  const EvaluationBackend ebk(F);
+  const Logic L(&ebk, F);
+  const FlatSha FSHA(L);
+  std::vector<Logic::v32> in(16), H0(8), outw(48), oute(64), outa(64), H1(8);
+  for (auto _ : state) {
+    // kLanes instances, one at a time
+    for (size_t l = 0; l < kLanes; ++l) {
+      for (size_t i = 0; i < 16; ++i) {
+        in[i] = L.vbit32(b[l].in[i]);
+      }
+      for (size_t i = 0; i < 8; ++i) {
+        H0[i] = L.vbit32(b[l].H0[i]);
+        H1[i] = L.vbit32(b[l].H1[i]);
+      }
+      for (size_t i = 0; i < 48; ++i) {
+        outw[i] = L.vbit32(b[l].outw[i]);
+      }
+      for (size_t i = 0; i < 64; ++i) {
+        oute[i] = L.vbit32(b[l].oute[i]);
+        outa[i] = L.vbit32(b[l].outa[i]);
+      }
+      FSHA.assert_transform_block(in.data(), H0.data(), outw.data(),
+                                  oute.data(), outa.data(), H1.data());
+    }
+  }
+}
+BENCHMARK(BM_FlatSha256Logic);
+
+void BM_FlatSha256Bitsliced(benchmark::State& state) {
+  auto b = random_blocks(6);
+  const BLogic BL(F);
+  const BFlatSha FSHA(BL);
+  std::vector<BLogic::v32> in(16), H0(8), outw(48), oute(64), outa(64), H1(8);
+  for (auto _ : state) {
+    for (size_t i = 0; i < 16; ++i) {
+      in[i] = pack32(BL, [&](size_t l) { return b[l].in[i]; });
+    }
+    for (size_t i = 0; i < 8; ++i) {
+      H0[i] = pack32(BL, [&](size_t l) { return b[l].H0[i]; });
+      H1[i] = pack32(BL, [&](size_t l) { return b[l].H1[i]; });
+    }
+    for (size_t i = 0; i < 48; ++i) {
+      outw[i] = pack32(BL, [&](size_t l) { return b[l].outw[i]; });
+    }
+    for (size_t i = 0; i < 64; ++i) {
+      oute[i] = pack32(BL, [&](size_t l) { return b[l].oute[i]; });
+      outa[i] = pack32(BL, [&](size_t l) { return b[l].outa[i]; });
+    }
+    FSHA.assert_transform_block(in.data(), H0.data(), outw.data(),
+                                oute.data(), outa.data(), H1.data());
+  }
+}
+BENCHMARK(BM_FlatSha256Bitsliced);
+
+}  // namespace
+}  // namespace proofs
@@ -14,7 +14,8 @@
 
 // This program generates a circuit for mdoc_zk, computes its ID, and writes
 // the circuit to a file named after the circuit ID in a specified output
-// directory.
+// directory.  With --all_specs, it regenerates the circuit of every
+// latest-version entry of kZkSpecs, in parallel.
 
 #include <cstddef>
 #include <cstdint>
@@ -23,6 +24,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <ostream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -40,12 +42,16 @@
 #include "gf2k/gf2_128.h"
 #include "ligero/ligero_param.h"
 #include "proto/circuit.h"
+#include "util/parallel.h"
 
 
 ABSL_FLAG(std::string, output_dir, "circuits",
           "Output directory for the circuit file");
 ABSL_FLAG(int, num_attributes, 1,
           "Number of attributes for the circuit (selects ZkSpec)");
+ABSL_FLAG(bool, all_specs, false,
+          "Regenerate the circuits of all latest-version ZkSpecs in parallel, "
+          "ignoring --num_attributes.  Each generation needs about 1.5GB.");
 
 std::string BytesToHexString(const uint8_t* bytes, size_t len) {
   std::stringstream ss;
@@ -75,7 +81,7 @@ size_t optimize(LigeroParam &lp) {
 // commitment parameters and print a ZkSpecStruct entry.
 void optimize_params(const uint8_t* circuit_bytes, size_t circuit_len,
                      const std::string& circuit_id_hex,
-                     const ZkSpecStruct* zk_spec) {
+                     const ZkSpecStruct* zk_spec, std::ostream& out) {
   using f_128 = proofs::GF2_128<>;
   // Parse circuits.
   const f_128 Fs;
@@ -103,14 +109,14 @@ void optimize_params(const uint8_t* circuit_bytes, size_t circuit_len,
       c_hash->nl, kLigeroRate, kLigeroNreq);
 
   size_t min_proof_size = hp.layout(hp.block_enc);
-  std::cout << "  hash legacy parameters: be:" << hp.block_enc
-            << " sz:" << min_proof_size << " r:" << hp.r << " w:" << hp.w
-            << " b:" << hp.block << " nr:" << hp.nrow << " nq:" << hp.nqtriples
-            << std::endl;
+  out << "  hash legacy parameters: be:" << hp.block_enc
+      << " sz:" << min_proof_size << " r:" << hp.r << " w:" << hp.w
+      << " b:" << hp.block << " nr:" << hp.nrow << " nq:" << hp.nqtriples
+      << std::endl;
   size_t best_block_enc = optimize(hp);
   min_proof_size = hp.layout(best_block_enc);
-  std::cout << "  hash   best parameters: be:" << best_block_enc
-            << " sz:" << min_proof_size << std::endl;
+  out << "  hash   best parameters: be:" << best_block_enc
+      << " sz:" << min_proof_size << std::endl;
 
   proofs::LigeroParam<proofs::Fp256Base> sp(
       (c_sig->ninputs - c_sig->npub_in) +
@@ -119,21 +125,21 @@ void optimize_params(const uint8_t* circuit_bytes, size_t circuit_len,
 
   min_proof_size = sp.layout(sp.block_enc);
 
-  std::cout << "   sig legacy parameters: be:" << sp.block_enc
-            << " sz:" << min_proof_size << " r:" << sp.r << " w:" << sp.w
-            << " b:" << sp.block << " nr:" << sp.nrow << " nq:" << sp.nqtriples
-            << std::endl;
+  out << "   sig legacy parameters: be:" << sp.block_enc
+      << " sz:" << min_proof_size << " r:" << sp.r << " w:" << sp.w
+      << " b:" << sp.block << " nr:" << sp.nrow << " nq:" << sp.nqtriples
+      << std::endl;
 
   size_t sig_best_block_enc = optimize(sp);
   min_proof_size = sp.layout(sig_best_block_enc);
 
-  std::cout << "   sig   best parameters: be:" << sig_best_block_enc
-            << " sz:" << min_proof_size << std::endl;
+  out << "   sig   best parameters: be:" << sig_best_block_enc
+      << " sz:" << min_proof_size << std::endl;
 
-  std::cout << "{\"" << zk_spec->system << "\", \"" << circuit_id_hex << "\", "
-            << zk_spec->num_attributes << ", " << zk_spec->version << ", "
-            << best_block_enc << ", " << sig_best_block_enc << "},"
-            << std::endl;
+  out << "{\"" << zk_spec->system << "\", \"" << circuit_id_hex << "\", "
+      << zk_spec->num_attributes << ", " << zk_spec->version << ", "
+      << best_block_enc << ", " << sig_best_block_enc << "},"
+      << std::endl;
 }
 
 // Helper to find a ZkSpecStruct matching the desired number of attributes.
@@ -148,35 +154,14 @@ const ZkSpecStruct* FindZkSpecByNumAttributes(int n_attrs) {
   return nullptr;  // Or handle as an error, or pick a default.
 }
 
-int main(int argc, char* argv[]) {
-  absl::ParseCommandLine(argc, argv);
-  proofs::set_log_level(proofs::ERROR);
-
-  std::string output_dir_path = absl::GetFlag(FLAGS_output_dir);
-  int n_attributes_requested = absl::GetFlag(FLAGS_num_attributes);
-  std::cout << "Output directory: " << output_dir_path << std::endl;
-  std::cout << "Requested number of attributes: " << n_attributes_requested
-            << std::endl;
-
-  // Find a ZkSpecStruct based on the number of attributes requested
-  const ZkSpecStruct* selected_zk_spec =
-      FindZkSpecByNumAttributes(n_attributes_requested);
-  if (selected_zk_spec == nullptr) {
-    std::cerr << "Error: No ZkSpec available in kZkSpecs array." << std::endl;
-    return 1;
-  }
-
-  std::cout << "Using ZkSpec: " << selected_zk_spec->system
-            << ", version: " << selected_zk_spec->version
-            << ", attributes: " << selected_zk_spec->num_attributes
-            << std::endl;
-
-  std::ifstream dir(output_dir_path, std::ios::binary);
-  if (!dir.is_open()) {
-    std::cerr << "Error: Could not open dir  " << output_dir_path << std::endl;
-    return 1;
-  }
-  dir.close();
+// Generate the circuit for ZK_SPEC, write it to OUTPUT_DIR, and print
+// the optimized ZkSpecStruct entry.  Progress goes to OUT and errors
+// to ERR.  Returns the process exit code.
+int make_circuit(const ZkSpecStruct* zk_spec, const std::string& output_dir,
+                 std::ostream& out, std::ostream& err) {
+  out << "Using ZkSpec: " << zk_spec->system
+      << ", version: " << zk_spec->version
+      << ", attributes: " << zk_spec->num_attributes << std::endl;
 
   uint8_t* circuit_bytes = nullptr;
   size_t circuit_len = 0;
@@ -187,56 +172,130 @@ int main(int argc, char* argv[]) {
     }
   };
 
-  std::cout << "Generating circuit..." << std::endl;
+  out << "Generating circuit..." << std::endl;
   CircuitGenerationErrorCode circuit_gen_status =
-      generate_circuit(selected_zk_spec, &circuit_bytes, &circuit_len);
+      generate_circuit(zk_spec, &circuit_bytes, &circuit_len);
   if (circuit_gen_status != CIRCUIT_GENERATION_SUCCESS) {
-    std::cerr << "Error generating circuit. Code: " << circuit_gen_status
-              << std::endl;
+    err << "Error generating circuit. Code: " << circuit_gen_status
+        << std::endl;
     return 1;
   }
   if (circuit_bytes == nullptr || circuit_len == 0) {
-    std::cerr << "Error: generate_circuit succeeded but output is empty."
-              << std::endl;
+    err << "Error: generate_circuit succeeded but output is empty."
+        << std::endl;
     return 1;
   }
-  std::cout << "Circuit generated successfully. Size: " << circuit_len
-            << " bytes." << std::endl;
+  out << "Circuit generated successfully. Size: " << circuit_len
+      << " bytes." << std::endl;
 
   // Compute circuit ID.
   constexpr size_t kSHA256DigestSize = 32;
   uint8_t c_id[kSHA256DigestSize];
-  std::cout << "Computing circuit ID." << std::endl;
-  if (!circuit_id(c_id, circuit_bytes, circuit_len, selected_zk_spec)) {
-    std::cerr << "Error computing circuit ID." << std::endl;
+  out << "Computing circuit ID." << std::endl;
+  if (!circuit_id(c_id, circuit_bytes, circuit_len, zk_spec)) {
+    err << "Error computing circuit ID." << std::endl;
     return 1;
   }
   std::string circuit_id_hex = BytesToHexString(c_id, kSHA256DigestSize);
-  std::cout << "Circuit ID (hex): " << circuit_id_hex << std::endl;
+  out << "Circuit ID (hex): " << circuit_id_hex << std::endl;
 
   // Write circuit bytes to file.
   namespace fs = std::filesystem;
-  std::string output_file_path = (fs::path(output_dir_path) / fs::path(circuit_id_hex)).string();
-  std::cout << "Writing circuit to: " << output_file_path << std::endl;
+  std::string output_file_path =
+      (fs::path(output_dir) / fs::path(circuit_id_hex)).string();
+  out << "Writing circuit to: " << output_file_path << std::endl;
   std::ofstream out_file(output_file_path, std::ios::binary | std::ios::trunc);
   if (!out_file.is_open()) {
-    std::cerr << "Error: Could not open file for writing: " << output_file_path
-              << std::endl;
+    err << "Error: Could not open file for writing: " << output_file_path
+        << std::endl;
     return 1;
   }
   out_file.write(reinterpret_cast<const char*>(circuit_bytes), circuit_len);
   if (!out_file) {  // Check for write errors
-    std::cerr << "Error writing circuit to file: " << output_file_path
-              << std::endl;
+    err << "Error writing circuit to file: " << output_file_path
+        << std::endl;
     out_file.close();
     return 1;
   }
   out_file.close();
-  std::cout << "Circuit successfully written to " << output_file_path
-            << std::endl;
+  out << "Circuit successfully written to " << output_file_path
+      << std::endl;
 
   // Search for optimal Ligero parameters.
-  std::cout << "Optimizing Ligero parameters..." << std::endl;
-  optimize_params(circuit_bytes, circuit_len, circuit_id_hex, selected_zk_spec);
+  out << "Optimizing Ligero parameters..." << std::endl;
+  optimize_params(circuit_bytes, circuit_len, circuit_id_hex, zk_spec, out);
   return 0;
 }
+
+// Regenerate all specs that generate_circuit() supports, namely the
+// latest version for each number of attributes.  Each job writes to
+// its own streams, which are printed in kZkSpecs order at the end so
+// that the output of concurrent jobs is not interleaved.
+int make_all_circuits(const std::string& output_dir) {
+  std::vector<const ZkSpecStruct*> specs;
+  for (size_t i = 0; i < kNumZkSpecs; ++i) {
+    bool latest = true;
+    for (size_t j = 0; j < kNumZkSpecs; ++j) {
+      if (kZkSpecs[j].num_attributes == kZkSpecs[i].num_attributes &&
+          kZkSpecs[j].version > kZkSpecs[i].version) {
+        latest = false;
+      }
+    }
+    if (latest) {
+      specs.push_back(&kZkSpecs[i]);
+    } else {
+      std::cout << "Skipping ZkSpec version " << kZkSpecs[i].version
+                << " for " << kZkSpecs[i].num_attributes
+                << " attributes, which is not the latest." << std::endl;
+    }
+  }
+
+  std::vector<std::ostringstream> outs(specs.size()), errs(specs.size());
+  std::vector<int> status(specs.size());
+  proofs::parallel_for(specs.size(), [&](size_t i) {
+    status[i] = make_circuit(specs[i], output_dir, outs[i], errs[i]);
+  });
+
+  int ret = 0;
+  for (size_t i = 0; i < specs.size(); ++i) {
+    std::cout << outs[i].str();
+    std::cerr << errs[i].str();
+    if (status[i] != 0) {
+      ret = status[i];
+    }
+  }
+  return ret;
+}
+
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
+  proofs::set_log_level(proofs::ERROR);
+
+  std::string output_dir_path = absl::GetFlag(FLAGS_output_dir);
+  std::cout << "Output directory: " << output_dir_path << std::endl;
+
+  std::ifstream dir(output_dir_path, std::ios::binary);
+  if (!dir.is_open()) {
+    std::cerr << "Error: Could not open dir  " << output_dir_path << std::endl;
+    return 1;
+  }
+  dir.close();
+
+  if (absl::GetFlag(FLAGS_all_specs)) {
+    return make_all_circuits(output_dir_path);
+  }
+
+  int n_attributes_requested = absl::GetFlag(FLAGS_num_attributes);
+  std::cout << "Requested number of attributes: " << n_attributes_requested
+            << std::endl;
+
+  // Find a ZkSpecStruct based on the number of attributes requested
+  const ZkSpecStruct* selected_zk_spec =
+      FindZkSpecByNumAttributes(n_attributes_requested);
+  if (selected_zk_spec == nullptr) {
+    std::cerr << "Error: No ZkSpec available in kZkSpecs array." << std::endl;
+    return 1;
+  }
+
+  return make_circuit(selected_zk_spec, output_dir_path, std::cout, std::cerr);
+}
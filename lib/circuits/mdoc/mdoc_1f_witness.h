@@ -187,7 +187,6 @@ class mdoc_1f_witness {
     const size_t l = pm_.sig_.len;
     Nat nr = nat_from_be<Nat>(&mdoc[pm_.sig_.pos]);
     Nat ns = nat_from_be<Nat>(&mdoc[pm_.sig_.pos + l / 2]);
-    ew_.compute_witness(pkX, pkY, ne, nr, ns);
 
     Nat ne2 = compute_transcript_hash<Nat>(transcript, tlen, &pm_.doc_type_);
     const size_t l2 = pm_.dksig_.len;
@@ -199,7 +198,12 @@ class mdoc_1f_witness {
     dpky_ = ec_.f_.to_montgomery(
         nat_from_be<Nat>(&mdoc[pmso + pm_.dev_key_pky_.pos]));
     e2_ = ec_.f_.to_montgomery(ne2);
-    dkw_.compute_witness(dpkx_, dpky_, ne2, nr2, ns2);
+
+    // Both signatures in one batch, which shares the inversions.
+    typename EcdsaWitness::Signature sig[] = {{pkX, pkY, ne, nr, ns},
+                                              {dpkx_, dpky_, ne2, nr2, ns2}};
+    EcdsaWitness* w[] = {&ew_, &dkw_};
+    EcdsaWitness::compute_witness(2, w, sig);
 
     memcpy(now_, tnow, kMdoc1DateLen);
     std::vector<uint8_t> buf;
@@ -233,14 +237,16 @@ class mdoc_1f_witness {
       atw_[i].resize(2);
     }
 
-    // Match the attributes with the witnesses from the deviceResponse.
+    // Match the attributes with the witnesses from the deviceResponse,
+    // and then hash all of the matched attributes together.
+    std::vector<size_t> msg_n(num_attr_);
+    std::vector<const uint8_t*> msg(num_attr_);
     for (size_t i = 0; i < num_attr_; ++i) {
       bool found = false;
       for (auto fa : pm_.attributes_) {
         if (fa == attrs[i]) {
-          FlatSHA256Witness::transform_and_witness_message(
-              fa.tag_len, &fa.doc[fa.tag_ind], 2, attr_n_[i],
-              &attr_bytes_[i][0], &atw_[i][0]);
+          msg_n[i] = fa.tag_len;
+          msg[i] = &fa.doc[fa.tag_ind];
           attr_mso_[i] = fa.mso;
           attr_ei_[i].offset = fa.id_ind - fa.tag_ind;
 
@@ -264,6 +270,16 @@ class mdoc_1f_witness {
         return false;
       }
     }
+
+    std::vector<uint8_t*> in(num_attr_);
+    std::vector<FlatSHA256Witness::BlockWitness*> bw(num_attr_);
+    for (size_t i = 0; i < num_attr_; ++i) {
+      in[i] = &attr_bytes_[i][0];
+      bw[i] = &atw_[i][0];
+    }
+    FlatSHA256Witness::transform_and_witness_messages(
+        num_attr_, msg_n.data(), msg.data(), 2, attr_n_.data(), in.data(),
+        bw.data());
     return true;
   }
 };
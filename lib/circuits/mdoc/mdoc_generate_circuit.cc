@@ -19,6 +19,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "circuits/compiler/circuit_dump.h"
@@ -37,12 +38,124 @@
 #include "sumcheck/circuit_id.h"
 #include "util/crypto.h"
 #include "util/log.h"
+#include "util/parallel.h"
 #include "zstd.h"
 
 namespace proofs {
 
 using f_128 = GF2_128<>;
 
+namespace {
+
+// Number of zstd compression workers, see generate_circuit().
+constexpr int kZstdWorkers = 4;
+
+// Compile the signature circuit and append its serialization to BYTES.
+void generate_sig_circuit(std::vector<uint8_t>& bytes) {
+  using CompilerBackend = CompilerBackend<Fp256Base>;
+  using LogicCircuit = Logic<Fp256Base, CompilerBackend>;
+  using EltW = LogicCircuit::EltW;
+  using MACTag = LogicCircuit::v128;
+  using MdocSignature = MdocSignature<LogicCircuit, Fp256Base, P256>;
+  QuadCircuit<Fp256Base> Q(p256_base);
+  const CompilerBackend cbk(&Q);
+  const LogicCircuit lc(&cbk, p256_base);
+  MdocSignature mdoc_s(lc, p256, n256_order);
+
+  EltW pkX = lc.eltw_input(), pkY = lc.eltw_input(), htr = lc.eltw_input();
+  MACTag mac[7]; /* 3 macs + av */
+  for (size_t i = 0; i < 7; ++i) {
+    mac[i] = lc.vinput<128>();
+  }
+  Q.private_input();
+
+  // Allocate this large object on heap.
+  auto w = std::make_unique<MdocSignature::Witness>();
+  w->input(lc);
+  mdoc_s.assert_signatures(pkX, pkY, htr, &mac[0], &mac[2], &mac[4], mac[6],
+                           *w);
+
+  auto circ = Q.mkcircuit(/*nc=*/1);
+  dump_info("sig", Q);
+  CircuitRep<Fp256Base> cr(p256_base, P256_ID);
+  cr.to_bytes(*circ, bytes);
+  uint8_t id[kSHA256DigestSize];
+  char buf[100];
+  circuit_id<Fp256Base>(id, *circ, p256_base);
+  hex_to_str(buf, id, kSHA256DigestSize);
+  log(INFO, "sig bytes: %zu id:%s", bytes.size(), buf);
+}
+
+// Compile the hash circuit and append its serialization to BYTES.
+void generate_hash_circuit(size_t number_of_attributes,
+                           std::vector<uint8_t>& bytes) {
+  const f_128 Fs;
+
+  using CompilerBackend = CompilerBackend<f_128>;
+  using LogicCircuit = Logic<f_128, CompilerBackend>;
+  using v8 = LogicCircuit::v8;
+  using v256 = LogicCircuit::v256;
+  using MdocHash = MdocHash<LogicCircuit, f_128>;
+  using MacBitPlucker = BitPlucker<LogicCircuit, kMACPluckerBits>;
+  using MAC = MACGF2<CompilerBackend, MacBitPlucker>;
+  using MACWitness = typename MAC::Witness;
+  using MACTag = MAC::v128;
+
+  QuadCircuit<f_128> Q(Fs);
+  const CompilerBackend cbk(&Q);
+  const LogicCircuit lc(&cbk, Fs);
+  MAC mac_check(lc);
+
+  std::vector<MdocHash::OpenedAttribute> oa(number_of_attributes);
+  MdocHash mdoc_h(lc);
+  for (size_t ai = 0; ai < number_of_attributes; ++ai) {
+    oa[ai].input(lc);
+  }
+  v8 now[20];
+  for (size_t i = 0; i < 20; ++i) {
+    now[i] = lc.template vinput<8>();
+  }
+
+  MACTag mac[7]; /* 3 macs + av */
+  for (size_t i = 0; i < 7; ++i) {
+    mac[i] = lc.eltw_input();
+  }
+
+  Q.private_input();
+  v256 e = lc.template vinput<256>();
+  v256 dpkx = lc.template vinput<256>();
+  v256 dpky = lc.template vinput<256>();
+
+  // Allocate this large object on heap.
+  auto w = std::make_unique<MdocHash::Witness>(number_of_attributes);
+  w->input(lc);
+
+  Q.begin_full_field();
+  MACWitness macw[3]; /* MACs for e, dpkx, dpky */
+  for (size_t i = 0; i < 3; ++i) {
+    macw[i].input(lc);
+  }
+
+  mdoc_h.assert_valid_hash_mdoc(oa.data(), now, e, dpkx, dpky, *w);
+
+  MACTag a_v = mac[6];
+  mac_check.verify_mac(&mac[0], a_v, e, macw[0]);
+  mac_check.verify_mac(&mac[2], a_v, dpkx, macw[1]);
+  mac_check.verify_mac(&mac[4], a_v, dpky, macw[2]);
+
+  auto circ = Q.mkcircuit(/*nc=*/1);
+  dump_info("hash", Q);
+  CircuitRep<f_128> cr(Fs, GF2_128_ID);
+  cr.to_bytes(*circ, bytes);
+  uint8_t id[kSHA256DigestSize];
+  char buf[100];
+  circuit_id<f_128>(id, *circ, Fs);
+  hex_to_str(buf, id, kSHA256DigestSize);
+  log(INFO, "hash bytes:%zu id:%s", bytes.size(), buf);
+}
+
+}  // namespace
+
 extern "C" {
 /*
 API version that uses 2 circuits over different fields.
@@ -76,108 +189,19 @@ CircuitGenerationErrorCode generate_circuit(const ZkSpecStruct* zk_spec,
 
   size_t number_of_attributes = zk_spec->num_attributes;
 
-  std::vector<uint8_t> bytes;
-
-  // ======== serialize signature circuit =========================
-  {
-    using CompilerBackend = CompilerBackend<Fp256Base>;
-    using LogicCircuit = Logic<Fp256Base, CompilerBackend>;
-    using EltW = LogicCircuit::EltW;
-    using MACTag = LogicCircuit::v128;
-    using MdocSignature = MdocSignature<LogicCircuit, Fp256Base, P256>;
-    QuadCircuit<Fp256Base> Q(p256_base);
-    const CompilerBackend cbk(&Q);
-    const LogicCircuit lc(&cbk, p256_base);
-    MdocSignature mdoc_s(lc, p256, n256_order);
-
-    EltW pkX = lc.eltw_input(), pkY = lc.eltw_input(), htr = lc.eltw_input();
-    MACTag mac[7]; /* 3 macs + av */
-    for (size_t i = 0; i < 7; ++i) {
-      mac[i] = lc.vinput<128>();
-    }
-    Q.private_input();
-
-    // Allocate this large object on heap.
-    auto w = std::make_unique<MdocSignature::Witness>();
-    w->input(lc);
-    mdoc_s.assert_signatures(pkX, pkY, htr, &mac[0], &mac[2], &mac[4], mac[6],
-                             *w);
-
-    auto circ = Q.mkcircuit(/*nc=*/1);
-    dump_info("sig", Q);
-    CircuitRep<Fp256Base> cr(p256_base, P256_ID);
-    cr.to_bytes(*circ, bytes);
-    uint8_t id[kSHA256DigestSize];
-    char buf[100];
-    circuit_id<Fp256Base>(id, *circ, p256_base);
-    hex_to_str(buf, id, kSHA256DigestSize);
-    log(INFO, "sig bytes: %zu id:%s", bytes.size(), buf);
-  }
-  {
-    const f_128 Fs;
-
-    using CompilerBackend = CompilerBackend<f_128>;
-    using LogicCircuit = Logic<f_128, CompilerBackend>;
-    using v8 = LogicCircuit::v8;
-    using v256 = LogicCircuit::v256;
-    using MdocHash = MdocHash<LogicCircuit, f_128>;
-    using MacBitPlucker = BitPlucker<LogicCircuit, kMACPluckerBits>;
-    using MAC = MACGF2<CompilerBackend, MacBitPlucker>;
-    using MACWitness = typename MAC::Witness;
-    using MACTag = MAC::v128;
-
-    QuadCircuit<f_128> Q(Fs);
-    const CompilerBackend cbk(&Q);
-    const LogicCircuit lc(&cbk, Fs);
-    MAC mac_check(lc);
-
-    std::vector<MdocHash::OpenedAttribute> oa(number_of_attributes);
-    MdocHash mdoc_h(lc);
-    for (size_t ai = 0; ai < number_of_attributes; ++ai) {
-      oa[ai].input(lc);
-    }
-    v8 now[20];
-    for (size_t i = 0; i < 20; ++i) {
-      now[i] = lc.template vinput<8>();
-    }
-
-    MACTag mac[7]; /* 3 macs + av */
-    for (size_t i = 0; i < 7; ++i) {
-      mac[i] = lc.eltw_input();
-    }
-
-    Q.private_input();
-    v256 e = lc.template vinput<256>();
-    v256 dpkx = lc.template vinput<256>();
-    v256 dpky = lc.template vinput<256>();
-
-    // Allocate this large object on heap.
-    auto w = std::make_unique<MdocHash::Witness>(number_of_attributes);
-    w->input(lc);
-
-    Q.begin_full_field();
-    MACWitness macw[3]; /* MACs for e, dpkx, dpky */
-    for (size_t i = 0; i < 3; ++i) {
-      macw[i].input(lc);
+  // The two circuits are independent until serialization, so
+  // compile them concurrently and concatenate the results in the
+  // order expected by the readers, signature circuit first.
+  std::vector<uint8_t> parts[2];
+  parallel_for(2, [&](size_t i) {
+    if (i == 0) {
+      generate_sig_circuit(parts[0]);
+    } else {
+      generate_hash_circuit(number_of_attributes, parts[1]);
     }
-
-    mdoc_h.assert_valid_hash_mdoc(oa.data(), now, e, dpkx, dpky, *w);
-
-    MACTag a_v = mac[6];
-    mac_check.verify_mac(&mac[0], a_v, e, macw[0]);
-    mac_check.verify_mac(&mac[2], a_v, dpkx, macw[1]);
-    mac_check.verify_mac(&mac[4], a_v, dpky, macw[2]);
-
-    auto circ = Q.mkcircuit(/*nc=*/1);
-    dump_info("hash", Q);
-    CircuitRep<f_128> cr(Fs, GF2_128_ID);
-    cr.to_bytes(*circ, bytes);
-    uint8_t id[kSHA256DigestSize];
-    char buf[100];
-    circuit_id<f_128>(id, *circ, Fs);
-    hex_to_str(buf, id, kSHA256DigestSize);
-    log(INFO, "hash bytes:%zu id:%s", bytes.size(), buf);
-  }
+  });
+  std::vector<uint8_t> bytes = std::move(parts[0]);
+  bytes.insert(bytes.end(), parts[1].begin(), parts[1].end());
 
   size_t sz = bytes.size();
   size_t buf_size = sz / 3 + 1;
@@ -187,7 +211,28 @@ CircuitGenerationErrorCode generate_circuit(const ZkSpecStruct* zk_spec,
   // wasting memory.
   uint8_t* buf = (uint8_t*)malloc(buf_size);
 
-  size_t zl = ZSTD_compress(buf, buf_size, src, sz, 16);
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  if (cctx == nullptr) {
+    log(ERROR, "zstd context allocation failed");
+    free(buf);
+    return CIRCUIT_GENERATION_ZLIB_FAILURE;
+  }
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, 16);
+  // Callers hash the compressed bytes, so they must not depend on the
+  // machine.  The worker count is pinned rather than taken from the
+  // hardware: zstd output is the same for any nbWorkers >= 1, but
+  // differs from single-threaded (nbWorkers = 0) output.  Setting the
+  // number of workers fails if libzstd was built without
+  // multithreading support, in which case compression proceeds on
+  // this thread and yields a different, equally valid, frame.
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, kZstdWorkers);
+  size_t zl = ZSTD_compress2(cctx, buf, buf_size, src, sz);
+  ZSTD_freeCCtx(cctx);
+  if (ZSTD_isError(zl)) {
+    log(ERROR, "zstd compression failed: %s", ZSTD_getErrorName(zl));
+    free(buf);
+    return CIRCUIT_GENERATION_ZLIB_FAILURE;
+  }
   log(INFO, "zstd from %zu --> %zu", sz, zl);
   *clen = zl;
   *cb = buf;
@@ -39,6 +39,7 @@
 #include "util/log.h"
 #include "util/panic.h"
 #include "zk/zk_testing.h"
+#include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
 
 namespace proofs {
@@ -440,5 +441,15 @@ TEST(mdoc, mdoc_hash_test_fp128_2) {
       oa);
 }
 
+void BM_ParseDeviceResponse(benchmark::State& state) {
+  const MdocTests& test = mdoc_tests[state.range(0)];
+  for (auto _ : state) {
+    ParsedMdoc pm;
+    bool ok = pm.parse_device_response(test.mdoc_size, test.mdoc);
+    benchmark::DoNotOptimize(ok);
+  }
+}
+BENCHMARK(BM_ParseDeviceResponse)->Arg(0)->Arg(6);
+
 }  // namespace
 }  // namespace proofs
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "arrays/dense.h"
+#include "cbor/flat_decoder.h"
 #include "cbor/host_decoder.h"
 #include "circuits/ecdsa/verify_witness.h"
 #include "circuits/logic/bit_plucker_encoder.h"
@@ -108,182 +109,192 @@ class ParsedMdoc {
     This method produces indices into doc as state.
   */
   bool parse_device_response(size_t len, const uint8_t resp[/* len */]) {
+    using node_t = FlatCborDoc::node_t;
+    constexpr node_t kNone = FlatCborDoc::kNone;
+
+    // One arena holds the DeviceResponse and all the CBOR embedded in
+    // it.  When this object falls out of scope, all parsing objects
+    // will be garbage collected.
+    FlatCborDoc doc(resp, len);
     size_t np = 0;
-    // When this object falls out of scope, all parsing objects will be
-    // garbage collected.
-    CborDoc root;
-    bool ok = root.decode(resp, len, np, 0);
-    if (!ok) {
+    node_t root = doc.decode(np, len);
+    if (root == kNone) {
       log(ERROR, "Failed to decode root");
       return false;
     }
 
     size_t di;
-    auto docs = root.lookup(resp, 9, (uint8_t*)"documents", di);
-    if (docs == nullptr) return false;
+    auto docs = doc.lookup(root, 9, (uint8_t*)"documents", di);
+    if (docs == kNone) return false;
     // Fields of Document are "docType", "issuerSigned", "deviceSigned", ?errors
 
-    auto docs0 = docs[1].index(0);
-    if (docs0 == nullptr) return false;
+    auto docs0 = doc.index(docs + 1, 0);
+    if (docs0 == kNone) return false;
 
-    auto dt = docs0[0].lookup(resp, 7, (uint8_t*)"docType", di);
-    if (dt == nullptr) return false;
-    doc_type_.insert(doc_type_.begin(), resp + dt[1].u_.string.pos,
-                     resp + dt[1].u_.string.pos + dt[1].u_.string.len);
+    auto dt = doc.lookup(docs0, 7, (uint8_t*)"docType", di);
+    if (dt == kNone) return false;
+    const auto& dtv = doc[dt + 1].u_.string;
+    doc_type_.insert(doc_type_.begin(), resp + dtv.pos,
+                     resp + dtv.pos + dtv.len);
 
-    // The returned docs0 is the map, so index at [0].
-    auto is = docs0[0].lookup(resp, 12, (uint8_t*)"issuerSigned", di);
-    if (is == nullptr) return false;
+    auto is = doc.lookup(docs0, 12, (uint8_t*)"issuerSigned", di);
+    if (is == kNone) return false;
 
-    auto ia = is[1].lookup(resp, 10, (uint8_t*)"issuerAuth", di);
-    if (ia == nullptr) return false;
+    auto ia = doc.lookup(is + 1, 10, (uint8_t*)"issuerAuth", di);
+    if (ia == kNone) return false;
 
-    auto tmso = ia[1].index(2);
-    if (tmso == nullptr) return false;
-    copy_header(t_mso_, tmso);
-    auto nsig = ia[1].index(3);
-    if (nsig == nullptr) return false;
-    copy_header(sig_, nsig);
+    auto tmso = doc.index(ia + 1, 2);
+    if (tmso == kNone) return false;
+    copy_header(t_mso_, doc[tmso]);
+    auto nsig = doc.index(ia + 1, 3);
+    if (nsig == kNone) return false;
+    copy_header(sig_, doc[nsig]);
 
-    auto ns = is[1].lookup(resp, 10, (uint8_t*)"nameSpaces", di);
-    if (ns == nullptr) return false;
+    auto ns = doc.lookup(is + 1, 10, (uint8_t*)"nameSpaces", di);
+    if (ns == kNone) return false;
 
     // Find the attribute witness we need from here.
     for (const char* sn : kSupportedNamespaces) {
-      auto mldns = ns[1].lookup(resp, strlen(sn), (const uint8_t*)sn, di);
-      if (mldns == nullptr) continue;
+      auto mldns = doc.lookup(ns + 1, strlen(sn), (const uint8_t*)sn, di);
+      if (mldns == kNone) continue;
       size_t ai = 0;
-      auto tattr = mldns[1].index(ai++);
-      while (tattr != nullptr) {
-        CborDoc er;
+      auto tattr = doc.index(mldns + 1, ai++);
+      while (tattr != kNone) {
         // Decode the map in this tagged attribute.
-        size_t pos = tattr->children_[0].u_.string.pos;
-        size_t end = pos + tattr->children_[0].u_.string.len;
-        if (!er.decode(resp, end, pos, 0)) {
-          return false;
-        }
-
-        auto ei = er.lookup(resp, 17, (uint8_t*)"elementIdentifier", di);
-        if (ei == nullptr) return false;
-        auto ev = er.lookup(resp, 12, (uint8_t*)"elementValue", di);
-        if (ev == nullptr) return false;
-        auto digid = er.lookup(resp, 8, (uint8_t*)"digestID", di);
-        if (digid == nullptr) return false;
+        auto tbytes = doc.index(tattr, 0);
+        if (tbytes == kNone) return false;
+        auto er = doc.decode_bytes(tbytes);
+        if (er == kNone) return false;
+
+        auto ei = doc.lookup(er, 17, (uint8_t*)"elementIdentifier", di);
+        if (ei == kNone) return false;
+        auto ev = doc.lookup(er, 12, (uint8_t*)"elementValue", di);
+        if (ev == kNone) return false;
+        auto digid = doc.lookup(er, 8, (uint8_t*)"digestID", di);
+        if (digid == kNone) return false;
 
         attributes_.push_back((FullAttribute){
-            ei[1].position(),
-            ei[1].length(),
-            ev[1].position(),
-            ev[1].length(),
+            doc.position(ei + 1),
+            doc.length(ei + 1),
+            doc.position(ev + 1),
+            doc.length(ev + 1),
             (const uint8_t*)sn,
-            static_cast<size_t>(digid[1].u_.u64), /* digest_id */
-            {0, 0, 0},                            /* default mso_ind */
-            tattr->header_pos_,                   /* tag_ind */
-            tattr->children_[0].u_.string.len +
+            static_cast<size_t>(doc[digid + 1].u_.u64), /* digest_id */
+            {0, 0, 0},                                  /* default mso_ind */
+            doc[tattr].header_pos_,                     /* tag_ind */
+            doc[tbytes].u_.string.len +
                 4, /* +4 for the D8 18 58 <> prefix */
             resp});
 
-        tattr = mldns[1].index(ai++);
+        tattr = doc.index(mldns + 1, ai++);
       }
     }
 
-    auto ds = docs0[0].lookup(resp, 12, (uint8_t*)"deviceSigned", di);
-    if (ds == nullptr) return false;
-    auto da = ds[1].lookup(resp, 10, (uint8_t*)"deviceAuth", di);
-    if (da == nullptr) return false;
-    auto dsi = da[1].lookup(resp, 15, (uint8_t*)"deviceSignature", di);
-    if (dsi == nullptr) return false;
-    auto ndksig = dsi[1].index(3);
-    if (ndksig == nullptr) return false;
-    copy_header(dksig_, ndksig);
+    auto ds = doc.lookup(docs0, 12, (uint8_t*)"deviceSigned", di);
+    if (ds == kNone) return false;
+    auto da = doc.lookup(ds + 1, 10, (uint8_t*)"deviceAuth", di);
+    if (da == kNone) return false;
+    auto dsi = doc.lookup(da + 1, 15, (uint8_t*)"deviceSignature", di);
+    if (dsi == kNone) return false;
+    auto ndksig = doc.index(dsi + 1, 3);
+    if (ndksig == kNone) return false;
+    copy_header(dksig_, doc[ndksig]);
 
     // Then parse tagged mso. Skip 5 bytes to skip the D8 18 59 <len2>.
-    const uint8_t* pmso = resp + tmso->u_.string.pos + 5;
-    size_t pos = 0;
-    CborDoc mso;
-    if (!mso.decode(pmso, tmso->u_.string.len - 5, pos, 0)) return false;
-    auto nv = mso.lookup(pmso, kValidityInfoLen, kValidityInfoID, valid_.ndx);
-    if (nv == nullptr) return false;
-    copy_kv_header(valid_, nv);
-
-    auto nvf = nv[1].lookup(pmso, kValidFromLen, kValidFromID, valid_from_.ndx);
-    if (nvf == nullptr) return false;
-    copy_kv_header(valid_from_, nvf);
+    // The mso indices are relative to the start of the mso.
+    if (doc[tmso].t_ != BYTES || t_mso_.len < 5) return false;
+    const size_t mso_base = t_mso_.pos + 5;
+    size_t pos = mso_base;
+    auto mso = doc.decode(pos, t_mso_.pos + t_mso_.len);
+    if (mso == kNone) return false;
+    auto nv =
+        doc.lookup(mso, kValidityInfoLen, kValidityInfoID, valid_.ndx);
+    if (nv == kNone) return false;
+    copy_kv_header(valid_, doc, nv, mso_base);
+
+    auto nvf =
+        doc.lookup(nv + 1, kValidFromLen, kValidFromID, valid_from_.ndx);
+    if (nvf == kNone) return false;
+    copy_kv_header(valid_from_, doc, nvf, mso_base);
 
     auto nvu =
-        nv[1].lookup(pmso, kValidUntilLen, kValidUntilID, valid_until_.ndx);
-    if (nvu == nullptr) return false;
-    copy_kv_header(valid_until_, nvu);
+        doc.lookup(nv + 1, kValidUntilLen, kValidUntilID, valid_until_.ndx);
+    if (nvu == kNone) return false;
+    copy_kv_header(valid_until_, doc, nvu, mso_base);
 
-    auto ndki = mso.lookup(pmso, kDeviceKeyInfoLen, kDeviceKeyInfoID,
+    auto ndki = doc.lookup(mso, kDeviceKeyInfoLen, kDeviceKeyInfoID,
                            dev_key_info_.ndx);
-    if (ndki == nullptr) return false;
-    copy_kv_header(dev_key_info_, ndki);
+    if (ndki == kNone) return false;
+    copy_kv_header(dev_key_info_, doc, ndki, mso_base);
 
-    auto ndk = ndki[1].lookup(pmso, kDeviceKeyLen, kDeviceKeyID, dev_key_.ndx);
-    if (ndk == nullptr) return false;
-    copy_kv_header(dev_key_, ndk);
+    auto ndk =
+        doc.lookup(ndki + 1, kDeviceKeyLen, kDeviceKeyID, dev_key_.ndx);
+    if (ndk == kNone) return false;
+    copy_kv_header(dev_key_, doc, ndk, mso_base);
 
-    auto npkx = ndk[1].lookup_negative(-1, dev_key_pkx_.ndx);
-    if (npkx == nullptr) return false;
-    copy_kv_header(dev_key_pkx_, npkx);
+    auto npkx = doc.lookup_negative(ndk + 1, -1, dev_key_pkx_.ndx);
+    if (npkx == kNone) return false;
+    copy_kv_header(dev_key_pkx_, doc, npkx, mso_base);
 
-    auto npky = ndk[1].lookup_negative(-2, dev_key_pky_.ndx);
-    if (npky == nullptr) return false;
-    copy_kv_header(dev_key_pky_, npky);
+    auto npky = doc.lookup_negative(ndk + 1, -2, dev_key_pky_.ndx);
+    if (npky == kNone) return false;
+    copy_kv_header(dev_key_pky_, doc, npky, mso_base);
 
-    auto nvd =
-        mso.lookup(pmso, kValueDigestsLen, kValueDigestsID, value_digests_.ndx);
-    if (nvd == nullptr) return false;
-    copy_kv_header(value_digests_, nvd);
+    auto nvd = doc.lookup(mso, kValueDigestsLen, kValueDigestsID,
+                          value_digests_.ndx);
+    if (nvd == kNone) return false;
+    copy_kv_header(value_digests_, doc, nvd, mso_base);
 
     // For backwards compatibility with 1f circuits, copy the hard-coded org_ if
     // it is present. TODO(shelat): Remove this once all 1f circuits have
     // been updated.
-    auto norg = nvd[1].lookup(pmso, kOrgLen, kOrgID, org_.ndx);
-    if (norg != nullptr) {
-      copy_kv_header(org_, norg);
+    auto norg = doc.lookup(nvd + 1, kOrgLen, kOrgID, org_.ndx);
+    if (norg != kNone) {
+      copy_kv_header(org_, doc, norg, mso_base);
     }
 
     for (auto& attr : attributes_) {
       size_t index;
-      auto nss = nvd[1].lookup(pmso, strlen((const char*)attr.mdl_ns),
-                               attr.mdl_ns, index);
-      if (nss == nullptr) return false;
+      auto nss = doc.lookup(nvd + 1, strlen((const char*)attr.mdl_ns),
+                            attr.mdl_ns, index);
+      if (nss == kNone) return false;
       uint64_t hi = (uint64_t)attr.digest_id;
-      auto hattr = nss[1].lookup_unsigned(hi, attr.mso.ndx);
-      if (hattr == nullptr) return false;
-      copy_kv_header(attr.mso, hattr);
+      auto hattr = doc.lookup_unsigned(nss + 1, hi, attr.mso.ndx);
+      if (hattr == kNone) return false;
+      copy_kv_header(attr.mso, doc, hattr, mso_base);
     }
 
     tagged_mso_bytes_.assign(std::begin(kCose1Prefix), std::end(kCose1Prefix));
     // Add 2-byte length
     tagged_mso_bytes_.push_back((t_mso_.len >> 8) & 0xff);
     tagged_mso_bytes_.push_back(t_mso_.len & 0xff);
-    for (size_t i = 0; i < t_mso_.len; ++i) {
-      tagged_mso_bytes_.push_back(resp[t_mso_.pos + i]);
-    }
+    tagged_mso_bytes_.insert(tagged_mso_bytes_.end(), resp + t_mso_.pos,
+                             resp + t_mso_.pos + t_mso_.len);
 
     return true;
   }
 
  private:
-  // Used to copy the results of a map lookup.
-  static void copy_kv_header(CborIndex& ind, const CborDoc* n) {
-    ind.k = n[0].header_pos_;
-    ind.v = n[1].header_pos_;
-
-    if (n[1].t_ == TEXT || n[1].t_ == BYTES) {
-      ind.pos = n[1].u_.string.pos;
-      ind.len = n[1].u_.string.len;
+  // Used to copy the results of a map lookup, with positions relative
+  // to BASE.
+  static void copy_kv_header(CborIndex& ind, const FlatCborDoc& doc,
+                             FlatCborDoc::node_t k, size_t base) {
+    const auto& key = doc[k];
+    const auto& val = doc[k + 1];
+    ind.k = key.header_pos_ - base;
+    ind.v = val.header_pos_ - base;
+
+    if (val.t_ == TEXT || val.t_ == BYTES) {
+      ind.pos = val.u_.string.pos - base;
+      ind.len = val.u_.string.len;
     }
   }
 
   // Used to copy the results of an index lookup.
-  static void copy_header(CborIndex& ind, const CborDoc* n) {
-    ind.k = n->header_pos_;
-    ind.pos = n->u_.string.pos;
-    ind.len = n->u_.string.len;
+  static void copy_header(CborIndex& ind, const FlatCborDoc::Node& n) {
+    ind.k = n.header_pos_;
+    ind.pos = n.u_.string.pos;
+    ind.len = n.u_.string.len;
   }
 };
 
@@ -513,6 +524,61 @@ class MdocSignatureWitness {
       return false;
     }
 
+    // Both signatures in one batch, which shares the inversions.
+    typename EcdsaWitness::Signature sig[] = {
+        issuer_signature(pm, pkX, pkY, mdoc),
+        device_signature(pm, mdoc, transcript, tlen)};
+    EcdsaWitness* w[] = {&ew_, &dkw_};
+    EcdsaWitness::compute_witness(2, w, sig);
+    return true;
+  }
+
+  // Computes the part of the witness that depends only on the
+  // credential, i.e., the issuer signature over the MSO and the device
+  // key in the MSO.  The result can be reused across presentations of
+  // the same credential, see compute_device_witness().
+  bool compute_issuer_witness(Elt pkX, Elt pkY, const uint8_t mdoc[/* len */],
+                              size_t len) {
+    ParsedMdoc pm;
+
+    if (!pm.parse_device_response(len, mdoc)) {
+      return false;
+    }
+
+    auto sig = issuer_signature(pm, pkX, pkY, mdoc);
+    ew_.compute_witness(sig.pkX, sig.pkY, sig.e, sig.r, sig.s);
+    return true;
+  }
+
+  // Computes the session-dependent part of the witness, i.e., the
+  // device signature over the transcript.  Requires a prior
+  // compute_issuer_witness() on a DeviceResponse with the same issuer
+  // MSO and signature as MDOC.
+  bool compute_device_witness(const uint8_t mdoc[/* len */], size_t len,
+                              const uint8_t transcript[/* tlen */],
+                              size_t tlen) {
+    ParsedMdoc pm;
+
+    if (!pm.parse_device_response(len, mdoc)) {
+      return false;
+    }
+
+    Nat ne = nat_from_hash<Nat>(pm.tagged_mso_bytes_.data(),
+                                pm.tagged_mso_bytes_.size());
+    if (ec_.f_.to_montgomery(ne) != e_) {
+      log(ERROR, "mdoc does not match the issuer witness");
+      return false;
+    }
+
+    auto sig = device_signature(pm, mdoc, transcript, tlen);
+    dkw_.compute_witness(sig.pkX, sig.pkY, sig.e, sig.r, sig.s);
+    return true;
+  }
+
+ private:
+  // Sets e_, dpkx_, dpky_ and returns the issuer signature.
+  typename EcdsaWitness::Signature issuer_signature(
+      const ParsedMdoc& pm, Elt pkX, Elt pkY, const uint8_t mdoc[/* len */]) {
     Nat ne = nat_from_hash<Nat>(pm.tagged_mso_bytes_.data(),
                                 pm.tagged_mso_bytes_.size());
     e_ = ec_.f_.to_montgomery(ne);
@@ -521,20 +587,26 @@ class MdocSignatureWitness {
     const size_t l = pm.sig_.len;
     Nat nr = nat_from_be<Nat>(&mdoc[pm.sig_.pos]);
     Nat ns = nat_from_be<Nat>(&mdoc[pm.sig_.pos + l / 2]);
-    ew_.compute_witness(pkX, pkY, ne, nr, ns);
 
-    Nat ne2 = compute_transcript_hash<Nat>(transcript, tlen, &pm.doc_type_);
-    const size_t l2 = pm.dksig_.len;
-    Nat nr2 = nat_from_be<Nat>(&mdoc[pm.dksig_.pos]);
-    Nat ns2 = nat_from_be<Nat>(&mdoc[pm.dksig_.pos + l2 / 2]);
     size_t pmso = pm.t_mso_.pos + 5; /* skip the tag */
     dpkx_ = ec_.f_.to_montgomery(
         nat_from_be<Nat>(&mdoc[pmso + pm.dev_key_pkx_.pos]));
     dpky_ = ec_.f_.to_montgomery(
         nat_from_be<Nat>(&mdoc[pmso + pm.dev_key_pky_.pos]));
+    return {pkX, pkY, ne, nr, ns};
+  }
+
+  // Sets e2_ and returns the device signature, which is by the
+  // device key dpkx_, dpky_.
+  typename EcdsaWitness::Signature device_signature(
+      const ParsedMdoc& pm, const uint8_t mdoc[/* len */],
+      const uint8_t transcript[/* tlen */], size_t tlen) {
+    Nat ne2 = compute_transcript_hash<Nat>(transcript, tlen, &pm.doc_type_);
+    const size_t l2 = pm.dksig_.len;
+    Nat nr2 = nat_from_be<Nat>(&mdoc[pm.dksig_.pos]);
+    Nat ns2 = nat_from_be<Nat>(&mdoc[pm.dksig_.pos + l2 / 2]);
     e2_ = ec_.f_.to_montgomery(ne2);
-    dkw_.compute_witness(dpkx_, dpky_, ne2, nr2, ns2);
-    return true;
+    return {dpkx_, dpky_, ne2, nr2, ns2};
   }
 };
 
@@ -638,6 +710,17 @@ class MdocHashWitness {
                        const uint8_t transcript[/* tlen */], size_t tlen,
                        const RequestedAttribute attrs[], size_t attrs_len,
                        const uint8_t tnow[/*20*/], size_t version) {
+    return compute_mso_witness(mdoc, len, version) &&
+           compute_attribute_witness(attrs, attrs_len, tnow);
+  }
+
+  // Computes the part of the witness that depends only on the
+  // credential: the parsed mdoc and the SHA-256 witness of the tagged
+  // MSO.  The attribute witnesses in pm_ point into MDOC, which must
+  // therefore outlive this object.
+  bool compute_mso_witness(const uint8_t mdoc[/* len */], size_t len,
+                           size_t version) {
+    pm_ = ParsedMdoc();
     if (!pm_.parse_device_response(len, mdoc)) {
       log(ERROR, "Failed to parse device response");
       return false;
@@ -665,13 +748,21 @@ class MdocHashWitness {
     ECNat ne = nat_from_u32<ECNat>(bw_[numb_ - 1].h1);
     e_ = ec_.f_.to_montgomery(ne);
 
-    memcpy(now_, tnow, 20);
-
     size_t pmso = pm_.t_mso_.pos + 5; /* +5 to skip the tag */
     dpkx_ = ec_.f_.to_montgomery(
         nat_from_be<ECNat>(&mdoc[pmso + pm_.dev_key_pkx_.pos]));
     dpky_ = ec_.f_.to_montgomery(
         nat_from_be<ECNat>(&mdoc[pmso + pm_.dev_key_pky_.pos]));
+    return true;
+  }
+
+  // Computes the witnesses of the disclosed attributes, after
+  // compute_mso_witness().
+  bool compute_attribute_witness(const RequestedAttribute attrs[],
+                                 size_t attrs_len,
+                                 const uint8_t tnow[/*20*/]) {
+    memcpy(now_, tnow, 20);
+    num_attr_ = attrs_len;
 
     // initialize variables
     attr_n_.resize(attrs_len);
@@ -681,16 +772,18 @@ class MdocHashWitness {
     attr_bytes_.resize(attrs_len);
     atw_.resize(attrs_len);
 
-    // Match the attributes with the witnesses from the deviceResponse.
+    // Match the attributes with the witnesses from the deviceResponse,
+    // and then hash all of the matched attributes together.
+    std::vector<size_t> msg_n(attrs_len);
+    std::vector<const uint8_t*> msg(attrs_len);
     for (size_t i = 0; i < attrs_len; ++i) {
       attr_bytes_[i].resize(128);
       atw_[i].resize(2);
       bool found = false;
       for (auto fa : pm_.attributes_) {
         if (fa == attrs[i]) {
-          FlatSHA256Witness::transform_and_witness_message(
-              fa.tag_len, &fa.doc[fa.tag_ind], 2, attr_n_[i],
-              &attr_bytes_[i][0], &atw_[i][0]);
+          msg_n[i] = fa.tag_len;
+          msg[i] = &fa.doc[fa.tag_ind];
           attr_mso_[i] = fa.mso;
           // In version >= 4, the attribute id is encoded as the length of the
           // id followed by the id.  The witness starts at the id, so we
@@ -712,6 +805,16 @@ class MdocHashWitness {
         return false;
       }
     }
+
+    std::vector<uint8_t*> in(attrs_len);
+    std::vector<FlatSHA256Witness::BlockWitness*> bw(attrs_len);
+    for (size_t i = 0; i < attrs_len; ++i) {
+      in[i] = &attr_bytes_[i][0];
+      bw[i] = &atw_[i][0];
+    }
+    FlatSHA256Witness::transform_and_witness_messages(
+        attrs_len, msg_n.data(), msg.data(), 2, attr_n_.data(), in.data(),
+        bw.data());
     return true;
   }
 };
@@ -17,15 +17,22 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "algebra/convolution.h"
+#include "algebra/crt.h"
+#include "algebra/crt_convolution.h"
 #include "algebra/fp2.h"
 #include "algebra/reed_solomon.h"
+#include "algebra/tuned_convolution.h"
 #include "arrays/dense.h"
 #include "circuits/mac/mac_reference.h"
 #include "circuits/mac/mac_witness.h"
@@ -34,6 +41,8 @@
 #include "ec/p256.h"
 #include "gf2k/gf2_128.h"
 #include "gf2k/lch14_reed_solomon.h"
+#include "ligero/ligero_param.h"
+#include "merkle/merkle_tree.h"
 #include "proto/circuit.h"
 #include "random/secure_random_engine.h"
 #include "random/transcript.h"
@@ -41,6 +50,8 @@
 #include "util/log.h"
 #include "util/panic.h"
 #include "util/readbuffer.h"
+#include "util/writebuffer.h"
+#include "zk/zk_estimate.h"
 #include "zk/zk_proof.h"
 #include "zk/zk_prover.h"
 #include "zk/zk_verifier.h"
@@ -69,9 +80,11 @@ using N = Fp256Base::N;
 using Scalar = Fp256Base::Elt;
 using Elt = Fp256Base::Elt;
 using f2_p256 = Fp2<Fp256Base>;
-using Elt2 = f2_p256::Elt;
 using FftExtConvolutionFactory = FFTExtConvolutionFactory<Fp256Base, f2_p256>;
-using RSFactory_b = ReedSolomonFactory<Fp256Base, FftExtConvolutionFactory>;
+using CrtConvolutionFactory_b =
+    CrtConvolutionFactory<CRT256<Fp256Base>, Fp256Base>;
+using TunedConvolutionFactory_b = TunedConvolutionFactory<Fp256Base>;
+using RSFactory_b = ReedSolomonFactory<Fp256Base, TunedConvolutionFactory_b>;
 using f_128 = GF2_128<>;
 using gf2k = f_128::Elt;
 
@@ -85,6 +98,26 @@ static constexpr char kRootY[] =
     "84087994358540907695740461427818660560182168997182378749313018254450460212"
     "908";
 
+// Convolution engines for the Reed-Solomon code over Fp256Base, chosen
+// statically by size without timing anything.  CRT256 overtakes the
+// extension-field FFT at about n = 4096 on x86-64; convolution_tuner
+// prints the crossover for other machines.
+static constexpr size_t kSigCrtMinN = 4096;
+
+static const TunedConvolutionFactory_b& sig_convolution_factory() {
+  static const f2_p256 p256_2(p256_base);
+  static const FftExtConvolutionFactory fft_b(
+      p256_base, p256_2, p256_2.of_string(kRootX, kRootY), 1ull << 31);
+  static const CrtConvolutionFactory_b crt_b(p256_base);
+  static const TunedConvolutionFactory_b* tuned = [] {
+    auto* t = new TunedConvolutionFactory_b(p256_base);
+    t->add("fft_ext", fft_b);
+    t->add("crt", crt_b, kSigCrtMinN);
+    return t;
+  }();
+  return *tuned;
+}
+
 // Magic constant 4 is derived from the circuit layout.
 // It represents the location of the signature MAC wire in the signature
 // verification circuit and must be updated if the public interface of the sig
@@ -112,6 +145,32 @@ static constexpr bool enforce_circuit_id_in_verifier = false;
 
 // =========== Helper methods for the main exported C functions.
 
+// The Merkle shape of the Ligero commitments, where zero fields
+// select the binary tree with a single root.
+static MerkleShape merkle_shape(const ZkSpecStruct *zk_spec) {
+  MerkleShape shape;
+  if (zk_spec->merkle_arity != 0) {
+    shape.arity = zk_spec->merkle_arity;
+  }
+  if (zk_spec->merkle_cap != 0) {
+    shape.cap = zk_spec->merkle_cap;
+  }
+  return shape;
+}
+
+// Whether the Merkle shape of ZK_SPEC fits the commitments of both
+// circuits.  The shape is not part of the circuit, and an invalid one
+// would abort the process when the proof parameters are built.
+static bool valid_merkle_shape(const ZkSpecStruct *zk_spec) {
+  const MerkleShape shape = merkle_shape(zk_spec);
+  return MerkleLayout::valid(LigeroParam<f_128>::block_ext_for(
+                                 zk_spec->block_enc_hash, kLigeroRate),
+                             shape) &&
+         MerkleLayout::valid(LigeroParam<Fp256Base>::block_ext_for(
+                                 zk_spec->block_enc_sig, kLigeroRate),
+                             shape);
+}
+
 // Specialization for filling the mac when using f_128.
 template <>
 void fill_gf2k<f_128, f_128>(const typename f_128::Elt &m,
@@ -202,20 +261,16 @@ bool fill_public_inputs(DenseFiller<Fp256Base> &sig_filler,
   return true;
 }
 
-// Fills the hash and signature public inputs and private witnesses.
+using MdocHW = MdocHashWitness<P256, f_128>;
+using MdocSW = MdocSignatureWitness<P256, Fp256Scalar>;
+
+// Fills the hash and signature public inputs and private witnesses,
+// given the computed witness objects HW and SW.
 bool fill_witness(DenseFiller<Fp256Base> &fill_b, DenseFiller<f_128> &fill_s,
-                  const uint8_t *mdoc, size_t mdoc_len, const Elt &pkX,
-                  const Elt &pkY, const uint8_t *tr, size_t tr_len,
-                  const RequestedAttribute *attrs, size_t attrs_len,
-                  const uint8_t *now, ProverState &state,
+                  const MdocHW &hw, MdocSW &sw, const Elt &pkX,
+                  const Elt &pkY, const RequestedAttribute *attrs,
+                  size_t attrs_len, const uint8_t *now, ProverState &state,
                   SecureRandomEngine &rng, const f_128 &Fs, size_t version) {
-  using MdocHW = MdocHashWitness<P256, f_128>;
-  using MdocSW = MdocSignatureWitness<P256, Fp256Scalar>;
-
-  // Allocate these objects on the heap because Android has a small stack.
-  auto hw = std::make_unique<MdocHW>(attrs_len, p256, Fs);
-  auto sw = std::make_unique<MdocSW>(p256, p256_scalar, Fs);
-
   // hash public inputs
   if (!fill_attributes(fill_s, attrs, attrs_len, now, Fs, version)) {
     return false;
@@ -226,39 +281,34 @@ bool fill_witness(DenseFiller<Fp256Base> &fill_b, DenseFiller<f_128> &fill_s,
     fill_gf2k<f_128, f_128>(Fs.zero(), fill_s, Fs);
   }
 
-  bool ok_h = hw->compute_witness(mdoc, mdoc_len, tr, tr_len, attrs, attrs_len,
-                                  now, version);
-  bool ok_s = sw->compute_witness(pkX, pkY, mdoc, mdoc_len, tr, tr_len);
-  if (!ok_h || !ok_s) return false;
-
   // signature public inputs
-  fill_signature_inputs(fill_b, pkX, pkY, sw->e2_);
+  fill_signature_inputs(fill_b, pkX, pkY, sw.e2_);
   for (size_t i = 0; i < 7; ++i) {
     fill_gf2k<f_128, Fp256Base>(Fs.zero(), fill_b, p256_base);
   }
 
   // compute macs
-  state = {.common = {hw->e_, hw->dpkx_, hw->dpky_}};
+  state = {.common = {hw.e_, hw.dpkx_, hw.dpky_}};
   MACReference<f_128> mac_ref;
   mac_ref.sample(state.ap, 6, &rng);
 
   uint8_t buf[Fp256Base::kBytes];
 
-  Fp256Base::Elt tt[3] = {hw->e_, hw->dpkx_, hw->dpky_};
+  Fp256Base::Elt tt[3] = {hw.e_, hw.dpkx_, hw.dpky_};
   for (size_t i = 0; i < 3; ++i) {
     p256_base.to_bytes_field(buf, tt[i]);
-    sw->macs_[i].compute_witness(&state.ap[2 * i], buf);
+    sw.macs_[i].compute_witness(&state.ap[2 * i], buf);
     state.macs[i].compute_witness(&state.ap[2 * i]);
     fill_bit_string(fill_s, buf, 32, 32, Fs);
   }
 
   // private witnesses
-  hw->fill_witness(fill_s);
+  hw.fill_witness(fill_s);
   for (auto &mac : state.macs) {
     mac.fill_witness(fill_s);
   }
 
-  sw->fill_witness(fill_b);
+  sw.fill_witness(fill_b);
 
   return true;
 }
@@ -313,46 +363,12 @@ bool sameNamespace(const RequestedAttribute attrs[/*n*/], size_t n) {
   return true;
 }
 
-// =========== End of helper functions =====================
-extern "C" {
-/*
-API version that uses 2 circuits over different fields.
-*/
-using MdocSWw = MdocSignatureWitness<P256, Fp256Scalar>;
-
-// Main endpoint for producing a ZK proof for mdoc properties.
-// This implementation uses 2 separate circuits over 2 fields to verify
-// the signature and the hash components of the mdoc.
-// It is the caller's job to free the memory pointed to by prf.
-MdocProverErrorCode run_mdoc_prover(
-    const uint8_t *bcp, size_t bcsz, /* circuit data */
-    const uint8_t *mdoc, size_t mdoc_len, const char *pkx,
-    const char *pky,                          /* string rep of public key */
-    const uint8_t *transcript, size_t tr_len, /* session transcript */
-    const RequestedAttribute *attrs, size_t attrs_len,
-    const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
-    uint8_t **prf, size_t *proof_len, const ZkSpecStruct *zk_spec) {
-  if (bcp == nullptr || mdoc == nullptr || pkx == nullptr || pky == nullptr ||
-      transcript == nullptr || attrs == nullptr || now == nullptr ||
-      prf == nullptr || proof_len == nullptr || zk_spec == nullptr) {
-    return MDOC_PROVER_NULL_INPUT;
-  }
-
-  Elt pkX, pkY;
-  if (!parsePk(pkx, pky, pkX, pkY)) {
-    log(ERROR, "invalid pkx, pky");
-    return MDOC_PROVER_INVALID_INPUT;
-  }
-
-  if (!sameNamespace(attrs, attrs_len)) {
-    log(ERROR, "attributes must all be in the same namespace");
-    return MDOC_PROVER_INVALID_INPUT;
-  }
-
-  // Parse circuits from cached byte representation.
-  const f2_p256 p256_2(p256_base);
-  const f_128 Fs;
-
+// Parse the signature and hash circuits from their compressed byte
+// representation.
+MdocProverErrorCode parse_prover_circuits(
+    const uint8_t *bcp, size_t bcsz, const f_128 &Fs,
+    std::unique_ptr<Circuit<Fp256Base>> &c_sig,
+    std::unique_ptr<Circuit<f_128>> &c_hash) {
   size_t len = kCircuitSizeMax;
   std::vector<uint8_t> bytes(len);
   size_t full_size = decompress(bytes, bcp, bcsz);
@@ -365,56 +381,129 @@ MdocProverErrorCode run_mdoc_prover(
   ReadBuffer rb_circuit(bytes.data(), full_size);
 
   CircuitRep<Fp256Base> cr_s(p256_base, P256_ID);
-  auto c_sig = cr_s.from_bytes(rb_circuit, enforce_circuit_id_in_prover);
+  c_sig = cr_s.from_bytes(rb_circuit, enforce_circuit_id_in_prover,
+                          /*compact=*/true);
   if (c_sig == nullptr) {
     log(ERROR, "signature circuit could not be parsed");
     return MDOC_PROVER_CIRCUIT_PARSING_FAILURE;
   }
   CircuitRep<f_128> cr_h(Fs, GF2_128_ID);
-  auto c_hash = cr_h.from_bytes(rb_circuit, enforce_circuit_id_in_prover);
+  c_hash = cr_h.from_bytes(rb_circuit, enforce_circuit_id_in_prover,
+                           /*compact=*/true);
 
   if (c_hash == nullptr) {
     log(ERROR, "hash circuit could not be parsed");
     return MDOC_PROVER_HASH_PARSING_FAILURE;
   }
+  return MDOC_PROVER_SUCCESS;
+}
+
+// Cancellation and progress reporting of prove_mdoc().  The default
+// object never cancels and reports nothing.
+struct ProverMonitor {
+  const std::atomic<bool> *cancel = nullptr;
+  MdocProverProgress progress = nullptr;
+  void *ctx = nullptr;
+
+  bool cancelled() const { return cancel != nullptr && cancel->load(); }
+
+  void report(MdocProverPhase phase) const {
+    if (progress != nullptr) {
+      progress(ctx, phase);
+    }
+  }
+
+  template <class Prover>
+  void attach(Prover &p) const {
+    p.set_cancel(cancel);
+    if (progress != nullptr) {
+      p.set_progress([this](ZkProverPhase ph) {
+        report(ph == ZK_PHASE_COMMIT     ? MDOC_PROVER_PHASE_COMMIT
+               : ph == ZK_PHASE_SUMCHECK ? MDOC_PROVER_PHASE_SUMCHECK
+                                         : MDOC_PROVER_PHASE_LIGERO);
+      });
+    }
+  }
+};
+
+// Common part of the mdoc provers after the inputs have been validated.
+// COMPUTE_WITNESS(HW, SW, FS) must allocate and compute the hash and
+// signature witness objects, and return false on failure.
+// PROOF_BUFFER(N, &P) must point P to N writable bytes for the proof,
+// or return an error code.  If MON is cancelled, all intermediate state
+// is released on return, and PROOF_BUFFER is not called.
+template <class ComputeWitness, class ProofBuffer>
+MdocProverErrorCode prove_mdoc(
+    const uint8_t *bcp, size_t bcsz, const Elt &pkX, const Elt &pkY,
+    const uint8_t *transcript, size_t tr_len, const RequestedAttribute *attrs,
+    size_t attrs_len, const char *now, size_t *proof_len,
+    const ZkSpecStruct *zk_spec, const ComputeWitness &compute_witness,
+    const ProofBuffer &proof_buffer, const ProverMonitor &mon) {
+  if (!valid_merkle_shape(zk_spec)) {
+    log(ERROR, "invalid Merkle shape in ZK spec");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  // Parse circuits from cached byte representation.
+  mon.report(MDOC_PROVER_PHASE_PARSE);
+  const f_128 Fs;
+  std::unique_ptr<Circuit<Fp256Base>> c_sig;
+  std::unique_ptr<Circuit<f_128>> c_hash;
+  MdocProverErrorCode ret = parse_prover_circuits(bcp, bcsz, Fs, c_sig, c_hash);
+  if (ret != MDOC_PROVER_SUCCESS) {
+    return ret;
+  }
+  if (mon.cancelled()) {
+    return MDOC_PROVER_CANCELLED;
+  }
   log(INFO, "circuit created. h[in:%zu q:%zu], s[in:%zu q:%zu]",
       c_hash->ninputs, c_hash->nl, c_sig->ninputs, c_sig->nl);
 
   //  ============ Produce zk witness ==============
+  mon.report(MDOC_PROVER_PHASE_WITNESS);
   auto W_sig = Dense<Fp256Base>(1, c_sig->ninputs);
   auto W_hash = Dense<f_128>(1, c_hash->ninputs);
   DenseFiller<Fp256Base> sig_filler(W_sig);
   DenseFiller<f_128> hash_filler(W_hash);
 
+  std::unique_ptr<MdocHW> hw;
+  std::unique_ptr<MdocSW> sw;
   SecureRandomEngine rng;
   ProverState state;
-  bool ok = fill_witness(
-      sig_filler, hash_filler, mdoc, mdoc_len, pkX, pkY, transcript, tr_len,
-      attrs, attrs_len, (const uint8_t *)now, state, rng, Fs, zk_spec->version);
+  bool ok = compute_witness(hw, sw, Fs) &&
+            fill_witness(sig_filler, hash_filler, *hw, *sw, pkX, pkY, attrs,
+                         attrs_len, (const uint8_t *)now, state, rng, Fs,
+                         zk_spec->version);
   if (!ok) {
     log(ERROR, "fill_witness failed");
     return MDOC_PROVER_WITNESS_CREATION_FAILURE;
   }
+  if (mon.cancelled()) {
+    return MDOC_PROVER_CANCELLED;
+  }
 
   // ========= Run prover ==============
   // Use the transcript from the session to select the random oracle.
   Transcript tp(transcript, tr_len, zk_spec->version);
 
-  const Elt2 omega = p256_2.of_string(kRootX, kRootY);
-  const FftExtConvolutionFactory fft_b(p256_base, p256_2, omega, 1ull << 31);
-  const RSFactory_b rsf_b(fft_b, p256_base);
+  const RSFactory_b rsf_b(sig_convolution_factory(), p256_base);
   const RSFactory the_reed_solomon_factory(Fs);
 
   ZkProof<f_128> h_zk(*c_hash, kLigeroRate, kLigeroNreq,
-                      zk_spec->block_enc_hash);
+                      zk_spec->block_enc_hash, merkle_shape(zk_spec));
   ZkProof<Fp256Base> sig_zk(*c_sig, kLigeroRate, kLigeroNreq,
-                            zk_spec->block_enc_sig);
+                            zk_spec->block_enc_sig, merkle_shape(zk_spec));
 
   ZkProver<f_128, RSFactory> hash_p(*c_hash, Fs, the_reed_solomon_factory);
   ZkProver<Fp256Base, RSFactory_b> sig_p(*c_sig, p256_base, rsf_b);
 
-  hash_p.commit(h_zk, W_hash, tp, rng);
-  sig_p.commit(sig_zk, W_sig, tp, rng);
+  mon.attach(hash_p);
+  mon.attach(sig_p);
+
+  if (!hash_p.commit(h_zk, W_hash, tp, rng) ||
+      !sig_p.commit(sig_zk, W_sig, tp, rng)) {
+    return MDOC_PROVER_CANCELLED;
+  }
 
   log(INFO,
       "commit created. h[nl:%zu, ni:%zu], s[nl:%zu, ni:%zu] hc[b:%zu r:%zu] "
@@ -433,37 +522,512 @@ MdocProverErrorCode run_mdoc_prover(
               getHashMacIndex(attrs_len, zk_spec->version), macs, av, Fs);
 
   if (!hash_p.prove(h_zk, W_hash, tp)) {
-    return MDOC_PROVER_GENERAL_FAILURE;
+    return mon.cancelled() ? MDOC_PROVER_CANCELLED
+                           : MDOC_PROVER_GENERAL_FAILURE;
   };
   log(INFO, "ZK hash proof done");
 
   if (!sig_p.prove(sig_zk, W_sig, tp)) {
-    return MDOC_PROVER_GENERAL_FAILURE;
+    return mon.cancelled() ? MDOC_PROVER_CANCELLED
+                           : MDOC_PROVER_GENERAL_FAILURE;
   };
   log(INFO, "ZK signature proof done");
+  if (mon.cancelled()) {
+    return MDOC_PROVER_CANCELLED;
+  }
 
-  // Serialize proof to bytes.
-  // [6 mac values] [docType] [hash proof] [sig proof]
-  std::vector<uint8_t> buf;
+  // Serialize proof to bytes, directly into the output buffer.
+  mon.report(MDOC_PROVER_PHASE_SERIALIZE);
+  // [6 mac values] [hash proof] [sig proof]
   // This sum will not overflow based on constraints of circuit & proof size.
-  size_t tt = 6 * f_128::kBytes + h_zk.size() + sig_zk.size();
-  buf.reserve(tt);
-  buf.insert(buf.begin(), macs_b, macs_b + 6 * f_128::kBytes);
-  h_zk.write(buf, Fs);
-  sig_zk.write(buf, p256_base);
-  *proof_len = buf.size();
+  size_t tt = 6 * f_128::kBytes + h_zk.encoded_size(Fs) +
+              sig_zk.encoded_size(p256_base);
+  *proof_len = tt;
   log(INFO, "proof_len: %zu ", *proof_len);
 
-  // Allocate memory and copy proof bytes.
-  *prf = (uint8_t *)malloc(*proof_len);
-  if (!prf) {
-    log(ERROR, "malloc failed");
-    return MDOC_PROVER_MEMORY_ALLOCATION_FAILURE;
+  uint8_t *prf = nullptr;
+  ret = proof_buffer(tt, &prf);
+  if (ret != MDOC_PROVER_SUCCESS) {
+    return ret;
   }
-  memcpy(*prf, buf.data(), buf.size());
+  WriteBuffer wb(prf, tt);
+  wb.next(6 * f_128::kBytes, macs_b);
+  // WB holds exactly the encoded_size() of both proofs.
+  h_zk.write_unchecked(wb, Fs);
+  sig_zk.write_unchecked(wb, p256_base);
   return MDOC_PROVER_SUCCESS;
 }
 
+// Calibration of mdoc_resource_estimate(): nanoseconds per unit of
+// the ZkResources work counts, fitted to the phase times that
+// BM_MdocProver and BM_MdocVerifier log on one core of an x86-64
+// machine with SHA extensions.  The per-op cost differs by phase
+// because the phases differ in how much of their work is additions
+// and memory traffic, which the op counts do not see.
+struct MdocPhaseCost {
+  double commit, sumcheck, ligero, verify;
+};
+static constexpr MdocPhaseCost kMdocHashCost = {8, 14, 14, 14};
+static constexpr MdocPhaseCost kMdocSigCost = {170, 66, 340, 138};
+static constexpr double kMdocShaByte = 0.8;
+// Parsing, per circuit term, and witness generation, per input wire.
+static constexpr double kMdocParseTerm = 50;
+static constexpr double kMdocWitnessInput = 45;
+
+// Proof buffer for prove_mdoc() that mallocs the proof into *PRF.
+auto malloc_proof_buffer(uint8_t **prf) {
+  return [prf](size_t n, uint8_t **p) {
+    *prf = (uint8_t *)malloc(n);
+    if (*prf == nullptr) {
+      log(ERROR, "malloc failed");
+      return MDOC_PROVER_MEMORY_ALLOCATION_FAILURE;
+    }
+    *p = *prf;
+    return MDOC_PROVER_SUCCESS;
+  };
+}
+
+// Proof buffer for prove_mdoc() that uses the caller's array PRF of
+// PRF_LEN bytes.
+auto caller_proof_buffer(uint8_t *prf, size_t prf_len) {
+  return [prf, prf_len](size_t n, uint8_t **p) {
+    if (n > prf_len) {
+      log(ERROR, "proof needs %zu bytes, buffer has %zu", n, prf_len);
+      return MDOC_PROVER_BUFFER_TOO_SMALL;
+    }
+    *p = prf;
+    return MDOC_PROVER_SUCCESS;
+  };
+}
+
+// =========== End of helper functions =====================
+}  // namespace proofs
+
+// Session-independent witness state for one credential.  The hash
+// witness holds pointers into MDOC, so the cache owns a copy.
+struct MdocProverCache {
+  std::vector<uint8_t> mdoc;
+  proofs::Elt pkX, pkY;
+  size_t version;
+  proofs::f_128 Fs;
+  std::unique_ptr<proofs::MdocHW> hw;
+  std::unique_ptr<proofs::MdocSW> sw;
+};
+
+// One run of the prover by mdoc_prover_task_start() or
+// mdoc_prover_task_run().  The inputs are copies, since the caller may
+// release its buffers while the task runs.  RESULT, PRF and PROOF_LEN
+// belong to the running thread until it is joined or has returned.
+struct MdocProverTask {
+  explicit MdocProverTask(const ZkSpecStruct &spec)
+      : zk_spec(spec),
+        cancel(false),
+        started(false),
+        result(MDOC_PROVER_GENERAL_FAILURE),
+        prf(nullptr),
+        proof_len(0) {}
+
+  std::vector<uint8_t> circuit, mdoc, transcript;
+  std::string pkx, pky;
+  char now[20];  // not NUL-terminated, like the caller's argument
+  std::vector<RequestedAttribute> attrs;
+  const ZkSpecStruct zk_spec;
+  proofs::ProverMonitor monitor;
+
+  std::atomic<bool> cancel;
+  std::thread thread;
+  bool started;
+  MdocProverErrorCode result;
+  uint8_t *prf;
+  size_t proof_len;
+};
+
+namespace proofs {
+
+// Body of run_mdoc_prover(), run_mdoc_prover_into() and
+// mdoc_prover_task_run().
+template <class ProofBuffer>
+MdocProverErrorCode mdoc_prover(
+    const uint8_t *bcp, size_t bcsz, const uint8_t *mdoc, size_t mdoc_len,
+    const char *pkx, const char *pky, const uint8_t *transcript, size_t tr_len,
+    const RequestedAttribute *attrs, size_t attrs_len, const char *now,
+    size_t *proof_len, const ZkSpecStruct *zk_spec,
+    const ProofBuffer &proof_buffer, const ProverMonitor &mon) {
+  if (bcp == nullptr || mdoc == nullptr || pkx == nullptr || pky == nullptr ||
+      transcript == nullptr || attrs == nullptr || now == nullptr ||
+      proof_len == nullptr || zk_spec == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+
+  Elt pkX, pkY;
+  if (!parsePk(pkx, pky, pkX, pkY)) {
+    log(ERROR, "invalid pkx, pky");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  if (!sameNamespace(attrs, attrs_len)) {
+    log(ERROR, "attributes must all be in the same namespace");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  return prove_mdoc(
+      bcp, bcsz, pkX, pkY, transcript, tr_len, attrs, attrs_len, now,
+      proof_len, zk_spec,
+      [&](std::unique_ptr<MdocHW> &hw, std::unique_ptr<MdocSW> &sw,
+          const f_128 &Fs) {
+        // Allocate these objects on the heap because Android has a small
+        // stack.
+        hw = std::make_unique<MdocHW>(attrs_len, p256, Fs);
+        sw = std::make_unique<MdocSW>(p256, p256_scalar, Fs);
+        bool ok_h = hw->compute_witness(mdoc, mdoc_len, transcript, tr_len,
+                                        attrs, attrs_len, (const uint8_t *)now,
+                                        zk_spec->version);
+        bool ok_s = sw->compute_witness(pkX, pkY, mdoc, mdoc_len, transcript,
+                                        tr_len);
+        return ok_h && ok_s;
+      },
+      proof_buffer, mon);
+}
+
+// Body of run_mdoc_prover_cached() and run_mdoc_prover_cached_into().
+template <class ProofBuffer>
+MdocProverErrorCode mdoc_prover_cached(
+    const uint8_t *bcp, size_t bcsz, const MdocProverCache *cache,
+    const uint8_t *mdoc, size_t mdoc_len, const uint8_t *transcript,
+    size_t tr_len, const RequestedAttribute *attrs, size_t attrs_len,
+    const char *now, size_t *proof_len, const ZkSpecStruct *zk_spec,
+    const ProofBuffer &proof_buffer) {
+  if (bcp == nullptr || cache == nullptr || mdoc == nullptr ||
+      transcript == nullptr || attrs == nullptr || now == nullptr ||
+      proof_len == nullptr || zk_spec == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+
+  if (zk_spec->version != cache->version) {
+    log(ERROR, "cache was created for a different ZK spec version");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  if (!sameNamespace(attrs, attrs_len)) {
+    log(ERROR, "attributes must all be in the same namespace");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  return prove_mdoc(
+      bcp, bcsz, cache->pkX, cache->pkY, transcript, tr_len, attrs, attrs_len,
+      now, proof_len, zk_spec,
+      [&](std::unique_ptr<MdocHW> &hw, std::unique_ptr<MdocSW> &sw,
+          const f_128 &Fs) {
+        // Start from copies of the cached witnesses, and only compute
+        // the attribute and device-signature parts.
+        hw = std::make_unique<MdocHW>(*cache->hw);
+        sw = std::make_unique<MdocSW>(*cache->sw);
+        bool ok_h = hw->compute_attribute_witness(attrs, attrs_len,
+                                                  (const uint8_t *)now);
+        bool ok_s =
+            sw->compute_device_witness(mdoc, mdoc_len, transcript, tr_len);
+        return ok_h && ok_s;
+      },
+      proof_buffer, ProverMonitor());
+}
+
+void run_prover_task(MdocProverTask *t) {
+  t->result = mdoc_prover(
+      t->circuit.data(), t->circuit.size(), t->mdoc.data(), t->mdoc.size(),
+      t->pkx.c_str(), t->pky.c_str(), t->transcript.data(),
+      t->transcript.size(), t->attrs.data(), t->attrs.size(), t->now,
+      &t->proof_len, &t->zk_spec, malloc_proof_buffer(&t->prf), t->monitor);
+  log(INFO, "prover task finished: %d", t->result);
+}
+
+extern "C" {
+/*
+API version that uses 2 circuits over different fields.
+*/
+using MdocSWw = MdocSignatureWitness<P256, Fp256Scalar>;
+
+// Main endpoint for producing a ZK proof for mdoc properties.
+// This implementation uses 2 separate circuits over 2 fields to verify
+// the signature and the hash components of the mdoc.
+// It is the caller's job to free the memory pointed to by prf.
+MdocProverErrorCode run_mdoc_prover(
+    const uint8_t *bcp, size_t bcsz, /* circuit data */
+    const uint8_t *mdoc, size_t mdoc_len, const char *pkx,
+    const char *pky,                          /* string rep of public key */
+    const uint8_t *transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute *attrs, size_t attrs_len,
+    const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
+    uint8_t **prf, size_t *proof_len, const ZkSpecStruct *zk_spec) {
+  if (prf == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  return mdoc_prover(bcp, bcsz, mdoc, mdoc_len, pkx, pky, transcript, tr_len,
+                     attrs, attrs_len, now, proof_len, zk_spec,
+                     malloc_proof_buffer(prf), ProverMonitor());
+}
+
+MdocProverErrorCode run_mdoc_prover_into(
+    const uint8_t *bcp, size_t bcsz, /* circuit data */
+    const uint8_t *mdoc, size_t mdoc_len, const char *pkx,
+    const char *pky,                          /* string rep of public key */
+    const uint8_t *transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute *attrs, size_t attrs_len,
+    const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
+    uint8_t *prf, size_t prf_len, size_t *proof_len,
+    const ZkSpecStruct *zk_spec) {
+  if (prf == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  return mdoc_prover(bcp, bcsz, mdoc, mdoc_len, pkx, pky, transcript, tr_len,
+                     attrs, attrs_len, now, proof_len, zk_spec,
+                     caller_proof_buffer(prf, prf_len), ProverMonitor());
+}
+
+MdocProverErrorCode mdoc_proof_max_len(const uint8_t *bcp, size_t bcsz,
+                                       const ZkSpecStruct *zk_spec,
+                                       size_t *max_len) {
+  if (bcp == nullptr || zk_spec == nullptr || max_len == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  if (!valid_merkle_shape(zk_spec)) {
+    log(ERROR, "invalid Merkle shape in ZK spec");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  const f_128 Fs;
+  std::unique_ptr<Circuit<Fp256Base>> c_sig;
+  std::unique_ptr<Circuit<f_128>> c_hash;
+  MdocProverErrorCode ret = parse_prover_circuits(bcp, bcsz, Fs, c_sig, c_hash);
+  if (ret != MDOC_PROVER_SUCCESS) {
+    return ret;
+  }
+
+  ZkProof<f_128> h_zk(*c_hash, kLigeroRate, kLigeroNreq,
+                      zk_spec->block_enc_hash, merkle_shape(zk_spec));
+  ZkProof<Fp256Base> sig_zk(*c_sig, kLigeroRate, kLigeroNreq,
+                            zk_spec->block_enc_sig, merkle_shape(zk_spec));
+  *max_len = 6 * f_128::kBytes + h_zk.size() + sig_zk.size();
+  return MDOC_PROVER_SUCCESS;
+}
+
+MdocProverErrorCode mdoc_resource_estimate(const uint8_t *bcp, size_t bcsz,
+                                           const ZkSpecStruct *zk_spec,
+                                           MdocResourceEstimate *est) {
+  if (bcp == nullptr || zk_spec == nullptr || est == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  if (!valid_merkle_shape(zk_spec)) {
+    log(ERROR, "invalid Merkle shape in ZK spec");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  const f_128 Fs;
+  std::unique_ptr<Circuit<Fp256Base>> c_sig;
+  std::unique_ptr<Circuit<f_128>> c_hash;
+  MdocProverErrorCode ret = parse_prover_circuits(bcp, bcsz, Fs, c_sig, c_hash);
+  if (ret != MDOC_PROVER_SUCCESS) {
+    return ret;
+  }
+
+  ZkProof<f_128> h_zk(*c_hash, kLigeroRate, kLigeroNreq,
+                      zk_spec->block_enc_hash, merkle_shape(zk_spec));
+  ZkProof<Fp256Base> sig_zk(*c_sig, kLigeroRate, kLigeroNreq,
+                            zk_spec->block_enc_sig, merkle_shape(zk_spec));
+  const ZkResources h = zk_resources(h_zk);
+  const ZkResources s = zk_resources(sig_zk);
+  // Both provers commit before either proves, so both resident parts
+  // are live at once.  Parsing holds the decompression buffer, which
+  // is released before the witness is computed.
+  size_t parsing = kCircuitSizeMax + h.circuit + s.circuit;
+  size_t proving = h.prover_resident + s.prover_resident +
+                   std::max(h.prover_transient, s.prover_transient) +
+                   h.max_proof + s.max_proof;
+  size_t verifying = h.verifier_resident + s.verifier_resident +
+                     std::max(h.verifier_transient, s.verifier_transient);
+  est->prover_memory = std::max(parsing, proving);
+  est->verifier_memory = std::max(parsing, verifying);
+  est->tableau_size = h.tableau + s.tableau;
+  est->proof_size = 6 * f_128::kBytes + h.proof + s.proof;
+  est->max_proof_size = 6 * f_128::kBytes + h.max_proof + s.max_proof;
+
+  const MdocPhaseCost &kh = kMdocHashCost, &ks = kMdocSigCost;
+  auto us = [](double ns) { return static_cast<size_t>(ns / 1000.0); };
+  double parse = kMdocParseTerm * (c_hash->nterms() + c_sig->nterms());
+  est->parse_us = us(parse);
+  est->witness_us =
+      us(kMdocWitnessInput * (c_hash->ninputs + c_sig->ninputs));
+  est->commit_us = us(kh.commit * h.commit_ops + ks.commit * s.commit_ops +
+                      kMdocShaByte * (h.commit_hashed + s.commit_hashed));
+  est->sumcheck_us =
+      us(kh.sumcheck * h.sumcheck_ops + ks.sumcheck * s.sumcheck_ops);
+  est->ligero_us = us(kh.ligero * h.ligero_ops + ks.ligero * s.ligero_ops);
+  est->verifier_us =
+      us(parse + kh.verify * h.verifier_ops + ks.verify * s.verifier_ops +
+         kMdocShaByte * (h.verifier_hashed + s.verifier_hashed));
+  return MDOC_PROVER_SUCCESS;
+}
+
+MdocProverErrorCode mdoc_prover_cache_create(
+    const uint8_t *mdoc, size_t mdoc_len, /* full mdoc */
+    const char *pkx, const char *pky,     /* string rep of public key */
+    const ZkSpecStruct *zk_spec, MdocProverCache **cache) {
+  if (mdoc == nullptr || pkx == nullptr || pky == nullptr ||
+      zk_spec == nullptr || cache == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+
+  auto c = std::make_unique<MdocProverCache>();
+  if (!parsePk(pkx, pky, c->pkX, c->pkY)) {
+    log(ERROR, "invalid pkx, pky");
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+
+  c->mdoc.assign(mdoc, mdoc + mdoc_len);
+  c->version = zk_spec->version;
+  c->hw = std::make_unique<MdocHW>(0, p256, c->Fs);
+  c->sw = std::make_unique<MdocSW>(p256, p256_scalar, c->Fs);
+
+  bool ok_h = c->hw->compute_mso_witness(c->mdoc.data(), c->mdoc.size(),
+                                         c->version);
+  bool ok_s = c->sw->compute_issuer_witness(c->pkX, c->pkY, c->mdoc.data(),
+                                            c->mdoc.size());
+  if (!ok_h || !ok_s) {
+    log(ERROR, "credential witness failed");
+    return MDOC_PROVER_WITNESS_CREATION_FAILURE;
+  }
+
+  *cache = c.release();
+  return MDOC_PROVER_SUCCESS;
+}
+
+void mdoc_prover_cache_free(MdocProverCache *cache) { delete cache; }
+
+MdocProverErrorCode run_mdoc_prover_cached(
+    const uint8_t *bcp, size_t bcsz,      /* circuit data */
+    const MdocProverCache *cache,         /* credential witness */
+    const uint8_t *mdoc, size_t mdoc_len, /* full mdoc */
+    const uint8_t *transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute *attrs, size_t attrs_len,
+    const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
+    uint8_t **prf, size_t *proof_len, const ZkSpecStruct *zk_spec) {
+  if (prf == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  return mdoc_prover_cached(bcp, bcsz, cache, mdoc, mdoc_len, transcript,
+                            tr_len, attrs, attrs_len, now, proof_len, zk_spec,
+                            malloc_proof_buffer(prf));
+}
+
+MdocProverErrorCode run_mdoc_prover_cached_into(
+    const uint8_t *bcp, size_t bcsz,      /* circuit data */
+    const MdocProverCache *cache,         /* credential witness */
+    const uint8_t *mdoc, size_t mdoc_len, /* full mdoc */
+    const uint8_t *transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute *attrs, size_t attrs_len,
+    const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
+    uint8_t *prf, size_t prf_len, size_t *proof_len,
+    const ZkSpecStruct *zk_spec) {
+  if (prf == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  return mdoc_prover_cached(bcp, bcsz, cache, mdoc, mdoc_len, transcript,
+                            tr_len, attrs, attrs_len, now, proof_len, zk_spec,
+                            caller_proof_buffer(prf, prf_len));
+}
+
+MdocProverErrorCode mdoc_prover_task_create(
+    const uint8_t *bcp, size_t bcsz, /* circuit data */
+    const uint8_t *mdoc, size_t mdoc_len, const char *pkx,
+    const char *pky,                          /* string rep of public key */
+    const uint8_t *transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute *attrs, size_t attrs_len,
+    const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
+    const ZkSpecStruct *zk_spec, MdocProverProgress progress, void *ctx,
+    MdocProverTask **task) {
+  if (bcp == nullptr || mdoc == nullptr || pkx == nullptr || pky == nullptr ||
+      transcript == nullptr || attrs == nullptr || now == nullptr ||
+      zk_spec == nullptr || task == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+
+  auto t = std::make_unique<MdocProverTask>(*zk_spec);
+  t->circuit.assign(bcp, bcp + bcsz);
+  t->mdoc.assign(mdoc, mdoc + mdoc_len);
+  t->pkx = pkx;
+  t->pky = pky;
+  t->transcript.assign(transcript, transcript + tr_len);
+  t->attrs.assign(attrs, attrs + attrs_len);
+  memcpy(t->now, now, sizeof(t->now));
+  t->monitor.cancel = &t->cancel;
+  t->monitor.progress = progress;
+  t->monitor.ctx = ctx;
+
+  *task = t.release();
+  return MDOC_PROVER_SUCCESS;
+}
+
+MdocProverErrorCode mdoc_prover_task_start(MdocProverTask *task) {
+  if (task == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  if (task->started) {
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+  task->started = true;
+  task->thread = std::thread(run_prover_task, task);
+  return MDOC_PROVER_SUCCESS;
+}
+
+MdocProverErrorCode mdoc_prover_task_run(MdocProverTask *task) {
+  if (task == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  if (task->started) {
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+  task->started = true;
+  run_prover_task(task);
+  return task->result;
+}
+
+void mdoc_prover_task_cancel(MdocProverTask *task) {
+  if (task != nullptr) {
+    task->cancel = true;
+  }
+}
+
+MdocProverErrorCode mdoc_prover_task_wait(MdocProverTask *task,
+                                          uint8_t **prf, size_t *proof_len) {
+  if (task == nullptr || prf == nullptr || proof_len == nullptr) {
+    return MDOC_PROVER_NULL_INPUT;
+  }
+  if (!task->started) {
+    return MDOC_PROVER_INVALID_INPUT;
+  }
+  if (task->thread.joinable()) {
+    task->thread.join();
+  }
+  if (task->result == MDOC_PROVER_SUCCESS) {
+    // The proof now belongs to the caller.
+    *prf = task->prf;
+    *proof_len = task->proof_len;
+    task->prf = nullptr;
+  }
+  return task->result;
+}
+
+void mdoc_prover_task_free(MdocProverTask *task) {
+  if (task == nullptr) {
+    return;
+  }
+  task->cancel = true;
+  if (task->thread.joinable()) {
+    task->thread.join();
+  }
+  free(task->prf);
+  delete task;
+}
+
 MdocVerifierErrorCode run_mdoc_verifier(
     const uint8_t *bcp, size_t bcsz,          /* circuit data */
     const char *pkx, const char *pky,         /* string rep of public key */
@@ -472,6 +1036,19 @@ MdocVerifierErrorCode run_mdoc_verifier(
     const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
     const uint8_t *zkproof, size_t proof_len, const char *docType,
     const ZkSpecStruct *zk_spec) {
+  return run_mdoc_verifier_threads(bcp, bcsz, pkx, pky, transcript, tr_len,
+                                   attrs, attrs_len, now, zkproof, proof_len,
+                                   docType, zk_spec, /*max_threads=*/1);
+}
+
+MdocVerifierErrorCode run_mdoc_verifier_threads(
+    const uint8_t *bcp, size_t bcsz,          /* circuit data */
+    const char *pkx, const char *pky,         /* string rep of public key */
+    const uint8_t *transcript, size_t tr_len, /* session Transcript */
+    const RequestedAttribute *attrs, size_t attrs_len,
+    const char *now, /* time formatted as "2023-11-02T09:00:00Z" */
+    const uint8_t *zkproof, size_t proof_len, const char *docType,
+    const ZkSpecStruct *zk_spec, size_t max_threads) {
   if (bcp == nullptr || pkx == nullptr || pky == nullptr ||
       transcript == nullptr || now == nullptr || attrs == nullptr ||
       zkproof == nullptr || docType == nullptr || zk_spec == nullptr) {
@@ -489,6 +1066,11 @@ MdocVerifierErrorCode run_mdoc_verifier(
     return MDOC_VERIFIER_INVALID_INPUT;
   }
 
+  if (!valid_merkle_shape(zk_spec)) {
+    log(ERROR, "invalid Merkle shape in ZK spec");
+    return MDOC_VERIFIER_INVALID_INPUT;
+  }
+
   const f_128 Fs;
 
   // Sanity check input sizes.
@@ -496,7 +1078,6 @@ MdocVerifierErrorCode run_mdoc_verifier(
     return MDOC_VERIFIER_ARGUMENTS_TOO_SMALL;
   }
 
-  const f2_p256 p256_2(p256_base);
 
   // Parse circuits from cached byte representation.
   size_t len = kCircuitSizeMax;
@@ -510,14 +1091,16 @@ MdocVerifierErrorCode run_mdoc_verifier(
 
   ReadBuffer rb_circuit(bytes.data(), full_size);
   CircuitRep<Fp256Base> cr_s(p256_base, P256_ID);
-  auto c_sig = cr_s.from_bytes(rb_circuit, enforce_circuit_id_in_verifier);
+  auto c_sig = cr_s.from_bytes(rb_circuit, enforce_circuit_id_in_verifier,
+                               /*compact=*/true);
   if (c_sig == nullptr) {
     log(ERROR, "signature circuit could not be parsed");
     return MDOC_VERIFIER_CIRCUIT_PARSING_FAILURE;
   }
 
   CircuitRep<f_128> cr_h(Fs, GF2_128_ID);
-  auto c_hash = cr_h.from_bytes(rb_circuit, enforce_circuit_id_in_verifier);
+  auto c_hash = cr_h.from_bytes(rb_circuit, enforce_circuit_id_in_verifier,
+                                /*compact=*/true);
 
   if (c_hash == nullptr) {
     log(ERROR, "circuit could not be parsed");
@@ -528,9 +1111,9 @@ MdocVerifierErrorCode run_mdoc_verifier(
 
   // Parse proofs
   ZkProof<f_128> pr_hash(*c_hash, kLigeroRate, kLigeroNreq,
-                         zk_spec->block_enc_hash);
+                         zk_spec->block_enc_hash, merkle_shape(zk_spec));
   ZkProof<Fp256Base> pr_sig(*c_sig, kLigeroRate, kLigeroNreq,
-                            zk_spec->block_enc_sig);
+                            zk_spec->block_enc_sig, merkle_shape(zk_spec));
 
   log(INFO,
       "proof params: h[nl:%zu, ni:%zu], s[nl:%zu, ni:%zu] hc[b:%zu r:%zu] "
@@ -539,8 +1122,8 @@ MdocVerifierErrorCode run_mdoc_verifier(
       pr_hash.param.block, pr_hash.param.nrow, pr_sig.param.block,
       pr_sig.param.nrow);
 
-  const std::vector<uint8_t> zbuf(zkproof, zkproof + proof_len);
-  ReadBuffer rb(zbuf);
+  // Parse in place from the caller's bytes.
+  ReadBuffer rb(zkproof, proof_len);
 
   // Read macs from proof string.
   // The sanity check above ensures that the proof is big enough for the MACs.
@@ -568,17 +1151,18 @@ MdocVerifierErrorCode run_mdoc_verifier(
 
   // =============== Verify
 
-  const Elt2 omega = p256_2.of_string(kRootX, kRootY);
-  const FftExtConvolutionFactory fft_b(p256_base, p256_2, omega, 1ull << 31);
-  const RSFactory_b rsf_b(fft_b, p256_base);
+  const RSFactory_b rsf_b(sig_convolution_factory(), p256_base);
   const RSFactory the_reed_solomon_factory(Fs);
 
   ZkVerifier<f_128, RSFactory> hash_v(*c_hash, the_reed_solomon_factory,
                                       kLigeroRate, kLigeroNreq,
-                                      zk_spec->block_enc_hash, Fs);
+                                      zk_spec->block_enc_hash, Fs,
+                                      merkle_shape(zk_spec));
   ZkVerifier<Fp256Base, RSFactory_b> sig_v(*c_sig, rsf_b, kLigeroRate,
                                            kLigeroNreq, zk_spec->block_enc_sig,
-                                           p256_base);
+                                           p256_base, merkle_shape(zk_spec));
+  hash_v.set_threads(max_threads);
+  sig_v.set_threads(max_threads);
 
   // Use the transcript from the session to select the random oracle.
   class Transcript tv(transcript, tr_len, zk_spec->version);
@@ -607,10 +1191,11 @@ MdocVerifierErrorCode run_mdoc_verifier(
     return MDOC_VERIFIER_ATTRIBUTE_NUMBER_MISMATCH;
   }
 
-  bool ok = hash_v.verify(pr_hash, pub_hash, tv);
-  bool ok2 = sig_v.verify(pr_sig, pub_sig, tv);
+  // Stop at the first proof that fails.
+  bool ok = hash_v.verify(pr_hash, pub_hash, tv) &&
+            sig_v.verify(pr_sig, pub_sig, tv);
 
-  return ok && ok2 ? MDOC_VERIFIER_SUCCESS : MDOC_VERIFIER_GENERAL_FAILURE;
+  return ok ? MDOC_VERIFIER_SUCCESS : MDOC_VERIFIER_GENERAL_FAILURE;
 }
 
 } /* extern "C" */
@@ -54,6 +54,8 @@ typedef enum {
   MDOC_PROVER_GENERAL_FAILURE,
   MDOC_PROVER_MEMORY_ALLOCATION_FAILURE,
   MDOC_PROVER_INVALID_ZK_SPEC_VERSION,
+  MDOC_PROVER_BUFFER_TOO_SMALL,
+  MDOC_PROVER_CANCELLED,
 } MdocProverErrorCode;
 
 // Return codes for the run_mdoc2_verifier method.
@@ -98,6 +100,17 @@ typedef struct {
   size_t version;
   // The block_enc parameter for the ZK proof.
   size_t block_enc_hash, block_enc_sig;
+  // The arity of the Merkle trees of the Ligero commitments (2, 4, or
+  // 8), and the number of tree nodes in the commitment (a power of the
+  // arity).  Zero selects the binary tree committed by its root, which
+  // is what all versions up to 6 use.  A shape that does not fit the
+  // commitments of both circuits makes the prover and verifier return
+  // their INVALID_INPUT codes.
+  //
+  // These fields were added after the others, which grew the struct.
+  // Callers that allocate a ZkSpecStruct themselves instead of using
+  // kZkSpecs must zero it, e.g. with calloc(), or set these fields.
+  size_t merkle_arity, merkle_cap;
 } ZkSpecStruct;
 
 static const char kDefaultDocType[] = "org.iso.18013.5.1.mDL";
@@ -132,10 +145,164 @@ MdocProverErrorCode run_mdoc_prover(
     const char* now, /* time formatted as "2023-11-02T09:00:00Z" */
     uint8_t** prf, size_t* proof_len, const ZkSpecStruct* zk_spec_version);
 
+// Same as run_mdoc_prover, but writes the proof into the caller's array
+// PRF of PRF_LEN bytes instead of allocating it.  *PROOF_LEN is set to
+// the length of the proof.  If that exceeds PRF_LEN, nothing is written
+// and the prover returns MDOC_PROVER_BUFFER_TOO_SMALL.
+MdocProverErrorCode run_mdoc_prover_into(
+    const uint8_t* bcp, size_t bcsz,          /* circuit data */
+    const uint8_t* mdoc, size_t mdoc_len,     /* full mdoc */
+    const char* pkx, const char* pky,         /* string rep of public key */
+    const uint8_t* transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute* attrs, size_t attrs_len,
+    const char* now, /* time formatted as "2023-11-02T09:00:00Z" */
+    uint8_t* prf, size_t prf_len, size_t* proof_len,
+    const ZkSpecStruct* zk_spec_version);
+
+// Sets *MAX_LEN to an upper bound on the length of any proof for the
+// circuits BCP.  A buffer of this size is always large enough for
+// run_mdoc_prover_into() and run_mdoc_prover_cached_into().  The bound
+// depends only on the circuits and ZK spec, so callers can compute it
+// once.
+MdocProverErrorCode mdoc_proof_max_len(const uint8_t* bcp, size_t bcsz,
+                                       const ZkSpecStruct* zk_spec_version,
+                                       size_t* max_len);
+
+// Predicted resources of one presentation with a circuit bundle, see
+// mdoc_resource_estimate().  Sizes are in bytes, and times in
+// microseconds on the reference machine of the calibration.
+typedef struct {
+  size_t prover_memory;    /* peak heap of the prover */
+  size_t verifier_memory;  /* peak heap of the verifier */
+  size_t tableau_size;     /* Ligero tableaus of both circuits */
+  size_t proof_size;       /* expected proof length */
+  size_t max_proof_size;   /* as returned by mdoc_proof_max_len() */
+
+  /* prover time by phase */
+  size_t parse_us;    /* decompressing and parsing the circuits */
+  size_t witness_us;  /* witness of the mdoc and the signatures */
+  size_t commit_us;   /* encoding and hashing the tableaus */
+  size_t sumcheck_us; /* circuit evaluation and sumcheck */
+  size_t ligero_us;   /* Ligero responses and openings */
+
+  size_t verifier_us; /* verifier time, including its parsing */
+} MdocResourceEstimate;
+
+// Predicts the memory and time of run_mdoc_prover() and
+// run_mdoc_verifier() for the circuits BCP and ZK spec, without
+// running them, so that callers can decide where and when to prove.
+// The estimate parses the circuits, but does not depend on the mdoc or
+// on the number of attributes beyond what the circuits encode.
+MdocProverErrorCode mdoc_resource_estimate(const uint8_t* bcp, size_t bcsz,
+                                           const ZkSpecStruct* zk_spec_version,
+                                           MdocResourceEstimate* est);
+
+// Opaque, session-independent witness state for one credential.
+typedef struct MdocProverCache MdocProverCache;
+
+// Precomputes the parts of the prover witness that depend only on the
+// credential: parsing of the mdoc, the SHA-256 witness of the MSO, and
+// the witness of the issuer signature.  On success, *cache must later
+// be released with mdoc_prover_cache_free().  The cache is bound to the
+// version of zk_spec_version.
+MdocProverErrorCode mdoc_prover_cache_create(
+    const uint8_t* mdoc, size_t mdoc_len, /* full mdoc */
+    const char* pkx, const char* pky,     /* string rep of public key */
+    const ZkSpecStruct* zk_spec_version, MdocProverCache** cache);
+
+void mdoc_prover_cache_free(MdocProverCache* cache);
+
+// Same as run_mdoc_prover, but reuses the credential witness in CACHE
+// and only computes the attribute witnesses and the device-signature
+// witness over the session transcript.  The mdoc must be a
+// DeviceResponse for the same credential as the one used to create
+// CACHE.  CACHE is not modified and can be reused.
+MdocProverErrorCode run_mdoc_prover_cached(
+    const uint8_t* bcp, size_t bcsz,      /* circuit data */
+    const MdocProverCache* cache,         /* credential witness */
+    const uint8_t* mdoc, size_t mdoc_len, /* full mdoc */
+    const uint8_t* transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute* attrs, size_t attrs_len,
+    const char* now, /* time formatted as "2023-11-02T09:00:00Z" */
+    uint8_t** prf, size_t* proof_len, const ZkSpecStruct* zk_spec_version);
+
+// Same as run_mdoc_prover_cached, but writes the proof into the
+// caller's array PRF as in run_mdoc_prover_into().
+MdocProverErrorCode run_mdoc_prover_cached_into(
+    const uint8_t* bcp, size_t bcsz,      /* circuit data */
+    const MdocProverCache* cache,         /* credential witness */
+    const uint8_t* mdoc, size_t mdoc_len, /* full mdoc */
+    const uint8_t* transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute* attrs, size_t attrs_len,
+    const char* now, /* time formatted as "2023-11-02T09:00:00Z" */
+    uint8_t* prf, size_t prf_len, size_t* proof_len,
+    const ZkSpecStruct* zk_spec_version);
+
+// Phases of the prover, reported as they start.  COMMIT, SUMCHECK and
+// LIGERO are reported once for the hash circuit and once for the
+// signature circuit, in the order COMMIT, COMMIT, SUMCHECK, LIGERO,
+// SUMCHECK, LIGERO.
+typedef enum {
+  MDOC_PROVER_PHASE_PARSE = 0,
+  MDOC_PROVER_PHASE_WITNESS,
+  MDOC_PROVER_PHASE_COMMIT,
+  MDOC_PROVER_PHASE_SUMCHECK,
+  MDOC_PROVER_PHASE_LIGERO,
+  MDOC_PROVER_PHASE_SERIALIZE,
+} MdocProverPhase;
+
+typedef void (*MdocProverProgress)(void* ctx, MdocProverPhase phase);
+
+// A cancellable run of the prover, for callers that cannot block until
+// the proof is done, e.g. because the user may dismiss the request.
+typedef struct MdocProverTask MdocProverTask;
+
+// Creates a task that computes the same proof as run_mdoc_prover().
+// The task keeps copies of all inputs, so the caller's buffers can be
+// released after this call.  PROGRESS, if not NULL, is called with
+// CTX on the thread running the task as each phase starts.  The task
+// does not run until mdoc_prover_task_start() or mdoc_prover_task_run(),
+// and must be released with mdoc_prover_task_free().
+MdocProverErrorCode mdoc_prover_task_create(
+    const uint8_t* bcp, size_t bcsz,          /* circuit data */
+    const uint8_t* mdoc, size_t mdoc_len,     /* full mdoc */
+    const char* pkx, const char* pky,         /* string rep of public key */
+    const uint8_t* transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute* attrs, size_t attrs_len,
+    const char* now, /* time formatted as "2023-11-02T09:00:00Z" */
+    const ZkSpecStruct* zk_spec_version, MdocProverProgress progress,
+    void* ctx, MdocProverTask** task);
+
+// Runs TASK on a new thread owned by the library, and returns without
+// waiting for it.  A task runs at most once.
+MdocProverErrorCode mdoc_prover_task_start(MdocProverTask* task);
+
+// Runs TASK on the calling thread, e.g. a worker of the caller's own
+// pool, and returns its result when done.  A task runs at most once.
+MdocProverErrorCode mdoc_prover_task_run(MdocProverTask* task);
+
+// Asks TASK to stop.  Can be called from any thread, including the
+// progress callback.  The prover checks between phases and within
+// the layout of the commitment and the sumcheck rounds, and then
+// frees its working memory and finishes with MDOC_PROVER_CANCELLED.
+void mdoc_prover_task_cancel(MdocProverTask* task);
+
+// Waits until TASK has finished and returns its result.  On success,
+// *PRF and *PROOF_LEN are set to the proof, which the caller must
+// free, as in run_mdoc_prover().  Call at most once per task, after
+// mdoc_prover_task_start() or after mdoc_prover_task_run() returned.
+MdocProverErrorCode mdoc_prover_task_wait(MdocProverTask* task,
+                                          uint8_t** prf, size_t* proof_len);
+
+// Cancels TASK if it is still running, waits for it to stop, and frees
+// it.  A proof not taken by mdoc_prover_task_wait() is freed as well.
+void mdoc_prover_task_free(MdocProverTask* task);
+
 // The run_mdoc2_verifier method accepts a byte representation of the circuit,
 // the public key of the issuer, the transcript, an array of RequestedAttribute
 // that represents claims that you want to verify, and a 20-char representation
-// of the time, as well as the proof and its length.
+// of the time, as well as the proof and its length.  The proof is parsed in
+// place from ZKPROOF, without a copy.
 MdocVerifierErrorCode run_mdoc_verifier(
     const uint8_t* bcp, size_t bcsz,          /* circuit data */
     const char* pkx, const char* pky,         /* string rep of public key */
@@ -145,6 +312,19 @@ MdocVerifierErrorCode run_mdoc_verifier(
     const uint8_t* zkproof, size_t proof_len, const char* docType,
     const ZkSpecStruct* zk_spec_version);
 
+// Same as run_mdoc_verifier, which runs on the calling thread only, but
+// evaluates the circuit layers on up to MAX_THREADS threads including
+// the caller.  The number of threads is also capped by the number of
+// layers and by the hardware concurrency.
+MdocVerifierErrorCode run_mdoc_verifier_threads(
+    const uint8_t* bcp, size_t bcsz,          /* circuit data */
+    const char* pkx, const char* pky,         /* string rep of public key */
+    const uint8_t* transcript, size_t tr_len, /* session transcript */
+    const RequestedAttribute* attrs, size_t attrs_len,
+    const char* now, /* time formatted as "2023-11-02T09:00:00Z" */
+    const uint8_t* zkproof, size_t proof_len, const char* docType,
+    const ZkSpecStruct* zk_spec_version, size_t max_threads);
+
 // Produces a compressed version of the circuit bytes for the specified number
 // of attributes. The generator only supports the latest version of the ZKSpec
 // for a number of attributes. Attempt to generate older circuits will result in
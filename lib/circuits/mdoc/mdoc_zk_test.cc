@@ -20,6 +20,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <vector>
 
 #include "circuits/mdoc/mdoc_examples.h"
 #include "circuits/mdoc/mdoc_test_attributes.h"
@@ -85,6 +86,14 @@ class MdocZKTest : public testing::Test {
           test->transcript, test->transcript_size, attrs, num_attrs,
           (const char*)test->now, zkproof, proof_len, test->doc_type, &zk_spec);
       EXPECT_EQ(ret, MDOC_VERIFIER_SUCCESS);
+
+      // Spreading the layers over threads does not change the outcome.
+      ret = run_mdoc_verifier_threads(
+          circuit, circuit_len, test->pkx.as_pointer, test->pky.as_pointer,
+          test->transcript, test->transcript_size, attrs, num_attrs,
+          (const char*)test->now, zkproof, proof_len, test->doc_type, &zk_spec,
+          /*max_threads=*/4);
+      EXPECT_EQ(ret, MDOC_VERIFIER_SUCCESS);
       free(zkproof);
     }
   }
@@ -227,6 +236,299 @@ TEST_F(MdocZKTest, two_claims) {
   }
 }
 
+TEST_F(MdocZKTest, cached_witness) {
+  const ZkSpecStruct& zk_spec = kZkSpecs[0];
+  const MdocTests* test = &mdoc_tests[3];
+  const RequestedAttribute claims[] = {test::familyname_mustermann,
+                                       test::height_175};
+
+  MdocProverCache* cache = nullptr;
+  ASSERT_EQ(mdoc_prover_cache_create(test->mdoc, test->mdoc_size,
+                                     test->pkx.as_pointer,
+                                     test->pky.as_pointer, &zk_spec, &cache),
+            MDOC_PROVER_SUCCESS);
+
+  // The cache can be used for several presentations with different
+  // attributes.
+  for (const RequestedAttribute& attr : claims) {
+    uint8_t* zkproof;
+    size_t proof_len;
+    EXPECT_EQ(run_mdoc_prover_cached(
+                  circuit1_, circuit_len1_, cache, test->mdoc,
+                  test->mdoc_size, test->transcript, test->transcript_size,
+                  &attr, 1, (const char*)test->now, &zkproof, &proof_len,
+                  &zk_spec),
+              MDOC_PROVER_SUCCESS);
+    EXPECT_EQ(run_mdoc_verifier(circuit1_, circuit_len1_,
+                                test->pkx.as_pointer, test->pky.as_pointer,
+                                test->transcript, test->transcript_size, &attr,
+                                1, (const char*)test->now, zkproof, proof_len,
+                                test->doc_type, &zk_spec),
+              MDOC_VERIFIER_SUCCESS);
+    free(zkproof);
+  }
+
+  // A DeviceResponse for a different credential is rejected.
+  const MdocTests* other = &mdoc_tests[0];
+  uint8_t* zkproof;
+  size_t proof_len;
+  EXPECT_EQ(run_mdoc_prover_cached(circuit1_, circuit_len1_, cache,
+                                   other->mdoc, other->mdoc_size,
+                                   other->transcript, other->transcript_size,
+                                   &claims[0], 1, (const char*)other->now,
+                                   &zkproof, &proof_len, &zk_spec),
+            MDOC_PROVER_WITNESS_CREATION_FAILURE);
+
+  mdoc_prover_cache_free(cache);
+}
+
+TEST_F(MdocZKTest, caller_buffer) {
+  const ZkSpecStruct& zk_spec = kZkSpecs[0];
+  const MdocTests* test = &mdoc_tests[0];
+  const RequestedAttribute attrs[1] = {test::age_over_18};
+
+  size_t max_len = 0;
+  ASSERT_EQ(mdoc_proof_max_len(circuit1_, circuit_len1_, &zk_spec, &max_len),
+            MDOC_PROVER_SUCCESS);
+  std::vector<uint8_t> buf(max_len);
+
+  // Too small: the required length is reported and nothing is written.
+  size_t proof_len = 0;
+  EXPECT_EQ(run_mdoc_prover_into(circuit1_, circuit_len1_, test->mdoc,
+                                 test->mdoc_size, test->pkx.as_pointer,
+                                 test->pky.as_pointer, test->transcript,
+                                 test->transcript_size, attrs, 1,
+                                 (const char*)test->now, buf.data(), 1000,
+                                 &proof_len, &zk_spec),
+            MDOC_PROVER_BUFFER_TOO_SMALL);
+  EXPECT_GT(proof_len, 1000);
+  EXPECT_LE(proof_len, max_len);
+  EXPECT_EQ(buf[0], 0);
+
+  ASSERT_EQ(run_mdoc_prover_into(circuit1_, circuit_len1_, test->mdoc,
+                                 test->mdoc_size, test->pkx.as_pointer,
+                                 test->pky.as_pointer, test->transcript,
+                                 test->transcript_size, attrs, 1,
+                                 (const char*)test->now, buf.data(),
+                                 buf.size(), &proof_len, &zk_spec),
+            MDOC_PROVER_SUCCESS);
+  log(INFO, "proof %zu bytes, bound %zu", proof_len, max_len);
+  EXPECT_EQ(run_mdoc_verifier(circuit1_, circuit_len1_, test->pkx.as_pointer,
+                              test->pky.as_pointer, test->transcript,
+                              test->transcript_size, attrs, 1,
+                              (const char*)test->now, buf.data(), proof_len,
+                              test->doc_type, &zk_spec),
+            MDOC_VERIFIER_SUCCESS);
+}
+
+TEST_F(MdocZKTest, resource_estimate) {
+  const ZkSpecStruct& zk_spec = kZkSpecs[0];
+  const MdocTests* test = &mdoc_tests[0];
+  const RequestedAttribute attrs[1] = {test::age_over_18};
+
+  MdocResourceEstimate est;
+  ASSERT_EQ(mdoc_resource_estimate(circuit1_, circuit_len1_, &zk_spec, &est),
+            MDOC_PROVER_SUCCESS);
+  log(INFO,
+      "estimate: prover %zub verifier %zub tableau %zub proof %zub (max "
+      "%zub); parse %zuus witness %zuus commit %zuus sumcheck %zuus "
+      "ligero %zuus verifier %zuus",
+      est.prover_memory, est.verifier_memory, est.tableau_size,
+      est.proof_size, est.max_proof_size, est.parse_us, est.witness_us,
+      est.commit_us, est.sumcheck_us, est.ligero_us, est.verifier_us);
+
+  size_t max_len = 0;
+  ASSERT_EQ(mdoc_proof_max_len(circuit1_, circuit_len1_, &zk_spec, &max_len),
+            MDOC_PROVER_SUCCESS);
+  EXPECT_EQ(est.max_proof_size, max_len);
+  EXPECT_GT(est.tableau_size, 0);
+  EXPECT_GT(est.prover_memory, est.tableau_size);
+  EXPECT_GT(est.verifier_memory, 0);
+
+  // The predicted proof length is within 10% of an actual one.
+  uint8_t* zkproof;
+  size_t proof_len;
+  ASSERT_EQ(run_mdoc_prover(circuit1_, circuit_len1_, test->mdoc,
+                            test->mdoc_size, test->pkx.as_pointer,
+                            test->pky.as_pointer, test->transcript,
+                            test->transcript_size, attrs, 1,
+                            (const char*)test->now, &zkproof, &proof_len,
+                            &zk_spec),
+            MDOC_PROVER_SUCCESS);
+  free(zkproof);
+  EXPECT_LE(proof_len, max_len);
+  EXPECT_LT(proof_len, est.proof_size + est.proof_size / 10);
+  EXPECT_GT(proof_len, est.proof_size - est.proof_size / 10);
+
+  EXPECT_EQ(mdoc_resource_estimate(circuit1_, circuit_len1_, &zk_spec, nullptr),
+            MDOC_PROVER_NULL_INPUT);
+}
+
+// Records the phases of a prover task, and cancels the task when
+// CANCEL_AT starts.
+struct TaskProgress {
+  MdocProverTask* task = nullptr;
+  int cancel_at = -1;
+  std::vector<MdocProverPhase> phases;
+
+  static void callback(void* ctx, MdocProverPhase phase) {
+    TaskProgress* p = static_cast<TaskProgress*>(ctx);
+    p->phases.push_back(phase);
+    if (phase == p->cancel_at) {
+      mdoc_prover_task_cancel(p->task);
+    }
+  }
+};
+
+TEST_F(MdocZKTest, prover_task) {
+  const ZkSpecStruct& zk_spec = kZkSpecs[0];
+  const MdocTests* test = &mdoc_tests[0];
+  const RequestedAttribute attrs[1] = {test::age_over_18};
+  auto create = [&](TaskProgress* progress) {
+    MdocProverTask* task = nullptr;
+    EXPECT_EQ(mdoc_prover_task_create(
+                  circuit1_, circuit_len1_, test->mdoc, test->mdoc_size,
+                  test->pkx.as_pointer, test->pky.as_pointer, test->transcript,
+                  test->transcript_size, attrs, 1, (const char*)test->now,
+                  &zk_spec, TaskProgress::callback, progress, &task),
+              MDOC_PROVER_SUCCESS);
+    progress->task = task;
+    return task;
+  };
+
+  // On a thread of the library, reporting every phase.
+  TaskProgress progress;
+  MdocProverTask* task = create(&progress);
+  ASSERT_EQ(mdoc_prover_task_start(task), MDOC_PROVER_SUCCESS);
+  EXPECT_EQ(mdoc_prover_task_start(task), MDOC_PROVER_INVALID_INPUT);
+  uint8_t* zkproof = nullptr;
+  size_t proof_len = 0;
+  ASSERT_EQ(mdoc_prover_task_wait(task, &zkproof, &proof_len),
+            MDOC_PROVER_SUCCESS);
+  mdoc_prover_task_free(task);
+  EXPECT_EQ(progress.phases,
+            (std::vector<MdocProverPhase>{
+                MDOC_PROVER_PHASE_PARSE, MDOC_PROVER_PHASE_WITNESS,
+                MDOC_PROVER_PHASE_COMMIT, MDOC_PROVER_PHASE_COMMIT,
+                MDOC_PROVER_PHASE_SUMCHECK, MDOC_PROVER_PHASE_LIGERO,
+                MDOC_PROVER_PHASE_SUMCHECK, MDOC_PROVER_PHASE_LIGERO,
+                MDOC_PROVER_PHASE_SERIALIZE}));
+  EXPECT_EQ(run_mdoc_verifier(circuit1_, circuit_len1_, test->pkx.as_pointer,
+                              test->pky.as_pointer, test->transcript,
+                              test->transcript_size, attrs, 1,
+                              (const char*)test->now, zkproof, proof_len,
+                              test->doc_type, &zk_spec),
+            MDOC_VERIFIER_SUCCESS);
+  free(zkproof);
+
+  // On the caller's thread, cancelled as each phase starts.  The task
+  // stops before the next phase, without a proof.
+  for (MdocProverPhase phase :
+       {MDOC_PROVER_PHASE_PARSE, MDOC_PROVER_PHASE_WITNESS,
+        MDOC_PROVER_PHASE_COMMIT, MDOC_PROVER_PHASE_SUMCHECK,
+        MDOC_PROVER_PHASE_LIGERO}) {
+    TaskProgress cancelled;
+    cancelled.cancel_at = phase;
+    task = create(&cancelled);
+    EXPECT_EQ(mdoc_prover_task_run(task), MDOC_PROVER_CANCELLED);
+    zkproof = nullptr;
+    EXPECT_EQ(mdoc_prover_task_wait(task, &zkproof, &proof_len),
+              MDOC_PROVER_CANCELLED);
+    EXPECT_EQ(zkproof, nullptr);
+    EXPECT_EQ(cancelled.phases.back(), phase);
+    mdoc_prover_task_free(task);
+  }
+
+  // Freeing a running task cancels it.
+  TaskProgress abandoned;
+  task = create(&abandoned);
+  ASSERT_EQ(mdoc_prover_task_start(task), MDOC_PROVER_SUCCESS);
+  mdoc_prover_task_free(task);
+}
+
+TEST_F(MdocZKTest, merkle_shape) {
+  const MdocTests* test = &mdoc_tests[0];
+  const RequestedAttribute attrs[1] = {test::age_over_18};
+  const size_t shapes[][2] = {{0, 0}, {4, 16}, {8, 64}};
+
+  for (const auto& shape : shapes) {
+    ZkSpecStruct zk_spec = kZkSpecs[0];
+    zk_spec.merkle_arity = shape[0];
+    zk_spec.merkle_cap = shape[1];
+
+    uint8_t* zkproof;
+    size_t proof_len;
+    ASSERT_EQ(run_mdoc_prover(circuit1_, circuit_len1_, test->mdoc,
+                              test->mdoc_size, test->pkx.as_pointer,
+                              test->pky.as_pointer, test->transcript,
+                              test->transcript_size, attrs, 1,
+                              (const char*)test->now, &zkproof, &proof_len,
+                              &zk_spec),
+              MDOC_PROVER_SUCCESS);
+    log(INFO, "merkle arity %zu cap %zu: proof %zu bytes", shape[0],
+        shape[1], proof_len);
+
+    EXPECT_EQ(run_mdoc_verifier(circuit1_, circuit_len1_,
+                                test->pkx.as_pointer, test->pky.as_pointer,
+                                test->transcript, test->transcript_size, attrs,
+                                1, (const char*)test->now, zkproof, proof_len,
+                                test->doc_type, &zk_spec),
+              MDOC_VERIFIER_SUCCESS);
+
+    // The shape is part of the spec: a proof does not verify under
+    // a different one.
+    if (shape[0] != 0) {
+      EXPECT_NE(run_mdoc_verifier(circuit1_, circuit_len1_,
+                                  test->pkx.as_pointer, test->pky.as_pointer,
+                                  test->transcript, test->transcript_size,
+                                  attrs, 1, (const char*)test->now, zkproof,
+                                  proof_len, test->doc_type, &kZkSpecs[0]),
+                MDOC_VERIFIER_SUCCESS);
+    }
+    free(zkproof);
+  }
+}
+
+TEST_F(MdocZKTest, invalid_merkle_shape) {
+  const MdocTests* test = &mdoc_tests[0];
+  const RequestedAttribute attrs[1] = {test::age_over_18};
+  // Bad arity, cap not a power of the arity, caps deeper than the
+  // tree of one or both circuits.
+  const size_t shapes[][2] = {{3, 9}, {4, 8}, {2, 2048}, {2, 1ull << 20}};
+  std::vector<uint8_t> proof(20000);
+
+  for (const auto& shape : shapes) {
+    ZkSpecStruct zk_spec = kZkSpecs[0];
+    zk_spec.merkle_arity = shape[0];
+    zk_spec.merkle_cap = shape[1];
+
+    uint8_t* zkproof = nullptr;
+    size_t proof_len;
+    EXPECT_EQ(run_mdoc_prover(circuit1_, circuit_len1_, test->mdoc,
+                              test->mdoc_size, test->pkx.as_pointer,
+                              test->pky.as_pointer, test->transcript,
+                              test->transcript_size, attrs, 1,
+                              (const char*)test->now, &zkproof, &proof_len,
+                              &zk_spec),
+              MDOC_PROVER_INVALID_INPUT);
+    EXPECT_EQ(zkproof, nullptr);
+
+    size_t max_len;
+    EXPECT_EQ(mdoc_proof_max_len(circuit1_, circuit_len1_, &zk_spec, &max_len),
+              MDOC_PROVER_INVALID_INPUT);
+    MdocResourceEstimate est;
+    EXPECT_EQ(mdoc_resource_estimate(circuit1_, circuit_len1_, &zk_spec, &est),
+              MDOC_PROVER_INVALID_INPUT);
+
+    EXPECT_EQ(run_mdoc_verifier(circuit1_, circuit_len1_,
+                                test->pkx.as_pointer, test->pky.as_pointer,
+                                test->transcript, test->transcript_size, attrs,
+                                1, (const char*)test->now, proof.data(),
+                                proof.size(), test->doc_type, &zk_spec),
+              MDOC_VERIFIER_INVALID_INPUT);
+  }
+}
+
 TEST_F(MdocZKTest, wrong_witness) {
   const Claims fail_tests[] = {
       {"fail-not_over_18-mdoc[0]", {test::not_over_18}, &mdoc_tests[0]},
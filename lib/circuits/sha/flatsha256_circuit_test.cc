@@ -21,6 +21,7 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -354,6 +355,49 @@ TEST(FlatSHA256_Circuit, block_size_gf2_128_4) {
   test_block_circuit_size<f_128, 4>(Fs, "block_size_gf2128_pack_4");
 }
 
+// The multi-message witness must agree with the single-message one,
+// including for a partial group of lanes.
+TEST(FlatSHA256_Witness, messages) {
+  constexpr size_t max = 4;
+  constexpr size_t k = FlatSHA256Witness::kLanes + 3;
+  std::vector<std::vector<uint8_t>> msg(k);
+  size_t n[k];
+  const uint8_t* pmsg[k];
+  for (size_t i = 0; i < k; ++i) {
+    n[i] = (37 * i + 5) % (64 * max - 9);
+    for (size_t j = 0; j < n[i]; ++j) {
+      msg[i].push_back(static_cast<uint8_t>(i * 131 + j * 7));
+    }
+    pmsg[i] = msg[i].data();
+  }
+
+  uint8_t numb[k];
+  std::vector<std::vector<uint8_t>> in(k, std::vector<uint8_t>(64 * max));
+  std::vector<std::vector<FlatSHA256Witness::BlockWitness>> bw(
+      k, std::vector<FlatSHA256Witness::BlockWitness>(max));
+  uint8_t* pin[k];
+  FlatSHA256Witness::BlockWitness* pbw[k];
+  for (size_t i = 0; i < k; ++i) {
+    pin[i] = in[i].data();
+    pbw[i] = bw[i].data();
+  }
+  FlatSHA256Witness::transform_and_witness_messages(k, n, pmsg, max, numb,
+                                                    pin, pbw);
+
+  for (size_t i = 0; i < k; ++i) {
+    uint8_t numb1;
+    std::vector<uint8_t> in1(64 * max);
+    std::vector<FlatSHA256Witness::BlockWitness> bw1(max);
+    FlatSHA256Witness::transform_and_witness_message(
+        n[i], pmsg[i], max, numb1, in1.data(), bw1.data());
+    EXPECT_EQ(numb1, numb[i]);
+    EXPECT_EQ(in1, in[i]);
+    for (size_t bl = 0; bl < max; ++bl) {
+      EXPECT_EQ(memcmp(&bw1[bl], &bw[i][bl], sizeof(bw1[bl])), 0);
+    }
+  }
+}
+
 }  // namespace
 
 namespace bench {
@@ -605,5 +649,45 @@ void BM_ShaZK_quadbind_fp2_128(benchmark::State& state) {
 }
 BENCHMARK(BM_ShaZK_quadbind_fp2_128)->RangeMultiplier(2)->Range(1, 32);
 
+// Witnesses for state.range(0) independent 2-block messages, which
+// is the shape of the disclosed mdoc attributes.
+void BM_ShaWitness_message(benchmark::State& state) {
+  size_t k = state.range(0);
+  std::vector<uint8_t> msg(100, 'a');
+  std::vector<uint8_t> in(64 * 2);
+  std::vector<FlatSHA256Witness::BlockWitness> bw(2);
+  for (auto _ : state) {
+    for (size_t i = 0; i < k; ++i) {
+      uint8_t numb;
+      FlatSHA256Witness::transform_and_witness_message(
+          msg.size(), msg.data(), 2, numb, in.data(), bw.data());
+    }
+    benchmark::DoNotOptimize(bw);
+  }
+}
+BENCHMARK(BM_ShaWitness_message)->Arg(1)->Arg(4)->Arg(8);
+
+void BM_ShaWitness_messages(benchmark::State& state) {
+  size_t k = state.range(0);
+  std::vector<uint8_t> msg(100, 'a');
+  std::vector<size_t> n(k, msg.size());
+  std::vector<const uint8_t*> pmsg(k, msg.data());
+  std::vector<uint8_t> numb(k);
+  std::vector<uint8_t> in(64 * 2 * k);
+  std::vector<FlatSHA256Witness::BlockWitness> bw(2 * k);
+  std::vector<uint8_t*> pin(k);
+  std::vector<FlatSHA256Witness::BlockWitness*> pbw(k);
+  for (size_t i = 0; i < k; ++i) {
+    pin[i] = &in[64 * 2 * i];
+    pbw[i] = &bw[2 * i];
+  }
+  for (auto _ : state) {
+    FlatSHA256Witness::transform_and_witness_messages(
+        k, n.data(), pmsg.data(), 2, numb.data(), pin.data(), pbw.data());
+    benchmark::DoNotOptimize(bw);
+  }
+}
+BENCHMARK(BM_ShaWitness_messages)->Arg(1)->Arg(4)->Arg(8);
+
 }  // namespace bench
 }  // namespace proofs
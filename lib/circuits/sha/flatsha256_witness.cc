@@ -17,9 +17,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <cstring>
+
 #include "circuits/sha/sha256_constants.h"
 #include "util/ceildiv.h"
-#include "util/panic.h"
 
 namespace proofs {
 
@@ -118,35 +119,32 @@ static const uint32_t initial_h0[8] = {0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u,
                                        0xa54ff53au, 0x510e527fu, 0x9b05688cu,
                                        0x1f83d9abu, 0x5be0cd19u};
 
-void FlatSHA256Witness::transform_and_witness_message(
-    size_t n, const uint8_t msg[/*n*/], size_t max, uint8_t &numb,
-    uint8_t in[/* 64*max */], BlockWitness bw[/*max*/]) {
+// Copies MSG into IN followed by the SHA-256 padding, and zeroes
+// the rest of the MAX blocks.
+static void pad_message(size_t n, const uint8_t msg[/*n*/], size_t max,
+                        uint8_t &numb, uint8_t in[/* 64*max */]) {
   // Compute the exact number of blocks needed for hashing.
   numb = ceildiv<size_t>(n + 9, 64);
 
-  size_t ii = 0;
-  for (size_t i = 0; i < n; ++i, ++ii) {
-    in[ii] = msg[i];
-  }
-  in[ii++] = 0x80;
-  if ((ii % 64) == 0 || (ii % 64) > 56) {
-    while (ii % 64) {
-      in[ii++] = 0;
-    }
-  }
-  while ((ii % 64) < 56) {
-    in[ii++] = 0;
-  }
+  // The message, 0x80, zeros, and the 64-bit length, which ends
+  // block NUMB.
+  size_t ii = 64 * numb - 8;
+  memcpy(in, msg, n);
+  in[n] = 0x80;
+  memset(&in[n + 1], 0, ii - (n + 1));
   SHA256_wu64be(&in[ii], n * 8);
   ii += 8;
-  check(ii % 64 == 0, "Invalid padding");
 
   // Pad to end.
-  while (ii < 64 * max) {
-    in[ii++] = 0;
+  if (ii < 64 * max) {
+    memset(&in[ii], 0, 64 * max - ii);
   }
+}
 
-  // Compute all of the intermediate hashes and witnesses.
+// Computes all of the intermediate hashes and witnesses of the
+// padded message IN.
+static void witness_blocks(const uint8_t in[/* 64*max */], size_t max,
+                           FlatSHA256Witness::BlockWitness bw[/*max*/]) {
   uint32_t data[16];
   const uint32_t *H = initial_h0;
   for (size_t bl = 0; bl < max; bl++) {
@@ -154,10 +152,154 @@ void FlatSHA256Witness::transform_and_witness_message(
       data[i] = SHA256_ru32be(&in[bl * 64 + i * 4]);
     }
 
-    transform_and_witness_block(data, H, bw[bl].outw, bw[bl].oute, bw[bl].outa,
-                                bw[bl].h1);
+    FlatSHA256Witness::transform_and_witness_block(
+        data, H, bw[bl].outw, bw[bl].oute, bw[bl].outa, bw[bl].h1);
     H = bw[bl].h1;
   }
 }
 
+void FlatSHA256Witness::transform_and_witness_message(
+    size_t n, const uint8_t msg[/*n*/], size_t max, uint8_t &numb,
+    uint8_t in[/* 64*max */], BlockWitness bw[/*max*/]) {
+  pad_message(n, msg, max, numb, in);
+  witness_blocks(in, max, bw);
+}
+
+// The lane-parallel version of transform_and_witness_block(), which
+// computes kLanes independent blocks.  Every loop over the lanes has
+// a fixed trip count and no dependencies across lanes, so that the
+// compiler turns it into SIMD instructions (SSE2, AVX2 or NEON,
+// depending on the target).
+static constexpr size_t kLanes = FlatSHA256Witness::kLanes;
+
+// The baseline x86-64 ISA only has 128-bit SSE2 vectors, so also
+// compile an AVX2 clone, which holds all kLanes words in one
+// register, and pick it at load time when the CPU supports it.
+// target_clones resolves the clone through an ifunc, which only
+// ELF/glibc targets provide, so e.g. x86-64 macOS gets the baseline.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__AVX2__) && \
+    defined(__ELF__) && defined(__linux__)
+#define PROOFS_SHA_LANES_TARGET \
+  __attribute__((target_clones("avx2", "default")))
+#else
+#define PROOFS_SHA_LANES_TARGET
+#endif
+
+PROOFS_SHA_LANES_TARGET
+static void transform_and_witness_lanes(const uint32_t in[16][kLanes],
+                                        uint32_t H[8][kLanes],
+                                        uint32_t w[64][kLanes],
+                                        uint32_t E[68][kLanes],
+                                        uint32_t A[68][kLanes]) {
+  for (size_t i = 0; i < 16; ++i) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      w[i][l] = in[i][l];
+    }
+  }
+
+  for (size_t i = 16; i < 64; ++i) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      w[i][l] = sigma1(w[i - 2][l]) + w[i - 7][l] + sigma0(w[i - 15][l]) +
+                w[i - 16][l];
+    }
+  }
+
+  // The working variables of round t are a = A[t + 3], b = A[t + 2],
+  // ..., e = E[t + 3], ..., so that each round writes one new A and
+  // one new E instead of shifting all eight variables.  OUTA[t] and
+  // OUTE[t] are A[t + 4] and E[t + 4].
+  for (size_t l = 0; l < kLanes; ++l) {
+    A[3][l] = H[0][l];
+    A[2][l] = H[1][l];
+    A[1][l] = H[2][l];
+    A[0][l] = H[3][l];
+    E[3][l] = H[4][l];
+    E[2][l] = H[5][l];
+    E[1][l] = H[6][l];
+    E[0][l] = H[7][l];
+  }
+
+  for (size_t t = 0; t < 64; ++t) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint32_t t1 = E[t][l] + Sigma1(E[t + 3][l]) +
+                    Ch(E[t + 3][l], E[t + 2][l], E[t + 1][l]) +
+                    kSha256Round[t] + w[t][l];
+      uint32_t t2 =
+          Sigma0(A[t + 3][l]) + Maj(A[t + 3][l], A[t + 2][l], A[t + 1][l]);
+      E[t + 4][l] = A[t][l] + t1;
+      A[t + 4][l] = t1 + t2;
+    }
+  }
+
+  for (size_t l = 0; l < kLanes; ++l) {
+    H[0][l] += A[67][l];
+    H[1][l] += A[66][l];
+    H[2][l] += A[65][l];
+    H[3][l] += A[64][l];
+    H[4][l] += E[67][l];
+    H[5][l] += E[66][l];
+    H[6][l] += E[65][l];
+    H[7][l] += E[64][l];
+  }
+}
+
+void FlatSHA256Witness::transform_and_witness_messages(
+    size_t k, const size_t n[/*k*/], const uint8_t *const msg[/*k*/],
+    size_t max, uint8_t numb[/*k*/], uint8_t *const in[/*k*/],
+    BlockWitness *const bw[/*k*/]) {
+  for (size_t i = 0; i < k; ++i) {
+    pad_message(n[i], msg[i], max, numb[i], in[i]);
+  }
+
+  // Messages [i0, i0 + nl) occupy lanes [0, nl).  Unused lanes
+  // hash zeros and their results are discarded.
+  for (size_t i0 = 0; i0 < k; i0 += kLanes) {
+    size_t nl = (k - i0 < kLanes) ? k - i0 : kLanes;
+
+    // A block in every lane costs slightly more than kLanes / 2
+    // scalar blocks, so hash groups of up to kLanes / 2 messages
+    // one at a time.
+    if (nl <= kLanes / 2) {
+      for (size_t l = 0; l < nl; ++l) {
+        witness_blocks(in[i0 + l], max, bw[i0 + l]);
+      }
+      continue;
+    }
+
+    uint32_t H[8][kLanes];
+    for (size_t j = 0; j < 8; ++j) {
+      for (size_t l = 0; l < kLanes; ++l) {
+        H[j][l] = initial_h0[j];
+      }
+    }
+
+    for (size_t bl = 0; bl < max; ++bl) {
+      uint32_t data[16][kLanes] = {};
+      for (size_t l = 0; l < nl; ++l) {
+        const uint8_t *p = &in[i0 + l][bl * 64];
+        for (size_t i = 0; i < 16; ++i) {
+          data[i][l] = SHA256_ru32be(&p[i * 4]);
+        }
+      }
+
+      uint32_t w[64][kLanes], E[68][kLanes], A[68][kLanes];
+      transform_and_witness_lanes(data, H, w, E, A);
+
+      for (size_t l = 0; l < nl; ++l) {
+        BlockWitness &b = bw[i0 + l][bl];
+        for (size_t i = 0; i < 48; ++i) {
+          b.outw[i] = w[i + 16][l];
+        }
+        for (size_t t = 0; t < 64; ++t) {
+          b.oute[t] = E[t + 4][l];
+          b.outa[t] = A[t + 4][l];
+        }
+        for (size_t j = 0; j < 8; ++j) {
+          b.h1[j] = H[j][l];
+        }
+      }
+    }
+  }
+}
+
 }  // namespace proofs
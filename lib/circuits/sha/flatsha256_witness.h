@@ -40,6 +40,22 @@ class FlatSHA256Witness {
                                             size_t max, uint8_t &numb,
                                             uint8_t in[/* 64*max */],
                                             BlockWitness bw[/*max*/]);
+
+  // Number of messages that transform_and_witness_messages() hashes
+  // in parallel.
+  static constexpr size_t kLanes = 8;
+
+  // Same as K calls to transform_and_witness_message(), one for each
+  // of the independent messages MSG[i] of length N[i], all padded to
+  // MAX blocks.  Groups of more than kLanes / 2 messages are hashed
+  // one per SIMD lane, and smaller groups one at a time, since a
+  // partly empty lane group is slower than the scalar path.  In
+  // particular, the mdoc witnesses, with 1 to 4 attributes, always
+  // take the scalar path.
+  static void transform_and_witness_messages(
+      size_t k, const size_t n[/*k*/], const uint8_t *const msg[/*k*/],
+      size_t max, uint8_t numb[/*k*/], uint8_t *const in[/*k*/],
+      BlockWitness *const bw[/*k*/]);
 };
 
 }  // namespace proofs
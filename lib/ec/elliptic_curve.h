@@ -17,6 +17,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "algebra/nat.h"
 #include "util/panic.h"
@@ -67,7 +70,8 @@ class EllipticCurve {
         k8(F.of_scalar(8)),
         k3b(F.mulf(k3, b_)),
         k9b(F.mulf(F.of_scalar(9), b_)),
-        k24b(F.mulf(F.of_scalar(24), b_)) {
+        k24b(F.mulf(F.of_scalar(24), b_)),
+        gtable_(std::make_shared<GeneratorTable>()) {
     is_minus_3_a_ = (a_ == F.negf(k3));
     is_zero_a_ = (a_ == F.zero());
   }
@@ -158,6 +162,49 @@ class EllipticCurve {
     return p3;
   }
 
+  // Computes generator() * scalar using a table of precomputed
+  // multiples of the generator, which is built on first use and
+  // shared by all copies of this curve.  Costs one addition per
+  // kWindow bits of the scalar, and no doublings.
+  ECPoint scalar_multf_generator(const N& scalar) const {
+    const std::vector<ECPoint>& tbl = generator_table();
+    ECPoint p3 = zero();
+    for (size_t j = 0; j < kWindows; ++j) {
+      size_t d = window(scalar, j);
+      if (d != 0) {
+        addE(p3, tbl[j * kWindowSize + d]);
+      }
+    }
+    return p3;
+  }
+
+  // Computes generator() * a + p * b, using the generator table for
+  // the fixed base and a kWindow-bit fixed-window method for the
+  // variable base P.
+  ECPoint scalar_multf_generator(const N& a, const ECPoint& p,
+                                 const N& b) const {
+    // tp[d] = d * p
+    ECPoint tp[kWindowSize];
+    tp[0] = zero();
+    tp[1] = p;
+    for (size_t d = 2; d < kWindowSize; ++d) {
+      tp[d] = (d % 2 == 0) ? doubleEf(tp[d / 2]) : addEf(tp[d - 1], p);
+    }
+
+    ECPoint p3 = zero();
+    for (size_t j = kWindows; j-- > 0;) {
+      for (size_t i = 0; i < kWindow; ++i) {
+        doubleE(p3);
+      }
+      size_t d = window(b, j);
+      if (d != 0) {
+        addE(p3, tp[d]);
+      }
+    }
+    addE(p3, scalar_multf_generator(a));
+    return p3;
+  }
+
   // Computes the multi-scalar elliptic curve point multiplication.
   // Input: p1, p2, ..., pn, and scalars s1, s2, ..., sn
   // Output: p1 * s1 + p2 * s2 + ... + pn * sn
@@ -177,8 +224,8 @@ class EllipticCurve {
 
   // Check whether Y^2 = X^3 + aX + b.
   bool is_on_curve(const Elt& X, const Elt& Y) const {
-    Elt left = f_.mulf(Y, Y);
-    Elt X3 = f_.mulf(X, f_.mulf(X, X));
+    Elt left = f_.sqrf(Y);
+    Elt X3 = f_.mulf(X, f_.sqrf(X));
     Elt right = f_.addf(f_.addf(X3, f_.mulf(a_, X)), b_);
     return left == right;
   }
@@ -232,8 +279,8 @@ class EllipticCurve {
     }
 
     Elt Z1Z2 = f_.mulf(Z1, Z2);
-    Elt uu = f_.mulf(u, u);
-    Elt vv = f_.mulf(v, v);
+    Elt uu = f_.sqrf(u);
+    Elt vv = f_.sqrf(v);
     Elt vvv = f_.mulf(v, vv);
     Elt R = f_.mulf(vv, X1Z2);
     Elt A = f_.subf(f_.subf(f_.mulf(uu, Z1Z2), vvv), f_.mulf(k2, R));
@@ -265,11 +312,11 @@ class EllipticCurve {
       return;
     }
 
-    Elt Z2 = f_.mulf(Z, Z);
-    Elt X2 = f_.mulf(X, X);
+    Elt Z2 = f_.sqrf(Z);
+    Elt X2 = f_.sqrf(X);
     Elt X2_3 = f_.addf(f_.addf(X2, X2), X2);
     Elt s = f_.mulf(Y, Z);
-    Elt ss = f_.mulf(s, s);
+    Elt ss = f_.sqrf(s);
     Elt sss = f_.mulf(s, ss);
     Elt sss_2 = f_.addf(sss, sss);
     Elt w = f_.addf(f_.mulf(a_, Z2), X2_3);
@@ -278,10 +325,10 @@ class EllipticCurve {
     Elt B = f_.mulf(X, R);
     Elt sss_8 = f_.addf(sss_4, sss_4);
     Elt B_2 = f_.addf(B, B);
-    Elt R2 = f_.mulf(R, R);
+    Elt R2 = f_.sqrf(R);
     Elt B_4 = f_.addf(B_2, B_2);
     Elt B_8 = f_.addf(B_4, B_4);
-    Elt w2 = f_.mulf(w, w);
+    Elt w2 = f_.sqrf(w);
     Elt h = f_.subf(w2, B_8);
     Elt s_2 = f_.addf(s, s);
     Elt X3 = f_.mulf(h, s_2);
@@ -297,6 +344,46 @@ class EllipticCurve {
   }
 
  private:
+  // Fixed-window parameters of the generator table, which holds
+  // d * 2^(kWindow * j) * generator() at index j * kWindowSize + d,
+  // for all kWindows windows j of an N and all 0 <= d < kWindowSize.
+  static constexpr size_t kWindow = 4;
+  static constexpr size_t kWindowSize = size_t(1) << kWindow;
+  static constexpr size_t kWindows =
+      (N::kLimbs * N::kBitsPerLimb + kWindow - 1) / kWindow;
+  static_assert(N::kBitsPerLimb % kWindow == 0,
+                "windows must not straddle limbs");
+
+  struct GeneratorTable {
+    std::once_flag once;
+    std::vector<ECPoint> tbl;
+  };
+
+  static size_t window(const N& scalar, size_t j) {
+    size_t bit = j * kWindow;
+    return (scalar.limb_[bit / N::kBitsPerLimb] >> (bit % N::kBitsPerLimb)) &
+           (kWindowSize - 1);
+  }
+
+  const std::vector<ECPoint>& generator_table() const {
+    std::call_once(gtable_->once, [this]() {
+      std::vector<ECPoint>& tbl = gtable_->tbl;
+      tbl.resize(kWindows * kWindowSize);
+      ECPoint base = generator();
+      for (size_t j = 0; j < kWindows; ++j) {
+        ECPoint* t = &tbl[j * kWindowSize];
+        t[0] = zero();
+        for (size_t d = 1; d < kWindowSize; ++d) {
+          t[d] = addEf(t[d - 1], base);
+        }
+        for (size_t i = 0; i < kWindow; ++i) {
+          doubleE(base);
+        }
+      }
+    });
+    return gtable_->tbl;
+  }
+
   /* From Algorithm 7: Complete, projective point addition for prime order
     j-invariant 0 short Weierstrass curves E/Fq : y^2 = x^3 + b.
 
@@ -388,9 +475,9 @@ class EllipticCurve {
    */
   void doubleEMinus3A(Elt& X3o, Elt& Y3o, Elt& Z3o, const Elt& X, const Elt& Y,
                       const Elt& Z) const {
-    Elt t0 = f_.mulf(X, X);
-    Elt t1 = f_.mulf(Y, Y);
-    Elt t2 = f_.mulf(Z, Z);
+    Elt t0 = f_.sqrf(X);
+    Elt t1 = f_.sqrf(Y);
+    Elt t2 = f_.sqrf(Z);
     Elt t3 = f_.mulf(X, Y);
     t3 = f_.addf(t3, t3);
     Elt Z3 = f_.mulf(X, Z);
@@ -438,8 +525,8 @@ class EllipticCurve {
   void doubleEZeroA(Elt& X3o, Elt& Y3o, Elt& Z3o, const Elt& X, const Elt& Y,
                     const Elt& Z) const {
     Elt t0 = f_.mulf(X, Y);
-    Elt t1 = f_.mulf(Y, Y);
-    Elt t2 = f_.mulf(Z, Z);
+    Elt t1 = f_.sqrf(Y);
+    Elt t2 = f_.sqrf(Z);
     Elt t4 = f_.mulf(Y, Z);
     Elt t5 = f_.mulf(k9b, t2);  // 9bZZ
     Elt t6 = f_.subf(t1, t5);   // YY - 9bZZ
@@ -590,6 +677,7 @@ class EllipticCurve {
 
   bool is_zero_a_;
   bool is_minus_3_a_;
+  std::shared_ptr<GeneratorTable> gtable_;
 };
 }  // namespace proofs
 
@@ -395,6 +395,50 @@ TEST(EllipticCurve, P256MultiExponentiation) {
   }
 }
 
+TEST(EllipticCurve, P256FixedBase) {
+  auto g = p256.generator();
+
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint64_t> dist;
+  auto random_nat = [&]() {
+    std::array<uint64_t, W> init;
+    for (size_t j = 0; j < W; ++j) {
+      init[j] = dist(rng);
+    }
+    return P256::N(init);
+  };
+
+  // copies share the generator table
+  const P256 ec = p256;
+
+  auto pk = p256.scalar_multf(g, P256::N(12345));
+  for (size_t i = 0; i < 20; ++i) {
+    P256::N a = random_nat(), b = random_nat();
+    if (i == 0) {
+      a = P256::N(0);
+    } else if (i == 1) {
+      b = P256::N(0);
+    } else if (i == 2) {
+      a = P256::N(1);
+    }
+    auto want_a = p256.scalar_multf(g, a);
+    EXPECT_TRUE(p256.equal(want_a, p256.scalar_multf_generator(a)));
+    EXPECT_TRUE(p256.equal(want_a, ec.scalar_multf_generator(a)));
+
+    P256::ECPoint bases[] = {g, pk};
+    P256::N scalars[] = {a, b};
+    auto want = p256.scalar_multf(2, bases, scalars);
+    auto got = p256.scalar_multf_generator(a, pk, b);
+    EXPECT_TRUE(p256.equal(want, got));
+  }
+
+  // g * (order - 1) + g = 0
+  P256::N nm1 = n256_order;
+  nm1.sub(P256::N(1));
+  auto z = p256.scalar_multf_generator(nm1, g, P256::N(1));
+  EXPECT_TRUE(p256.equal(p256.zero(), z));
+}
+
 // ============================= Benchmarks ================================
 
 void BM_add_p256(benchmark::State& state) {
@@ -445,6 +489,45 @@ void BM_scalar(benchmark::State& state) {
 }
 BENCHMARK(BM_scalar);
 
+// g * a + pk * b as computed by the ECDSA witness, via Bos-Coster
+// and via the fixed-base table.
+void BM_scalar2_p256(benchmark::State& state) {
+  auto g = p256.generator();
+  auto pk = p256.scalar_multf(g, P256::N(12345));
+  P256::N a(
+      "0x8f3a9b27c1d4e65f0a1b2c3d4e5f60718293a4b5c6d7e8f90123456789abcdef");
+  P256::N b(
+      "0x1d2c3b4a59687766554433221100ffeeddccbbaa99887766554433221100ffee");
+  for (auto _ : state) {
+    P256::ECPoint bases[] = {g, pk};
+    P256::N scalars[] = {a, b};
+    benchmark::DoNotOptimize(p256.scalar_multf(2, bases, scalars));
+  }
+}
+BENCHMARK(BM_scalar2_p256);
+
+void BM_scalar2_fixed_base_p256(benchmark::State& state) {
+  auto g = p256.generator();
+  auto pk = p256.scalar_multf(g, P256::N(12345));
+  P256::N a(
+      "0x8f3a9b27c1d4e65f0a1b2c3d4e5f60718293a4b5c6d7e8f90123456789abcdef");
+  P256::N b(
+      "0x1d2c3b4a59687766554433221100ffeeddccbbaa99887766554433221100ffee");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(p256.scalar_multf_generator(a, pk, b));
+  }
+}
+BENCHMARK(BM_scalar2_fixed_base_p256);
+
+void BM_scalar_generator_p256(benchmark::State& state) {
+  P256::N a(
+      "0x8f3a9b27c1d4e65f0a1b2c3d4e5f60718293a4b5c6d7e8f90123456789abcdef");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(p256.scalar_multf_generator(a));
+  }
+}
+BENCHMARK(BM_scalar_generator_p256);
+
 void BM_commit(benchmark::State& state) {
   auto p = ec_32543.point(
       f_32543.of_string("104494200016653967385948977022237419181744316220626192"
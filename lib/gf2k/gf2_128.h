@@ -17,11 +17,13 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "gf2k/gf2poly.h"
 #include "gf2k/sysdep.h"
@@ -111,6 +113,9 @@ class GF2_128 {
     // Reduce the basis to row-echelon form
     beta_ref();
 
+    // Tables for of_scalar() and project()
+    subfield_tables();
+
     // Evaluation points.  We use g^i for these as well
     poly_evaluation_points_[0] = zero();
     Elt gi = one();
@@ -142,13 +147,13 @@ class GF2_128 {
   // The bits of u are the coordinates with respect to the basis
   // beta_[] of the subfield.
   Elt of_scalar(uint64_t u) const {
-    Elt t = zero();
-    for (size_t k = 0; k < kSubFieldBits; ++k, u >>= 1) {
-      if (u & 1) {
-        add(t, beta_[k]);
-      }
+    if constexpr (kSubFieldBits < 64) {
+      check((u >> kSubFieldBits) == 0, "of_scalar(u), too many bits");
+    }
+    Elt t = embed_[0][u & 0xFFu];
+    for (size_t b = 1; b < kSubFieldBytes; ++b) {
+      add(t, embed_[b][(u >> (8 * b)) & 0xFFu]);
     }
-    check(u == 0, "of_scalar(u), too many bits");
     return t;
   }
 
@@ -172,11 +177,32 @@ class GF2_128 {
     x.unpack().to_bytes(ab);
   }
 
-  bool in_subfield(Elt e) const {
-    auto eu = solve(e);
-    return eu.first == N1{};
+  // Bulk versions of to_bytes_field() and of_bytes_field() for the N
+  // elements X[i * INCX], stored in N * kBytes contiguous bytes.
+  // Every byte string is a valid element, so of_bytes_field_n()
+  // always returns true.
+  void to_bytes_field_n(size_t n, uint8_t ab[/* n * kBytes */],
+                        const Elt x[/*n:incx*/], size_t incx) const {
+    for (size_t i = 0; i < n; ++i) {
+      x[i * incx].unpack().to_bytes(&ab[i * kBytes]);
+    }
+  }
+
+  bool of_bytes_field_n(size_t n, Elt x[/*n*/],
+                        const uint8_t ab[/* n * kBytes */]) const {
+    for (size_t i = 0; i < n; ++i) {
+      x[i] = of_scalar_field(N1::of_bytes(&ab[i * kBytes]).u64());
+    }
+    return true;
   }
 
+  bool in_subfield(Elt e) const { return of_scalar(project(e)) == e; }
+
+  // The u such that of_scalar(u) == x, if x is in the subfield.
+  // For other x the result is meaningless, but the map is linear in
+  // x, so that callers can tabulate it.
+  uint64_t subfield_projection(const Elt& x) const { return project(x); }
+
   std::optional<Elt> of_bytes_subfield(
       const uint8_t ab[/* kSubFieldBytes */]) const {
     uint64_t u = 0;
@@ -188,9 +214,8 @@ class GF2_128 {
   }
 
   void to_bytes_subfield(uint8_t ab[/* kSubFieldBytes */], const Elt& x) const {
-    auto eu = solve(x);
-    check(eu.first == N1{}, "eu.first == N1{}");
-    uint64_t u = eu.second;
+    uint64_t u = project(x);
+    check(of_scalar(u) == x, "x not in subfield");
     for (size_t i = 0; i < kSubFieldBytes; ++i) {
       ab[i] = u & 0xFFu;
       u >>= 8;
@@ -331,6 +356,14 @@ class GF2_128 {
   // reconstruct it from u_, but we cache it for efficiency.
   size_t ldnz_[kSubFieldBits];
 
+  // embed_[b][v] = of_scalar(v << (8 * b)), and proj_[b][v] is the
+  // solve() coordinates of the element whose byte B is V and whose
+  // other bytes are zero.  Since solve() is linear and only looks at
+  // the pivot columns ldnz_[], proj_ only needs the bytes up to the
+  // last pivot.
+  Elt embed_[kSubFieldBytes][256];
+  std::vector<std::array<uint64_t, 256>> proj_;
+
   Elt poly_evaluation_points_[kNPolyEvaluationPoints];
   Elt newton_denominators_[kNPolyEvaluationPoints][kNPolyEvaluationPoints];
 
@@ -463,6 +496,49 @@ class GF2_128 {
     check(rnk == kSubFieldBits, "rnk == kSubFieldBits");
   }
 
+  void subfield_tables() {
+    for (size_t b = 0; b < kSubFieldBytes; ++b) {
+      embed_[b][0] = zero();
+      for (size_t v = 1; v < 256; ++v) {
+        // v = (v & (v - 1)) + 2^k, where k is the lowest set bit
+        size_t k = 0;
+        while (((v >> k) & 1) == 0) {
+          ++k;
+        }
+        embed_[b][v] = addf(embed_[b][v & (v - 1)], beta_[8 * b + k]);
+      }
+    }
+
+    size_t nproj = 0;
+    for (size_t rnk = 0; rnk < kSubFieldBits; ++rnk) {
+      nproj = std::max(nproj, (ldnz_[rnk] / 8) + 1);
+    }
+    proj_.resize(nproj);
+    for (size_t b = 0; b < nproj; ++b) {
+      proj_[b][0] = 0;
+      for (size_t v = 1; v < 256; ++v) {
+        size_t k = 0;
+        while (((v >> k) & 1) == 0) {
+          ++k;
+        }
+        std::array<uint64_t, 2> e = {0, 0};
+        e[(8 * b + k) / 64] = uint64_t(1) << ((8 * b + k) % 64);
+        proj_[b][v] =
+            proj_[b][v & (v - 1)] ^ solve(of_scalar_field(e)).second;
+      }
+    }
+  }
+
+  // Equivalent to solve(e).second, by table lookup
+  uint64_t project(const Elt& e) const {
+    auto w = uint64x2_of_gf2_128(e.n);
+    uint64_t u = 0;
+    for (size_t b = 0; b < proj_.size(); ++b) {
+      u ^= proj_[b][(w[b / 8] >> (8 * (b % 8))) & 0xFFu];
+    }
+    return u;
+  }
+
   std::pair<N1, uint64_t> solve(const Elt& e) const {
     uint64_t u = 0;
     N1 ue = e.unpack();
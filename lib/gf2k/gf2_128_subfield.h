@@ -0,0 +1,146 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_GF2K_GF2_128_SUBFIELD_H_
+#define PRIVACY_PROOFS_ZK_LIB_GF2K_GF2_128_SUBFIELD_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "util/panic.h"
+
+namespace proofs {
+
+// The subfield of a GF2_128 field, where the element F.of_scalar(u)
+// is represented by its coordinates u with respect to the basis
+// F.beta(i).  Addition is xor, and multiplication uses log/exp tables
+// with respect to the generator F.g() of the subfield.  Conversions
+// use the tables of F.of_scalar() and F.subfield_projection().
+//
+// The class implements the part of the field interface used by LCH14.
+// Since the LCH14 twiddle factors are in the subfield, a transform of
+// subfield data can run on these short coordinates instead of 128-bit
+// elements, and it produces the same result.
+template <class Field>
+class GF2_128Subfield {
+  using FieldElt = typename Field::Elt;
+
+ public:
+  static constexpr size_t kSubFieldBits = Field::kSubFieldBits;
+  static constexpr size_t kSubFieldBytes = Field::kSubFieldBytes;
+  static constexpr bool kCharacteristicTwo = true;
+
+  // The tables have 2^kSubFieldBits entries, and the constructor
+  // fails for larger subfields.
+  static constexpr size_t kMaxSubFieldBits = 16;
+
+  struct Elt {
+    uint16_t u;
+
+    bool operator==(const Elt& y) const { return u == y.u; }
+    bool operator!=(const Elt& y) const { return !operator==(y); }
+  };
+
+  explicit GF2_128Subfield(const Field& F) : f_(F) {
+    check(kSubFieldBits <= kMaxSubFieldBits, "subfield too large");
+    constexpr size_t order = (size_t(1) << kSubFieldBits) - 1;
+
+    // mg[b][v] = coordinates of g * of_scalar(v << (8 * b)), i.e.,
+    // the linear map "multiply by g", tabulated by bytes
+    std::vector<std::array<uint16_t, 256>> mg(kSubFieldBytes);
+    for (size_t b = 0; b < kSubFieldBytes; ++b) {
+      for (size_t v = 0; v < 256; ++v) {
+        Elt e{static_cast<uint16_t>(v << (8 * b))};
+        auto u = of_field(f_.mulf(f_.g(), to_field(e)));
+        check(u.has_value(), "g * beta(i) not in subfield");
+        mg[b][v] = u.value().u;
+      }
+    }
+    check(to_field(one()) == f_.one(), "one() != beta(0)");
+
+    // exp_[k] = g^k for 0 <= k < 2 * order, so that log(x) + log(y)
+    // needs no reduction.  The log of zero is 2 * order, which points
+    // into a region of zeroes large enough for the sum of two such
+    // logs, so that mulf() needs no test for zero.
+    exp_.resize(4 * order + 1, 0);
+    log_.resize(order + 1);
+    uint32_t x = 1;
+    for (size_t k = 0; k < order; ++k) {
+      check(k == 0 || x != 1, "g is not a generator");
+      exp_[k] = exp_[k + order] = static_cast<uint16_t>(x);
+      log_[x] = static_cast<uint32_t>(k);
+
+      uint32_t gx = 0;
+      for (size_t b = 0; b < kSubFieldBytes; ++b) {
+        gx ^= mg[b][(x >> (8 * b)) & 0xFFu];
+      }
+      x = gx;
+    }
+    check(x == 1, "g^order != 1");
+    log_[0] = static_cast<uint32_t>(2 * order);
+  }
+
+  GF2_128Subfield(const GF2_128Subfield&) = delete;
+  GF2_128Subfield& operator=(const GF2_128Subfield&) = delete;
+
+  // The subfield coordinates of X, or nullopt if X is not in the
+  // subfield.
+  std::optional<Elt> of_field(const FieldElt& x) const {
+    Elt e{static_cast<uint16_t>(f_.subfield_projection(x))};
+    if (to_field(e) != x) {
+      return std::nullopt;
+    }
+    return e;
+  }
+
+  FieldElt to_field(const Elt& x) const { return f_.of_scalar(x.u); }
+
+  // functional interface
+  Elt addf(const Elt& x, const Elt& y) const {
+    return Elt{static_cast<uint16_t>(x.u ^ y.u)};
+  }
+  Elt subf(const Elt& x, const Elt& y) const { return addf(x, y); }
+  Elt mulf(const Elt& x, const Elt& y) const {
+    return Elt{exp_[size_t(log_[x.u]) + log_[y.u]]};
+  }
+  Elt invertf(const Elt& x) const {
+    check(x.u != 0, "invertf(0)");
+    constexpr size_t order = (size_t(1) << kSubFieldBits) - 1;
+    return Elt{exp_[order - log_[x.u]]};
+  }
+
+  // two-operands interface
+  void add(Elt& a, const Elt& y) const { a = addf(a, y); }
+  void sub(Elt& a, const Elt& y) const { a = subf(a, y); }
+  void mul(Elt& a, const Elt& y) const { a = mulf(a, y); }
+
+  Elt zero() const { return Elt{0}; }
+  Elt one() const { return Elt{1}; }
+  Elt beta(size_t i) const {
+    check(i < kSubFieldBits, "i < kSubFieldBits");
+    return Elt{static_cast<uint16_t>(1u << i)};
+  }
+
+ private:
+  const Field& f_;
+  std::vector<uint16_t> exp_;
+  std::vector<uint32_t> log_;
+};
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_GF2K_GF2_128_SUBFIELD_H_
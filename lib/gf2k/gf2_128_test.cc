@@ -25,6 +25,7 @@
 #include "algebra/bogorng.h"
 #include "algebra/compare.h"
 #include "algebra/poly.h"
+#include "gf2k/gf2_128_subfield.h"
 #include "gtest/gtest.h"
 
 namespace proofs {
@@ -359,7 +360,55 @@ TEST(GF2_128, Bytes) {
     EXPECT_TRUE(ef != std::nullopt);
     EXPECT_EQ(e, ef.value());
   }
+
+  // bulk conversions, with stride 3
+  std::vector<Elt> x(3 * n);
+  for (size_t i = 0; i < 3 * n; ++i) {
+    x[i] = F.mulf(F.of_scalar(i % n), F.x());
+  }
+  std::vector<uint8_t> want(n * F.kBytes), got(n * F.kBytes);
+  for (size_t i = 0; i < n; ++i) {
+    F.to_bytes_field(&want[i * F.kBytes], x[3 * i]);
+  }
+  F.to_bytes_field_n(n, got.data(), x.data(), 3);
+  EXPECT_EQ(want, got);
+  std::vector<Elt> y(n);
+  EXPECT_TRUE(F.of_bytes_field_n(n, y.data(), got.data()));
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(y[i], x[3 * i]);
+  }
 }
+TEST(GF2_128, SubfieldTables) {
+  const GF2_128Subfield<Field> SF(F);
+  using SElt = GF2_128Subfield<Field>::Elt;
+
+  uint64_t s = 7;
+  for (size_t iter = 0; iter < 1000; ++iter) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    uint16_t a = s >> 48, b = (s >> 32) & 0xFFFFu;
+    if (iter < 3) {
+      a = iter;  // include 0, 1, 2
+    }
+    Elt ea = F.of_scalar(a), eb = F.of_scalar(b);
+    SElt sa{a}, sb{b};
+
+    EXPECT_EQ(SF.to_field(sa), ea);
+    auto oa = SF.of_field(ea);
+    ASSERT_TRUE(oa.has_value());
+    EXPECT_EQ(oa.value(), sa);
+
+    EXPECT_EQ(SF.to_field(SF.addf(sa, sb)), F.addf(ea, eb));
+    EXPECT_EQ(SF.to_field(SF.mulf(sa, sb)), F.mulf(ea, eb));
+    if (a != 0) {
+      EXPECT_EQ(SF.to_field(SF.invertf(sa)), F.invertf(ea));
+    }
+  }
+  for (size_t i = 0; i < Field::kSubFieldBits; ++i) {
+    EXPECT_EQ(SF.to_field(SF.beta(i)), F.beta(i));
+  }
+  EXPECT_FALSE(SF.of_field(F.x()).has_value());
+}
+
 }  // namespace
 
 namespace subfield {
@@ -21,6 +21,7 @@
 #include <memory>
 #include <vector>
 
+#include "gf2k/gf2_128_subfield.h"
 #include "gf2k/lch14.h"
 
 namespace proofs {
@@ -28,6 +29,8 @@ namespace proofs {
 template <class Field>
 class LCH14ReedSolomon {
   using Elt = typename Field::Elt;
+  using Subfield = GF2_128Subfield<Field>;
+  using SElt = typename Subfield::Elt;
 
   // only works in binary fields
   static_assert(Field::kCharacteristicTwo);
@@ -41,12 +44,50 @@ class LCH14ReedSolomon {
   // In principle we don't need to know N and M at construction time,
   // but we require N and M for compatibility of the interface with
   // the ReedSolomon class over prime fields.
-  LCH14ReedSolomon(size_t n, size_t m, const Field& F)
-      : f_(F), n_(n), m_(m), fft_(F) {}
+  //
+  // If SFFT is not null, inputs that are entirely in the subfield
+  // are interpolated in the subfield representation SF.
+  LCH14ReedSolomon(size_t n, size_t m, const Field& F,
+                   const Subfield* sf = nullptr,
+                   const LCH14<Subfield>* sfft = nullptr)
+      : f_(F), n_(n), m_(m), fft_(F), sf_(sf), sfft_(sfft) {}
 
   // Y[i] is expected to be defined for 0 <= i < N, and this
   // routine fills it for 0 <= i < M
   void interpolate(Elt y[/*m*/]) const {
+    if (sfft_ != nullptr) {
+      // Rows that are entirely in the subfield, such as most witness
+      // rows of the hash circuit, are transformed on their subfield
+      // coordinates and embedded back at the end.  Other rows usually
+      // fail the test at y[0].
+      std::vector<SElt> ys(m_);
+      if (to_subfield(&ys[0], y)) {
+        interpolate_in(*sf_, *sfft_, &ys[0]);
+        for (size_t i = n_; i < m_; ++i) {
+          y[i] = sf_->to_field(ys[i]);
+        }
+        return;
+      }
+    }
+    interpolate_in(f_, fft_, y);
+  }
+
+ private:
+  bool to_subfield(SElt ys[/*n*/], const Elt y[/*n*/]) const {
+    for (size_t i = 0; i < n_; ++i) {
+      auto u = sf_->of_field(y[i]);
+      if (!u.has_value()) {
+        return false;
+      }
+      ys[i] = u.value();
+    }
+    return true;
+  }
+
+  // The interpolation proper, in field F with elements of type E,
+  // which is either Field or its Subfield.
+  template <class F, class E>
+  void interpolate_in(const F& f, const LCH14<F>& fft, E y[/*m*/]) const {
     // determine the FFT size
     size_t l = 0;
     size_t fftn = 1;
@@ -56,7 +97,7 @@ class LCH14ReedSolomon {
     }
 
     // "coefficients" in the LCH14 novel polynomial basis
-    std::vector<Elt> C(fftn);
+    std::vector<E> C(fftn);
 
     // compute the "coefficients" under the assumption
     // that we know n_ evaluations and that the higher-order
@@ -65,9 +106,9 @@ class LCH14ReedSolomon {
       C[i] = y[i];
     }
     for (size_t i = n_; i < fftn; ++i) {
-      C[i] = f_.zero();
+      C[i] = f.zero();
     }
-    fft_.BidirectionalFFT(l, /*k=*/n_, &C[0]);
+    fft.BidirectionalFFT(l, /*k=*/n_, &C[0]);
 
     // fill in the missing evaluations in the first coset, since we
     // already have the missing evaluations in C[[n_, (1<<l))]
@@ -77,7 +118,7 @@ class LCH14ReedSolomon {
 
     // revert C to pure coefficients for later use
     for (size_t i = n_; i < fftn; ++i) {
-      C[i] = f_.zero();
+      C[i] = f.zero();
     }
 
     // all remaining cosets:
@@ -89,10 +130,10 @@ class LCH14ReedSolomon {
         for (size_t i = 0; i < fftn; ++i) {
           y[i + b] = C[i];
         }
-        fft_.FFT(l, b, &y[b]);
+        fft.FFT(l, b, &y[b]);
       } else {
         // Partial fit.  Transform C and copy the output.
-        fft_.FFT(l, b, &C[0]);
+        fft.FFT(l, b, &C[0]);
         for (size_t i = 0; i + b < m_; ++i) {
           y[i + b] = C[i];
         }
@@ -102,24 +143,37 @@ class LCH14ReedSolomon {
     }
   }
 
- private:
   const Field& f_;
   size_t n_;
   size_t m_;
   LCH14<Field> fft_;
+  const Subfield* sf_;
+  const LCH14<Subfield>* sfft_;
 };
 
 template <class Field>
 class LCH14ReedSolomonFactory {
+  using Subfield = GF2_128Subfield<Field>;
+
  public:
-  explicit LCH14ReedSolomonFactory(const Field& f) : f_(f) {}
+  // The subfield tables are built once here and shared by all
+  // encoders, if the subfield is small enough to have them.
+  explicit LCH14ReedSolomonFactory(const Field& f) : f_(f) {
+    if (Field::kSubFieldBits <= Subfield::kMaxSubFieldBits) {
+      sf_ = std::make_unique<const Subfield>(f_);
+      sfft_ = std::make_unique<const LCH14<Subfield>>(*sf_);
+    }
+  }
 
   std::unique_ptr<LCH14ReedSolomon<Field>> make(size_t n, size_t m) const {
-    return std::make_unique<LCH14ReedSolomon<Field>>(n, m, f_);
+    return std::make_unique<LCH14ReedSolomon<Field>>(n, m, f_, sf_.get(),
+                                                     sfft_.get());
   }
 
  private:
   const Field& f_;
+  std::unique_ptr<const Subfield> sf_;
+  std::unique_ptr<const LCH14<Subfield>> sfft_;
 };
 
 }  // namespace proofs
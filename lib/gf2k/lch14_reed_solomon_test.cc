@@ -15,6 +15,7 @@
 #include "gf2k/lch14_reed_solomon.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "algebra/bogorng.h"
@@ -66,6 +67,40 @@ TEST(LCH14, ReedSolomon) {
     }
   }
 }
+
+// The subfield path of the factory's encoders must agree with the
+// plain GF(2^128) transform.
+TEST(LCH14, ReedSolomonSubfield) {
+  using Field = GF2_128<4>;
+  using Elt = Field::Elt;
+  static const Field F;
+  LCH14ReedSolomonFactory<Field> rs_factory(F);
+  uint64_t s = 1;
+
+  for (size_t m : {1, 7, 8, 9, 63, 64, 65, 99, 128, 1000}) {
+    for (size_t n = 1; n < m; n += 1 + n / 8) {
+      auto rs = rs_factory.make(n, m);
+      const LCH14ReedSolomon<Field> rs_full(n, m, F);
+
+      for (bool subfield : {true, false}) {
+        std::vector<Elt> Y(m), Z(m);
+        for (size_t i = 0; i < n; ++i) {
+          s = s * 6364136223846793005ull + 1442695040888963407ull;
+          Y[i] = F.of_scalar(s >> 48);
+        }
+        if (!subfield) {
+          // one element outside the subfield disables the subfield path
+          Y[n - 1] = F.x();
+        }
+        Z = Y;
+
+        rs->interpolate(&Y[0]);
+        rs_full.interpolate(&Z[0]);
+        EXPECT_EQ(Y, Z);
+      }
+    }
+  }
+}
 }  // namespace
 
 namespace bench {
@@ -106,5 +141,27 @@ void BM_ReedSolomon_gf128(benchmark::State& state) {
 
 BENCHMARK(BM_ReedSolomon_gf128)->RangeMultiplier(4)->Range(1 << 10, 1 << 20);
 
+// Same as above, with all inputs in the subfield.
+void BM_ReedSolomon_gf128_subfield(benchmark::State& state) {
+  using Field = GF2_128<4>;
+  using Elt = Field::Elt;
+  static const Field F;
+  size_t n = state.range(0);
+  LCH14ReedSolomonFactory<Field> rs_factory(F);
+  auto rs = rs_factory.make(n, n * 4);
+
+  std::vector<Elt> L2(n + n * 4);
+  for (size_t i = 0; i < n; ++i) {
+    L2[i] = F.of_scalar((i * 40503u) & 0xFFFFu);
+  }
+  for (auto _ : state) {
+    rs->interpolate(&L2[0]);
+  }
+}
+
+BENCHMARK(BM_ReedSolomon_gf128_subfield)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 14);
+
 }  // namespace bench
 }  // namespace proofs
@@ -138,6 +138,9 @@ struct LigeroParam {
   size_t mc_pathlen;  // length of a Merkle-tree proof
                       // with BLOCK_ENC-BLOCK leaves
 
+  // shape of the Merkle tree over the BLOCK_EXT columns
+  MerkleShape mc_shape;
+
   // layout of rows
   size_t ildt;   // blinding for the low-degree test
   size_t idot;   // blinding row for the dot-product check
@@ -168,15 +171,33 @@ struct LigeroParam {
     sanity();
   }
 
-  // Constructor that accepts a pre-computed block_enc.
+  // Constructor that accepts a pre-computed block_enc, and optionally
+  // a Merkle shape other than the binary tree.
   LigeroParam(size_t nw, size_t nq, size_t rateinv, size_t nreq,
-              size_t be)
-      : nw(nw), nq(nq), rateinv(rateinv), nreq(nreq), block_enc(be) {
+              size_t be, const MerkleShape& shape = MerkleShape{})
+      : nw(nw),
+        nq(nq),
+        rateinv(rateinv),
+        nreq(nreq),
+        block_enc(be),
+        mc_shape(shape) {
     r = nreq;
     check(layout(block_enc) < SIZE_MAX, "block_enc too large");
     sanity();
   }
 
+  // The number of columns BLOCK_EXT that layout(BE) commits to with a
+  // Merkle tree, or 0 if BE is too small for RATEINV.  This lets
+  // callers validate a Merkle shape before constructing a parameter
+  // set, which aborts on invalid shapes.
+  static size_t block_ext_for(size_t be, size_t rateinv) {
+    if (be + 1 < 2 + rateinv) {
+      return 0;
+    }
+    size_t dblock = 2 * ((be + 1) / (2 + rateinv)) - 1;
+    return be < dblock ? 0 : be - dblock;
+  }
+
   // Return an estimate of the proof size.
   //
   // This function is kind of a hack in that it breaks abstraction
@@ -255,7 +276,11 @@ struct LigeroParam {
       return SIZE_MAX;
     }
 
-    mc_pathlen = merkle_commitment_len(block_ext);
+    // The tree must be deep enough for the cap.
+    if (!MerkleLayout::valid(block_ext, mc_shape)) {
+      return SIZE_MAX;
+    }
+    mc_pathlen = merkle_commitment_len(block_ext, mc_shape);
 
     /* proof+commitment size.  */
     // Compute the size in uint64_t instead of size_t since
@@ -263,7 +288,7 @@ struct LigeroParam {
     uint64_t sz = 0;
 
     // commitment
-    sz += sizeof(Digest);
+    sz += static_cast<uint64_t>(mc_shape.cap) * sizeof(Digest);
 
     // Merkle openings, approximated because the exact # of leaves depends
     // on the random coins.
@@ -308,7 +333,9 @@ struct LigeroParam {
 
 template <class Field>
 struct LigeroCommitment {
-  Digest root;
+  // The cap of the Merkle tree, [mc_shape.cap].  For the default
+  // shape this is the root alone.
+  std::vector<Digest> cap;
 };
 
 template <class Field>
@@ -428,10 +455,14 @@ class LigeroCommon {
 
   static void column_hash(size_t n, const Elt x[/*n:incx*/], size_t incx,
                           SHA256 &sha, const Field &F) {
-    for (size_t i = 0; i < n; ++i) {
-      uint8_t buf[Field::kBytes];
-      F.to_bytes_field(buf, x[i * incx]);
-      sha.Update(buf, sizeof(buf));
+    // Serialize in chunks, so that the hash sees a few long updates
+    // instead of one update per element.
+    constexpr size_t kChunk = 64;
+    uint8_t buf[kChunk * Field::kBytes];
+    for (size_t i = 0; i < n; i += kChunk) {
+      size_t m = std::min(kChunk, n - i);
+      F.to_bytes_field_n(m, buf, &x[i * incx], incx);
+      sha.Update(buf, m * Field::kBytes);
     }
   }
 };
@@ -19,6 +19,8 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "algebra/blas.h"
@@ -31,13 +33,62 @@
 #include "util/panic.h"
 
 namespace proofs {
+
+// Bytes of the tableau that LigeroProver allocates for parameters P.
+// Witness rows entirely below SUBFIELD_BOUNDARY are stored packed
+// when the subfield encoding is shorter than a full element.
+template <class Field>
+size_t ligero_tableau_size(const LigeroParam<Field> &p,
+                           size_t subfield_boundary) {
+  size_t npacked = 0;
+  if (Field::kSubFieldBytes < Field::kBytes) {
+    npacked = std::min(p.nwrow, subfield_boundary / p.w);
+  }
+  return (p.nrow - npacked) * p.block_enc * sizeof(typename Field::Elt) +
+         npacked * p.block_enc * Field::kSubFieldBytes;
+}
+
 template <class Field, class InterpolatorFactory>
 class LigeroProver {
   using Elt = typename Field::Elt;
 
  public:
   explicit LigeroProver(const LigeroParam<Field> &p)
-      : p_(p), mc_(p.block_enc - p.dblock), tableau_(p.nrow * p.block_enc) {}
+      : p_(p),
+        mc_(p.block_enc - p.dblock, p.mc_shape),
+        packed_row_(p.nrow),
+        row_index_(p.nrow),
+        precomputed_(false),
+        precomputed_subfield_boundary_(0),
+        cancel_(nullptr) {}
+
+  const LigeroParam<Field> &param() const { return p_; }
+
+  // Once *CANCEL becomes true, commit() abandons the layout of the
+  // tableau at the next row and returns false.
+  void set_cancel(const std::atomic<bool> *cancel) { cancel_ = cancel; }
+
+  // Perform the part of commit() that depends only on the randomness
+  // and on the shape of the tableau: encode the three blinding rows,
+  // draw the random prefixes of the witness and quadratic rows, and
+  // draw the Merkle nonces.  A subsequent commit() with the same
+  // SUBFIELD_BOUNDARY then only lays out and encodes the witnesses.
+  void precompute(size_t subfield_boundary,
+                  const InterpolatorFactory &interpolator, RandomEngine &rng,
+                  const Field &F) {
+    check(!precomputed_, "LigeroProver already precomputed");
+    allocate_tableau(subfield_boundary);
+    layout_blinding_rows(interpolator, rng, F);
+    for (size_t i = 0; i < p_.nwrow; ++i) {
+      random_witness_prefix(i, subfield_boundary, rng, F);
+    }
+    for (size_t i = 0; i < 3 * p_.nqtriples; ++i) {
+      random_row(p_.iq + i, p_.r, rng, F);
+    }
+    mc_.precompute_nonces(rng);
+    precomputed_ = true;
+    precomputed_subfield_boundary_ = subfield_boundary;
+  }
 
   // The SUBFIELD_BOUNDARY parameter is kind of a hack.
   //
@@ -55,7 +106,10 @@ class LigeroProver {
   // i < SUBFIELD_BOUNDARY, and in the full field otherwise.
   // If you don't know better, set SUBFIELD_BOUNDARY = 0 which
   // trivially works for any input.
-  void commit(LigeroCommitment<Field> &commitment, Transcript &ts,
+  //
+  // Returns false, without writing to COMMITMENT or TS, only if
+  // cancelled.
+  bool commit(LigeroCommitment<Field> &commitment, Transcript &ts,
               const Elt W[/*p_.nw*/], const size_t subfield_boundary,
               const LigeroQuadraticConstraint lqc[/*nq*/],
               const InterpolatorFactory &interpolator, RandomEngine &rng,
@@ -65,17 +119,37 @@ class LigeroProver {
       check(F.in_subfield(W[i]), "element not in subfield");
     }
 
+    if (precomputed_) {
+      check(subfield_boundary == precomputed_subfield_boundary_,
+            "subfield_boundary differs from precomputation");
+    }
+
     layout(W, subfield_boundary, lqc, interpolator, rng, F);
+    precomputed_ = false;
+    if (cancelled()) {
+      return false;
+    }
 
-    // Merkle commitment
+    // Merkle commitment.  When rows may be packed, the column is
+    // gathered row by row first.
+    std::vector<Elt> column(kPackSubfieldRows ? p_.nrow : 0);
     auto updhash = [&](size_t j, SHA256 &sha) {
-      LigeroCommon<Field>::column_hash(p_.nrow, &tableau_at(0, j + p_.dblock),
-                                       p_.block_enc, sha, F);
+      if constexpr (!kPackSubfieldRows) {
+        LigeroCommon<Field>::column_hash(p_.nrow, &tableau_at(0, j + p_.dblock),
+                                         p_.block_enc, sha, F);
+      } else {
+        for (size_t i = 0; i < p_.nrow; ++i) {
+          column[i] = load(i, j + p_.dblock, F);
+        }
+        LigeroCommon<Field>::column_hash(p_.nrow, &column[0], 1, sha, F);
+      }
     };
-    commitment.root = mc_.commit(updhash, rng);
+    (void)mc_.commit(updhash, rng);
+    commitment.cap = mc_.cap();
 
     // P -> V
     LigeroTranscript<Field>::write_commitment(commitment, ts);
+    return true;
   }
 
   // HASH_OF_LLTERM is a hash of LLTERM provided by the caller.  We
@@ -137,16 +211,79 @@ class LigeroProver {
       // V -> P
       LigeroTranscript<Field>::gen_idx(&idx[0], p_, ts, F);
 
-      compute_req(proof, &idx[0]);
+      compute_req(proof, &idx[0], F);
 
       mc_.open(proof.merkle, &idx[0], p_.nreq);
     }
   }
 
  private:
+  // Store subfield-only rows at kSubFieldBytes per entry when that
+  // is shorter than a full element.
+  static constexpr bool kPackSubfieldRows =
+      Field::kSubFieldBytes < Field::kBytes;
+
+  bool cancelled() const {
+    return cancel_ != nullptr && cancel_->load(std::memory_order_relaxed);
+  }
+
+  // TRUE if witness row I is entirely in the subfield
+  bool subfield_only(size_t i, size_t subfield_boundary) const {
+    return (i + 1) * p_.w <= subfield_boundary;
+  }
+
+  // Decide which rows are packed and allocate both storages.
+  void allocate_tableau(size_t subfield_boundary) {
+    size_t nfull = 0, npacked = 0;
+    for (size_t i = 0; i < p_.nrow; ++i) {
+      packed_row_[i] = kPackSubfieldRows && i >= p_.iw &&
+                       i < p_.iw + p_.nwrow &&
+                       subfield_only(i - p_.iw, subfield_boundary);
+      row_index_[i] = packed_row_[i] ? npacked++ : nfull++;
+    }
+    tableau_.assign(nfull * p_.block_enc, Elt{});
+    packed_.assign(npacked * p_.block_enc * Field::kSubFieldBytes, 0);
+  }
+
+  // Row I must not be packed.
   Elt &tableau_at(size_t i, size_t j) {
     size_t ld = p_.block_enc;
-    return tableau_[i * ld + j];
+    return tableau_[row_index_[i] * ld + j];
+  }
+
+  uint8_t *packed_at(size_t i, size_t j) {
+    size_t ld = p_.block_enc * Field::kSubFieldBytes;
+    return &packed_[row_index_[i] * ld + j * Field::kSubFieldBytes];
+  }
+
+  // Entry [I, J] of either kind of row
+  Elt load(size_t i, size_t j, const Field &F) {
+    if (packed_row_[i]) {
+      return F.of_bytes_subfield(packed_at(i, j)).value();
+    }
+    return tableau_at(i, j);
+  }
+
+  void store(size_t i, size_t j, const Elt &x, const Field &F) {
+    if (packed_row_[i]) {
+      F.to_bytes_subfield(packed_at(i, j), x);
+    } else {
+      tableau_at(i, j) = x;
+    }
+  }
+
+  // Entries [I, [J, J + N)) as a contiguous array, either in place
+  // or unpacked into TMP.
+  const Elt *row(size_t i, size_t j, size_t n, std::vector<Elt> &tmp,
+                 const Field &F) {
+    if (packed_row_[i]) {
+      tmp.resize(n);
+      for (size_t k = 0; k < n; ++k) {
+        tmp[k] = load(i, j + k, F);
+      }
+      return &tmp[0];
+    }
+    return &tableau_at(i, j);
   }
 
   // fill t_[i, [0,n)] with random elements
@@ -161,7 +298,18 @@ class LigeroProver {
   void random_subfield_row(size_t i, size_t n, RandomEngine &rng,
                            const Field &F) {
     for (size_t j = 0; j < n; ++j) {
-      tableau_at(i, j) = rng.subfield_elt(F);
+      store(i, j, rng.subfield_elt(F), F);
+    }
+  }
+
+  // Randomize the first R entries of witness row I.  The randomness
+  // is drawn from the subfield if the entire row is in the subfield.
+  void random_witness_prefix(size_t i, size_t subfield_boundary,
+                             RandomEngine &rng, const Field &F) {
+    if (subfield_only(i, subfield_boundary)) {
+      random_subfield_row(i + p_.iw, p_.r, rng, F);
+    } else {
+      random_row(i + p_.iw, p_.r, rng, F);
     }
   }
 
@@ -207,24 +355,38 @@ class LigeroProver {
                            RandomEngine &rng, const Field &F) {
     const auto interp = interpolator.make(p_.block, p_.block_enc);
 
+    // packed rows are encoded here and then packed
+    std::vector<Elt> tmp(p_.block_enc);
+
     // witness row EXTEND([RANDOM[R], WITNESS[W]], BLOCK)
     for (size_t i = 0; i < p_.nwrow; ++i) {
-      // TRUE if the entire row is in the subfield
-      bool subfield_only = ((i + 1) * p_.w <= subfield_boundary);
+      if (cancelled()) return;
+      size_t ir = i + p_.iw;
+      if (!precomputed_) {
+        random_witness_prefix(i, subfield_boundary, rng, F);
+      }
 
-      if (subfield_only) {
-        random_subfield_row(i + p_.iw, p_.r, rng, F);
+      Elt *wrow = &tmp[0];
+      if (packed_row_[ir]) {
+        for (size_t j = 0; j < p_.r; ++j) {
+          wrow[j] = load(ir, j, F);
+        }
       } else {
-        random_row(i + p_.iw, p_.r, rng, F);
+        wrow = &tableau_at(ir, 0);
       }
 
       // Set the WITNESS columns to zero first, and then
       // overwrite with the witnesses that actually exist
-      Blas<Field>::clear(p_.w, &tableau_at(i + p_.iw, p_.r), 1, F);
+      Blas<Field>::clear(p_.w, &wrow[p_.r], 1, F);
       size_t max_col = std::min(p_.w, p_.nw - i * p_.w);
-      Blas<Field>::copy(max_col, &tableau_at(i + p_.iw, p_.r), 1, &W[i * p_.w],
-                        1);
-      interp->interpolate(&tableau_at(i + p_.iw, 0));
+      Blas<Field>::copy(max_col, &wrow[p_.r], 1, &W[i * p_.w], 1);
+      interp->interpolate(wrow);
+
+      if (packed_row_[ir]) {
+        for (size_t j = 0; j < p_.block_enc; ++j) {
+          store(ir, j, wrow[j], F);
+        }
+      }
     }
   }
 
@@ -240,9 +402,12 @@ class LigeroProver {
     size_t iqz = iqy + p_.nqtriples;
 
     for (size_t i = 0; i < p_.nqtriples; ++i) {
-      random_row(iqx + i, p_.r, rng, F);
-      random_row(iqy + i, p_.r, rng, F);
-      random_row(iqz + i, p_.r, rng, F);
+      if (cancelled()) return;
+      if (!precomputed_) {
+        random_row(iqx + i, p_.r, rng, F);
+        random_row(iqy + i, p_.r, rng, F);
+        random_row(iqz + i, p_.r, rng, F);
+      }
 
       // clear everything first, then overwrite the witnesses that
       // actually exist
@@ -268,7 +433,10 @@ class LigeroProver {
               const LigeroQuadraticConstraint lqc[/*nq*/],
               const InterpolatorFactory &interpolator, RandomEngine &rng,
               const Field &F) {
-    layout_blinding_rows(interpolator, rng, F);
+    if (!precomputed_) {
+      allocate_tableau(subfield_boundary);
+      layout_blinding_rows(interpolator, rng, F);
+    }
     layout_witness_rows(W, subfield_boundary, interpolator, rng, F);
     layout_quadratic_rows(W, lqc, interpolator, rng, F);
   }
@@ -279,9 +447,10 @@ class LigeroProver {
     Blas<Field>::copy(p_.block, y, 1, &tableau_at(p_.ildt, 0), 1);
 
     // all witness and quadratic rows with coefficient u_ldt[]
+    std::vector<Elt> tmp;
     for (size_t i = 0; i < p_.nwqrow; ++i) {
-      Blas<Field>::axpy(p_.block, y, 1, u_ldt[i], &tableau_at(i + p_.iw, 0), 1,
-                        F);
+      Blas<Field>::axpy(p_.block, y, 1, u_ldt[i],
+                        row(i + p_.iw, 0, p_.block, tmp, F), 1, F);
     }
   }
 
@@ -293,13 +462,14 @@ class LigeroProver {
     Blas<Field>::copy(p_.dblock, y, 1, &tableau_at(p_.idot, 0), 1);
 
     std::vector<Elt> Aext(p_.dblock);
+    std::vector<Elt> tmp;
     for (size_t i = 0; i < p_.nwqrow; ++i) {
       LigeroCommon<Field>::layout_Aext(&Aext[0], p_, i, &A[0], F);
       interpA->interpolate(&Aext[0]);
 
       // Accumulate y += A \otimes W.
       Blas<Field>::vaxpy(p_.dblock, &y[0], 1, &Aext[0], 1,
-                         &tableau_at(i + p_.iw, 0), 1, F);
+                         row(i + p_.iw, 0, p_.dblock, tmp, F), 1, F);
     }
   }
 
@@ -338,16 +508,39 @@ class LigeroProver {
     Blas<Field>::copy(p_.dblock - p_.block, y2, 1, &y[p_.block], 1);
   }
 
-  void compute_req(LigeroProof<Field> &proof, const size_t idx[/*nreq*/]) {
+  void compute_req(LigeroProof<Field> &proof, const size_t idx[/*nreq*/],
+                   const Field &F) {
     for (size_t i = 0; i < p_.nrow; ++i) {
-      Blas<Field>::gather(p_.nreq, &proof.req_at(i, 0),
-                          &tableau_at(i, p_.dblock), idx);
+      if (packed_row_[i]) {
+        for (size_t k = 0; k < p_.nreq; ++k) {
+          proof.req_at(i, k) = load(i, p_.dblock + idx[k], F);
+        }
+      } else {
+        Blas<Field>::gather(p_.nreq, &proof.req_at(i, 0),
+                            &tableau_at(i, p_.dblock), idx);
+      }
     }
   }
 
   const LigeroParam<Field> p_; /* safer to make copy */
   MerkleCommitment mc_;
-  std::vector<Elt> tableau_ /*[nrow, block_enc]*/;
+
+  // The tableau [nrow, block_enc] is split in two storages.  Rows
+  // with packed_row_[i] live in packed_ at kSubFieldBytes per entry,
+  // and the others in tableau_.  row_index_[i] is the index of row I
+  // within its storage.  Packing cuts the memory of the witness rows
+  // of circuits over GF2_128, which are mostly in the subfield.
+  std::vector<Elt> tableau_ /*[nfull, block_enc]*/;
+  std::vector<uint8_t> packed_ /*[npacked, block_enc, kSubFieldBytes]*/;
+  std::vector<bool> packed_row_;
+  std::vector<size_t> row_index_;
+
+  // TRUE if precompute() has filled the blinding rows and the random
+  // prefixes of the tableau, and commit() has not consumed them yet.
+  bool precomputed_;
+  size_t precomputed_subfield_boundary_;
+
+  const std::atomic<bool> *cancel_;
 };
 }  // namespace proofs
 
@@ -35,8 +35,11 @@
 namespace proofs {
 namespace {
 
+// If SUBFIELD is true, the first half of the witnesses are in the
+// subfield and the prover is told so.
 template <class Field, class ReedSolomonFactory>
-void ligero_test(const ReedSolomonFactory &rs_factory, const Field &F) {
+void ligero_test(const ReedSolomonFactory &rs_factory, const Field &F,
+                 bool subfield = false) {
   using Elt = typename Field::Elt;
   set_log_level(INFO);
   static const constexpr size_t nw = 300000;
@@ -47,21 +50,29 @@ void ligero_test(const ReedSolomonFactory &rs_factory, const Field &F) {
   log(INFO, "%zd %zd %zd %zd %zd %zd\n", param.r, param.w, param.block,
       param.block_enc, param.nrow, param.nqtriples);
 
+  const size_t subfield_boundary = subfield ? nw / 2 : 0;
+
   std::vector<Elt> W(nw);
   std::vector<Elt> A(nw);
   for (size_t i = 0; i < nw; ++i) {
-    W[i] = F.of_scalar_field(random());
+    if (i < subfield_boundary) {
+      W[i] = F.of_scalar(random() & 0xFFFF);
+    } else {
+      W[i] = F.of_scalar_field(random());
+    }
     A[i] = F.of_scalar_field(random());
   }
 
   // Set up semi-random quadratic constraints.  For simplicity
   // of testing, say that the first NQ odd-index witnesses are
-  // the product of two even-index witnesses
+  // the product of two even-index witnesses, taken from the subfield
+  // part if there is one so that the products stay in the subfield.
+  const size_t nxy = subfield ? subfield_boundary : nw;
   std::vector<LigeroQuadraticConstraint> lqc(nq);
   for (size_t i = 0; i < nq; ++i) {
     lqc[i].z = 2 * i + 1;
-    lqc[i].x = 2 * ((random() % nw) / 2);
-    lqc[i].y = 2 * ((random() % nw) / 2);
+    lqc[i].x = 2 * ((random() % nxy) / 2);
+    lqc[i].y = 2 * ((random() % nxy) / 2);
     W[lqc[i].z] = F.mulf(W[lqc[i].x], W[lqc[i].y]);
   }
 
@@ -89,7 +100,7 @@ void ligero_test(const ReedSolomonFactory &rs_factory, const Field &F) {
     SecureRandomEngine rng;
     LigeroProver<Field, ReedSolomonFactory> prover(param);
     Transcript ts((uint8_t *)"test", 4);
-    prover.commit(commitment, ts, &W[0], /*subfield_boundary=*/0, &lqc[0],
+    prover.commit(commitment, ts, &W[0], subfield_boundary, &lqc[0],
                   rs_factory, rng, F);
     prover.prove(proof, ts, nl, llterm.size(), &llterm[0], hash_of_llterm,
                  &lqc[0], rs_factory, F);
@@ -132,5 +143,14 @@ TEST(Ligero, GF2_128) {
   ligero_test(rs_factory, F);
 }
 
+TEST(Ligero, GF2_128Subfield) {
+  using Field = GF2_128<>;
+  const Field F;
+  using ReedSolomonFactory = LCH14ReedSolomonFactory<Field>;
+  const ReedSolomonFactory rs_factory(F);
+
+  ligero_test(rs_factory, F, /*subfield=*/true);
+}
+
 }  // namespace
 }  // namespace proofs
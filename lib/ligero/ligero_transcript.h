@@ -30,7 +30,9 @@ class LigeroTranscript {
 
   static void write_commitment(const LigeroCommitment<Field>& commitment,
                                Transcript& ts) {
-    ts.write(commitment.root.data, commitment.root.kLength);
+    for (const Digest& d : commitment.cap) {
+      ts.write(d.data, d.kLength);
+    }
   }
 
   static void gen_uldt(Elt u[/*nwqrow*/], const LigeroParam<Field>& p,
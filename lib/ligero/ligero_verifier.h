@@ -39,6 +39,22 @@ class LigeroVerifier {
     LigeroTranscript<Field>::write_commitment(commitment, ts);
   }
 
+  // The verifier challenges of one proof, drawn by replay().
+  struct Challenges {
+    Challenges(const LigeroParam<Field>& p, size_t nl)
+        : u_ldt(p.nwqrow),
+          alphal(nl),
+          alphaq(p.nq),
+          u_quad(p.nqtriples),
+          idx(p.nreq) {}
+
+    std::vector<Elt> u_ldt;                  // [nwqrow]
+    std::vector<Elt> alphal;                 // [nl]
+    std::vector<std::array<Elt, 3>> alphaq;  // [nq]
+    std::vector<Elt> u_quad;                 // [nqtriples]
+    std::vector<size_t> idx;                 // [nreq]
+  };
+
   static bool verify(const char** why, const LigeroParam<Field>& p,
                      const LigeroCommitment<Field>& commitment,
                      const LigeroProof<Field>& proof, Transcript& ts, size_t nl,
@@ -51,28 +67,35 @@ class LigeroVerifier {
       return false;
     }
 
-    std::vector<Elt> u_ldt(p.nwqrow);
-    std::vector<Elt> alphal(nl);
-    std::vector<std::array<Elt, 3>> alphaq(p.nq);
-    std::vector<Elt> u_quad(p.nqtriples);
-    std::vector<size_t> idx(p.nreq);
-
-    // Replay the protocol first in order to compute all the
-    // challenges.  In particular, we need IDX before we can do
-    // anything useful.
+    Challenges ch(p, nl);
+    replay(ch, p, proof, ts, hash_of_llterm, F);
+    return check_opening(why, p, commitment, proof, ch, interpolator, F) &&
+           check_constraints(why, p, proof, ch, nllterm, llterm, b, lqc,
+                             interpolator, F);
+  }
 
+  // Replay the protocol first in order to compute all the
+  // challenges.  In particular, we need IDX before we can do
+  // anything useful.  The transcript depends on the constraints
+  // only through HASH_OF_LLTERM and their number, so the caller
+  // can defer computing the constraints until after
+  // check_opening().
+  static void replay(Challenges& ch, const LigeroParam<Field>& p,
+                     const LigeroProof<Field>& proof, Transcript& ts,
+                     const LigeroHash& hash_of_llterm, const Field& F) {
     // P -> V
     ts.write(hash_of_llterm.bytes, hash_of_llterm.kLength);
 
     // V -> P
-    LigeroTranscript<Field>::gen_uldt(&u_ldt[0], p, ts, F);
+    LigeroTranscript<Field>::gen_uldt(&ch.u_ldt[0], p, ts, F);
 
     // V -> P
-    LigeroTranscript<Field>::gen_alphal(nl, &alphal[0], ts, F);
-    LigeroTranscript<Field>::gen_alphaq(&alphaq[0], p, ts, F);
+    LigeroTranscript<Field>::gen_alphal(ch.alphal.size(), &ch.alphal[0], ts,
+                                        F);
+    LigeroTranscript<Field>::gen_alphaq(&ch.alphaq[0], p, ts, F);
 
     // V -> P
-    LigeroTranscript<Field>::gen_uquad(&u_quad[0], p, ts, F);
+    LigeroTranscript<Field>::gen_uquad(&ch.u_quad[0], p, ts, F);
 
     // P -> V
     ts.write(&proof.y_ldt[0], 1, p.block, F);
@@ -81,32 +104,56 @@ class LigeroVerifier {
     ts.write(&proof.y_quad_2[0], 1, p.dblock - p.block, F);
 
     // V -> P
-    LigeroTranscript<Field>::gen_idx(&idx[0], p, ts, F);
+    LigeroTranscript<Field>::gen_idx(&ch.idx[0], p, ts, F);
+  }
 
-    if (!merkle_check(p, commitment, proof, &idx[0], F)) {
+  // The checks that do not depend on the constraints: the opened
+  // columns against the commitment, and the low-degree test.  Most
+  // malformed proofs fail here, at a cost independent of the size of
+  // the constraint system.
+  static bool check_opening(const char** why, const LigeroParam<Field>& p,
+                            const LigeroCommitment<Field>& commitment,
+                            const LigeroProof<Field>& proof,
+                            const Challenges& ch,
+                            const InterpolatorFactory& interpolator,
+                            const Field& F) {
+    if (!merkle_check(p, commitment, proof, &ch.idx[0], F)) {
       *why = "merkle_check failed";
       return false;
     }
 
-    if (!low_degree_check(p, proof, &idx[0], &u_ldt[0], interpolator, F)) {
+    if (!low_degree_check(p, proof, &ch.idx[0], &ch.u_ldt[0], interpolator,
+                          F)) {
       *why = "low_degree_check failed";
       return false;
     }
+    return true;
+  }
 
+  // The linear and quadratic checks, with as many linear constraints
+  // B[] as there are ch.alphal.
+  static bool check_constraints(
+      const char** why, const LigeroParam<Field>& p,
+      const LigeroProof<Field>& proof, const Challenges& ch, size_t nllterm,
+      const LigeroLinearConstraint<Field> llterm[/*nllterm*/],
+      const Elt b[/*nl*/], const LigeroQuadraticConstraint lqc[/*nq*/],
+      const InterpolatorFactory& interpolator, const Field& F) {
+    size_t nl = ch.alphal.size();
     {
       // linear check
       std::vector<Elt> A(p.nwqrow * p.w);
 
       LigeroCommon<Field>::inner_product_vector(&A[0], p, nl, nllterm, llterm,
-                                                &alphal[0], lqc, &alphaq[0], F);
+                                                &ch.alphal[0], lqc,
+                                                &ch.alphaq[0], F);
 
-      if (!dot_check(p, proof, &idx[0], &A[0], interpolator, F)) {
+      if (!dot_check(p, proof, &ch.idx[0], &A[0], interpolator, F)) {
         *why = "dot_check failed";
         return false;
       }
 
       // check the putative value of the inner product
-      Elt want_dot = Blas<Field>::dot(nl, b, 1, &alphal[0], 1, F);
+      Elt want_dot = Blas<Field>::dot(nl, b, 1, &ch.alphal[0], 1, F);
       Elt proof_dot = Blas<Field>::dot1(p.w, &proof.y_dot[p.r], 1, F);
       if (want_dot != proof_dot) {
         *why = "wrong dot product";
@@ -114,7 +161,8 @@ class LigeroVerifier {
       }
     }
 
-    if (!quadratic_check(p, proof, &idx[0], &u_quad[0], interpolator, F)) {
+    if (!quadratic_check(p, proof, &ch.idx[0], &ch.u_quad[0], interpolator,
+                         F)) {
       *why = "quadratic_check failed";
       return false;
     }
@@ -147,8 +195,8 @@ class LigeroVerifier {
     };
 
     return MerkleCommitmentVerifier::verify(p.block_enc - p.dblock,
-                                            commitment.root, proof.merkle, idx,
-                                            p.nreq, updhash);
+                                            commitment.cap, p.mc_shape,
+                                            proof.merkle, idx, p.nreq, updhash);
   }
 
   static bool low_degree_check(const LigeroParam<Field>& p,
@@ -41,17 +41,31 @@ struct MerkleProof {
 };
 
 inline size_t merkle_commitment_len(size_t n) { return merkle_tree_len(n); }
+inline size_t merkle_commitment_len(size_t n, const MerkleShape &shape) {
+  return merkle_tree_len(n, shape);
+}
 
 // prover-side
 class MerkleCommitment {
  public:
-  explicit MerkleCommitment(size_t n) : n_(n), mt_(n), nonce_(n) {}
+  explicit MerkleCommitment(size_t n, const MerkleShape &shape = MerkleShape{})
+      : n_(n), mt_(n, shape), nonce_(n), have_nonces_(false) {}
+
+  // Draw the nonces ahead of time, so that commit() only hashes.
+  void precompute_nonces(RandomEngine &rng) {
+    for (size_t i = 0; i < n_; ++i) {
+      rng.bytes(nonce_[i].bytes, MerkleNonce::kLength);
+    }
+    have_nonces_ = true;
+  }
 
   Digest commit(const std::function<void(size_t, SHA256 &)> &updhash,
                 RandomEngine &rng) {
     for (size_t i = 0; i < n_; ++i) {
       SHA256 sha;
-      rng.bytes(nonce_[i].bytes, MerkleNonce::kLength);
+      if (!have_nonces_) {
+        rng.bytes(nonce_[i].bytes, MerkleNonce::kLength);
+      }
       sha.Update(nonce_[i].bytes, MerkleNonce::kLength);
       updhash(i, sha);
 
@@ -60,9 +74,15 @@ class MerkleCommitment {
       mt_.set_leaf(i, dig);
     }
 
+    // the nonces are bound to this commitment and cannot be reused
+    have_nonces_ = false;
     return mt_.build_tree();
   }
 
+  // The cap of the last commit(), whose first element is the value
+  // returned by commit().
+  std::vector<Digest> cap() const { return mt_.cap(); }
+
   void open(MerkleProof &proof, const size_t pos[/*np*/], size_t np) {
     // fill in the nonces of the opening
     for (size_t i = 0; i < np; ++i) {
@@ -76,6 +96,7 @@ class MerkleCommitment {
   size_t n_;
   MerkleTree mt_;
   std::vector<MerkleNonce> nonce_;
+  bool have_nonces_;
 };
 
 // Declare a class for symmetry, but this class is never instantiated
@@ -84,6 +105,14 @@ class MerkleCommitmentVerifier {
   static bool verify(size_t n, const Digest &root, const MerkleProof &proof,
                      const size_t pos[/*nreq*/], size_t nreq,
                      const std::function<void(size_t, SHA256 &)> &updhash) {
+    return verify(n, std::vector<Digest>(1, root), MerkleShape{}, proof, pos,
+                  nreq, updhash);
+  }
+
+  static bool verify(size_t n, const std::vector<Digest> &cap,
+                     const MerkleShape &shape, const MerkleProof &proof,
+                     const size_t pos[/*nreq*/], size_t nreq,
+                     const std::function<void(size_t, SHA256 &)> &updhash) {
     // Assemble the expected leaf values
     std::vector<Digest> leaves(nreq);
     for (size_t r = 0; r < nreq; ++r) {
@@ -93,7 +122,7 @@ class MerkleCommitmentVerifier {
       sha.DigestData(leaves[r].data);
     }
 
-    MerkleTreeVerifier mtv(n, root);
+    MerkleTreeVerifier mtv(n, cap, shape);
     return mtv.verify_compressed_proof(proof.path.data(), proof.path.size(),
                                        &leaves[0], pos, nreq);
   }
@@ -56,6 +56,125 @@ struct Digest {
     sha.DigestData(output.data);
     return output;
   }
+
+  // Hash of the concatenation of D[0], ..., D[K-1].  hashn(D, 2) is
+  // the same as hash2(D[0], D[1]).
+  static Digest hashn(const Digest d[/*k*/], size_t k) {
+    SHA256 sha;
+    for (size_t i = 0; i < k; ++i) {
+      sha.Update(d[i].data, kLength);
+    }
+    Digest output;
+    sha.DigestData(output.data);
+    return output;
+  }
+};
+
+// The shape of a Merkle tree.  Each inner node is the hash of its
+// ARITY children, and the commitment consists of the CAP nodes at
+// depth log_ARITY(CAP) instead of the root alone.  A wider tree
+// needs fewer compression-function calls to build, and a cap
+// shortens every authentication path by log_ARITY(CAP) levels in
+// exchange for CAP digests in the commitment.
+//
+// The default shape is the binary tree committed by its root.
+struct MerkleShape {
+  size_t arity = 2;
+  size_t cap = 1;
+
+  bool operator==(const MerkleShape& y) const {
+    return arity == y.arity && cap == y.cap;
+  }
+  bool operator!=(const MerkleShape& y) const { return !operator==(y); }
+};
+
+// Node numbering of a Merkle tree of N leaves with a given shape.
+//
+// Nodes are stored in heap order starting at index 1, and the
+// children of node I are nodes [A * (I - 1) + 2, A * I + 2) for arity
+// A.  The leaves are padded with zero digests to a count N' such
+// that every inner node has exactly A children; padding leaves are
+// known to both parties and never appear in a proof.  For the binary
+// tree, N' = N, the leaves are nodes [N, 2 * N), and the children of
+// node I are 2 * I and 2 * I + 1.
+class MerkleLayout {
+ public:
+  MerkleLayout(size_t n, const MerkleShape& shape)
+      : n_(n), arity_(shape.arity), cap_(shape.cap) {
+    check(valid(n, shape), "invalid Merkle tree shape");
+    npad_ = padded_leaves(n, arity_);
+    ninner_ = (npad_ - 1) / (arity_ - 1);
+    cap_begin_ = depth_begin(arity_, cap_);
+  }
+
+  // Whether a tree of N leaves can have SHAPE.  The arity must be 2,
+  // 4, or 8, the cap must be a power of the arity, and all cap nodes
+  // must exist.
+  static bool valid(size_t n, const MerkleShape& shape) {
+    size_t a = shape.arity;
+    if (n == 0 || (a != 2 && a != 4 && a != 8)) {
+      return false;
+    }
+    size_t c = 1;
+    while (c < shape.cap) {
+      c *= a;
+    }
+    if (c != shape.cap) {
+      return false;
+    }
+    size_t npad = padded_leaves(n, a);
+    size_t nnodes = 1 + (npad - 1) / (a - 1) + npad;
+    return depth_begin(a, shape.cap) + shape.cap <= nnodes;
+  }
+
+  size_t arity() const { return arity_; }
+  size_t cap() const { return cap_; }
+  size_t nnodes() const { return 1 + ninner_ + npad_; }
+
+  // Inner nodes are [1, ninner()] and the cap is
+  // [cap_begin(), cap_begin() + cap()).  Only inner nodes at or below
+  // the cap are ever computed.
+  size_t ninner() const { return ninner_; }
+  size_t cap_begin() const { return cap_begin_; }
+
+  size_t leaf(size_t pos) const { return ninner_ + 1 + pos; }
+  size_t child(size_t i, size_t c) const { return arity_ * (i - 1) + 2 + c; }
+  bool padding(size_t i) const { return i >= leaf(n_); }
+
+  // Upper bound on the number of proof digests per opened leaf, plus
+  // one, as in merkle_tree_len().
+  size_t pathlen() const {
+    size_t depth = 0;
+    for (size_t i = nnodes() - 1; i > 1; i = (i - 2) / arity_ + 1) {
+      ++depth;
+    }
+    size_t cap_depth = 0;
+    for (size_t c = 1; c < cap_; c *= arity_) {
+      ++cap_depth;
+    }
+    return (arity_ - 1) * (depth - cap_depth) + 1;
+  }
+
+ private:
+  static size_t padded_leaves(size_t n, size_t a) {
+    return n + ((a - 1) - (n - 1) % (a - 1)) % (a - 1);
+  }
+
+  // first node at depth log_A(C)
+  static size_t depth_begin(size_t a, size_t c) {
+    size_t s = 1;
+    for (size_t k = 1; k < c; k *= a) {
+      s = a * (s - 1) + 2;
+    }
+    return s;
+  }
+
+  size_t n_;
+  size_t arity_;
+  size_t cap_;
+  size_t npad_;
+  size_t ninner_;
+  size_t cap_begin_;
 };
 
 // Return the length of the proof for N leaves.
@@ -70,72 +189,84 @@ inline size_t merkle_tree_len(size_t n) {
   return r;
 }
 
+// The same bound for a tree of the given shape.  Equal to
+// merkle_tree_len(N) for the default shape.
+inline size_t merkle_tree_len(size_t n, const MerkleShape& shape) {
+  return MerkleLayout(n, shape).pathlen();
+}
+
 // compute the set of all nodes on the path from the
-// root to any leaf in POS.
-inline std::vector<bool> compressed_merkle_proof_tree(size_t n,
+// cap to any leaf in POS.
+inline std::vector<bool> compressed_merkle_proof_tree(const MerkleLayout& lt,
                                                       const size_t pos[/*np*/],
                                                       size_t np) {
   check(np > 0, "A Merkle proof with 0 leaves is not defined.");
-  std::vector<bool> tree(2 * n, false);
+  std::vector<bool> tree(lt.nnodes(), false);
 
   // leaves are in TREE
   for (size_t ip = 0; ip < np; ++ip) {
-    check(pos[ip] < n, "Invalid position for leaf in Merkle tree");
-    check(tree[pos[ip] + n] == false,
-          "duplicate position in merkle tree requested");
-    tree[pos[ip] + n] = true;
+    size_t l = lt.leaf(pos[ip]);
+    check(!lt.padding(l), "Invalid position for leaf in Merkle tree");
+    check(tree[l] == false, "duplicate position in merkle tree requested");
+    tree[l] = true;
   }
 
   // If a child of an inner node is in TREE, then the parent is in TREE.
-  for (size_t i = n; i-- > 1;) {
-    tree[i] = (tree[2 * i] || tree[2 * i + 1]);
+  for (size_t i = lt.ninner() + 1; i-- > lt.cap_begin();) {
+    for (size_t c = 0; c < lt.arity() && !tree[i]; ++c) {
+      tree[i] = tree[lt.child(i, c)];
+    }
   }
 
-  // Assert that the root is in TREE.
-  check(tree[1], "tree[1]");
-
   return tree;
 }
 
 class MerkleTree {
  public:
-  explicit MerkleTree(size_t n) : n_(n), layers_(2 * n) {}
+  explicit MerkleTree(size_t n, const MerkleShape& shape = MerkleShape{})
+      : n_(n), lt_(n, shape), layers_(lt_.nnodes()) {}
 
   void set_leaf(size_t pos, const Digest& leaf) {
     check(pos < n_, "Invalid position for leaf in Merkle tree");
-    layers_[pos + n_] = leaf;
+    layers_[lt_.leaf(pos)] = leaf;
   }
 
+  // Return the root, which is the first cap node.
   Digest build_tree() {
-    for (size_t i = n_; i-- > 1;) {
-      layers_[i] = Digest::hash2(layers_[2 * i], layers_[2 * i + 1]);
+    for (size_t i = lt_.ninner() + 1; i-- > lt_.cap_begin();) {
+      layers_[i] = Digest::hashn(&layers_[lt_.child(i, 0)], lt_.arity());
     }
-    return layers_[1];
+    return layers_[lt_.cap_begin()];
+  }
+
+  // The cap nodes, valid after build_tree().
+  std::vector<Digest> cap() const {
+    auto b = layers_.begin() + lt_.cap_begin();
+    return std::vector<Digest>(b, b + lt_.cap());
   }
 
   // Compressed Merkle proofs over a set POS[NP] of leaves.
   //
   // We first compute the set TREE of all nodes that are on the path
-  // from the root to any leaf in POS.  Then, for each inner node in
-  // TREE, we include in the proof the child that is not in TREE, if
-  // any.  Note, this method requires pos to contain no duplicates.
+  // from the cap to any leaf in POS.  Then, for each inner node in
+  // TREE, we include in the proof the children that are not in TREE,
+  // other than padding.  Note, this method requires pos to contain
+  // no duplicates.
   size_t generate_compressed_proof(std::vector<Digest>& proof,
                                    const size_t pos[/*np*/], size_t np) {
-    std::vector<bool> tree = compressed_merkle_proof_tree(n_, pos, np);
+    std::vector<bool> tree = compressed_merkle_proof_tree(lt_, pos, np);
 
     // For each TREE node, include in the proof the
-    // child that is not TREE, if any.
+    // children that are not TREE, if any.
     size_t sz = 0;
-    for (size_t i = n_; i-- > 1;) {
+    for (size_t i = lt_.ninner() + 1; i-- > lt_.cap_begin();) {
       if (tree[i]) {
-        size_t child = 2 * i;
-        if (tree[child]) {
-          // try the other child
-          child = 2 * i + 1;
-        }
-        if (!tree[child]) {
-          proof.push_back(layers_[child]);
-          ++sz;
+        for (size_t c = 0; c < lt_.arity(); ++c) {
+          size_t child = lt_.child(i, c);
+          if (!tree[child] && !lt_.padding(child)) {
+            proof.push_back(layers_[child]);
+            ++sz;
+          }
         }
       }
     }
@@ -143,6 +274,8 @@ class MerkleTree {
   }
 
   size_t n_;
+  MerkleLayout lt_;
+  // Nodes in the order of MerkleLayout.  For the binary tree:
   // layers_[n, 2 * n) stores the leaves (nodes at layer 0).
   // layers_[n/2, n) stores nodes at layer 1.
   // layers_[n/4, n/2) stores nodes at layer 2, etc.
@@ -153,31 +286,39 @@ class MerkleTree {
 class MerkleTreeVerifier {
  public:
   explicit MerkleTreeVerifier(size_t n, const Digest& root)
-      : n_(n), root_(root) {}
+      : lt_(n, MerkleShape{}), cap_(1, root) {}
+
+  MerkleTreeVerifier(size_t n, const std::vector<Digest>& cap,
+                     const MerkleShape& shape)
+      : lt_(n, shape), cap_(cap) {}
 
   // Verify a compressed Merkle proof.
   // As mentioned above, this method assumes that pos contains no duplicates.
   bool verify_compressed_proof(const Digest* proof, size_t proof_len,
                                const Digest leaves[/*np*/],
                                const size_t pos[/*np*/], size_t np) const {
+    if (cap_.size() != lt_.cap()) {
+      return false;
+    }
+
     // Reconstructed layers_, where only the DEFINED subset is
-    // defined.
-    std::vector<Digest> layers(2 * n_, Digest{});
-    std::vector<bool> defined(2 * n_, false);
-
-    /*scope for TREE */ {
-      std::vector<bool> tree = compressed_merkle_proof_tree(n_, pos, np);
-
-      // read the proof
-      size_t sz = 0;
-      for (size_t i = n_; i-- > 1;) {
-        if (tree[i]) {
-          size_t child = 2 * i;
-          if (tree[child]) {
-            // try the other child
-            child = 2 * i + 1;
-          }
-          if (!tree[child]) {
+    // defined.  Padding leaves are zero and always defined.
+    size_t nnodes = lt_.nnodes();
+    std::vector<Digest> layers(nnodes, Digest{});
+    std::vector<bool> defined(nnodes, false);
+    for (size_t l = lt_.leaf(0); l < nnodes; ++l) {
+      defined[l] = lt_.padding(l);
+    }
+
+    std::vector<bool> tree = compressed_merkle_proof_tree(lt_, pos, np);
+
+    // read the proof
+    size_t sz = 0;
+    for (size_t i = lt_.ninner() + 1; i-- > lt_.cap_begin();) {
+      if (tree[i]) {
+        for (size_t c = 0; c < lt_.arity(); ++c) {
+          size_t child = lt_.child(i, c);
+          if (!tree[child] && !lt_.padding(child)) {
             if (sz >= proof_len) {
               return false;
             }
@@ -190,25 +331,37 @@ class MerkleTreeVerifier {
 
     // set LAYERS at all leaves in POS
     for (size_t ip = 0; ip < np; ++ip) {
-      size_t l = pos[ip] + n_;
+      size_t l = lt_.leaf(pos[ip]);
       layers[l] = leaves[ip];
       defined[l] = true;
     }
 
     // Recompute as many inner nodes as we can
-    for (size_t i = n_; i-- > 1;) {
-      if (defined[2 * i] && defined[2 * i + 1]) {
-        layers[i] = Digest::hash2(layers[2 * i], layers[2 * i + 1]);
+    for (size_t i = lt_.ninner() + 1; i-- > lt_.cap_begin();) {
+      size_t c0 = lt_.child(i, 0);
+      bool all = true;
+      for (size_t c = 0; c < lt_.arity(); ++c) {
+        all = all && defined[c0 + c];
+      }
+      if (all) {
+        layers[i] = Digest::hashn(&layers[c0], lt_.arity());
         defined[i] = true;
       }
     }
 
-    return (defined[1] && (root_ == layers[1]));
+    // Every cap node on a path must match the commitment.
+    for (size_t k = 0; k < lt_.cap(); ++k) {
+      size_t i = lt_.cap_begin() + k;
+      if (tree[i] && !(defined[i] && cap_[k] == layers[i])) {
+        return false;
+      }
+    }
+    return true;
   }
 
  private:
-  size_t n_;
-  Digest root_;
+  MerkleLayout lt_;
+  std::vector<Digest> cap_;
 };
 
 }  // namespace proofs
@@ -44,9 +44,45 @@ TEST(MerkleTree, BuildTree) {
 }
 
 
+TEST(MerkleTree, BuildTreeArity4) {
+  // Five leaves are padded to seven, and node 2 holds the last two
+  // leaves and two zero padding leaves.
+  MerkleTree mt(5, MerkleShape{4, 1});
+  Digest leaves[5] = {Digest{100}, Digest{101}, Digest{102}, Digest{103},
+                      Digest{104}};
+  for (size_t i = 0; i < 5; i++) {
+    mt.set_leaf(i, leaves[i]);
+  }
+  Digest root = mt.build_tree();
+  Digest low[4] = {leaves[3], leaves[4], Digest{}, Digest{}};
+  Digest top[4] = {Digest::hashn(low, 4), leaves[0], leaves[1], leaves[2]};
+  EXPECT_EQ(root, Digest::hashn(top, 4));
+  EXPECT_EQ(mt.cap().size(), 1);
+  EXPECT_EQ(mt.cap()[0], root);
+}
+
+TEST(MerkleTree, ShapeValidity) {
+  EXPECT_TRUE(MerkleLayout::valid(1, MerkleShape{}));
+  EXPECT_TRUE(MerkleLayout::valid(300, MerkleShape{8, 64}));
+  EXPECT_FALSE(MerkleLayout::valid(0, MerkleShape{}));
+  EXPECT_FALSE(MerkleLayout::valid(300, MerkleShape{3, 1}));
+  EXPECT_FALSE(MerkleLayout::valid(300, MerkleShape{16, 1}));
+  EXPECT_FALSE(MerkleLayout::valid(300, MerkleShape{4, 2}));
+  EXPECT_FALSE(MerkleLayout::valid(300, MerkleShape{8, 512}));
+  EXPECT_FALSE(MerkleLayout::valid(5, MerkleShape{2, 8}));
+  EXPECT_TRUE(MerkleLayout::valid(5, MerkleShape{2, 4}));
+}
+
+TEST(MerkleTree, ShapeLength) {
+  for (size_t n = 1; n < 3000; ++n) {
+    EXPECT_EQ(merkle_tree_len(n, MerkleShape{}), merkle_tree_len(n));
+  }
+}
+
 MerkleTree setupBatch(size_t n, size_t batch_size, std::vector<Digest>& leaves,
-                      std::vector<size_t>& idx) {
-  MerkleTree prover(n);
+                      std::vector<size_t>& idx,
+                      const MerkleShape& shape = MerkleShape{}) {
+  MerkleTree prover(n, shape);
   uint8_t data = 1;
   for (size_t i = 0; i < n; i++) {
     prover.set_leaf(i, Digest{data});
@@ -61,7 +97,7 @@ MerkleTree setupBatch(size_t n, size_t batch_size, std::vector<Digest>& leaves,
       j = random() % n;
     }
     idx.push_back(j);
-    leaves.push_back(prover.layers_[j + n]);
+    leaves.push_back(prover.layers_[prover.lt_.leaf(j)]);
   }
   return prover;
 }
@@ -158,6 +194,50 @@ TEST(MerkleTree, BatchVerifyProofTooShort) {
                                                 &idx[0], idx.size()));
 }
 
+TEST(MerkleTree, VerifyCompressedProofShapes) {
+  const MerkleShape shapes[] = {{2, 1}, {2, 16}, {4, 1},
+                                {4, 16}, {8, 1}, {8, 64}};
+  for (const MerkleShape& shape : shapes) {
+    for (size_t testSize : {1, 10, 80}) {
+      for (size_t n = 200; n <= 300; n += 7) {
+        std::vector<size_t> idx;
+        std::vector<Digest> leaves;
+        MerkleTree prover = setupBatch(n, testSize, leaves, idx, shape);
+        prover.build_tree();
+        std::vector<Digest> cap = prover.cap();
+        EXPECT_EQ(cap.size(), shape.cap);
+
+        std::vector<Digest> proof;
+        size_t len =
+            prover.generate_compressed_proof(proof, &idx[0], testSize);
+        EXPECT_LE(len, testSize * merkle_tree_len(n, shape));
+
+        MerkleTreeVerifier verifier(n, cap, shape);
+        EXPECT_TRUE(verifier.verify_compressed_proof(
+            proof.data(), len, leaves.data(), idx.data(), idx.size()));
+        if (len > 0) {
+          EXPECT_FALSE(verifier.verify_compressed_proof(
+              proof.data(), len - 1, leaves.data(), idx.data(), idx.size()));
+        }
+        for (size_t ei = 0; ei < proof.size(); ++ei) {
+          proof[ei].data[0] ^= 1;
+          EXPECT_FALSE(verifier.verify_compressed_proof(
+              proof.data(), len, leaves.data(), idx.data(), idx.size()));
+          proof[ei].data[0] ^= 1;
+        }
+
+        // A wrong cap fails.
+        for (Digest& d : cap) {
+          d.data[0] ^= 1;
+        }
+        MerkleTreeVerifier bad(n, cap, shape);
+        EXPECT_FALSE(bad.verify_compressed_proof(
+            proof.data(), len, leaves.data(), idx.data(), idx.size()));
+      }
+    }
+  }
+}
+
 void print_digest(const Digest& d) {
   for (size_t i = 0; i < Digest::kLength; ++i) {
     printf("%02x", d.data[i]);
@@ -236,5 +316,34 @@ void BM_MerkleTree_BuildTree(benchmark::State& state) {
 }
 BENCHMARK(BM_MerkleTree_BuildTree)->RangeMultiplier(4)->Range(1024, 1 << 20);
 
+// Build a tree over 2^16 leaves and open 128 of them, for a given
+// arity and cap.
+void BM_MerkleTree_Shape(benchmark::State& state) {
+  const size_t n = 1 << 16, nreq = 128;
+  const MerkleShape shape{static_cast<size_t>(state.range(0)),
+                          static_cast<size_t>(state.range(1))};
+  std::vector<size_t> idx;
+  std::vector<Digest> leaves;
+  MerkleTree mt = setupBatch(n, nreq, leaves, idx, shape);
+
+  size_t len = 0;
+  for (auto s : state) {
+    mt.build_tree();
+    std::vector<Digest> proof;
+    len = mt.generate_compressed_proof(proof, &idx[0], nreq);
+    MerkleTreeVerifier verifier(n, mt.cap(), shape);
+    benchmark::DoNotOptimize(verifier.verify_compressed_proof(
+        proof.data(), len, leaves.data(), idx.data(), idx.size()));
+  }
+  state.counters["bytes"] = (len + shape.cap) * Digest::kLength;
+}
+BENCHMARK(BM_MerkleTree_Shape)
+    ->Args({2, 1})
+    ->Args({2, 64})
+    ->Args({4, 1})
+    ->Args({4, 64})
+    ->Args({8, 1})
+    ->Args({8, 64});
+
 }  // namespace
 }  // namespace proofs
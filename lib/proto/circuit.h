@@ -99,26 +99,26 @@ class CircuitRep {
     for (const auto& layer : sc_c.l) {
       serialize_size(quadb, layer.logw);
       serialize_size(quadb, layer.nw);
-      serialize_size(quadb, layer.quad->n_);
+      serialize_size(quadb, layer.nterms());
 
       QuadCorner prevg(0), prevh0(0), prevh1(0);
-      for (size_t i = 0; i < layer.quad->n_; ++i) {
-        serialize_index(quadb, layer.quad->c_[i].g, prevg);
-        prevg = layer.quad->c_[i].g;
-        serialize_index(quadb, layer.quad->c_[i].h[0], prevh0);
-        prevh0 = layer.quad->c_[i].h[0];
-        serialize_index(quadb, layer.quad->c_[i].h[1], prevh1);
-        prevh1 = layer.quad->c_[i].h[1];
-        serialize_num(quadb, eh.kstore(layer.quad->c_[i].v));
+      for (size_t i = 0; i < layer.nterms(); ++i) {
+        const auto t = layer.term(i);
+        serialize_index(quadb, t.g, prevg);
+        prevg = t.g;
+        serialize_index(quadb, t.h[0], prevh0);
+        prevh0 = t.h[0];
+        serialize_index(quadb, t.h[1], prevh1);
+        prevh1 = t.h[1];
+        serialize_num(quadb, eh.kstore(t.v));
       }
     }
 
-    serialize_size(bytes, eh.constants_.size());
-    for (const auto& v : eh.constants_) {
-      uint8_t buf[Field::kBytes];
-      f_.to_bytes_field(buf, v);
-      bytes.insert(bytes.end(), buf, buf + Field::kBytes);
-    }
+    size_t nconst = eh.constants_.size();
+    serialize_size(bytes, nconst);
+    size_t sz = bytes.size();
+    bytes.resize(sz + nconst * Field::kBytes);
+    f_.to_bytes_field_n(nconst, bytes.data() + sz, eh.constants_.data(), 1);
 
     bytes.insert(bytes.end(), quadb.begin(), quadb.end());
     bytes.insert(bytes.end(), sc_c.id, sc_c.id + 32);
@@ -129,8 +129,14 @@ class CircuitRep {
   //
   // If ENFORCE_CIRCUIT_ID is TRUE, check that the circuit id in
   // the serialization matches the id stored in the circuit.
+  //
+  // If COMPACT is TRUE, the layers are built in CompactQuad form,
+  // reusing the constant table of the serialization, as if
+  // Circuit::compact() had been called but without ever allocating
+  // the full quads.
   std::unique_ptr<Circuit<Field>> from_bytes(ReadBuffer& buf,
-                                             bool enforce_circuit_id) {
+                                             bool enforce_circuit_id,
+                                             bool compact = false) {
     if (!buf.have(8 * kBytesWritten + 1)) {
       return nullptr;
     }
@@ -162,13 +168,10 @@ class CircuitRep {
     }
 
     std::vector<Elt> constants(numconst);
-    for (size_t i = 0; i < numconst; ++i) {
-      // Fail if Elt cannot be parsed.
-      auto vv = f_.of_bytes_field(buf.next(Field::kBytes));
-      if (!vv.has_value()) {
-        return nullptr;
-      }
-      constants[i] = vv.value();
+    // Fail if any Elt cannot be parsed.
+    if (!f_.of_bytes_field_n(numconst, constants.data(),
+                             buf.next(need.value()))) {
+      return nullptr;
     }
 
     auto c = std::make_unique<Circuit<Field>>();
@@ -202,7 +205,17 @@ class CircuitRep {
         return nullptr;
       }
 
-      auto qq = std::make_unique<Quad<Field>>(nq);
+      std::unique_ptr<Quad<Field>> qq;
+      std::vector<QuadCorner> cg, chl, chr;
+      std::vector<uint32_t> ck;
+      if (compact) {
+        cg.resize(nq);
+        chl.resize(nq);
+        chr.resize(nq);
+        ck.resize(nq);
+      } else {
+        qq = std::make_unique<Quad<Field>>(nq);
+      }
       size_t prevg = 0, prevhl = 0, prevhr = 0;
       for (size_t i = 0; i < nq; ++i) {
         size_t g = read_index(buf, prevg);
@@ -222,13 +235,29 @@ class CircuitRep {
           return nullptr;
         }
 
-        qq->c_[i] = typename Quad<Field>::corner{
-            QuadCorner(g), {QuadCorner(hl), QuadCorner(hr)}, constants[vi]};
+        if (compact) {
+          cg[i] = QuadCorner(g);
+          chl[i] = QuadCorner(hl);
+          chr[i] = QuadCorner(hr);
+          ck[i] = static_cast<uint32_t>(vi);
+        } else {
+          qq->c_[i] = typename Quad<Field>::corner{
+              QuadCorner(g), {QuadCorner(hl), QuadCorner(hr)}, constants[vi]};
+        }
+      }
+      if (compact) {
+        c->l.push_back(Layer<Field>{
+            .nw = nw,
+            .logw = lw,
+            .cquad = std::make_unique<const CompactQuad<Field>>(
+                std::move(cg), std::move(chl), std::move(chr), std::move(ck),
+                constants)});
+      } else {
+        c->l.push_back(Layer<Field>{
+            .nw = nw,
+            .logw = lw,
+            .quad = std::unique_ptr<const Quad<Field>>(std::move(qq))});
       }
-      c->l.push_back(Layer<Field>{
-          .nw = nw,
-          .logw = lw,
-          .quad = std::unique_ptr<const Quad<Field>>(std::move(qq))});
       max_g = nw;
     }
     // Read the circuit name from the serialization.
@@ -55,6 +55,18 @@ void serialize_test2(const Circuit<FF>& circuit, const FF& F,
   EXPECT_TRUE(c2 != nullptr);
   EXPECT_TRUE(*c2 == circuit);
 
+  // The compact form has the same terms and id, and serializes to the
+  // same bytes.
+  ReadBuffer rbc(bytes);
+  auto cc = cr2.from_bytes(rbc, /*enforce_circuit_id=*/true,
+                           /*compact=*/true);
+  EXPECT_TRUE(cc != nullptr);
+  EXPECT_TRUE(*cc == circuit);
+  EXPECT_TRUE(cc->l[0].quad == nullptr);
+  std::vector<uint8_t> cbytes;
+  cr2.to_bytes(*cc, cbytes);
+  EXPECT_EQ(cbytes, bytes);
+
   // Test truncated inputs.
   ReadBuffer rb1(bytes.data(), sz - 1);
   auto bad = cr2.from_bytes(rb1, /*enforce_circuit_id=*/true);
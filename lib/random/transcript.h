@@ -150,8 +150,13 @@ class Transcript : public RandomEngine {
     }
     length(n);
 
-    for (size_t i = 0; i < n; ++i) {
-      write_untyped(e[i * ince], F);
+    // At most kChunk elements per write_untyped().
+    constexpr size_t kChunk = 64;
+    uint8_t buf[kChunk * Field::kBytes];
+    for (size_t i = 0; i < n; i += kChunk) {
+      size_t m = (n - i < kChunk) ? n - i : kChunk;
+      F.to_bytes_field_n(m, buf, &e[i * ince], ince);
+      write_untyped(buf, m * Field::kBytes);
     }
   }
 
@@ -23,6 +23,7 @@
 
 #include "algebra/poly.h"
 #include "arrays/affine.h"
+#include "sumcheck/compact_quad.h"
 #include "sumcheck/quad.h"
 
 namespace proofs {
@@ -32,13 +33,41 @@ struct Layer {
   size_t logw;  // number of binding rounds for the hand variables
   std::unique_ptr<const Quad<Field>> quad;
 
+  // The same terms in struct-of-arrays form, see compact().  Exactly
+  // one of QUAD and CQUAD is set.  The prover and verifier bind CQUAD
+  // directly instead of cloning QUAD.
+  std::unique_ptr<const CompactQuad<Field>> cquad;
+
   bool operator==(const Layer& y) const {
     // This operator relies on the layer being properly constructed, so that
-    // the quad reference is never a nullptr.
-    return nw == y.nw && logw == y.logw && *quad == *y.quad;
+    // one of the quad references is not a nullptr.
+    if (nw != y.nw || logw != y.logw || nterms() != y.nterms()) {
+      return false;
+    }
+    for (size_t i = 0; i < nterms(); ++i) {
+      if (!(term(i) == y.term(i))) {
+        return false;
+      }
+    }
+    return true;
   }
 
-  size_t nterms() const { return quad->n_; }
+  size_t nterms() const {
+    return quad != nullptr ? quad->n_ : cquad->size();
+  }
+
+  typename Quad<Field>::corner term(size_t i) const {
+    using index_t = typename Quad<Field>::index_t;
+    return quad != nullptr ? quad->c_[i] : cquad->term(index_t(i));
+  }
+
+  // Replace QUAD by CQUAD.
+  void compact(const Field& F) {
+    if (quad != nullptr) {
+      cquad = std::make_unique<const CompactQuad<Field>>(*quad, F);
+      quad.reset();
+    }
+  }
 };
 
 template <class Field>
@@ -69,6 +98,13 @@ struct Circuit {
     }
     return n;
   }
+
+  // Switch every layer to the CompactQuad representation.
+  void compact(const Field& F) {
+    for (auto& layer : l) {
+      layer.compact(F);
+    }
+  }
 };
 
 template <class Field>
@@ -54,12 +54,13 @@ void circuit_id(uint8_t id[/*32*/], const Circuit<Field>& c, const Field& F) {
   for (const auto& layer : c.l) {
     sha.Update8(layer.nw);
     sha.Update8(layer.logw);
-    sha.Update8(layer.quad->n_);
-    for (size_t i = 0; i < layer.quad->n_; ++i) {
-      sha.Update8(static_cast<uint64_t>(layer.quad->c_[i].g));
-      sha.Update8(static_cast<uint64_t>(layer.quad->c_[i].h[0]));
-      sha.Update8(static_cast<uint64_t>(layer.quad->c_[i].h[1]));
-      F.to_bytes_field(tmp, layer.quad->c_[i].v);
+    sha.Update8(layer.nterms());
+    for (size_t i = 0; i < layer.nterms(); ++i) {
+      const auto t = layer.term(i);
+      sha.Update8(static_cast<uint64_t>(t.g));
+      sha.Update8(static_cast<uint64_t>(t.h[0]));
+      sha.Update8(static_cast<uint64_t>(t.h[1]));
+      F.to_bytes_field(tmp, t.v);
       sha.Update(tmp, sizeof(tmp));
     }
   }
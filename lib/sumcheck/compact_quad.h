@@ -0,0 +1,207 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_SUMCHECK_COMPACT_QUAD_H_
+#define PRIVACY_PROOFS_ZK_LIB_SUMCHECK_COMPACT_QUAD_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "arrays/affine.h"
+#include "arrays/eqs.h"
+#include "sumcheck/quad.h"
+#include "util/panic.h"
+
+namespace proofs {
+// Read-only, struct-of-arrays version of an unbound Quad<Field>.
+//
+// A compiled circuit contains only a handful of distinct constants,
+// but Quad<Field>::corner stores a full Elt per term, which for
+// large fields is most of the storage.  CompactQuad stores the
+// (g, h[0], h[1]) indices in separate arrays and replaces the Elt by
+// an index into a table of distinct constants.  Full Elt values are
+// materialized only by bind_g(), which is the first operation that
+// makes the coefficients of different terms distinct, and which thus
+// replaces the clone() + bind_g() sequence of Quad<Field>.
+template <class Field>
+class CompactQuad {
+  using Elt = typename Field::Elt;
+
+ public:
+  using quad_corner_t = typename Quad<Field>::quad_corner_t;
+  using index_t = typename Quad<Field>::index_t;
+  using kindex_t = uint32_t;
+
+  CompactQuad(const Quad<Field>& q, const Field& F)
+      : n_(q.n_), g_(n_), h0_(n_), h1_(n_), k_(n_) {
+    // Assign constant indices by sorting the serialized
+    // coefficients, so that each Elt is converted only once.
+    using key = std::pair<std::array<uint8_t, Field::kBytes>, index_t>;
+    std::vector<key> keys(n_);
+    for (index_t i = 0; i < n_; ++i) {
+      const auto& c = q.c_[i];
+      g_[i] = c.g;
+      h0_[i] = c.h[0];
+      h1_[i] = c.h[1];
+      F.to_bytes_field(keys[i].first.data(), c.v);
+      keys[i].second = i;
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for (index_t i = 0; i < n_; ++i) {
+      if (i == 0 || keys[i].first != keys[i - 1].first) {
+        check(konst_.size() < ~kindex_t(0), "too many distinct constants");
+        konst_.push_back(q.c_[keys[i].second].v);
+      }
+      k_[keys[i].second] = static_cast<kindex_t>(konst_.size() - 1);
+    }
+  }
+
+  // Adopt the index arrays and the constant table of a quad whose
+  // constants are already numbered, as in a serialized circuit.  K[i]
+  // indexes KONST, which may contain duplicates.
+  CompactQuad(std::vector<quad_corner_t> g, std::vector<quad_corner_t> h0,
+              std::vector<quad_corner_t> h1, std::vector<kindex_t> k,
+              std::vector<Elt> konst)
+      : n_(static_cast<index_t>(g.size())),
+        g_(std::move(g)),
+        h0_(std::move(h0)),
+        h1_(std::move(h1)),
+        k_(std::move(k)),
+        konst_(std::move(konst)) {
+    check(h0_.size() == n_ && h1_.size() == n_ && k_.size() == n_,
+          "CompactQuad arrays of different lengths");
+  }
+
+  // no copies
+  CompactQuad(const CompactQuad& y) = delete;
+  CompactQuad(const CompactQuad&& y) = delete;
+  CompactQuad operator=(const CompactQuad& y) = delete;
+
+  index_t size() const { return n_; }
+
+  // Term I, as stored in the equivalent Quad<Field>
+  typename Quad<Field>::corner term(index_t i) const {
+    return typename Quad<Field>::corner{
+        .g = g_[i], .h = {h0_[i], h1_[i]}, .v = konst_[k_[i]]};
+  }
+  size_t nconstants() const { return konst_.size(); }
+
+  // Bytes of storage used by this representation, to be compared
+  // against n * sizeof(Quad<Field>::corner).
+  size_t memory_bytes() const {
+    return n_ * (3 * sizeof(quad_corner_t) + sizeof(kindex_t)) +
+           konst_.size() * sizeof(Elt);
+  }
+
+  // Equivalent to Q = quad.clone(); Q->bind_g(...); return Q,
+  // but reading the unbound terms from the compact arrays.
+  std::unique_ptr<Quad<Field>> bind_g(size_t logv, const Elt* G0,
+                                      const Elt* G1, const Elt& alpha,
+                                      const Elt& beta, const Field& F) const {
+    size_t nv = size_t(1) << logv;
+    auto dot = Eqs<Field>::raw_eq2(logv, nv, G0, G1, alpha, F);
+    std::vector<Elt> kb = konst_with_beta(beta, F);
+
+    auto Q = std::make_unique<Quad<Field>>(n_);
+    for (index_t i = 0; i < n_; ++i) {
+      auto& c = Q->c_[i];
+      c.g = quad_corner_t(0);
+      c.h[0] = h0_[i];
+      c.h[1] = h1_[i];
+      c.v = F.mulf(kb[k_[i]], dot[corner_t(g_[i])]);
+    }
+
+    // coalesce any duplicates that we may have created
+    Q->coalesce(F);
+    return Q;
+  }
+
+  // Same as Quad<Field>::bind_gh_all()
+  Elt bind_gh_all(
+      // G bindings
+      size_t logv, const Elt G0[/*logv*/], const Elt G1[/*logv*/],
+      const Elt& alpha, const Elt& beta,
+      // H bindings
+      size_t logw, const Elt H0[/*logw*/], const Elt H1[/*logw*/],
+      // field
+      const Field& F) const {
+    size_t nv = size_t(1) << logv;
+    auto eqg = Eqs<Field>::raw_eq2(logv, nv, G0, G1, alpha, F);
+
+    size_t nw = size_t(1) << logw;
+    Eqs<Field> eqh0(logw, nw, H0, F);
+    Eqs<Field> eqh1(logw, nw, H1, F);
+    std::vector<Elt> kb = konst_with_beta(beta, F);
+    std::vector<char> kone(kb.size());
+    for (size_t k = 0; k < kb.size(); ++k) {
+      kone[k] = (kb[k] == F.one());
+    }
+
+    // See Quad<Field>::bind_gh_all() for the factoring of EQH0.
+    Elt s{}, run{};
+    for (index_t i = 0; i < n_; ++i) {
+      Elt q = eqg[corner_t(g_[i])];
+      if (!kone[k_[i]]) {
+        F.mul(q, kb[k_[i]]);
+      }
+      F.mul(q, eqh1.at(corner_t(h1_[i])));
+      F.add(run, q);
+      if (i + 1 == n_ || h0_[i + 1] != h0_[i]) {
+        F.mul(run, eqh0.at(corner_t(h0_[i])));
+        F.add(s, run);
+        run = F.zero();
+      }
+    }
+    return s;
+  }
+
+  // Inverse of the constructor
+  std::unique_ptr<Quad<Field>> expand() const {
+    auto Q = std::make_unique<Quad<Field>>(n_);
+    for (index_t i = 0; i < n_; ++i) {
+      Q->c_[i] = term(i);
+    }
+    return Q;
+  }
+
+ private:
+  // The constant table where the zero constant, which denotes an
+  // assert-zero term, has been replaced by BETA.
+  std::vector<Elt> konst_with_beta(const Elt& beta, const Field& F) const {
+    std::vector<Elt> kb(konst_);
+    for (auto& k : kb) {
+      if (k == F.zero()) {
+        k = beta;
+      }
+    }
+    return kb;
+  }
+
+  index_t n_;
+  std::vector<quad_corner_t> g_;
+  std::vector<quad_corner_t> h0_;
+  std::vector<quad_corner_t> h1_;
+  std::vector<kindex_t> k_;
+  std::vector<Elt> konst_;
+};
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_SUMCHECK_COMPACT_QUAD_H_
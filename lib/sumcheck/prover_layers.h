@@ -17,6 +17,7 @@
 
 #include <stddef.h>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -40,7 +41,16 @@ class ProverLayers {
  public:
   using inputs = std::vector<std::unique_ptr<Dense<Field>>>;
 
-  explicit ProverLayers(const Field& f) : f_(f) {}
+  explicit ProverLayers(const Field& f) : f_(f), cancel_(nullptr) {}
+
+  // Once *CANCEL becomes true, eval_circuit() fails and prove()
+  // returns early with an incomplete proof, at the next layer or
+  // sumcheck round.  CANCEL must outlive the prover.
+  void set_cancel(const std::atomic<bool>* cancel) { cancel_ = cancel; }
+
+  bool cancelled() const {
+    return cancel_ != nullptr && cancel_->load(std::memory_order_relaxed);
+  }
 
   // Evaluate CIRCUIT on input wires W0.  This function stores the
   // input wires of each layer L into IN->at(L), and returns the
@@ -76,9 +86,9 @@ class ProverLayers {
         V = finalV.get();
       }
 
-      bool ok = eval_quad(circ->l[l].quad.get(), V, W, F);
+      bool ok = !cancelled() && eval_layer(circ->l[l], V, W, F);
       if (!ok) {
-        // Early exit in case of assertion failure.
+        // Early exit in case of assertion failure or cancellation.
         // In this case IN is only partially allocated.
         // To avoid ambiguities, free all memory that we may have allocated.
         for (size_t i = 0; i < nl; ++i) {
@@ -97,6 +107,7 @@ class ProverLayers {
 
  protected:
   const Field& f_;
+  const std::atomic<bool>* cancel_;
 
   // A struct that collects the bindings generated while proving one
   // layer, to serve as initial bindings for the next layer.
@@ -133,15 +144,23 @@ class ProverLayers {
     }
 
     for (size_t ly = 0; ly < circ->nl; ++ly) {
+      if (cancelled()) return;
       auto clr = &circ->l.at(ly);
       Elt alpha, beta;
       ts.begin_layer(alpha, beta, ly);
       Eqs<Field> EQ(logc, nc, bnd.q, F);
-      auto QUAD = clr->quad->clone();
-      QUAD->bind_g(bnd.logv, bnd.g[0], bnd.g[1], alpha, beta, F);
+      std::unique_ptr<Quad<Field>> QUAD;
+      if (clr->cquad != nullptr) {
+        QUAD = clr->cquad->bind_g(bnd.logv, bnd.g[0], bnd.g[1], alpha, beta,
+                                  F);
+      } else {
+        QUAD = clr->quad->clone();
+        QUAD->bind_g(bnd.logv, bnd.g[0], bnd.g[1], alpha, beta, F);
+      }
 
       layer(pr, pad, ts, bnd, ly, logc, clr->logw, &EQ, QUAD.get(),
             in.at(ly).get(), F);
+      if (cancelled()) return;  // QUAD may be partially bound
 
       if (aux != nullptr) {
         aux->bound_quad[ly] = QUAD->scalar();
@@ -183,6 +202,7 @@ class ProverLayers {
     // cases number_of_copies > log(circuit_size), so we don't have to
     // optimize binding R, L.
     for (size_t round = 0; round < logc; ++round) {
+      if (cancelled()) return;
       CPoly sum{};
 
       // sum over r,l: QUAD[|r,l] EQ[|c] W[r,c] W[l,c]
@@ -222,6 +242,7 @@ class ProverLayers {
     Dense<Field>* WH[2] = {W, Wclone.get()};  // reuse W
 
     for (size_t round = 0; round < logw; ++round) {
+      if (cancelled()) return;
       for (size_t hand = 0; hand < 2; hand++) {
         // In SUM_{l,r} Q[l,r] W[l] W[r], first precompute QW[l] =
         // SUM_{r} Q[l,r] W[r] as a dense array, and then compute
@@ -260,23 +281,43 @@ class ProverLayers {
     end_layer(pr, pad, ts, layer, WC, F);
   }
 
+  // Evaluate the quadratic form of LAYER, in either representation.
+  bool eval_layer(const Layer<Field>& layer, Dense<Field>* V,
+                  const Dense<Field>* W, const Field& F) {
+    if (layer.cquad != nullptr) {
+      const CompactQuad<Field>* q = layer.cquad.get();
+      return eval_quad(
+          q->size(), [q](index_t i) { return q->term(i); }, V, W, F);
+    }
+    const Quad<Field>* q = layer.quad.get();
+    return eval_quad(
+        q->n_,
+        [q](index_t i) -> const typename Quad<Field>::corner& {
+          return q->c_[i];
+        },
+        V, W, F);
+  }
+
   // Evaluate the quadratic form
   //
   //         V[g,c] = QUAD[g|r,l] W[r,c] W[l,c]
   //
+  // where TERM(i) is the i-th of the N terms of QUAD.
   // Returns false in the case the quad is an assert0 check that fails.
-  bool eval_quad(const Quad<Field>* quad, Dense<Field>* V,
+  template <class Term>
+  bool eval_quad(index_t n, const Term& term, Dense<Field>* V,
                  const Dense<Field>* W, const Field& F) {
     check(V->n0_ == W->n0_, "V->n0_ == W->n0_");
     corner_t n0 = V->n0_;
 
     V->clear(F);
-    for (index_t i = 0; i < quad->n_; i++) {
-      corner_t g(quad->c_[i].g);
-      corner_t r(quad->c_[i].h[0]);
-      corner_t l(quad->c_[i].h[1]);
+    for (index_t i = 0; i < n; i++) {
+      const auto& t = term(i);
+      corner_t g(t.g);
+      corner_t r(t.h[0]);
+      corner_t l(t.h[1]);
       for (corner_t c = 0; c < n0; ++c) {
-        auto x = quad->c_[i].v;
+        auto x = t.v;
         if (x == F.zero()) {
           // assert that the computed W[l]W[r] is zero.
           auto y = W->v_[n0 * l + c];
@@ -33,6 +33,9 @@
 // ------------------------------------------------------------
 // Special-purpose sparse array for use with sumcheck
 namespace proofs {
+template <class Field>
+class CompactQuad;
+
 template <class Field>
 class Quad {
   using Elt = typename Field::Elt;
@@ -176,17 +179,30 @@ class Quad {
     Eqs<Field> eqh0(logw, nw, H0, F);
     Eqs<Field> eqh1(logw, nw, H1, F);
 
-    Elt s{};
+    // This loop is bound by field multiplications.  Compiled
+    // circuits sort terms so that consecutive terms usually share
+    // h[0], and most coefficients are one.  Thus, accumulate
+    //   V * EQG[g] * EQH1[h[1]]
+    // over a run of equal h[0] and multiply by EQH0[h[0]] once per
+    // run, skipping the multiplication by V when V = 1.  The result
+    // is the same for any term order.
+    Elt s{}, run{};
 
     for (index_t i = 0; i < n_; ++i) {
-      Elt q(c_[i].v);
-      if (q == F.zero()) {
-        q = beta;
+      Elt q = eqg[corner_t(c_[i].g)];
+      const Elt& v = c_[i].v;
+      if (v == F.zero()) {
+        F.mul(q, beta);
+      } else if (v != F.one()) {
+        F.mul(q, v);
       }
-      F.mul(q, eqg[corner_t(c_[i].g)]);
-      F.mul(q, eqh0.at(corner_t(c_[i].h[0])));
       F.mul(q, eqh1.at(corner_t(c_[i].h[1])));
-      F.add(s, q);
+      F.add(run, q);
+      if (i + 1 == n_ || c_[i + 1].h[0] != c_[i].h[0]) {
+        F.mul(run, eqh0.at(corner_t(c_[i].h[0])));
+        F.add(s, run);
+        run = F.zero();
+      }
     }
     return s;
   }
@@ -210,6 +226,10 @@ class Quad {
   }
 
  private:
+  // CompactQuad::bind_g() materializes a bound Quad directly
+  // and needs to coalesce it.
+  friend class CompactQuad<Field>;
+
   void coalesce(const Field& F) {
     // Coalesce duplicates.
     // The (rd,wr)=(0,0) iteration executes the else{} branch and
@@ -24,6 +24,8 @@
 #include "algebra/fp.h"
 #include "arrays/affine.h"
 #include "arrays/sparse.h"
+#include "sumcheck/compact_quad.h"
+#include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
 
 namespace proofs {
@@ -158,6 +160,90 @@ TEST(Quad, equality) {
   Q1b.c_[0] = {qone, {qone, qone}, F.two()};
   EXPECT_FALSE(Q1 == Q1b);
 }
+
+// A quad with few distinct constants, as produced by the compiler
+std::unique_ptr<Quad<Field>> circuit_like_quad(index_t n, size_t logv,
+                                               size_t logw) {
+  const Elt konst[] = {F.zero(), F.one(), F.two(), F.mone(), F.of_scalar(7)};
+  size_t maskv = (size_t(1) << logv) - 1;
+  size_t maskw = (size_t(1) << logw) - 1;
+  auto Q = std::make_unique<Quad<Field>>(n);
+  for (index_t i = 0; i < n; ++i) {
+    Q->c_[i] = Quad<Field>::corner{
+        .g = quad_corner_t((7 * i + 1) & maskv),
+        .h = {quad_corner_t((13 * i + 4) & maskw),
+              quad_corner_t((23 * i + 3) & maskw)},
+        .v = konst[i % 5]};
+  }
+  Q->canonicalize(F);
+  return Q;
+}
+
+TEST(CompactQuad, Expand) {
+  auto Q = circuit_like_quad(index_t(1000), 9, 10);
+  CompactQuad<Field> CQ(*Q, F);
+  EXPECT_EQ(CQ.size(), Q->n_);
+  EXPECT_LE(CQ.nconstants(), 5);
+  EXPECT_LT(CQ.memory_bytes(), Q->n_ * sizeof(Quad<Field>::corner));
+  EXPECT_TRUE(*CQ.expand() == *Q);
+}
+
+TEST(CompactQuad, BindG) {
+  for (size_t n = 1; n < 300; n += 17) {
+    size_t logv = 5, logw = 7;
+    auto Q = circuit_like_quad(index_t(n), logv, logw);
+    CompactQuad<Field> CQ(*Q, F);
+    RandomSlice G0(logv), G1(logv);
+    Elt alpha = rng.next(), beta = rng.next();
+
+    auto Q1 = Q->clone();
+    Q1->bind_g(logv, G0.r_.data(), G1.r_.data(), alpha, beta, F);
+    auto Q2 = CQ.bind_g(logv, G0.r_.data(), G1.r_.data(), alpha, beta, F);
+    EXPECT_TRUE(*Q1 == *Q2);
+  }
+}
+
+TEST(CompactQuad, BindGHAll) {
+  for (size_t n = 1; n < 300; n += 17) {
+    size_t logv = 5, logw = 7;
+    auto Q = circuit_like_quad(index_t(n), logv, logw);
+    CompactQuad<Field> CQ(*Q, F);
+    RandomSlice G0(logv), G1(logv), H0(logw), H1(logw);
+    Elt alpha = rng.next(), beta = rng.next();
+
+    Elt want = Q->bind_gh_all(logv, G0.r_.data(), G1.r_.data(), alpha, beta,
+                              logw, H0.r_.data(), H1.r_.data(), F);
+    Elt got = CQ.bind_gh_all(logv, G0.r_.data(), G1.r_.data(), alpha, beta,
+                             logw, H0.r_.data(), H1.r_.data(), F);
+    EXPECT_EQ(want, got);
+  }
+}
+
+void BM_QuadCloneBindG(benchmark::State& state) {
+  size_t logv = 16, logw = 16;
+  auto Q = circuit_like_quad(index_t(state.range(0)), logv, logw);
+  RandomSlice G0(logv), G1(logv);
+  Elt alpha = rng.next(), beta = rng.next();
+  for (auto s : state) {
+    auto Q1 = Q->clone();
+    Q1->bind_g(logv, G0.r_.data(), G1.r_.data(), alpha, beta, F);
+    benchmark::DoNotOptimize(Q1->n_);
+  }
+}
+BENCHMARK(BM_QuadCloneBindG)->RangeMultiplier(4)->Range(1 << 12, 1 << 20);
+
+void BM_CompactQuadBindG(benchmark::State& state) {
+  size_t logv = 16, logw = 16;
+  auto Q = circuit_like_quad(index_t(state.range(0)), logv, logw);
+  CompactQuad<Field> CQ(*Q, F);
+  RandomSlice G0(logv), G1(logv);
+  Elt alpha = rng.next(), beta = rng.next();
+  for (auto s : state) {
+    auto Q1 = CQ.bind_g(logv, G0.r_.data(), G1.r_.data(), alpha, beta, F);
+    benchmark::DoNotOptimize(Q1->n_);
+  }
+}
+BENCHMARK(BM_CompactQuadBindG)->RangeMultiplier(4)->Range(1 << 12, 1 << 20);
 }  // namespace
 }  // namespace proofs
 
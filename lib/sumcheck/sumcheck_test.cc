@@ -272,6 +272,12 @@ TEST(Sumcheck, SumcheckAddEOneCopy) {
   one_test_sumcheck(CIRCUIT.get());
 }
 
+TEST(Sumcheck, SumcheckAddECompact) {
+  auto CIRCUIT = addE_circuit(8, corner_t(177));
+  CIRCUIT->compact(F);
+  one_test_sumcheck(CIRCUIT.get());
+}
+
 // ------------------------------------------------------------
 // tests with random circuits
 size_t around(size_t n) { return n + (std::rand() % n); }
@@ -316,6 +322,8 @@ TEST(Sumcheck, RandomCircuit) {
   for (size_t i = 0; i < 10; ++i) {
     auto CIRCUIT = random_circuit();
     one_test_sumcheck(CIRCUIT.get());
+    CIRCUIT->compact(F);
+    one_test_sumcheck(CIRCUIT.get());
   }
 }
 }  // namespace
@@ -178,9 +178,15 @@ class VerifierLayers {
 
       // bind QUAD[g|r,l] to the alpha-combination of the
       // two G values GR, GL
-      auto QUAD = clr->quad->clone();
-      QUAD->bind_g(cl->logv, cl->g[0], cl->g[1], challenge->alpha,
-                   challenge->beta, F);
+      std::unique_ptr<Quad<Field>> QUAD;
+      if (clr->cquad != nullptr) {
+        QUAD = clr->cquad->bind_g(cl->logv, cl->g[0], cl->g[1],
+                                  challenge->alpha, challenge->beta, F);
+      } else {
+        QUAD = clr->quad->clone();
+        QUAD->bind_g(cl->logv, cl->g[0], cl->g[1], challenge->alpha,
+                     challenge->beta, F);
+      }
 
       // bind QUAD[G|r,l] to R, L
       for (size_t round = 0; round < clr->logw; ++round) {
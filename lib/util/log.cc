@@ -31,6 +31,7 @@
 #else
 // The point of using std::chrono is to avoid the dependency on absl::time.
 #include <chrono>
+#include <mutex>
 #endif
 
 namespace proofs {
@@ -41,6 +42,7 @@ static enum LogLevel _LOG_LEVEL = INFO;
 
 #if !defined(__ABSL__)
 static auto _last = std::chrono::steady_clock::now();
+static std::mutex _last_mu;  // log() may be called from several threads
 const char* level_str(enum LogLevel l) {
   switch (l) {
     case ERROR:
@@ -96,6 +98,7 @@ void log(enum LogLevel l, const char* format, ...) {
   using microseconds = std::chrono::microseconds;
   using milliseconds = std::chrono::milliseconds;
   if (l <= _LOG_LEVEL) {
+    std::lock_guard<std::mutex> lock(_last_mu);
     auto nt = std::chrono::steady_clock::now();
     auto mus = std::chrono::duration_cast<microseconds>(nt - _last).count();
     auto ms = std::chrono::duration_cast<milliseconds>(nt - _last).count();
@@ -0,0 +1,71 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_UTIL_PARALLEL_H_
+#define PRIVACY_PROOFS_ZK_LIB_UTIL_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace proofs {
+
+// Call f(i) for all 0 <= i < n, in unspecified order, on at most
+// MAX_THREADS threads including the caller, and never on more than n
+// or std::thread::hardware_concurrency().  MAX_THREADS <= 1 runs
+// everything on the caller without creating threads.
+// F must be safe to call concurrently for distinct i.  Iterations
+// are handed out one at a time, so this is meant for a modest number
+// of coarse-grained tasks of uneven size, such as circuit layers.
+template <class F>
+void parallel_for(size_t n, size_t max_threads, const F& f) {
+  size_t nthreads = std::min<size_t>(
+      {n, max_threads, size_t(std::thread::hardware_concurrency())});
+  if (nthreads <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i; (i = next.fetch_add(1)) < n;) {
+      f(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nthreads - 1);
+  for (size_t t = 1; t < nthreads; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// Same as parallel_for(N, MAX_THREADS, F) with as many threads as the
+// hardware supports.
+template <class F>
+void parallel_for(size_t n, const F& f) {
+  parallel_for(n, std::thread::hardware_concurrency(), f);
+}
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_UTIL_PARALLEL_H_
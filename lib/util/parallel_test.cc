@@ -0,0 +1,62 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/parallel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace proofs {
+namespace {
+
+TEST(Parallel, EachIndexOnce) {
+  for (size_t n : {0, 1, 2, 7, 1000}) {
+    std::vector<std::atomic<int>> seen(n);
+    parallel_for(n, [&](size_t i) { seen[i]++; });
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(seen[i].load(), 1);
+    }
+  }
+}
+
+TEST(Parallel, OneThreadStaysOnCaller) {
+  const std::thread::id caller = std::this_thread::get_id();
+  size_t calls = 0;  // not atomic: all calls must be on this thread
+  parallel_for(100, 1, [&](size_t i) {
+    EXPECT_EQ(std::this_thread::get_id(), caller);
+    ++calls;
+  });
+  EXPECT_EQ(calls, 100);
+}
+
+TEST(Parallel, AtMostMaxThreads) {
+  std::atomic<int> running(0), peak(0);
+  parallel_for(64, 2, [&](size_t i) {
+    int r = ++running;
+    int p = peak.load();
+    while (r > p && !peak.compare_exchange_weak(p, r)) {
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    --running;
+  });
+  EXPECT_LE(peak.load(), 2);
+}
+
+}  // namespace
+}  // namespace proofs
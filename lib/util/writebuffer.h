@@ -0,0 +1,77 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_UTIL_WRITEBUFFER_H_
+#define PRIVACY_PROOFS_ZK_LIB_UTIL_WRITEBUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "util/panic.h"
+
+namespace proofs {
+
+// The writing counterpart of ReadBuffer: a cursor over a caller-owned
+// array of fixed size.  A WriteBuffer constructed without an array
+// only counts bytes, so that the code that serializes an object can
+// also compute its exact size.
+class WriteBuffer {
+ public:
+  // counting only
+  WriteBuffer() : buf_(nullptr), size_(SIZE_MAX), next_(0) {}
+
+  explicit WriteBuffer(uint8_t *buf, size_t sz)
+      : buf_(buf), size_(sz), next_(0) {}
+
+  // no copies
+  WriteBuffer(const WriteBuffer &) = delete;
+
+  // TRUE if at least N bytes remain
+  bool have(size_t n) const { return remaining() >= n; }
+
+  size_t remaining() const {
+    check(next_ <= size_, "next_ <= size_");
+    return size_ - next_;
+  }
+
+  // number of bytes written (or counted) so far
+  size_t written() const { return next_; }
+
+  // Claim the next N bytes.  Return a pointer to them, or nullptr if
+  // the buffer is only counting.
+  uint8_t *next(size_t n) {
+    check(have(n), "have(n)");
+    uint8_t *p = (buf_ == nullptr) ? nullptr : &buf_[next_];
+    next_ += n;
+    return p;
+  }
+
+  void next(size_t n, const uint8_t src[/*n*/]) {
+    uint8_t *p = next(n);
+    if (p != nullptr) {
+      for (size_t i = 0; i < n; ++i) {
+        p[i] = src[i];
+      }
+    }
+  }
+
+ private:
+  uint8_t *buf_;
+  size_t size_;
+  size_t next_;
+};
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_UTIL_WRITEBUFFER_H_
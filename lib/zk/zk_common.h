@@ -27,6 +27,7 @@
 #include "sumcheck/quad.h"
 #include "sumcheck/transcript_sumcheck.h"
 #include "util/panic.h"
+#include "util/parallel.h"
 
 namespace proofs {
 
@@ -46,37 +47,61 @@ class ZkCommon {
   using FWPoly = typename LayerProof<Field>::FWPoly;
 
  public:
+  class SumcheckReplay;
+
+  // Number of Ligero linear constraints induced by CIRCUIT: one per
+  // layer, plus the input binding.
+  static size_t num_constraints(const Circuit<Field>& circuit) {
+    return circuit.nl + 1;
+  }
+
   // pi: witness index for first pad element in a larger commitment
   static size_t verifier_constraints(
       const Circuit<Field>& circuit, const Dense<Field>& pub,
       const Proof<Field>& proof, const ProofAux<Field>* aux,
       std::vector<Llc>& a, std::vector<typename Field::Elt>& b, Transcript& tsv,
       size_t pi, const Field& F) {
-    const size_t ninp = circuit.ninputs, npub = circuit.npub_in;
+    SumcheckReplay sr(circuit.nl);
+    replay(sr, circuit, proof, tsv, pi, F);
+    return constraints(sr, circuit, pub, proof, aux, a, b, F);
+  }
 
-    Challenge<Field> ch(circuit.nl);
+  // Constraint generation proceeds in three passes.  The first pass,
+  // replay(), replays the transcript, which is inherently sequential,
+  // and builds the symbolic claim of each layer.  It draws all the
+  // challenges but does not look at the quads, so it is cheap.  The
+  // bound quads are not needed until the final constraint of each
+  // layer, so the second pass evaluates them for all layers
+  // concurrently.  This is the O(circuit size) part of the verifier.
+  // The third pass emits the constraints in layer order.  The last two
+  // passes are in constraints().
+  static void replay(SumcheckReplay& sr, const Circuit<Field>& circuit,
+                     const Proof<Field>& proof, Transcript& tsv, size_t pi,
+                     const Field& F) {
     TranscriptSumcheck<Field> tss(tsv, F);
 
-    tss.begin_circuit(ch.q, ch.g);
+    tss.begin_circuit(sr.ch_.q, sr.ch_.g);
     Claims cla = Claims{
         .logv = circuit.logv,
         .claim = {F.zero(), F.zero()},
-        .q = ch.q,
-        .g = {ch.g, ch.g},
+        .q = sr.ch_.q,
+        .g = {sr.ch_.g, sr.ch_.g},
     };
 
-    size_t ci = 0;  // Index of the next Ligero constraint.
-
     const typename FWPoly::dot_interpolation dot_wpoly(F);
 
     // no copies in this version.
     check(circuit.logc == 0, "assuming that copies=1");
 
+    sr.cbs_.reserve(circuit.nl);
+    sr.clas_.reserve(circuit.nl);
+    sr.pis_.reserve(circuit.nl);
+
     // Constraints from the sumcheck verifier.
     for (size_t ly = 0; ly < circuit.nl; ++ly) {
       auto clr = &circuit.l.at(ly);
       auto plr = &proof.l[ly];
-      auto challenge = &ch.l[ly];
+      auto challenge = &sr.ch_.l[ly];
 
       tss.begin_layer(challenge->alpha, challenge->beta, ly);
 
@@ -84,7 +109,7 @@ class ZkCommon {
       check(clr->logw > 0, "clr->logw > 0");
 
       PadLayout pl(clr->logw);
-      ConstraintBuilder cb(pl, F);  // representing 0
+      ConstraintBuilder& cb = sr.cbs_.emplace_back(pl, F);  // representing 0
 
       cb.first(challenge->alpha, cla.claim);
       // now cb contains claim_{-1} from the previous layer
@@ -101,21 +126,11 @@ class ZkCommon {
         }
       }
 
-      // Verify
-      //        claim = EQ[Q,C] QUAD[R,L] W[R,C] W[L,C]
-      // by substituting in the symbolic constraint on p(1) from the relation:
-      //      claim = <lag, (p(0), p(1), p(2))>.
-      Elt quad = aux == nullptr ? bind_quad(clr, cla, challenge, F)
-                                : aux->bound_quad[ly];
-      Elt eqv =
-          Eq<Field>::eval(circuit.logc, circuit.nc, ch.q, challenge->cb, F);
-      Elt eqq = F.mulf(eqv, quad);
-
-      // Add the final constraint from above.
-      cb.finalize(plr->wc, eqq, ci++, ly, pi, a, b);
-
       tss.write(&plr->wc[0], 1, 2);
 
+      sr.clas_.push_back(cla);
+      sr.pis_.push_back(pi);
+
       cla = Claims{
           .logv = clr->logw,
           .claim = {plr->wc[0], plr->wc[1]},
@@ -127,13 +142,54 @@ class ZkCommon {
                               // next layer
     }
 
+    // Challenge for the input binding
+    sr.cla_ = cla;
+    sr.pi_ = pi;
+    sr.alpha_ = tsv.elt(F);
+  }
+
+  // Emit the constraints of a transcript replayed into SR, and return
+  // their number, which is num_constraints(CIRCUIT).
+  // Without AUX, the bound quads of up to MAX_THREADS layers are
+  // evaluated concurrently, see parallel_for().
+  static size_t constraints(SumcheckReplay& sr, const Circuit<Field>& circuit,
+                            const Dense<Field>& pub, const Proof<Field>& proof,
+                            const ProofAux<Field>* aux, std::vector<Llc>& a,
+                            std::vector<typename Field::Elt>& b,
+                            const Field& F, size_t max_threads = 1) {
+    const size_t ninp = circuit.ninputs, npub = circuit.npub_in;
+    size_t ci = 0;  // Index of the next Ligero constraint.
+
+    std::vector<Elt> quads(circuit.nl);
+    if (aux != nullptr) {
+      quads = aux->bound_quad;
+    } else {
+      parallel_for(circuit.nl, max_threads, [&](size_t ly) {
+        quads[ly] =
+            bind_quad(&circuit.l[ly], sr.clas_[ly], &sr.ch_.l[ly], F);
+      });
+    }
+
+    for (size_t ly = 0; ly < circuit.nl; ++ly) {
+      // Verify
+      //        claim = EQ[Q,C] QUAD[R,L] W[R,C] W[L,C]
+      // by substituting in the symbolic constraint on p(1) from the relation:
+      //      claim = <lag, (p(0), p(1), p(2))>.
+      Elt eqv = Eq<Field>::eval(circuit.logc, circuit.nc, sr.ch_.q,
+                                sr.ch_.l[ly].cb, F);
+      Elt eqq = F.mulf(eqv, quads[ly]);
+
+      // Add the final constraint from above.
+      sr.cbs_[ly].finalize(proof.l[ly].wc, eqq, ci++, ly, sr.pis_[ly], a, b);
+    }
+
     // Constraints induced by the input binding
     //   <eq0 + alpha.eq1, witness> = W_l + alpha.W_r
-    Elt alpha = tsv.elt(F);
     auto plr = &proof.l[circuit.nl - 1];
-    Elt got = F.addf(plr->wc[0], F.mulf(alpha, plr->wc[1]));
+    Elt got = F.addf(plr->wc[0], F.mulf(sr.alpha_, plr->wc[1]));
 
-    return input_constraint(cla, pub, npub, ninp, pi, got, alpha, a, b, ci, F);
+    return input_constraint(sr.cla_, pub, npub, ninp, sr.pi_, got, sr.alpha_,
+                            a, b, ci, F);
   }
 
   // Returns the size of the proof pad for circuit C.
@@ -291,7 +347,7 @@ class ZkCommon {
 
   class ConstraintBuilder {
     Expression expr_;
-    const PadLayout& pl_;
+    PadLayout pl_;
     const Field& f_;
 
    public:
@@ -400,6 +456,29 @@ class ZkCommon {
     }
   };
 
+ public:
+  // The state of replay() needed by constraints().  The claims point
+  // into the challenges, so the object cannot be copied.
+  class SumcheckReplay {
+   public:
+    explicit SumcheckReplay(size_t nl) : ch_(nl) {}
+    SumcheckReplay(const SumcheckReplay&) = delete;
+    SumcheckReplay& operator=(const SumcheckReplay&) = delete;
+
+   private:
+    friend class ZkCommon;
+
+    Challenge<Field> ch_;
+    std::vector<ConstraintBuilder> cbs_;
+    std::vector<Claims> clas_;  // claims at the start of each layer
+    std::vector<size_t> pis_;   // pad index of each layer
+    Claims cla_;                // claims on the input
+    size_t pi_;                 // pad index of the input binding
+    Elt alpha_;                 // input binding challenge
+  };
+
+ private:
+
   // binding(inputs, R) = binding(pub_inputs, R_p) + binding(witness, R_w)
   // This method explicitly computes the public binding, and then adds the
   // constraints that
@@ -441,6 +520,15 @@ class ZkCommon {
 
   static Elt bind_quad(const Layer<Field>* clr, const Claims& cla,
                        const LayerChallenge<Field>* chal, const Field& F) {
+    if (clr->cquad != nullptr) {
+      return clr->cquad->bind_gh_all(
+          // G
+          cla.logv, cla.g[0], cla.g[1], chal->alpha, chal->beta,
+          // H
+          clr->logw, chal->hb[0], chal->hb[1],
+          // Field
+          F);
+    }
     return clr->quad->bind_gh_all(
         // G
         cla.logv, cla.g[0], cla.g[1], chal->alpha, chal->beta,
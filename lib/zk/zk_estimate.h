@@ -0,0 +1,153 @@
+// Copyright 2025 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_ZK_ZK_ESTIMATE_H_
+#define PRIVACY_PROOFS_ZK_LIB_ZK_ZK_ESTIMATE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "ligero/ligero_param.h"
+#include "ligero/ligero_prover.h"
+#include "merkle/merkle_commitment.h"
+#include "merkle/merkle_tree.h"
+#include "sumcheck/circuit.h"
+#include "sumcheck/compact_quad.h"
+#include "sumcheck/quad.h"
+#include "util/ceildiv.h"
+#include "zk/zk_proof.h"
+
+namespace proofs {
+
+// Resources needed to prove and verify one circuit, predicted from the
+// circuit dimensions and the Ligero layout without running anything.
+//
+// Memory is split into the part that stays allocated from commit()
+// until the proof is written (RESIDENT), and the part that only lives
+// within one phase (TRANSIENT), so that the peak of several proofs
+// run in sequence is the sum of the resident parts plus the largest
+// transient one.  Work is counted in field multiplications (OPS) and
+// in bytes hashed with SHA-256 (HASHED), which callers convert to time
+// with per-field calibration constants.
+struct ZkResources {
+  size_t circuit;      // quads of all layers
+  size_t tableau;      // the Ligero tableau
+  size_t max_proof;    // ZkProof::size()
+  size_t proof;        // expected serialized length
+
+  size_t prover_resident;
+  size_t prover_transient;
+  size_t verifier_resident;
+  size_t verifier_transient;
+
+  uint64_t commit_ops, commit_hashed;
+  uint64_t sumcheck_ops;
+  uint64_t ligero_ops;
+  uint64_t verifier_ops, verifier_hashed;
+};
+
+template <class Field>
+ZkResources zk_resources(const ZkProof<Field>& zkp) {
+  using Elt = typename Field::Elt;
+  constexpr size_t kTerm = sizeof(typename Quad<Field>::corner);
+  const Circuit<Field>& c = zkp.c;
+  const LigeroParam<Field>& p = zkp.param;
+  ZkResources r{};
+
+  // The sumcheck prover keeps the inputs of every layer, and binds a
+  // copy of one layer at a time.
+  size_t wires = 0, max_layer = 0, sc_elts = 0;
+  uint64_t sumcheck = 0, verify = 0;
+  for (const Layer<Field>& layer : c.l) {
+    size_t nt = layer.nterms();
+    size_t nw = static_cast<size_t>(layer.nw);
+    size_t nc = static_cast<size_t>(c.nc);
+    r.circuit += layer.cquad != nullptr ? layer.cquad->memory_bytes()
+                                        : nt * kTerm;
+    wires += nc * nw * sizeof(Elt);
+    max_layer = std::max(max_layer, nt * kTerm + nw * sizeof(Elt));
+
+    // evaluation, binding of G and C, then two hands whose terms
+    // roughly halve in every round
+    sumcheck += static_cast<uint64_t>(nc) * nt + nt +
+                (c.logc > 0 ? 2 * static_cast<uint64_t>(nc) * nt : 0) +
+                4 * (static_cast<uint64_t>(nt) + nw);
+    verify += 2 * static_cast<uint64_t>(nt);
+
+    // as serialized by ZkProof::write_sc_proof()
+    sc_elts += 4 * layer.logw + 3 * c.logc + 2;
+  }
+
+  // Rebase the subfield boundary to the private inputs, as ZkProver
+  // does.
+  size_t sb = 0;
+  if (c.subfield_boundary >= c.npub_in) {
+    sb = c.subfield_boundary - c.npub_in;
+  }
+  r.sumcheck_ops = sumcheck;
+  r.tableau = ligero_tableau_size(p, sb);
+  r.max_proof = zkp.size();
+  {
+    LigeroParam<Field> q = p;
+    r.proof = sc_elts * Field::kBytes + q.layout(q.block_enc);
+  }
+
+  // Elements held by the in-memory ZkProof, dominated by the opened
+  // columns.
+  size_t proof_object =
+      (zkp.proof.size() + 2 * p.dblock + p.nreq * p.nrow) * sizeof(Elt) +
+      p.nreq * p.mc_pathlen * Digest::kLength;
+
+  // The witness, and the prover's copy of it with the pad.
+  size_t witness = (c.ninputs + p.nw) * sizeof(Elt);
+
+  // Linear constraints (about one term per private input) and the
+  // dense matrix A of the dot-product test.
+  size_t constraints = p.nw * sizeof(LigeroLinearConstraint<Field>) +
+                       p.nwqrow * p.w * sizeof(Elt);
+
+  r.prover_resident = r.circuit + r.tableau + witness + proof_object;
+  r.prover_transient = std::max(wires + max_layer, constraints);
+  r.verifier_resident = r.circuit + proof_object;
+  r.verifier_transient = std::max(max_layer, constraints);
+
+  // Encoding of every row, and hashing of every column into the
+  // Merkle tree.
+  uint64_t lgbe = lg(p.block_enc);
+  uint64_t block_ext = p.block_enc - p.dblock;
+  r.commit_ops = static_cast<uint64_t>(p.nrow) * p.block_enc * lgbe;
+  r.commit_hashed =
+      block_ext * (static_cast<uint64_t>(p.nrow) * Field::kBytes +
+                   MerkleNonce::kLength + 2 * Digest::kLength);
+
+  // The three row combinations, the dense A, and the constraints.
+  r.ligero_ops = 3 * static_cast<uint64_t>(p.nwqrow) * p.dblock +
+                 static_cast<uint64_t>(p.nwqrow) * p.w + p.nw;
+
+  // Sumcheck replay, the checks on the opened columns, extension of
+  // the three responses, and the dense A.
+  r.verifier_ops = verify + 3 * static_cast<uint64_t>(p.nreq) * p.nrow +
+                   3 * static_cast<uint64_t>(p.block_enc) * lgbe +
+                   static_cast<uint64_t>(p.nwqrow) * p.w;
+  r.verifier_hashed =
+      static_cast<uint64_t>(p.nreq) *
+      (static_cast<uint64_t>(p.nrow) * Field::kBytes + MerkleNonce::kLength +
+       static_cast<uint64_t>(p.mc_pathlen) * Digest::kLength);
+  return r;
+}
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_ZK_ZK_ESTIMATE_H_
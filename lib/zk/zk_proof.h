@@ -27,6 +27,7 @@
 #include "util/log.h"
 #include "util/readbuffer.h"
 #include "util/serialization.h"
+#include "util/writebuffer.h"
 #include "zk/zk_common.h"
 
 namespace proofs {
@@ -68,33 +69,74 @@ struct ZkProof {
         com_proof(&param) {}
 
   explicit ZkProof(const Circuit<Field> &c, size_t rate, size_t req,
-                   size_t block_enc)
+                   size_t block_enc,
+                   const MerkleShape &shape = MerkleShape{})
       : c(c),
         proof(c.nl),
         param((c.ninputs - c.npub_in) + ZkCommon<Field>::pad_size(c), c.nl,
-              rate, req, block_enc),
+              rate, req, block_enc, shape),
         com_proof(&param) {}
 
-  // Maximum size of the proof in bytes. The actual size will be smaller
-  // because the Merkle proof is batched.
+  // Maximum size of the proof in bytes, counting everything write()
+  // emits.  The actual size is smaller because the Merkle proof is
+  // batched, and the opened rows usually compress.
   size_t size() const {
-    return Digest::kLength +
+    size_t sc = 0;
+    for (size_t i = 0; i < c.nl; ++i) {
+      sc += c.l[i].logw * (3 - 1) * 2 + 2;
+    }
+
+    // Each opened element takes at most kBytes, plus one 4-byte run
+    // header per run.  Every run except the first is nonempty or
+    // follows a run of kMaxRunLen elements.  Unless switching to a
+    // subfield run saves at least the 8 bytes of the two extra
+    // headers, the worst case alternates runs of single elements.
+    const size_t nopen = com_proof.nreq * com_proof.nrow;
+    const size_t saved = Field::kBytes - Field::kSubFieldBytes;
+    size_t runs = nopen * Field::kBytes + 4 * (1 + nopen / kMaxRunLen);
+    if (saved < 8) {
+      runs += (nopen + 1) / 2 * (8 - saved);
+    }
 
-           proof.size() * Field::kBytes +
+    return param.mc_shape.cap * Digest::kLength +
 
-           com_proof.block * 2 * Field::kBytes +
-           com_proof.nreq * com_proof.nrow * Field::kBytes +
-           com_proof.nreq * com_proof.mc_pathlen * Digest::kLength;
+           sc * Field::kBytes +
+
+           (com_proof.block + com_proof.dblock + com_proof.r +
+            (com_proof.dblock - com_proof.block)) *
+               Field::kBytes +
+           com_proof.nreq * MerkleNonce::kLength + runs +
+           4 + com_proof.nreq * com_proof.mc_pathlen * Digest::kLength;
   }
 
-  void write(std::vector<uint8_t> &buf, const Field &F) const {
-    size_t s0 = buf.size();
+  // Exact size of the serialized proof in bytes, at most size().
+  size_t encoded_size(const Field &F) const {
+    WriteBuffer count;
+    write_com(com, count, F);
+    write_sc_proof(proof, count, F);
+    write_com_proof(com_proof, count, F);
+    return count.written();
+  }
+
+  // Serialize into the caller's buffer.  Return false, and write
+  // nothing, if fewer than encoded_size() bytes remain in BUF.
+  bool write(WriteBuffer &buf, const Field &F) const {
+    if (!buf.have(encoded_size(F))) return false;
+    write_unchecked(buf, F);
+    return true;
+  }
+
+  // Same as write(), for callers that already know that BUF has room
+  // for encoded_size() more bytes, so that the proof is serialized
+  // only once.
+  void write_unchecked(WriteBuffer &buf, const Field &F) const {
+    size_t s0 = buf.written();
     write_com(com, buf, F);
-    size_t s1 = buf.size();
+    size_t s1 = buf.written();
     write_sc_proof(proof, buf, F);
-    size_t s2 = buf.size();
+    size_t s2 = buf.written();
     write_com_proof(com_proof, buf, F);
-    size_t s3 = buf.size();
+    size_t s3 = buf.written();
     log(INFO,
         "com:%zu, sc:%zu, com_proof:%zu [%zu el, %zu el, %zu d in %zu "
         "rows]: %zub",
@@ -103,6 +145,10 @@ struct ZkProof {
         com_proof.nrow, s3 - s0);
   }
 
+  void write(std::vector<uint8_t> &buf, const Field &F) const {
+    append(buf, [&](WriteBuffer &wb) { write_unchecked(wb, F); });
+  }
+
   // The read function returns false on error or underflow.
   bool read(ReadBuffer &buf, const Field &F) {
     if (!read_com(com, buf, F)) return false;
@@ -113,6 +159,21 @@ struct ZkProof {
 
   void write_sc_proof(const Proof<Field> &pr, std::vector<uint8_t> &buf,
                       const Field &F) const {
+    append(buf, [&](WriteBuffer &wb) { write_sc_proof(pr, wb, F); });
+  }
+
+  void write_com(const LigeroCommitment<Field> &com0, std::vector<uint8_t> &buf,
+                 const Field &F) const {
+    append(buf, [&](WriteBuffer &wb) { write_com(com0, wb, F); });
+  }
+
+  void write_com_proof(const LigeroProof<Field> &pr, std::vector<uint8_t> &buf,
+                       const Field &F) const {
+    append(buf, [&](WriteBuffer &wb) { write_com_proof(pr, wb, F); });
+  }
+
+  void write_sc_proof(const Proof<Field> &pr, WriteBuffer &buf,
+                      const Field &F) const {
     check(c.logc == 0, "cannot write sc proof with logc != 0");
     for (size_t i = 0; i < pr.l.size(); ++i) {
       for (size_t wi = 0; wi < c.l[i].logw; ++wi) {
@@ -129,25 +190,19 @@ struct ZkProof {
     }
   }
 
-  void write_com(const LigeroCommitment<Field> &com0, std::vector<uint8_t> &buf,
+  void write_com(const LigeroCommitment<Field> &com0, WriteBuffer &buf,
                  const Field &F) const {
-    buf.insert(buf.end(), com0.root.data, com0.root.data + Digest::kLength);
+    for (const Digest &d : com0.cap) {
+      write_digest(d, buf);
+    }
   }
 
-  void write_com_proof(const LigeroProof<Field> &pr, std::vector<uint8_t> &buf,
+  void write_com_proof(const LigeroProof<Field> &pr, WriteBuffer &buf,
                        const Field &F) const {
-    for (size_t i = 0; i < pr.block; ++i) {
-      write_elt(pr.y_ldt[i], buf, F);
-    }
-    for (size_t i = 0; i < pr.dblock; ++i) {
-      write_elt(pr.y_dot[i], buf, F);
-    }
-    for (size_t i = 0; i < pr.r; ++i) {
-      write_elt(pr.y_quad_0[i], buf, F);
-    }
-    for (size_t i = 0; i < pr.dblock - pr.block; ++i) {
-      write_elt(pr.y_quad_2[i], buf, F);
-    }
+    write_elts(pr.block, pr.y_ldt.data(), buf, F);
+    write_elts(pr.dblock, pr.y_dot.data(), buf, F);
+    write_elts(pr.r, pr.y_quad_0.data(), buf, F);
+    write_elts(pr.dblock - pr.block, pr.y_quad_2.data(), buf, F);
 
     // write all the Merkle nonces
     for (size_t i = 0; i < pr.nreq; ++i) {
@@ -166,12 +221,12 @@ struct ZkProof {
         ++runlen;
       }
       write_size(runlen, buf);
-      for (size_t i = ci; i < ci + runlen; ++i) {
-        if (subfield_run) {
+      if (subfield_run) {
+        for (size_t i = ci; i < ci + runlen; ++i) {
           write_subfield_elt(pr.req[i], buf, F);
-        } else {
-          write_elt(pr.req[i], buf, F);
         }
+      } else {
+        write_elts(runlen, &pr.req[ci], buf, F);
       }
       ci += runlen;
       subfield_run = !subfield_run;
@@ -184,35 +239,56 @@ struct ZkProof {
   }
 
  private:
-  void write_elt(const Elt &x, std::vector<uint8_t> &buf,
-                 const Field &F) const {
-    uint8_t tmp[Field::kBytes];
-    F.to_bytes_field(tmp, x);
-    buf.insert(buf.end(), tmp, tmp + Field::kBytes);
+  // Append the output of EMIT to BUF.  EMIT runs twice, first on a
+  // counting WriteBuffer to size BUF, and then to fill it in place.
+  template <class Emit>
+  static void append(std::vector<uint8_t> &buf, const Emit &emit) {
+    WriteBuffer count;
+    emit(count);
+    size_t sz = buf.size();
+    buf.resize(sz + count.written());
+    WriteBuffer wb(buf.data() + sz, count.written());
+    emit(wb);
   }
 
-  void write_subfield_elt(const Elt &x, std::vector<uint8_t> &buf,
+  // The writers below only convert elements when BUF is not counting.
+  void write_elt(const Elt &x, WriteBuffer &buf, const Field &F) const {
+    if (uint8_t *p = buf.next(Field::kBytes)) {
+      F.to_bytes_field(p, x);
+    }
+  }
+
+  void write_elts(size_t n, const Elt x[/*n*/], WriteBuffer &buf,
+                  const Field &F) const {
+    if (uint8_t *p = buf.next(n * Field::kBytes)) {
+      F.to_bytes_field_n(n, p, x, 1);
+    }
+  }
+
+  void write_subfield_elt(const Elt &x, WriteBuffer &buf,
                           const Field &F) const {
-    uint8_t tmp[Field::kSubFieldBytes];
-    F.to_bytes_subfield(tmp, x);
-    buf.insert(buf.end(), tmp, tmp + Field::kSubFieldBytes);
+    if (uint8_t *p = buf.next(Field::kSubFieldBytes)) {
+      F.to_bytes_subfield(p, x);
+    }
   }
 
-  void write_digest(const Digest &x, std::vector<uint8_t> &buf) const {
-    buf.insert(buf.end(), x.data, x.data + Digest::kLength);
+  void write_digest(const Digest &x, WriteBuffer &buf) const {
+    buf.next(Digest::kLength, x.data);
   }
 
-  void write_nonce(const MerkleNonce &x, std::vector<uint8_t> &buf) const {
-    buf.insert(buf.end(), x.bytes, x.bytes + MerkleNonce::kLength);
+  void write_nonce(const MerkleNonce &x, WriteBuffer &buf) const {
+    buf.next(MerkleNonce::kLength, x.bytes);
   }
 
   // Assumption is that all of the sizes of arrays that are part of proofs
   // fit into 4 bytes, and can thus work on 32-b machines.
-  void write_size(size_t g, std::vector<uint8_t> &buf) const {
+  void write_size(size_t g, WriteBuffer &buf) const {
+    uint8_t tmp[4];
     for (size_t i = 0; i < 4; ++i) {
-      buf.push_back(static_cast<uint8_t>(g & 0xff));
+      tmp[i] = static_cast<uint8_t>(g & 0xff);
       g >>= 8;
     }
+    buf.next(4, tmp);
   }
 
   bool read_sc_proof(Proof<Field> &pr, ReadBuffer &buf, const Field &F) {
@@ -252,50 +328,21 @@ struct ZkProof {
 
   bool read_com(LigeroCommitment<Field> &com0, ReadBuffer &buf,
                 const Field &F) {
-    if (!buf.have(Digest::kLength)) return false;
-    read_digest(buf, com0.root);
+    size_t ncap = param.mc_shape.cap;
+    if (!buf.have(ncap * Digest::kLength)) return false;
+    com0.cap.resize(ncap);
+    for (size_t i = 0; i < ncap; ++i) {
+      read_digest(buf, com0.cap[i]);
+    }
     return true;
   }
 
   bool read_com_proof(LigeroProof<Field> &pr, ReadBuffer &buf, const Field &F) {
-    if (!buf.have(pr.block * Field::kBytes)) return false;
-    for (size_t i = 0; i < pr.block; ++i) {
-      auto v = read_elt(buf, F);
-      if (v) {
-        pr.y_ldt[i] = v.value();
-      } else {
-        return false;
-      }
-    }
-
-    if (!buf.have(pr.dblock * Field::kBytes)) return false;
-    for (size_t i = 0; i < pr.dblock; ++i) {
-      auto v = read_elt(buf, F);
-      if (v) {
-        pr.y_dot[i] = v.value();
-      } else {
-        return false;
-      }
-    }
-
-    if (!buf.have(pr.r * Field::kBytes)) return false;
-    for (size_t i = 0; i < pr.r; ++i) {
-      auto v = read_elt(buf, F);
-      if (v) {
-        pr.y_quad_0[i] = v.value();
-      } else {
-        return false;
-      }
-    }
-
-    if (!buf.have((pr.dblock - pr.block) * Field::kBytes)) return false;
-    for (size_t i = 0; i < pr.dblock - pr.block; ++i) {
-      auto v = read_elt(buf, F);
-      if (v) {
-        pr.y_quad_2[i] = v.value();
-      } else {
-        return false;
-      }
+    if (!read_elts(buf, pr.block, pr.y_ldt.data(), F)) return false;
+    if (!read_elts(buf, pr.dblock, pr.y_dot.data(), F)) return false;
+    if (!read_elts(buf, pr.r, pr.y_quad_0.data(), F)) return false;
+    if (!read_elts(buf, pr.dblock - pr.block, pr.y_quad_2.data(), F)) {
+      return false;
     }
 
     if (!buf.have(pr.nreq * MerkleNonce::kLength)) return false;
@@ -321,15 +368,7 @@ struct ZkProof {
           }
         }
       } else {
-        if (!buf.have(runlen * Field::kBytes)) return false;
-        for (size_t i = ci; i < ci + runlen; ++i) {
-          auto v = read_elt(buf, F);
-          if (v) {
-            pr.req[i] = v.value();
-          } else {
-            return false;
-          }
-        }
+        if (!read_elts(buf, runlen, &pr.req[ci], F)) return false;
       }
       ci += runlen;
       subfield_run = !subfield_run;
@@ -358,6 +397,14 @@ struct ZkProof {
     return F.of_bytes_field(buf.next(Field::kBytes));
   }
 
+  // Read N contiguous elements, failing on underflow or if any
+  // element is out of range.
+  bool read_elts(ReadBuffer &buf, size_t n, Elt x[/*n*/],
+                 const Field &F) const {
+    if (!buf.have(n * Field::kBytes)) return false;
+    return F.of_bytes_field_n(n, x, buf.next(n * Field::kBytes));
+  }
+
   std::optional<Elt> read_subfield_elt(ReadBuffer &buf, const Field &F) const {
     return F.of_bytes_subfield(buf.next(Field::kSubFieldBytes));
   }
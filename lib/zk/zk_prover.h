@@ -17,7 +17,9 @@
 
 #include <stddef.h>
 
+#include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "arrays/dense.h"
@@ -34,6 +36,47 @@
 #include "zk/zk_proof.h"
 
 namespace proofs {
+template <class Field, class ReedSolomonFactory>
+class ZkProver;
+
+// Phases of ZkProver, reported to the progress callback as they start.
+enum ZkProverPhase {
+  ZK_PHASE_COMMIT,    // layout, encoding and hashing of the tableau
+  ZK_PHASE_SUMCHECK,  // circuit evaluation and padded sumcheck
+  ZK_PHASE_LIGERO,    // constraints and the proof over the commitment
+};
+
+// The part of ZkProver::commit() that depends only on randomness and on
+// the shape of the circuit, but not on the witness or on the session
+// transcript: the sumcheck pad, the Ligero blinding rows, the random
+// prefixes of the Ligero witness rows, and the Merkle nonces.
+//
+// Objects of this class are produced by ZkProver::precompute(), for
+// example while the application waits for user consent, and are
+// consumed by exactly one ZkProver::commit(), which takes ownership.
+template <class Field, class ReedSolomonFactory>
+class ZkProverPrecomputation {
+  using Elt = typename Field::Elt;
+
+ public:
+  // no copies: the randomness must not be used twice
+  ZkProverPrecomputation(const ZkProverPrecomputation&) = delete;
+  ZkProverPrecomputation& operator=(const ZkProverPrecomputation&) = delete;
+
+ private:
+  friend class ZkProver<Field, ReedSolomonFactory>;
+
+  using LP = LigeroProver<Field, ReedSolomonFactory>;
+
+  ZkProverPrecomputation(const Circuit<Field>* c, const LigeroParam<Field>& p)
+      : c_(c), pad_(c->nl), lp_(std::make_unique<LP>(p)) {}
+
+  const Circuit<Field>* c_;    // circuit for which this object was built
+  Proof<Field> pad_;           // sumcheck pad
+  std::vector<Elt> padw_;      // pad values in commitment order
+  std::unique_ptr<LP> lp_;     // Ligero prover with precomputed tableau
+};
+
 // ZK Prover
 //
 // This class implements a zero-knowledge argument over a sumcheck transcript
@@ -69,23 +112,23 @@ class ZkProver : public ProverLayers<Field> {
         lqc_(c_.nl),
         lp_(nullptr) {}
 
-  void commit(ZkProof<Field>& zkp, const Dense<Field>& W, Transcript& tp,
+  using Precomputation = ZkProverPrecomputation<Field, ReedSolomonFactory>;
+
+  // PROGRESS, if set, is called at the start of each phase of commit()
+  // and prove(), on the thread that runs them.  Cancellation, see
+  // ProverLayers::set_cancel(), makes commit() and prove() return
+  // false.
+  void set_progress(std::function<void(ZkProverPhase)> progress) {
+    progress_ = std::move(progress);
+  }
+
+  // Returns false only if cancelled.
+  bool commit(ZkProof<Field>& zkp, const Dense<Field>& W, Transcript& tp,
               RandomEngine& rng) {
     log(INFO, "ZK Commit start");
+    report(ZK_PHASE_COMMIT);
 
-    // Copy witnesses for commitment
-    // Layout of the com: 0 ...<witnesses>... start_pad <pad> len
-    // Only commit the private witnesses, which begin at index c_.npub_in.
-    for (size_t i = 0; i < n_witness_; ++i) {
-      witness_[i] = W.v_[i + c_.npub_in];
-    }
-
-    // Rebase the circuit SUBFIELD_BOUNDARY (if any) to start at
-    // NPUB_IN,
-    size_t subfield_boundary = 0;
-    if (c_.subfield_boundary >= c_.npub_in) {
-      subfield_boundary = c_.subfield_boundary - c_.npub_in;
-    }
+    copy_witness(W);
 
     // Fill pad with random values, add pad to witness, record lqc.
     fill_pad(rng);
@@ -93,10 +136,43 @@ class ZkProver : public ProverLayers<Field> {
 
     // Commit to witness and pad.
     lp_ = std::make_unique<LigeroProver<Field, ReedSolomonFactory>>(zkp.param);
-    lp_->commit(zkp.com, tp, &witness_[0], subfield_boundary, &lqc_[0], rsf_,
-                rng, f_);
+    return commit_ligero(zkp, tp, rng);
+  }
 
-    log(INFO, "ZK Commitment done");
+  // Produce the witness-independent part of commit() ahead of time.
+  // ZKP is only used for its Ligero parameters.
+  std::unique_ptr<Precomputation> precompute(const ZkProof<Field>& zkp,
+                                             RandomEngine& rng) const {
+    log(INFO, "ZK Precompute start");
+    std::unique_ptr<Precomputation> pre(new Precomputation(&c_, zkp.param));
+    fill_pad(pre->pad_, pre->padw_, rng);
+    pre->lp_->precompute(subfield_boundary(), rsf_, rng, f_);
+    log(INFO, "ZK Precompute done");
+    return pre;
+  }
+
+  // Same as commit(ZKP, W, TP, RNG), but consuming PRE instead of
+  // generating the pad and the blinding rows.  RNG is still needed for
+  // randomness that is not precomputed, if any.
+  bool commit(ZkProof<Field>& zkp, const Dense<Field>& W, Transcript& tp,
+              RandomEngine& rng, std::unique_ptr<Precomputation> pre) {
+    log(INFO, "ZK Commit start (precomputed)");
+    report(ZK_PHASE_COMMIT);
+    check(pre != nullptr, "missing precomputation");
+    check(pre->c_ == &c_, "precomputation for a different circuit");
+    check(same_layout(pre->lp_->param(), zkp.param),
+          "precomputation for different Ligero parameters");
+
+    copy_witness(W);
+
+    pad_ = pre->pad_;
+    witness_.insert(witness_.end(), pre->padw_.begin(), pre->padw_.end());
+    ZkCommon<Field>::setup_lqc(c_, lqc_, n_witness_ /* = start_pad */);
+
+    // The precomputed LigeroProver becomes ours, and PRE is destroyed
+    // on return.
+    lp_ = std::move(pre->lp_);
+    return commit_ligero(zkp, tp, rng);
   }
 
   bool prove(ZkProof<Field>& zkp, const Dense<Field>& W, Transcript& tsp) {
@@ -104,12 +180,16 @@ class ZkProver : public ProverLayers<Field> {
 
     // Interpret W as public parameters, we only append
     // c_.npub_in elements of W to the transcript
+    report(ZK_PHASE_SUMCHECK);
     ZkCommon<Field>::initialize_sumcheck_fiat_shamir(tsp, c_, W, f_);
     Transcript tst = tsp.clone();
 
     // Run sumcheck to generate a padded proof.
     inputs in;
     auto V = super::eval_circuit(&in, &c_, W.clone(), f_);
+    if (super::cancelled()) {
+      return false;
+    }
     if (V == nullptr) {
       log(ERROR, "eval_circuit failed");
       return false;
@@ -125,7 +205,11 @@ class ZkProver : public ProverLayers<Field> {
 
     TranscriptSumcheck<Field> tsts(tst, f_);
     super::prove(&zkp.proof, &pad_, &c_, in, &aux, bnd, tsts, f_);
+    if (super::cancelled()) {
+      return false;
+    }
     log(INFO, "ZK sumcheck done");
+    report(ZK_PHASE_LIGERO);
 
     // 5. Simulate the verifier to assemble constraints on the committed vals.
     //    Form the sparse matrix A and vector b such that A*w = b.
@@ -134,6 +218,9 @@ class ZkProver : public ProverLayers<Field> {
     size_t ci = ZkCommon<Field>::verifier_constraints(c_, W, zkp.proof, &aux, a,
                                                       b, tsp, n_witness_, f_);
     log(INFO, "ZK constraints done");
+    if (super::cancelled()) {
+      return false;
+    }
 
     // 6. Produce proof over commitment.
     // For FS soundness, it is ok for hash_of_A to be any string.
@@ -148,17 +235,39 @@ class ZkProver : public ProverLayers<Field> {
     return true;
   }
 
+  void report(ZkProverPhase phase) const {
+    if (progress_) {
+      progress_(phase);
+    }
+  }
+
+  bool commit_ligero(ZkProof<Field>& zkp, Transcript& tp, RandomEngine& rng) {
+    lp_->set_cancel(super::cancel_);
+    if (!lp_->commit(zkp.com, tp, &witness_[0], subfield_boundary(), &lqc_[0],
+                     rsf_, rng, f_)) {
+      log(INFO, "ZK Commit cancelled");
+      return false;
+    }
+    log(INFO, "ZK Commitment done");
+    return true;
+  }
+
   // Fill proof with random pad values for a given circuit.
-  void fill_pad(RandomEngine& rng) {
+  void fill_pad(RandomEngine& rng) { fill_pad(pad_, witness_, rng); }
+
+  // Fill PAD with random values, and append them to PADW in the
+  // order in which they are committed.
+  void fill_pad(Proof<Field>& pad, std::vector<Elt>& padw,
+                RandomEngine& rng) const {
     for (size_t i = 0; i < c_.nl; ++i) {
       for (size_t j = 0; j < c_.logc; ++j) {
         for (size_t k = 0; k < 4; ++k) {
           if (k != 1) {  // P(1) optimization
             Elt r = rng.elt(f_);
-            pad_.l[i].cp[j].t_[k] = r;
-            witness_.push_back(r);
+            pad.l[i].cp[j].t_[k] = r;
+            padw.push_back(r);
           } else {
-            pad_.l[i].cp[j].t_[k] = f_.zero();
+            pad.l[i].cp[j].t_[k] = f_.zero();
           }
         }
       }
@@ -167,26 +276,55 @@ class ZkProver : public ProverLayers<Field> {
           for (size_t k = 0; k < 3; ++k) {
             if (k != 1) {  // P(1) optimization
               Elt r = rng.elt(f_);
-              pad_.l[i].hp[h][j].t_[k] = r;
-              witness_.push_back(r);
+              pad.l[i].hp[h][j].t_[k] = r;
+              padw.push_back(r);
             } else {
-              pad_.l[i].hp[h][j].t_[k] = f_.zero();
+              pad.l[i].hp[h][j].t_[k] = f_.zero();
             }
           }
         }
       }
       for (size_t k = 0; k < 2; ++k) {
         Elt r = rng.elt(f_);
-        pad_.l[i].wc[k] = r;
-        witness_.push_back(r);
+        pad.l[i].wc[k] = r;
+        padw.push_back(r);
       }
 
       // Commit to product of pads for product proof.
-      Elt rr = f_.mulf(pad_.l[i].wc[0], pad_.l[i].wc[1]);
-      witness_.push_back(rr);
+      Elt rr = f_.mulf(pad.l[i].wc[0], pad.l[i].wc[1]);
+      padw.push_back(rr);
+    }
+  }
+
+  // Copy witnesses for commitment
+  // Layout of the com: 0 ...<witnesses>... start_pad <pad> len
+  // Only commit the private witnesses, which begin at index c_.npub_in.
+  void copy_witness(const Dense<Field>& W) {
+    witness_.resize(n_witness_);
+    for (size_t i = 0; i < n_witness_; ++i) {
+      witness_[i] = W.v_[i + c_.npub_in];
     }
   }
 
+  // Rebase the circuit SUBFIELD_BOUNDARY (if any) to start at
+  // NPUB_IN,
+  size_t subfield_boundary() const {
+    size_t subfield_boundary = 0;
+    if (c_.subfield_boundary >= c_.npub_in) {
+      subfield_boundary = c_.subfield_boundary - c_.npub_in;
+    }
+    return subfield_boundary;
+  }
+
+  static bool same_layout(const LigeroParam<Field>& a,
+                          const LigeroParam<Field>& b) {
+    return a.nw == b.nw && a.nq == b.nq && a.rateinv == b.rateinv &&
+           a.nreq == b.nreq && a.block_enc == b.block_enc &&
+           a.block == b.block && a.nrow == b.nrow &&
+           a.mc_shape.arity == b.mc_shape.arity &&
+           a.mc_shape.cap == b.mc_shape.cap;
+  }
+
   const Circuit<Field>& c_;
   const size_t n_witness_;
   const Field& f_;
@@ -195,6 +333,7 @@ class ZkProver : public ProverLayers<Field> {
   std::vector<Elt> witness_;
   std::vector<LigeroQuadraticConstraint> lqc_;
   std::unique_ptr<LigeroProver<Field, ReedSolomonFactory>> lp_;
+  std::function<void(ZkProverPhase)> progress_;
 };
 
 }  // namespace proofs
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "algebra/convolution.h"
+#include "algebra/fp2.h"
 #include "algebra/fp_p128.h"
 #include "algebra/reed_solomon.h"
 #include "arrays/dense.h"
@@ -30,8 +31,10 @@
 #include "circuits/logic/compiler_backend.h"
 #include "circuits/logic/logic.h"
 #include "ec/p256.h"
+#include "merkle/merkle_tree.h"
 #include "proto/circuit.h"
 #include "random/random.h"
+#include "random/secure_random_engine.h"
 #include "random/transcript.h"
 #include "sumcheck/circuit.h"
 #include "sumcheck/prover.h"
@@ -132,6 +135,32 @@ TEST_F(ZKTest, prover_verifier) {
                1ull << 31);
 }
 
+TEST_F(ZKTest, prover_verifier_precomputed) {
+  run2_test_zk(*circuit1_, *w_, *pub_, p256_base, omega_x_, omega_y_,
+               1ull << 31, /*precompute=*/true);
+}
+
+// A precomputation commits to its own Merkle shape, so it cannot be
+// used for a proof with a different one.
+TEST_F(ZKTest, precomputed_shape_mismatch) {
+  using Field2 = Fp2<Fp256Base>;
+  using FftExtConvolutionFactory = FFTExtConvolutionFactory<Fp256Base, Field2>;
+  using RSFactory = ReedSolomonFactory<Fp256Base, FftExtConvolutionFactory>;
+  const Field2 base_2(p256_base);
+  const FftExtConvolutionFactory fft(p256_base, base_2, {omega_x_, omega_y_},
+                                     1ull << 31);
+  const RSFactory rsf(fft, p256_base);
+
+  ZkProof<Fp256Base> zkp1(*circuit1_, kLigeroRate, kLigeroNreq);
+  ZkProof<Fp256Base> zkp4(*circuit1_, kLigeroRate, kLigeroNreq,
+                          zkp1.param.block_enc, MerkleShape{4, 16});
+  Transcript tp((uint8_t*)"zk_test", 7, kVersion);
+  SecureRandomEngine rng;
+  ZkProver<Fp256Base, RSFactory> prover(*circuit1_, p256_base, rsf);
+  EXPECT_DEATH(prover.commit(zkp4, *w_, tp, rng, prover.precompute(zkp1, rng)),
+               "precomputation for different Ligero parameters");
+}
+
 TEST_F(ZKTest, failing_test) {
   auto W_fail = Dense<Fp256Base>(1, circuit1_->ninputs);
   DenseFiller<Fp256Base> wf(W_fail);
@@ -199,6 +228,18 @@ TEST_F(ZKTest, elt_out_of_range) {
   }
 }
 
+TEST_F(ZKTest, size_bounds_encoding) {
+  ZkProof<Fp256Base> zkp(*circuit1_, 4, 189);
+  // Worst case: a full cap and an unbatched Merkle proof.
+  zkp.com.cap.resize(zkp.param.mc_shape.cap);
+  zkp.com_proof.merkle.path.resize(zkp.com_proof.nreq *
+                                   zkp.com_proof.mc_pathlen);
+  size_t sz = zkp.encoded_size(p256_base);
+  EXPECT_LE(sz, zkp.size());
+  // Only the run headers are estimated, the rest is exact.
+  EXPECT_GE(sz + 4 * zkp.com_proof.nreq * zkp.com_proof.nrow, zkp.size());
+}
+
 TEST(ZK, test_circuit_io) {
   auto c = Circuit<Fp256Base>{
       .nv = 2,
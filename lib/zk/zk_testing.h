@@ -15,8 +15,10 @@
 #ifndef PRIVACY_PROOFS_ZK_LIB_ZK_ZK_TESTING_H_
 #define PRIVACY_PROOFS_ZK_LIB_ZK_ZK_TESTING_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "algebra/convolution.h"
@@ -28,6 +30,7 @@
 #include "sumcheck/circuit.h"
 #include "util/log.h"
 #include "util/readbuffer.h"
+#include "util/writebuffer.h"
 #include "zk/zk_proof.h"
 #include "zk/zk_prover.h"
 #include "zk/zk_verifier.h"
@@ -40,12 +43,14 @@ constexpr size_t kLigeroNreq = 189;
 constexpr size_t kVersion = 4;
 
 // Runs a zk prover and verifier for a field that requires a field extension
-// to perform the commitment.
+// to perform the commitment.  If PRECOMPUTE is set, the prover commits
+// using a ZkProverPrecomputation.
 template <class Field>
 void run2_test_zk(const Circuit<Field>& circuit, Dense<Field>& W,
                   const Dense<Field>& pub, const Field& base,
                   const typename Field::Elt& root_x,
-                  const typename Field::Elt& root_y, size_t root_order) {
+                  const typename Field::Elt& root_y, size_t root_order,
+                  bool precompute = false) {
   // Build the relevant algebra objects.
   using Field2 = Fp2<Field>;
   using Elt2 = typename Field2::Elt;
@@ -62,14 +67,58 @@ void run2_test_zk(const Circuit<Field>& circuit, Dense<Field>& W,
   Transcript tp((uint8_t*)"zk_test", 7, kVersion);
   SecureRandomEngine rng;
   ZkProver<Field, RSFactory> prover(circuit, base, rsf);
-  prover.commit(zkpr, W, tp, rng);
+  std::vector<ZkProverPhase> phases;
+  prover.set_progress([&](ZkProverPhase ph) { phases.push_back(ph); });
+  if (precompute) {
+    auto pre = prover.precompute(zkpr, rng);
+    EXPECT_TRUE(prover.commit(zkpr, W, tp, rng, std::move(pre)));
+  } else {
+    EXPECT_TRUE(prover.commit(zkpr, W, tp, rng));
+  }
   EXPECT_TRUE(prover.prove(zkpr, W, tp));
   log(INFO, "ZK Prover done");
+  EXPECT_EQ(phases, (std::vector<ZkProverPhase>{
+                        ZK_PHASE_COMMIT, ZK_PHASE_SUMCHECK, ZK_PHASE_LIGERO}));
+
+  // A cancelled prover fails at its next check, whether that is in
+  // commit() or in prove().
+  {
+    std::atomic<bool> cancel(true);
+    ZkProof<Field> zkpc(circuit, kLigeroRate, kLigeroNreq);
+    Transcript tc((uint8_t*)"zk_test", 7, kVersion);
+    ZkProver<Field, RSFactory> cp(circuit, base, rsf);
+    cp.set_cancel(&cancel);
+    EXPECT_FALSE(cp.commit(zkpc, W, tc, rng));
+  }
+  {
+    std::atomic<bool> cancel(false);
+    ZkProof<Field> zkpc(circuit, kLigeroRate, kLigeroNreq);
+    Transcript tc((uint8_t*)"zk_test", 7, kVersion);
+    ZkProver<Field, RSFactory> cp(circuit, base, rsf);
+    cp.set_cancel(&cancel);
+    cp.set_progress([&](ZkProverPhase ph) {
+      if (ph == ZK_PHASE_SUMCHECK) cancel = true;
+    });
+    EXPECT_TRUE(cp.commit(zkpc, W, tc, rng));
+    EXPECT_FALSE(cp.prove(zkpc, W, tc));
+  }
 
   std::vector<uint8_t> zbuf;
   zkpr.write(zbuf, base);
   log(INFO, "zkp len: %zu bytes", zbuf.size());
 
+  // Writing into a caller's buffer gives the same bytes, and writes
+  // nothing if the buffer is one byte short.
+  EXPECT_EQ(zbuf.size(), zkpr.encoded_size(base));
+  EXPECT_LE(zbuf.size(), zkpr.size());
+  std::vector<uint8_t> ebuf(zbuf.size());
+  WriteBuffer short_wb(ebuf.data(), ebuf.size() - 1);
+  EXPECT_FALSE(zkpr.write(short_wb, base));
+  EXPECT_EQ(short_wb.written(), 0);
+  WriteBuffer wb(ebuf.data(), ebuf.size());
+  EXPECT_TRUE(zkpr.write(wb, base));
+  EXPECT_EQ(ebuf, zbuf);
+
   // ======= run verifier =============
   // Re-parse the proof to simulate a different client.
   ZkProof<Field> zkpv(circuit, kLigeroRate, kLigeroNreq);
@@ -82,6 +131,22 @@ void run2_test_zk(const Circuit<Field>& circuit, Dense<Field>& W,
   verifier.recv_commitment(zkpv, tv);
   EXPECT_TRUE(verifier.verify(zkpv, pub, tv));
   log(INFO, "ZK Verify done");
+
+  // A tampered Merkle opening fails, and so does a tampered sumcheck
+  // transcript, since it changes the opened columns.
+  for (size_t tamper = 0; tamper < 2; ++tamper) {
+    ZkProof<Field> zkpb(circuit, kLigeroRate, kLigeroNreq);
+    ReadBuffer rbb(zbuf);
+    EXPECT_TRUE(zkpb.read(rbb, base));
+    if (tamper == 0) {
+      zkpb.com_proof.merkle.path[0].data[0] ^= 1;
+    } else {
+      base.add(zkpb.proof.l[0].wc[0], base.one());
+    }
+    Transcript tb((uint8_t*)"zk_test", 7, kVersion);
+    verifier.recv_commitment(zkpb, tb);
+    EXPECT_FALSE(verifier.verify(zkpb, pub, tb));
+  }
 }
 
 template <class Field>
@@ -22,9 +22,11 @@
 #include "arrays/dense.h"
 #include "ligero/ligero_param.h"
 #include "ligero/ligero_verifier.h"
+#include "merkle/merkle_tree.h"
 #include "random/transcript.h"
 #include "sumcheck/circuit.h"
 #include "util/log.h"
+#include "util/panic.h"
 #include "zk/zk_common.h"
 #include "zk/zk_proof.h"
 
@@ -55,17 +57,23 @@ class ZkVerifier {
 
   explicit ZkVerifier(const Circuit<Field>& c, const RSFactory& rsf,
                       size_t rate, size_t nreq, size_t block_enc,
-                      const Field& F)
+                      const Field& F,
+                      const MerkleShape& shape = MerkleShape{})
       : circ_(c),
         n_witness_(c.ninputs - c.npub_in),
         param_(n_witness_ + ZkCommon<Field>::pad_size(c), c.nl, rate, nreq,
-               block_enc),
+               block_enc, shape),
         lqc_(c.nl),
         rsf_(rsf),
         f_(F) {
     ZkCommon<Field>::setup_lqc(c, lqc_, n_witness_);
   }
 
+  // Use up to N threads, including the caller, in verify().  The
+  // default of 1 never creates threads, so that callers with their
+  // own thread pools are not oversubscribed.
+  void set_threads(size_t n) { max_threads_ = n; }
+
   void recv_commitment(const ZkProof<Field>& zk, Transcript& t) const {
     log(INFO, "verifier: recv commit");
     LigeroVerifier<Field, RSFactory>::receive_commitment(zk.com, t);
@@ -78,19 +86,37 @@ class ZkVerifier {
 
     ZkCommon<Field>::initialize_sumcheck_fiat_shamir(tv, circ_, pub, f_);
 
-    // Derive constraints on the witness.
-    using Llc = LigeroLinearConstraint<Field>;
-    std::vector<Llc> A;
-    std::vector<Elt> b;
+    // Fail fast.  The transcript depends on the constraints only
+    // through their number and through HASH_OF_A, which is a
+    // constant.  We thus replay the whole transcript first, then check
+    // the Merkle opening and the low-degree test, where most bad
+    // proofs fail, and only then derive the constraints, which costs
+    // O(circuit size).
+    using LV = LigeroVerifier<Field, RSFactory>;
+    typename ZkCommon<Field>::SumcheckReplay sr(circ_.nl);
+    ZkCommon<Field>::replay(sr, circ_, zk.proof, tv, n_witness_, f_);
+
     const LigeroHash hash_of_A{0xde, 0xad, 0xbe, 0xef};
-    size_t cn = ZkCommon<Field>::verifier_constraints(circ_, pub, zk.proof,
-                                                      /*aux=*/nullptr, A, b, tv,
-                                                      n_witness_, f_);
+    typename LV::Challenges ch(param_,
+                               ZkCommon<Field>::num_constraints(circ_));
+    LV::replay(ch, param_, zk.com_proof, tv, hash_of_A, f_);
 
     const char* why = "";
-    bool ok = LigeroVerifier<Field, RSFactory>::verify(
-        &why, param_, zk.com, zk.com_proof, tv, cn, A.size(), &A[0], hash_of_A,
-        &b[0], &lqc_[0], rsf_, f_);
+    bool ok = LV::check_opening(&why, param_, zk.com, zk.com_proof, ch, rsf_,
+                                f_);
+    if (ok) {
+      // Derive constraints on the witness.
+      using Llc = LigeroLinearConstraint<Field>;
+      std::vector<Llc> A;
+      std::vector<Elt> b;
+      size_t cn = ZkCommon<Field>::constraints(sr, circ_, pub, zk.proof,
+                                               /*aux=*/nullptr, A, b, f_,
+                                               max_threads_);
+      check(cn == ch.alphal.size(), "cn == num_constraints()");
+
+      ok = LV::check_constraints(&why, param_, zk.com_proof, ch, A.size(),
+                                 &A[0], &b[0], &lqc_[0], rsf_, f_);
+    }
 
     log(INFO, "verify done: %s", why);
     return ok;
@@ -103,6 +129,7 @@ class ZkVerifier {
   std::vector<LigeroQuadraticConstraint> lqc_;
   const RSFactory& rsf_;
   const Field& f_;
+  size_t max_threads_ = 1;
 };
 }  // namespace proofs
 
@@ -36,7 +36,7 @@ import (
 // /* Simple helpers to manipulate the C structs. */
 //
 // ZkSpecStruct* make_zkspec(size_t num) {
-//    ZkSpecStruct *r = malloc(sizeof(ZkSpecStruct));
+//    ZkSpecStruct *r = calloc(1, sizeof(ZkSpecStruct));
 //    r->num_attributes = num;
 //    return r;
 // }